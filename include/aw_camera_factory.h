@@ -3,13 +3,14 @@
 
 #include "device_camera_base.h"
 #include "device_camera_sy011.h"  // 引入SY011相机
+#include "device_camera_simulator.h"  // 模拟相机（无硬件测试/基准）
 
 class CameraFactory {
 public:
     // 枚举相机类型
     enum class CameraType {
         SY011,  // SY011相机
-        SIMULATOR  // 模拟器（可扩展）
+        SIMULATOR  // 模拟器：合成帧或回放录制帧
     };
 
     // 工厂方法：根据类型创建相机实例
@@ -17,6 +18,8 @@ public:
         switch (type) {
             case CameraType::SY011:
                 return std::make_unique<DeviceCameraSY011>();
+            case CameraType::SIMULATOR:
+                return std::make_unique<DeviceCameraSimulator>();
             default:
                 return nullptr;
         }
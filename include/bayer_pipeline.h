@@ -0,0 +1,68 @@
+// bayer_pipeline.h
+#ifndef BAYER_PIPELINE_H
+#define BAYER_PIPELINE_H
+
+#include "MvCameraControl.h"
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// 与SDK转换结果的对比
+struct BayerCompareResult {
+    bool ok = false;
+    double mean_abs_diff = 0.0;
+    double max_abs_diff = 0.0;
+};
+
+// 主机端Bayer8去马赛克，可与去畸变查找、缩放融合为一次输出写入。
+// Without a remap the whole frame goes through OpenCV's vectorized bilinear demosaic straight
+// into dst. With undistortion and/or resize, the output is processed in row tiles in parallel:
+// each tile demosaics only the source rows its lookup touches into a cache-sized scratch
+// buffer, then remaps them into its rows of dst.
+class BayerDemosaicer {
+public:
+    BayerDemosaicer() = default;
+
+    // 配置输入尺寸、Bayer排列与输出尺寸；map_x/map_y（可选，CV_32FC1，输入尺寸）为去畸变查找表
+    bool configure(const cv::Size& input_size, MvGvspPixelType bayer_type, const cv::Size& output_size,
+                   const cv::Mat& map_x = cv::Mat(), const cv::Mat& map_y = cv::Mat());
+    bool is_configured() const { return color_code_ >= 0; }
+
+    void set_num_threads(int num_threads) { num_threads_ = num_threads < 0 ? 0 : num_threads; }
+    void set_tile_rows(int tile_rows);
+
+    const cv::Size& input_size() const { return input_size_; }
+    const cv::Size& output_size() const { return output_size_; }
+
+    // 输入Bayer8数据（stride为每行字节数），输出BGR8；dst尺寸类型匹配时直接写入
+    bool process(const unsigned char* bayer, size_t stride, cv::Mat& dst);
+
+    static bool is_bayer8(MvGvspPixelType pixel_type);
+
+    // 按Bayer排列对BGR8图像采样，得到单通道Bayer8图像（用于合成测试帧）
+    static void mosaic(const cv::Mat& bgr, MvGvspPixelType bayer_type, cv::Mat& bayer);
+
+    // 用合成Bayer帧对比本类与MV_CC_ConvertPixelTypeEx的BGR8结果（不含2像素边框）
+    static BayerCompareResult compare_with_sdk(void* handle, int width, int height, MvGvspPixelType bayer_type);
+
+private:
+    struct Tile {
+        int out_row_begin;
+        int out_row_end;
+        int src_row_begin;      // 偶数，保证子图与整图的Bayer相位一致
+        int src_row_end;
+        cv::Mat map1;           // 相对src_row_begin的定点映射表
+        cv::Mat map2;
+    };
+
+    bool build_tiles(const cv::Mat& map_x, const cv::Mat& map_y);
+
+    cv::Size input_size_;
+    cv::Size output_size_;
+    int color_code_ = -1;
+    bool identity_ = true;
+    int num_threads_ = 0;
+    int tile_rows_ = 32;
+    std::vector<Tile> tiles_;
+};
+
+#endif // BAYER_PIPELINE_H
@@ -0,0 +1,78 @@
+// camera_manager.h
+#ifndef CAMERA_MANAGER_H
+#define CAMERA_MANAGER_H
+
+#include "device_camera_sy011.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 帧组中单个相机的一帧
+struct CameraFrame {
+    std::string serial;
+    uint64_t sequence = 0;                  // 该相机帧环中的序号
+    uint64_t timestamp = 0;                 // 对齐所用的时间戳
+    MV_FRAME_OUT_INFO_EX info = {};
+    std::vector<unsigned char> data;        // 跨调用复用，容量只增不减
+};
+
+// 按时间戳对齐的一组帧，frames与相机顺序一致
+struct FrameSet {
+    std::vector<CameraFrame> frames;
+    uint64_t reference_timestamp = 0;
+    uint64_t skew = 0;                      // 组内最大时间差
+};
+
+// 多相机管理：SDK只初始化一次，按序列号打开USB/GigE设备，每个设备使用各自的SDK取流线程
+// 写入各自的FrameRing（可绑定CPU），grab_frame_set()从各环中取出时间戳对齐的一组帧。
+// 设备时间戳只有在相机之间做过时钟同步（PTP/动作命令）时才可比，否则使用主机时间戳。
+class CameraManager {
+public:
+    CameraManager();
+    ~CameraManager();
+
+    CameraManager(const CameraManager&) = delete;
+    CameraManager& operator=(const CameraManager&) = delete;
+
+    // 枚举设备，返回序列号列表；结果在进程内缓存，refresh为true时重新枚举
+    std::vector<std::string> enumerate(unsigned int layer_types = MV_USB_DEVICE | MV_GIGE_DEVICE, bool refresh = false);
+
+    // 打开序列号匹配的设备；serials为空时打开全部，打开顺序与serials一致
+    bool open(const std::vector<std::string>& serials = std::vector<std::string>(),
+              unsigned int layer_types = MV_USB_DEVICE | MV_GIGE_DEVICE);
+
+    size_t camera_count() const { return cameras_.size(); }
+    DeviceCameraSY011* camera(size_t index);
+    std::string serial(size_t index) const;
+
+    bool set_cpu_affinity(size_t index, int cpu);
+    bool start(size_t slot_count = 8);
+    void stop();
+    void close();
+
+    void set_skew_tolerance(uint64_t tolerance) { skew_tolerance_ = tolerance; }
+    uint64_t skew_tolerance() const { return skew_tolerance_; }
+    void set_use_host_timestamp(bool use_host_timestamp) { use_host_timestamp_ = use_host_timestamp; }
+
+    // 等待并取出下一组对齐的帧；每一帧最多出现在一组中
+    bool grab_frame_set(FrameSet& frame_set, unsigned int timeout_ms = 1000);
+
+    // 因时间差超过容差而被放弃的参考帧数
+    uint64_t unmatched_count() const { return unmatched_; }
+
+private:
+    // 返回true表示已组成一组；否则blocking_camera为需要等待新帧的相机
+    bool try_align(FrameSet& frame_set, size_t& blocking_camera);
+
+    std::vector<std::unique_ptr<DeviceCameraSY011>> cameras_;
+    std::vector<uint64_t> next_sequence_;   // 每个相机下一组可用的最小序号
+    bool sdk_acquired_ = false;
+
+    uint64_t skew_tolerance_ = 1000000;     // 默认1ms（时间戳单位为ns时）
+    bool use_host_timestamp_ = false;
+    uint64_t unmatched_ = 0;
+    uint64_t last_unmatched_reference_ = UINT64_MAX;
+};
+
+#endif // CAMERA_MANAGER_H
@@ -0,0 +1,76 @@
+// camera_nodes.h
+#ifndef CAMERA_NODES_H
+#define CAMERA_NODES_H
+
+#include "MvCameraControl.h"
+#include <cstdint>
+
+// 本库访问的相机节点；同一用途在不同机型上可能有不同的节点名
+enum class CameraNode {
+    Width,
+    Height,
+    OffsetX,
+    OffsetY,
+    BinningHorizontal,
+    BinningVertical,
+    DecimationHorizontal,
+    DecimationVertical,
+    PixelFormat,
+    PayloadSize,
+    ExposureTime,
+    Gain,
+    ResultingFrameRate,
+    GevSCPSPacketSize,
+    TriggerMode,
+    TriggerSource,
+    TriggerSoftware,
+    AcquisitionBurstFrameCount,
+    ImageCompressionMode,
+    Count
+};
+
+// 节点缓存：每个节点第一次访问时在候选名中找出设备实际实现的那个，并记下它的类型
+// （整型/浮点/枚举/布尔/命令），此后直接调用对应类型的SDK接口，不再逐个名字、逐个类型地试探；
+// 设备没有实现的节点同样被记住，再次访问立即返回false。
+// 换句柄（打开/重连）时调用attach()清空。本类不加锁，由相机类在持有设备锁时调用。
+class CameraNodeCache {
+public:
+    void attach(void* handle);
+
+    bool supported(CameraNode node);
+    const char* name(CameraNode node);      // 解析出的节点名，未实现时为nullptr
+    static const char* label(CameraNode node);  // 首选节点名，用于日志
+
+    // 整型节点的当前值与min/max/inc
+    bool get_int(CameraNode node, MVCC_INTVALUE_EX& value);
+    bool set_int(CameraNode node, int64_t value);
+
+    // 按节点的实际类型读写数值。写入总是下发到设备：配置文件、自动曝光或其他客户端
+    // 都可能在本库之外改写节点，记下的上次写入值不能代表设备上的当前值
+    bool get_number(CameraNode node, double& value);
+    bool set_number(CameraNode node, double value);
+
+    // 按符号名写入枚举节点（如ImageCompressionMode的"HB"/"Off"）
+    bool set_enum_string(CameraNode node, const char* value);
+
+    // 执行命令节点（如TriggerSoftware）
+    bool execute(CameraNode node);
+
+    int last_error() const { return last_error_; }
+
+private:
+    enum class NodeType : uint8_t { Unresolved, Missing, Integer, Float, Enumeration, Boolean, Command };
+
+    struct Entry {
+        NodeType type = NodeType::Unresolved;
+        const char* name = nullptr;
+    };
+
+    Entry& resolve(CameraNode node);
+
+    void* handle_ = nullptr;
+    Entry entries_[(int)CameraNode::Count];
+    int last_error_ = MV_OK;
+};
+
+#endif // CAMERA_NODES_H
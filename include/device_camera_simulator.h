@@ -0,0 +1,113 @@
+// device_camera_simulator.h
+#ifndef DEVICE_CAMERA_SIMULATOR_H
+#define DEVICE_CAMERA_SIMULATOR_H
+
+#include "device_camera_base.h"
+#include "frame_ring.h"
+#include "frame_sink.h"
+#include "frame_statistics.h"
+#include "frame_telemetry.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 模拟相机：按设定的分辨率、像素格式和帧率生成合成帧或回放录制帧，
+// 并像真实相机一样填写MV_FRAME_OUT_INFO_EX。可注入丢帧、丢包和帧间隔抖动；
+// 随机数使用固定种子，同一配置下每次运行的帧序列完全一致。
+class DeviceCameraSimulator : public DeviceCamera {
+public:
+    DeviceCameraSimulator();
+    virtual ~DeviceCameraSimulator();
+
+    bool init() override;
+    bool set_resolution(int width, int height) override;
+    bool set_pixel_format(unsigned int pixel_format);      // BGR8/RGB8/Mono8/BayerXX8
+    bool set_exposure_time(int exposure_time);
+    void set_frame_rate(double fps);                        // 0表示不限速
+    void set_drop_probability(double probability);          // 每帧被丢弃（帧号跳过）的概率
+    void set_lost_packet_probability(double probability);   // 每帧报告丢包的概率
+    void set_jitter(double jitter_us);                      // 帧间隔抖动（标准差，微秒）
+    void set_seed(unsigned int seed);
+
+    // 回放：按顺序循环输出给定图像（转换为当前像素格式与分辨率）
+    bool load_replay(const std::vector<std::string>& image_paths);
+    void clear_replay();
+
+    bool start_grabbing() override;
+    void stop_grabbing() override;
+    bool capture_image(unsigned char* pData, MV_FRAME_OUT_INFO_EX& frameInfo) override;
+    // 同capture_image；后台采集时最多等待timeout_ms，主动取图时按模拟帧率出图
+    bool capture_image(unsigned char* pData, MV_FRAME_OUT_INFO_EX& frameInfo, unsigned int timeout_ms);
+    bool grabbing() const { return grabbing_; }
+    void close() override;
+
+    // 与DeviceCameraSY011相同的后台采集接口：模拟取流线程写入FrameRing
+    bool start_acquisition(size_t slot_count = 8);
+    bool acquisition_running() const { return acquisition_thread_.joinable(); }
+    bool read_latest_frame(unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo,
+                           FrameStatistics* statistics = nullptr);
+    bool read_next_frame(unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo, unsigned int timeout_ms = 1000,
+                         FrameStatistics* statistics = nullptr);
+    FrameRingStats acquisition_stats() const;
+    // 与DeviceCameraSY011::telemetry()相同；模拟相机没有SDK队列，sdk_queue_depth恒为0
+    TelemetrySnapshot telemetry() const;
+    void reset_telemetry() { telemetry_.reset(); }
+    std::shared_ptr<FrameRing> frame_ring() const { return current_ring(); }
+    // 与DeviceCameraSY011相同的帧统计，只在后台采集时计算
+    void set_frame_statistics(bool enable, const FrameStatisticsOptions& options = FrameStatisticsOptions());
+    bool frame_statistics(unsigned int frame_num, FrameStatistics& statistics) const;
+    bool frame_statistics(const MV_FRAME_OUT_INFO_EX& frameInfo, FrameStatistics& statistics) const;
+    bool latest_frame_statistics(FrameStatistics& statistics) const;
+    bool add_frame_sink(FrameSink* sink) { return sinks_.add(sink); }
+    void remove_frame_sink(FrameSink* sink) { sinks_.remove(sink); }
+
+    float get_fps() const { return (float)frame_rate_; }
+    size_t frame_size() const;                              // 当前配置下一帧的字节数
+    unsigned int get_pixel_format() const { return pixel_format_; }
+    uint64_t generated_frames() const { return frame_counter_.load(std::memory_order_relaxed); }
+    uint64_t dropped_frames() const { return dropped_.load(std::memory_order_relaxed); }
+    // 设备时间戳（ns）的零点，用于计算出图到取图的延迟
+    std::chrono::steady_clock::time_point start_time() const { return start_time_; }
+
+private:
+    void build_frames();
+    // 生成下一帧（含丢帧/抖动/限速），data指向预生成帧
+    const unsigned char* next_frame(MV_FRAME_OUT_INFO_EX& frameInfo);
+    void acquisition_loop();
+    std::shared_ptr<FrameRing> current_ring() const { return std::atomic_load(&ring_); }
+
+    int width_ = 1440;
+    int height_ = 1080;
+    unsigned int pixel_format_ = PixelType_Gvsp_BGR8_Packed;
+    double frame_rate_ = 30.0;
+    float exposure_time_ = 10000.0f;
+    double drop_probability_ = 0.0;
+    double lost_packet_probability_ = 0.0;
+    double jitter_us_ = 0.0;
+    unsigned int seed_ = 12345;
+
+    bool initialized_ = false;
+    std::atomic<bool> grabbing_{false};
+    std::vector<std::vector<unsigned char>> frames_;        // 预生成的帧，循环使用
+    std::vector<std::string> replay_paths_;
+
+    std::mt19937 rng_;
+    std::atomic<uint64_t> frame_counter_{0};                // 相机内部帧号（包括被丢弃的帧）
+    std::atomic<uint64_t> dropped_{0};
+    std::chrono::steady_clock::time_point start_time_;
+    std::chrono::steady_clock::time_point next_due_;
+
+    // 槽数变化时start_acquisition()整体替换；读者通过current_ring()持有引用，替换期间不会访问已释放的环
+    std::shared_ptr<FrameRing> ring_;
+    std::shared_ptr<const FrameStatisticsCalculator> statistics_;
+    FrameSinkList sinks_;
+    FrameTelemetry telemetry_;
+    std::thread acquisition_thread_;
+    std::atomic<uint64_t> capture_cursor_{0};               // telemetry()在其他线程读取
+};
+
+#endif // DEVICE_CAMERA_SIMULATOR_H
@@ -2,9 +2,43 @@
 #ifndef DEVICE_CAMERA_SY011_H
 #define DEVICE_CAMERA_SY011_H
 
+#include "camera_nodes.h"
 #include "device_camera_base.h"
+#include "frame_arena.h"
+#include "frame_lease.h"
+#include "frame_ring.h"
+#include "frame_sink.h"
+#include "frame_statistics.h"
+#include "frame_telemetry.h"
+#include "hb_decoder.h"
 #include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 读出窗口：宽高/偏移以传感器（合并/抽样后）像素为单位；合并、抽样为1表示关闭
+struct CameraRoi {
+    int width = 0;
+    int height = 0;
+    int offset_x = 0;
+    int offset_y = 0;
+    int binning_horizontal = 1;
+    int binning_vertical = 1;
+    int decimation_horizontal = 1;
+    int decimation_vertical = 1;
+};
+
+// 触发取图统计；延迟为发出TriggerSoftware到该触发的第一帧交给本库（回调或取图返回）
+struct TriggerStats {
+    uint64_t triggers = 0;              // 发出的软触发次数
+    uint64_t frames = 0;                // 按触发取到的帧数
+    uint64_t timeouts = 0;              // 等待触发帧超时的次数
+    LatencySummary trigger_to_delivery;
+};
 
 class DeviceCameraSY011 : public DeviceCamera {
 public:
@@ -12,26 +46,260 @@ public:
     virtual ~DeviceCameraSY011();
 
     bool init() override;
-    bool set_resolution(int width, int height);
+    bool init_device(const MV_CC_DEVICE_INFO& device_info);   // 打开指定设备
+    // 按序列号打开设备：使用进程内缓存的枚举结果，缓存中没有或已过期时才重新枚举
+    bool init_serial(const std::string& serial, unsigned int layer_types = MV_USB_DEVICE | MV_GIGE_DEVICE);
+    std::string serial_number() const;
+    bool set_resolution(int width, int height);   // 只改宽高，保留当前偏移与合并设置
+
+    // 设置读出窗口/偏移/合并/抽样。每个值按MVCC_INTVALUE_EX的min/max/inc对齐，applied（可选）返回实际生效的值。
+    // 取流中调用时只做一次停止/开始取流（不重新打开设备），帧环按新的PayloadSize重新分配一次
+    bool set_roi(const CameraRoi& roi, CameraRoi* applied = nullptr);
+    CameraRoi get_roi();
+    // 当前配置下一帧的字节数（相机PayloadSize），capture_image的pData至少需要这么大
+    size_t payload_size() const { return payload_size_; }
     bool set_exposure_time(int exposure_time);
+    // 设置相机输出像素格式（默认BGR8；BayerXX8可使链路带宽降为1/3，由BayerDemosaicer在主机端转换）
+    bool set_pixel_format(unsigned int pixel_format);
+    unsigned int get_pixel_format() const { return pixel_format_; }
     bool start_grabbing();
+    // 只停止取流，设备保持打开，可直接再次start_grabbing()/start_acquisition()
     void stop_grabbing();
     bool capture_image(unsigned char* pData, MV_FRAME_OUT_INFO_EX& frameInfo);
+    // 同capture_image，最多等待timeout_ms
+    bool capture_image(unsigned char* pData, MV_FRAME_OUT_INFO_EX& frameInfo, unsigned int timeout_ms);
+    // 用户启动了取流且尚未停止（重连期间仍为true）
+    bool grabbing() const { return grab_wanted_; }
+    // 关闭设备；SDK保持初始化直到对象析构，再次init()无需重新初始化和枚举
     void close() override;
 
+    // 相机配置文件（MVS导出的.mfs）：一次导入全部参数，代替逐个节点设置；应在开始取流前调用。
+    // 导入后像素格式、ROI、曝光以设备上的值为准
+    bool load_profile(const std::string& path);
+    bool save_profile(const std::string& path);
+
+    // 断线重连：SDK报告MV_EXCEPTION_DEV_DISCONNECT后，由后台线程按序列号重新打开设备，
+    // 重新导入配置文件并恢复像素格式、ROI、曝光和取流。帧环、FrameSink和调用方的缓冲区保持不变，
+    // 阻塞在read_next_frame()中的读者在重连后直接收到新帧
+    void set_auto_reconnect(bool enable);
+    bool auto_reconnect() const { return auto_reconnect_; }
+    bool reconnect();                       // 立即同步重连一次
+    bool is_connected() const { return connected_; }
+    uint64_t reconnect_count() const { return reconnect_count_; }
+    double last_reconnect_ms() const;       // 最近一次成功重连的耗时
+
+    // 由本库分配帧缓存（FrameArena：按PayloadSize切槽、页对齐、预先缺页，可选大页）并注册给SDK，
+    // 相机直接写入这些槽；slot_count为0时恢复SDK内部缓存。须在未取流时调用，下次开始取流时生效，
+    // ROI/像素格式改变后按新的负载大小重新分配。注册失败时退回SDK内部缓存。
+    // 注册后SDK不再支持MV_CC_GetOneFrameTimeout，capture_image()改用MV_CC_GetImageBuffer
+    bool use_registered_buffers(size_t slot_count, bool huge_pages = false);
+    bool registered_buffers_active() const;
+    std::shared_ptr<const FrameArena> registered_buffers() const;
+
+    // 触发模式：enable为false时恢复连续采集；source取MV_TRIGGER_SOURCE_*（默认软触发）。
+    // 句柄未创建时只记录，打开设备/重连后生效；从未调用时保持设备上的设置
+    bool set_trigger_mode(bool enable, unsigned int source = MV_TRIGGER_SOURCE_SOFTWARE);
+    bool trigger_mode() const { return trigger_enabled_; }
+    unsigned int trigger_source() const { return trigger_source_; }
+    // 每次触发输出的帧数（AcquisitionBurstFrameCount），1为单帧；设备不支持时只能为1
+    bool set_burst_frame_count(int count);
+    int burst_frame_count() const { return burst_frame_count_; }
+
+    // 发出一次软触发，不等待
+    bool trigger_software();
+    // 软触发并等待这次触发产生的（第一）帧。后台采集模式下从帧环读取触发之后发布的帧；
+    // 否则先清空SDK缓存中的旧帧再取图。按帧的nTriggerIndex跳过更早触发（如之前超时的触发）迟到的帧。
+    // 要求触发模式已打开且触发源为软触发，否则直接失败。size至少为frame_buffer_size()（后台采集）或payload_size()
+    bool trigger_and_wait(unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo, unsigned int timeout_ms = 1000);
+    // 按触发采集count帧，依次写入base + i * stride（如FrameArena的槽）：每burst_frame_count()帧发出一次软触发。
+    // 返回实际取到的帧数，超时时少于count。后台采集模式下帧环应至少容纳一次突发的帧数
+    size_t trigger_burst(unsigned char* base, size_t stride, size_t count, MV_FRAME_OUT_INFO_EX* infos,
+                         unsigned int timeout_ms = 1000);
+    // 曝光包围：每帧先写入对应的ExposureTime（us）再软触发，依次写入base + i * stride；
+    // 结束后恢复原曝光。要求突发帧数为1；实际曝光可由infos[i].fExposureTime核对
+    size_t capture_bracket(const std::vector<double>& exposure_times, unsigned char* base, size_t stride,
+                           MV_FRAME_OUT_INFO_EX* infos, unsigned int timeout_ms = 1000);
+    TriggerStats trigger_stats() const;
+    void reset_trigger_stats();
+
+    // 零拷贝取图：借用SDK内部缓存（或已注册的FrameArena槽），失败时返回无效的FrameLease
+    FrameLease acquire_frame(unsigned int timeout_ms = 1000);
+
     // Add method to get FPS
     float get_fps();
 
+    // 后台采集：注册SDK图像回调，由SDK取流线程把每帧写入预分配的FrameRing，然后开始取流。
+    // 替代start_grabbing()调用；此模式下capture_image()改为从环中逐帧读取，acquire_frame()不可用
+    bool start_acquisition(size_t slot_count = 8);
+    bool acquisition_running() const { return acquisition_; }
+
+    // 非阻塞读取最新一帧；statistics（可选）同时返回该帧的统计（未开启时valid为false）
+    bool read_latest_frame(unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo,
+                           FrameStatistics* statistics = nullptr);
+    // 逐帧读取（无损）：使用相机内部游标，或调用方自己的游标（初值取acquisition_cursor()）
+    bool read_next_frame(unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo, unsigned int timeout_ms = 1000,
+                         FrameStatistics* statistics = nullptr);
+    bool read_next_frame(uint64_t& cursor, unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo,
+                         unsigned int timeout_ms = 1000, FrameStatistics* statistics = nullptr);
+    uint64_t acquisition_cursor() const;
+
+    FrameRingStats acquisition_stats() const;
+    // 逐帧时间/丢帧统计快照（无锁，可频繁调用）；ring_backlog相对相机内部游标
+    TelemetrySnapshot telemetry() const;
+    void reset_telemetry() { telemetry_.reset(); }
+    size_t frame_buffer_size() const;   // 环中每个槽的字节数
+
+    // 在取流线程上逐帧计算亮度直方图/均值/对焦度量/饱和像素数（采样网格或ROI），作为帧元数据随帧保存在环中；
+    // 主动取图（capture_image）时保存最近一帧的统计。取流中也可以开关或修改选项
+    void set_frame_statistics(bool enable, const FrameStatisticsOptions& options = FrameStatisticsOptions());
+    bool frame_statistics_enabled() const { return std::atomic_load(&statistics_) != nullptr; }
+    // 帧号为frame_num的帧的统计：该帧仍在环中，或是最近一次主动取到的帧
+    bool frame_statistics(unsigned int frame_num, FrameStatistics& statistics) const;
+    // 按帧号和时间戳查找，重连后帧号重新计数也不会取到别的帧
+    bool frame_statistics(const MV_FRAME_OUT_INFO_EX& frameInfo, FrameStatistics& statistics) const;
+    bool latest_frame_statistics(FrameStatistics& statistics) const;
+    // ROI或负载变化时帧环会被整体替换，调用方持有返回的引用期间旧环不会释放
+    std::shared_ptr<FrameRing> frame_ring() const { return current_ring(); }
+
+    // HB无损压缩传输（ImageCompressionMode=HB）：链路带宽受限时相机输出压缩帧以提高帧率。
+    // 后台采集模式下由decode_threads个线程与取流并行解码，按帧序交付，帧环、FrameSink和帧统计只看到解码后的帧；
+    // 主动取图（capture_image/trigger_and_wait）时同步解码，acquire_frame()租借的仍是压缩帧。
+    // 须在未取流时调用；句柄未创建时只记录，打开设备/重连后生效；从未调用时保持设备上的设置
+    bool set_lossless_compression(bool enable, int decode_threads = 2);
+    bool lossless_compression() const { return hb_enabled_; }
+    // 后台采集的压缩侧/解码侧吞吐与解码耗时
+    HbDecodeStats hb_decode_stats() const;
+    void reset_hb_decode_stats();
+
+    // 在取流线程（HB压缩时为交付解码帧的线程）上接收每一帧的消费者（录像等），仅在后台采集模式下调用；
+    // remove_frame_sink返回后即可安全销毁该消费者
+    bool add_frame_sink(FrameSink* sink) { return sinks_.add(sink); }
+    void remove_frame_sink(FrameSink* sink) { sinks_.remove(sink); }
+
+    // 把该设备的SDK取流（回调）线程绑定到指定CPU，-1表示不绑定；在start_acquisition之前调用
+    void set_cpu_affinity(int cpu);
+
     // Image callback
-    static void image_callback(unsigned char* pData, MV_FRAME_OUT_INFO_EX& frameInfo, void* pUser);
+    static void __stdcall image_callback(unsigned char* pData, MV_FRAME_OUT_INFO_EX* pFrameInfo, void* pUser);
+    static void __stdcall exception_callback(unsigned int nMsgType, void* pUser);
 
 private:
-    bool openDevice();
+    bool openDevice(const MV_CC_DEVICE_INFO& device_info);
+    bool open_serial(const std::string& serial, unsigned int layer_types);
+    void release_handle();
+    void end_grab_session();
+    bool prepare_registered_buffers();
+    bool apply_trigger_settings();
+    bool apply_compression_settings();
+    // 主动取图（capture_image的非回调路径），pData至少size字节
+    bool grab_frame(unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo, unsigned int timeout_ms);
+    // 主动取到一帧后计算并保存其统计（开启时）
+    void update_polled_statistics(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo);
+    // 帧交给本库时调用：有未完成的软触发时记录触发到交付的延迟
+    void note_trigger_delivery();
+    // 发出软触发，trigger_index返回这次触发的帧应带的触发计数
+    bool issue_trigger(uint32_t& trigger_index);
+    // 等待触发计数不早于trigger_index的帧（从帧环的cursor处或主动取图），跳过更早触发的帧
+    bool wait_trigger_frame(bool from_ring, uint64_t& cursor, uint32_t trigger_index, unsigned char* pData, size_t size,
+                            MV_FRAME_OUT_INFO_EX& frameInfo, unsigned int timeout_ms);
+    size_t query_payload_size();
+    // 使HB解码池与当前句柄、负载大小和槽数一致，不一致时重建；旧池正在运行（采集中）时由新池接替。
+    // 开始采集时调用，ROI、像素格式或配置文件改变负载大小后也要调用
+    std::shared_ptr<HbDecoder> update_hb_decoder(size_t slot_count);
+    // 按节点的min/max/inc对齐后写入整型参数，actual返回写入的值
+    bool set_int_aligned(CameraNode node, int64_t value, int64_t* actual = nullptr);
+    bool set_binning(CameraNode node, int value);
+    int get_binning(CameraNode node);
+    void reapply_settings();
+    void start_reconnect_thread();
+    void stop_reconnect_thread();
+    void reconnect_loop();
+    std::shared_ptr<FrameRing> current_ring() const { return std::atomic_load(&ring_); }
+    static void pin_current_thread(int cpu);
     void image_callback_handler(unsigned char* pData, MV_FRAME_OUT_INFO_EX& frameInfo);
+    // 把一帧（原始或解码后）交给帧环和FrameSink；同一时刻只有一个线程调用
+    void deliver_frame(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo);
+
+    unsigned int pixel_format_ = PixelType_Gvsp_BGR8_Packed;
+    MV_CC_DEVICE_INFO device_info_ = {};
+    bool sdk_acquired_ = false;
+
+    // 保护句柄和节点缓存：配置/取图与重连线程互斥（递归锁，set_resolution等会嵌套调用）
+    mutable std::recursive_mutex device_mutex_;
+    CameraNodeCache nodes_;
+
+    // 重连后需要恢复的配置
+    std::string profile_path_;
+    CameraRoi roi_;
+    bool roi_applied_ = false;
+    double exposure_time_ = -1.0;
+    std::atomic<bool> grab_wanted_{false};  // 用户启动了取流且尚未停止
+    bool trigger_configured_ = false;
+    bool trigger_enabled_ = false;
+    unsigned int trigger_source_ = MV_TRIGGER_SOURCE_SOFTWARE;
+    int burst_frame_count_ = 1;
+    bool hb_configured_ = false;
+    bool hb_enabled_ = false;
+    int hb_decode_threads_ = 2;
+
+    // 最近一次软触发的时间（steady_clock，us），该触发的第一帧交付时清零
+    std::atomic<int64_t> pending_trigger_us_{0};
+    std::atomic<uint64_t> triggers_{0};
+    // 最近交付的帧的nTriggerIndex，以及最近一次软触发期望的触发计数（device_mutex_保护）
+    std::atomic<uint32_t> last_trigger_index_{0};
+    uint32_t expected_trigger_index_ = 0;
+    std::atomic<uint64_t> trigger_frames_{0};
+    std::atomic<uint64_t> trigger_timeouts_{0};
+    LatencyHistogram trigger_latency_;
+
+    // 帧统计的计算器（只读，整体替换）；主动取图路径的最近一帧统计由statistics_mutex_保护
+    std::shared_ptr<const FrameStatisticsCalculator> statistics_;
+    mutable std::mutex statistics_mutex_;
+    FrameStatistics polled_statistics_;
+
+    // 后台采集的HB解码池，由update_hb_decoder()创建（尺寸和句柄不变时复用），回调线程通过atomic_load取用；
+    // hb_buffer_是主动取图路径解码前暂存压缩帧的缓冲区
+    std::shared_ptr<HbDecoder> hb_decoder_;
+    std::vector<unsigned char> hb_buffer_;
+
+    // 主动取图在SDK里阻塞等待时不持有device_mutex_：poll_mutex_让取图者之间串行（共用hb_buffer_），
+    // polls_in_flight_计数正在等待的取图，release_handle()停止取流后等它归零再销毁句柄
+    std::mutex poll_mutex_;
+    std::atomic<int> polls_in_flight_{0};
+
+    std::atomic<bool> auto_reconnect_{false};
+    std::atomic<bool> connected_{false};
+    std::atomic<uint64_t> reconnect_count_{0};
+    std::atomic<int64_t> last_reconnect_us_{0};
+    std::thread reconnect_thread_;
+    std::mutex reconnect_mutex_;
+    std::condition_variable reconnect_cv_;
+    bool reconnect_pending_ = false;
+    bool reconnect_stop_ = false;
+    // 重连恢复配置期间为true：帧环未重新分配时保留读游标，重连前未读的帧仍可读出（device_mutex_保护）
+    bool resuming_ = false;
+
+    int affinity_cpu_ = -1;
+    std::atomic<bool> affinity_applied_{false};
+
+    // 注册给SDK的帧缓存；重新分配时整体替换，FrameLease持有旧内存池的引用直到归还
+    std::shared_ptr<FrameArena> arena_;
+    size_t arena_slots_ = 0;
+    bool arena_huge_pages_ = false;
+
+    // 当前取流会话，FrameLease持有其引用；停止取流或销毁句柄之前由end_grab_session()结束，
+    // 之后FrameLease不再归还旧缓存
+    std::shared_ptr<GrabSession> grab_session_;
 
-    // 加锁保护的成员变量
-    std::mutex image_mutex_;
-    cv::Mat latest_image_;
+    // 后台采集的帧环，回调线程是唯一的生产者
+    // ROI变化时整体替换，读者通过current_ring()持有引用，替换期间不会访问已释放的环
+    std::shared_ptr<FrameRing> ring_;
+    FrameSinkList sinks_;
+    FrameTelemetry telemetry_;
+    size_t payload_size_ = 0;
+    bool acquisition_ = false;
+    // 内部读游标：取帧线程推进，telemetry()和trigger_burst()在其他线程读取或前移
+    std::atomic<uint64_t> capture_cursor_{0};
 };
 
 #endif // DEVICE_CAMERA_SY011_H
@@ -0,0 +1,54 @@
+// frame_arena.h
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include "MvCameraControl.h"
+#include <cstddef>
+
+// 帧内存池：一次分配一整块对齐内存（可选大页），按固定步长切成若干槽。
+// 分配时即完成缺页，取流过程中不再有缺页和逐帧分配；槽起始地址按页对齐，
+// 可以直接作为cv::Mat/NumPy数组的存储，也可以用MV_CC_RegisterBuffer注册给SDK，让相机直接写入。
+class FrameArena {
+public:
+    FrameArena() = default;
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // huge_pages：先尝试预留的大页（MAP_HUGETLB），失败时退回普通页并请求透明大页
+    bool allocate(size_t slot_count, size_t slot_size, size_t alignment = 64, bool huge_pages = false);
+    void release();
+
+    bool empty() const { return base_ == nullptr; }
+    size_t slot_count() const { return slot_count_; }
+    size_t slot_size() const { return slot_size_; }        // 每个槽可用的字节数
+    size_t slot_stride() const { return slot_stride_; }    // 相邻槽起始地址的间隔
+    size_t bytes() const { return bytes_; }
+    bool huge_pages() const { return huge_pages_; }         // 实际使用了MAP_HUGETLB大页
+
+    unsigned char* data() const { return base_; }
+    unsigned char* slot(size_t index) const { return base_ + index * slot_stride_; }
+    // p所在的槽，不在本内存池内时返回-1
+    int slot_index(const void* p) const;
+
+    // 把每个槽注册给设备（MV_CC_RegisterBuffer），之后SDK只通过回调或MV_CC_GetImageBuffer交付图像；
+    // 必须在开始取流之前调用，关闭设备之前调用unregister_buffers()
+    bool register_buffers(void* handle);
+    void unregister_buffers();
+    bool registered() const { return registered_handle_ != nullptr; }
+    void* registered_handle() const { return registered_handle_; }
+
+private:
+    unsigned char* base_ = nullptr;
+    size_t bytes_ = 0;
+    size_t slot_count_ = 0;
+    size_t slot_size_ = 0;
+    size_t slot_stride_ = 0;
+    bool huge_pages_ = false;
+    bool mapped_ = false;                   // mmap分配；否则为MV_CC_AllocAlignedBuffer
+    void* registered_handle_ = nullptr;
+    size_t registered_count_ = 0;
+};
+
+#endif // FRAME_ARENA_H
@@ -0,0 +1,85 @@
+// frame_lease.h
+#ifndef FRAME_LEASE_H
+#define FRAME_LEASE_H
+
+#include "MvCameraControl.h"
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+// 一次取流会话。FrameLease在mutex下检查active并归还缓存；相机停止取流或销毁句柄之前调用end()，
+// 之后不会再有归还落在已停止或已销毁的句柄上，进行中的归还也已结束
+struct GrabSession {
+    std::mutex mutex;
+    bool active = true;
+
+    void end() {
+        std::lock_guard<std::mutex> lock(mutex);
+        active = false;
+    }
+};
+
+// 借用SDK内部图像缓存（MV_CC_GetImageBuffer），析构或release()时归还（MV_CC_FreeImageBuffer）
+// 数据指针属于SDK，归还之后不得再使用
+class FrameLease {
+public:
+    FrameLease() { std::memset(&frame_, 0, sizeof(frame_)); }
+
+    // session由相机持有，停止取流或关闭时结束；比取流会话活得更久的租借不会把旧缓存还给SDK。
+    // backing（可选）是注册给SDK的帧内存，租借期间保持其有效
+    FrameLease(void* handle, const MV_FRAME_OUT& frame, std::shared_ptr<GrabSession> session,
+               std::shared_ptr<const void> backing = nullptr)
+        : handle_(handle), frame_(frame), session_(std::move(session)), backing_(std::move(backing)) {}
+
+    ~FrameLease() { release(); }
+
+    FrameLease(const FrameLease&) = delete;
+    FrameLease& operator=(const FrameLease&) = delete;
+
+    FrameLease(FrameLease&& other) noexcept
+        : handle_(other.handle_), frame_(other.frame_), session_(std::move(other.session_)),
+          backing_(std::move(other.backing_)) {
+        other.handle_ = nullptr;
+        std::memset(&other.frame_, 0, sizeof(other.frame_));
+    }
+
+    FrameLease& operator=(FrameLease&& other) noexcept {
+        if (this != &other) {
+            release();
+            handle_ = other.handle_;
+            frame_ = other.frame_;
+            session_ = std::move(other.session_);
+            backing_ = std::move(other.backing_);
+            other.handle_ = nullptr;
+            std::memset(&other.frame_, 0, sizeof(other.frame_));
+        }
+        return *this;
+    }
+
+    bool valid() const { return handle_ != nullptr && frame_.pBufAddr != nullptr; }
+    unsigned char* data() const { return frame_.pBufAddr; }
+    size_t size() const { return frame_.stFrameInfo.nFrameLen; }
+    const MV_FRAME_OUT_INFO_EX& info() const { return frame_.stFrameInfo; }
+
+    // 归还缓存给SDK，可重复调用
+    void release() {
+        if (valid() && session_) {
+            std::lock_guard<std::mutex> lock(session_->mutex);
+            if (session_->active) {
+                MV_CC_FreeImageBuffer(handle_, &frame_);
+            }
+        }
+        handle_ = nullptr;
+        std::memset(&frame_, 0, sizeof(frame_));
+        session_.reset();
+        backing_.reset();
+    }
+
+private:
+    void* handle_ = nullptr;
+    MV_FRAME_OUT frame_;
+    std::shared_ptr<GrabSession> session_;
+    std::shared_ptr<const void> backing_;
+};
+
+#endif // FRAME_LEASE_H
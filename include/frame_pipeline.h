@@ -0,0 +1,197 @@
+// frame_pipeline.h
+#ifndef FRAME_PIPELINE_H
+#define FRAME_PIPELINE_H
+
+#include "bayer_pipeline.h"
+#include "bounded_queue.h"
+#include "frame_sink.h"
+#include "frame_statistics.h"
+#include "frame_telemetry.h"
+#include "undistort.h"
+#include "MvCameraControl.h"
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 在流水线中流动的一帧。缓冲区属于帧池，跨帧复用：非原地阶段写入scratch后与image交换，
+// 尺寸类型不变时不再分配内存。
+struct PipelineFrame {
+    MV_FRAME_OUT_INFO_EX info = {};
+    uint64_t sequence = 0;
+    int64_t submit_us = 0;              // 进入流水线的时间（steady_clock）
+    bool from_raw = false;              // raw中是相机原始帧，需由解码阶段转换
+    std::vector<unsigned char> raw;
+    cv::Mat image;                      // 当前阶段的结果（BGR8或Mono8）
+    cv::Mat scratch;
+    FrameStatistics statistics;         // 统计阶段的结果，没有统计阶段时valid为false
+};
+
+// 叠加层：全部在image上原地绘制
+struct OverlayOptions {
+    bool crosshair = true;
+    int crosshair_size = 20;
+    bool frame_info = false;            // 左上角显示帧号和流水线输出帧率
+    std::string text;                   // 额外的固定文字
+    cv::Scalar color = cv::Scalar(0, 0, 255);
+    int thickness = 2;
+};
+
+struct PipelineStageStats {
+    std::string name;
+    uint64_t processed = 0;
+    size_t queue_depth = 0;             // 等待该阶段处理的帧数
+    LatencySummary latency;             // 单帧处理耗时
+};
+
+struct PipelineStats {
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    uint64_t failed = 0;
+    uint64_t dropped_input = 0;         // 帧池空或第一阶段队列满，帧未进入流水线
+    uint64_t dropped_stage = 0;         // 已处理完一个阶段但未能进入下一阶段队列的帧
+    uint64_t dropped_output = 0;        // 输出队列满时被较新结果顶替的旧结果
+    size_t output_depth = 0;
+    LatencySummary end_to_end;          // 进入流水线到处理完成
+    std::vector<PipelineStageStats> stages;
+};
+
+class FramePipeline;
+
+// 流水线输出帧的借用：持有期间缓冲区不会被复用，析构或release()后归还帧池
+class PipelineOutput {
+public:
+    PipelineOutput() = default;
+    ~PipelineOutput() { release(); }
+    PipelineOutput(PipelineOutput&& other) noexcept;
+    PipelineOutput& operator=(PipelineOutput&& other) noexcept;
+    PipelineOutput(const PipelineOutput&) = delete;
+    PipelineOutput& operator=(const PipelineOutput&) = delete;
+
+    bool valid() const { return frame_ != nullptr; }
+    const cv::Mat& image() const { return frame_->image; }
+    const MV_FRAME_OUT_INFO_EX& info() const { return frame_->info; }
+    uint64_t sequence() const { return frame_->sequence; }
+    const FrameStatistics& statistics() const { return frame_->statistics; }
+    void release();
+
+private:
+    friend class FramePipeline;
+    PipelineOutput(FramePipeline* pipeline, PipelineFrame* frame) : pipeline_(pipeline), frame_(frame) {}
+
+    FramePipeline* pipeline_ = nullptr;
+    PipelineFrame* frame_ = nullptr;
+};
+
+// 可组合的帧处理流水线：解码（Bayer/RGB/Mono -> BGR/Mono）之后依次执行配置的阶段
+// （去畸变、叠加、颜色转换、缩放、自定义回调）。各阶段之间是有界无锁队列，由固定数量的
+// 工作线程执行；同一阶段同一时刻只在一个线程上运行，所以帧顺序不变，而不同阶段处理
+// 相邻的帧，单帧工作在多个核心上重叠。下游队列满时上游暂停，最终在入口处丢帧（计数），
+// 采集线程从不等待；输出队列满时丢弃最旧的结果。
+// 作为FrameSink挂到相机上，on_frame()只把原始帧拷入池中的缓冲区并入队。
+class FramePipeline : public FrameSink {
+public:
+    using Callback = std::function<void(PipelineFrame&)>;
+
+    explicit FramePipeline(int num_threads = 2, size_t queue_capacity = 4);
+    ~FramePipeline();
+
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+
+    // 配置阶段，只能在第一次start()之前调用，按调用顺序执行
+    bool add_undistort(std::shared_ptr<ImageUndistorter> undistorter, double alpha = -1.0,
+                       int interpolation = cv::INTER_LINEAR, bool crop_to_roi = false);
+    bool add_undistort(const std::string& calibration_file, double alpha = -1.0,
+                       int interpolation = cv::INTER_LINEAR, bool crop_to_roi = false);
+    bool add_overlay(const OverlayOptions& options = OverlayOptions());
+    bool add_color_convert(int code);               // cv::cvtColor的转换码
+    bool add_resize(const cv::Size& size, int interpolation = cv::INTER_AREA);
+    bool add_callback(const std::string& name, Callback callback);
+    // 在当前image（Mono8或BGR8）上计算亮度/对焦统计，写入PipelineFrame::statistics
+    bool add_statistics(const FrameStatisticsOptions& options = FrameStatisticsOptions());
+    // Mono8输入解码为BGR（以便彩色叠加），默认保持单通道
+    void set_mono_to_bgr(bool enable) { mono_to_bgr_ = enable; }
+
+    bool start();
+    void stop();
+    bool running() const { return running_; }
+
+    void on_frame(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo) override;
+    // 提交已解码的8位图像（单通道或BGR），跳过解码阶段
+    bool submit(const cv::Mat& image, const MV_FRAME_OUT_INFO_EX* frameInfo = nullptr);
+
+    // 按顺序取下一个结果；超时返回无效的PipelineOutput
+    PipelineOutput read(unsigned int timeout_ms = 1000);
+    // 取最新的结果，丢弃（归还）更早的结果；没有结果时最多等待timeout_ms
+    PipelineOutput read_latest(unsigned int timeout_ms = 1000);
+
+    PipelineStats stats() const;
+    std::vector<std::string> stage_names() const;
+
+private:
+    friend class PipelineOutput;
+
+    struct Stage {
+        std::string name;
+        Callback process;
+        std::unique_ptr<BoundedQueue<PipelineFrame*>> input;
+        std::atomic<bool> busy{false};
+        std::atomic<uint64_t> processed{0};
+        LatencyHistogram latency;
+    };
+
+    bool add_stage(const std::string& name, Callback process);
+    bool enqueue(PipelineFrame* frame);
+    void decode(PipelineFrame& frame);
+    void worker_loop();
+    bool run_stage(size_t index);
+    void deliver(PipelineFrame* frame);
+    void recycle(PipelineFrame* frame);
+    bool runnable(size_t index) const;
+    bool has_work() const;
+    void notify_work();
+    void notify_output();
+    PipelineFrame* wait_output(unsigned int timeout_ms);
+
+    int num_threads_;
+    size_t queue_capacity_;
+    bool mono_to_bgr_ = false;
+    bool configured_ = false;           // 已经start()过，阶段与帧池固定
+    std::atomic<bool> running_{false};
+    // 正在on_frame()/submit()中的生产者数；stop()置running_为false后等它归零再回收队列中的帧
+    std::atomic<int> producers_{0};
+    std::vector<std::unique_ptr<Stage>> stages_;
+    std::vector<std::unique_ptr<PipelineFrame>> frames_;
+    std::unique_ptr<BoundedQueue<PipelineFrame*>> free_;
+    std::unique_ptr<BoundedQueue<PipelineFrame*>> output_;
+    std::vector<std::thread> workers_;
+
+    // 解码阶段的状态，同一时刻只有一个线程执行解码
+    BayerDemosaicer demosaicer_;
+    MvGvspPixelType demosaic_type_ = PixelType_Gvsp_Undefined;
+
+    // 空闲等待：只有存在等待者时才加锁通知
+    std::mutex work_mutex_;
+    std::condition_variable work_cv_;
+    std::atomic<int> work_waiters_{0};
+    std::mutex output_mutex_;
+    std::condition_variable output_cv_;
+    std::atomic<int> output_waiters_{0};
+
+    std::atomic<uint64_t> next_sequence_{0};
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::atomic<uint64_t> dropped_input_{0};
+    std::atomic<uint64_t> dropped_stage_{0};
+    std::atomic<uint64_t> dropped_output_{0};
+    LatencyHistogram end_to_end_;
+};
+
+#endif // FRAME_PIPELINE_H
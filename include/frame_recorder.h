@@ -0,0 +1,163 @@
+// frame_recorder.h
+#ifndef FRAME_RECORDER_H
+#define FRAME_RECORDER_H
+
+#include "frame_sink.h"
+#include "MvCameraControl.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 录像文件格式（每个分块文件 <base>_NNNNN.hkraw）：
+//   [RawChunkHeader, 占满第一页] [记录0] [记录1] ... [索引: RawIndexEntry * N] [RawChunkTrailer]
+// 每条记录 = RawRecordHeader + 原始帧数据，记录起始按kRawRecordAlignment对齐。
+// 尾部索引在分块结束时写入；未正常结束的分块可由读取端按记录头顺序扫描恢复。
+static const uint32_t kRawRecordMagic = 0x46524B48;    // "HKRF"
+static const uint64_t kRawRecordAlignment = 4096;
+
+struct RawChunkHeader {
+    char magic[8];                  // "HKRAWCHK"
+    uint32_t version;
+    uint32_t chunk_index;
+    uint64_t record_alignment;
+};
+
+struct RawRecordHeader {
+    uint32_t magic;
+    uint32_t header_size;           // sizeof(RawRecordHeader)，数据紧随其后
+    uint64_t length;
+    uint64_t frame_index;           // 整个录像中的序号
+    MV_FRAME_OUT_INFO_EX info;
+};
+
+struct RawIndexEntry {
+    uint64_t data_offset;           // 帧数据在分块文件中的偏移
+    uint64_t length;
+    MV_FRAME_OUT_INFO_EX info;
+};
+
+struct RawChunkTrailer {
+    uint64_t index_offset;
+    uint64_t frame_count;
+    char magic[8];                  // "HKRAWEND"
+};
+
+struct RecorderStats {
+    uint64_t submitted = 0;         // 进入队列的帧数
+    uint64_t written = 0;           // 已写入文件的帧数
+    uint64_t dropped = 0;           // 队列满时丢弃的帧数
+    uint64_t failed = 0;            // 写入失败、未进入录像的帧数
+    int last_error = 0;             // 最近一次写入失败的errno，0表示没有失败
+    uint64_t bytes_written = 0;
+    uint32_t chunks = 0;
+};
+
+// 流式原始帧录像：submit()只把帧拷贝进预分配的队列槽（队列满则丢弃并计数，从不等待），
+// 独立的写线程把排队的帧批量用pwritev追加到预分配（fallocate）的大分块文件中。
+// submit()只允许单个生产者线程调用（例如作为FrameSink挂在采集线程上）。
+class FrameRecorder : public FrameSink {
+public:
+    FrameRecorder();
+    ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    // slot_size为单帧最大字节数；chunk_size为每个分块文件的预分配大小
+    bool start(const std::string& base_path, size_t slot_size, size_t queue_slots = 32,
+               uint64_t chunk_size = 1ull << 30);
+    // 写完队列中剩余的帧并补写索引
+    void stop();
+    bool recording() const { return running_; }
+
+    bool submit(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo);
+    void on_frame(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo) override {
+        submit(pData, frameInfo);
+    }
+
+    RecorderStats stats() const;
+    size_t queue_depth() const;
+
+    static std::string chunk_path(const std::string& base_path, uint32_t chunk_index);
+
+private:
+    struct Slot {
+        std::vector<unsigned char> data;
+        size_t length = 0;
+        MV_FRAME_OUT_INFO_EX info;
+    };
+
+    void writer_loop();
+    bool write_batch(uint64_t begin, uint64_t end);
+    bool open_chunk();
+    bool finish_chunk();
+
+    std::string base_path_;
+    uint64_t chunk_size_ = 0;
+    std::vector<Slot> slots_;
+    std::atomic<uint64_t> head_{0};     // 生产者写入位置
+    std::atomic<uint64_t> tail_{0};     // 写线程已完成位置
+
+    std::thread writer_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> writer_waiting_{false};
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+
+    // 以下仅由写线程访问
+    int fd_ = -1;
+    uint32_t chunk_index_ = 0;
+    uint64_t write_offset_ = 0;
+    uint64_t synced_offset_ = 0;
+    uint64_t frame_index_ = 0;
+    std::vector<RawIndexEntry> index_;
+    std::vector<RawRecordHeader> record_headers_;
+
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::atomic<int> last_error_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+    std::atomic<uint32_t> chunks_{0};
+};
+
+// 录像读取：mmap全部分块，按帧号随机访问，返回指向映射内存的指针（无解码、无拷贝）
+class RawRecording {
+public:
+    RawRecording() = default;
+    ~RawRecording();
+
+    RawRecording(const RawRecording&) = delete;
+    RawRecording& operator=(const RawRecording&) = delete;
+
+    // path可以是录像的base路径（打开所有分块）或单个分块文件
+    bool open(const std::string& path);
+    void close();
+
+    size_t frame_count() const { return frames_.size(); }
+    // 返回的指针在close()之前有效
+    const unsigned char* frame(size_t index, size_t& length, MV_FRAME_OUT_INFO_EX& frameInfo) const;
+
+private:
+    struct Mapping {
+        unsigned char* base = nullptr;
+        size_t size = 0;
+    };
+    struct FrameRef {
+        const unsigned char* data;
+        uint64_t length;
+        MV_FRAME_OUT_INFO_EX info;
+    };
+
+    bool map_chunk(const std::string& path);
+
+    std::vector<Mapping> mappings_;
+    std::vector<FrameRef> frames_;
+};
+
+#endif // FRAME_RECORDER_H
@@ -0,0 +1,110 @@
+// frame_ring.h
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include "frame_arena.h"
+#include "frame_statistics.h"
+#include "MvCameraControl.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct FrameRingStats {
+    uint64_t published = 0;     // 生产者写入的帧数
+    uint64_t overwritten = 0;   // 未被任何读者取走就被覆盖的帧数
+    uint64_t dropped = 0;       // 逐帧读者落后超过环长度而跳过的帧数
+    uint64_t rejected = 0;      // 超过槽大小而被丢弃的帧数
+};
+
+// 单生产者/多消费者的预分配帧环。
+// The producer (SDK grab thread) never waits on readers: every slot carries a sequence
+// version (seqlock), readers copy the slot and re-check the version, and a reader that was
+// lapped simply sees the frame as dropped.
+class FrameRing {
+public:
+    // 槽存储是一块页对齐、预先缺页的FrameArena；huge_pages见FrameArena::allocate
+    FrameRing(size_t slot_count, size_t slot_size, bool huge_pages = false);
+    ~FrameRing() = default;
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+    size_t slot_count() const { return slot_count_; }
+    size_t slot_size() const { return slot_size_; }
+
+    // 写入一帧（仅限单个生产者线程调用）；statistics（可选）作为该帧的元数据一并保存
+    bool publish(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo,
+                 const FrameStatistics* statistics = nullptr);
+
+    // 非阻塞读取最新一帧；sequence（可选）返回该帧序号，statistics（可选）返回随帧保存的统计（没有时valid为false）
+    bool read_latest(unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo, uint64_t* sequence = nullptr,
+                     FrameStatistics* statistics = nullptr);
+
+    // 逐帧读取：cursor为下一个要读的序号，成功后自增；无新帧时最多等待timeout_ms
+    bool read_next(uint64_t& cursor, unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo, unsigned int timeout_ms,
+                   FrameStatistics* statistics = nullptr);
+
+    // 读取指定序号的帧；已被覆盖或尚未写入时返回false
+    bool read(uint64_t sequence, unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo);
+    // 只读取指定序号帧的元数据（不拷贝图像）
+    bool peek_info(uint64_t sequence, MV_FRAME_OUT_INFO_EX& frameInfo);
+    // 读取指定序号帧的统计；该帧没有统计、已被覆盖或尚未写入时返回false
+    bool read_statistics(uint64_t sequence, FrameStatistics& statistics);
+    // 在环中从新到旧查找帧号为frame_num的帧。帧号在重连或重新取流后从头开始，环中可能有同号的帧，
+    // 此时返回最新的一个
+    bool find_frame(unsigned int frame_num, uint64_t& sequence);
+    // 按帧号和设备/主机时间戳查找frameInfo描述的那一帧，不会与重连前的同号帧混淆
+    bool find_frame(const MV_FRAME_OUT_INFO_EX& frameInfo, uint64_t& sequence);
+    // 在环中查找时间戳最接近timestamp的帧
+    bool find_closest(uint64_t timestamp, bool host_timestamp, uint64_t& sequence, uint64_t& found_timestamp);
+
+    // 设备时间戳（nDevTimeStampHigh/Low）或主机时间戳
+    static uint64_t frame_timestamp(const MV_FRAME_OUT_INFO_EX& frameInfo, bool host_timestamp);
+
+    // 等待序号为sequence的帧写入
+    bool wait_for(uint64_t sequence, unsigned int timeout_ms);
+
+    // 已写入的帧数（即下一帧的序号）
+    uint64_t head() const { return head_.load(std::memory_order_acquire); }
+
+    FrameRingStats stats() const;
+
+    // 唤醒所有等待中的读者（停止取流时调用）
+    void close();
+    void reopen() { closed_.store(false); }
+
+private:
+    enum class ReadResult { Ok, Overwritten, TooSmall };
+
+    struct Slot {
+        std::atomic<uint64_t> version{0};   // 2*seq+1：写入中；2*seq+2：seq帧可读
+        std::atomic<bool> consumed{true};
+        MV_FRAME_OUT_INFO_EX info;
+        FrameStatistics statistics;
+        size_t length = 0;
+        unsigned char* data = nullptr;
+    };
+
+    ReadResult read_slot(uint64_t sequence, unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo,
+                         FrameStatistics* statistics = nullptr);
+
+    size_t slot_count_;
+    size_t slot_size_;
+    std::unique_ptr<Slot[]> slots_;
+    FrameArena storage_;
+
+    std::atomic<uint64_t> head_{0};
+    std::atomic<uint64_t> overwritten_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> rejected_{0};
+
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+    std::atomic<int> waiters_{0};
+    std::atomic<bool> closed_{false};
+};
+
+#endif // FRAME_RING_H
@@ -0,0 +1,65 @@
+// frame_sink.h
+#ifndef FRAME_SINK_H
+#define FRAME_SINK_H
+
+#include "MvCameraControl.h"
+#include <atomic>
+#include <thread>
+
+// 帧消费者接口：在采集线程上、帧数据仍有效时被调用。
+// 实现必须快速返回且不能阻塞（只做拷贝/入队），否则会拖慢取流。
+class FrameSink {
+public:
+    virtual ~FrameSink() = default;
+    virtual void on_frame(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo) = 0;
+};
+
+// 采集线程上的固定容量消费者列表。添加/移除可以在取流期间从其他线程进行：
+// dispatch不加锁，remove()等待正在进行的dispatch结束后才返回，之后即可安全销毁该消费者。
+class FrameSinkList {
+public:
+    static const int kMaxSinks = 4;
+
+    FrameSinkList() {
+        for (int i = 0; i < kMaxSinks; ++i) {
+            sinks_[i].store(nullptr);
+        }
+    }
+
+    bool add(FrameSink* sink) {
+        for (int i = 0; i < kMaxSinks; ++i) {
+            FrameSink* expected = nullptr;
+            if (sinks_[i].compare_exchange_strong(expected, sink)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void remove(FrameSink* sink) {
+        for (int i = 0; i < kMaxSinks; ++i) {
+            FrameSink* expected = sink;
+            sinks_[i].compare_exchange_strong(expected, nullptr);
+        }
+        while (dispatching_.load() > 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    void dispatch(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo) {
+        dispatching_.fetch_add(1);
+        for (int i = 0; i < kMaxSinks; ++i) {
+            FrameSink* sink = sinks_[i].load();
+            if (sink) {
+                sink->on_frame(pData, frameInfo);
+            }
+        }
+        dispatching_.fetch_sub(1);
+    }
+
+private:
+    std::atomic<FrameSink*> sinks_[kMaxSinks];
+    std::atomic<int> dispatching_{0};
+};
+
+#endif // FRAME_SINK_H
@@ -0,0 +1,66 @@
+// frame_statistics.h
+#ifndef FRAME_STATISTICS_H
+#define FRAME_STATISTICS_H
+
+#include "MvCameraControl.h"
+#include <cstddef>
+#include <cstdint>
+
+enum class FocusMeasure {
+    None,
+    LaplacianVariance,      // 4邻域拉普拉斯的方差
+    Tenengrad,              // 3x3 Sobel梯度平方和的均值
+};
+
+// 统计区域与采样网格。ROI以像素为单位，宽高为0表示到图像边缘；
+// 网格每隔step个像素取一个采样点，但对焦度量使用采样点在原分辨率下的相邻像素，不受step影响
+struct FrameStatisticsOptions {
+    int roi_x = 0;
+    int roi_y = 0;
+    int roi_width = 0;
+    int roi_height = 0;
+    int step = 4;
+    FocusMeasure focus = FocusMeasure::LaplacianVariance;
+    int saturation_level = 250;         // 8位亮度达到该值计为饱和
+};
+
+// 一帧的亮度统计。亮度统一为8位：Mono10/12取高8位，彩色为BT.601加权，Bayer为2x2单元的平均值
+struct FrameStatistics {
+    bool valid = false;
+    unsigned int frame_num = 0;
+    uint32_t samples = 0;
+    double mean = 0.0;
+    int min = 0;
+    int max = 0;
+    double focus = 0.0;
+    uint32_t saturated = 0;
+    double compute_us = 0.0;
+    uint32_t histogram[256] = {};
+
+    double saturated_fraction() const { return samples ? (double)saturated / samples : 0.0; }
+    // 直方图上的百分位亮度，fraction为0..1
+    int percentile(double fraction) const;
+};
+
+// 在采集线程上计算统计（帧数据仍在缓存中）。支持Mono8/10/12（含Packed）、BGR8/RGB8和Bayer8；
+// 采样点先按格式收集到小块缓冲区，再由SIMD内核（x86上SSE2，ARM上NEON，其余为标量）累加。
+// 对象构造后只读，可在多个线程间共享
+class FrameStatisticsCalculator {
+public:
+    explicit FrameStatisticsCalculator(const FrameStatisticsOptions& options = FrameStatisticsOptions());
+
+    const FrameStatisticsOptions& options() const { return options_; }
+
+    static bool is_supported(MvGvspPixelType pixel_type);
+    static const char* kernel_name();
+
+    // row_stride为0时按紧密排列计算；Packed格式的帧按连续像素流处理，row_stride被忽略
+    bool compute(const unsigned char* data, int width, int height, size_t row_stride, MvGvspPixelType pixel_type,
+                 FrameStatistics& stats) const;
+    bool compute(const unsigned char* data, const MV_FRAME_OUT_INFO_EX& frameInfo, FrameStatistics& stats) const;
+
+private:
+    FrameStatisticsOptions options_;
+};
+
+#endif // FRAME_STATISTICS_H
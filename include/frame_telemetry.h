@@ -0,0 +1,123 @@
+// frame_telemetry.h
+#ifndef FRAME_TELEMETRY_H
+#define FRAME_TELEMETRY_H
+
+#include "MvCameraControl.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+struct LatencySummary {
+    uint64_t count = 0;
+    double mean_us = 0.0;
+    double p50_us = 0.0;
+    double p90_us = 0.0;
+    double p99_us = 0.0;
+    double max_us = 0.0;
+};
+
+// 无锁延迟直方图（微秒）：小于16us逐一计数，之上每个2的幂区间再分8档（相对误差<12.5%）。
+// record()只做几次relaxed原子加，可在取流回调中调用；summary()可在任意线程读取。
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(uint64_t value_us);
+    LatencySummary summary() const;
+    void reset();
+
+private:
+    static const int kLinearBuckets = 16;
+    static const int kSubBuckets = 8;
+    static const int kBuckets = kLinearBuckets + (40 - 4) * kSubBuckets;
+
+    static int bucket_index(uint64_t value);
+    static double bucket_value(int index);
+
+    std::atomic<uint64_t> counts_[kBuckets];
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// 最近一帧各阶段的时间
+struct FrameStageTimes {
+    unsigned int frame_num = 0;
+    uint64_t device_timestamp = 0;      // 相机时钟（单位取决于机型）
+    int64_t host_arrival_ms = 0;        // SDK收齐该帧的主机时间（nHostTimeStamp，ms）
+    int64_t handoff_us = 0;             // SDK把帧交给本库（回调/取图返回），steady_clock
+    int64_t pickup_us = 0;              // 使用方取走该帧，steady_clock
+};
+
+struct TelemetrySnapshot {
+    uint64_t frames = 0;                // 交付给本库的帧数
+    uint64_t picked_up = 0;             // 被使用方取走的帧数
+    uint64_t gaps = 0;                  // nFrameNum不连续而缺失的帧数
+    uint64_t frame_num_resets = 0;      // 帧号回退（相机重启取流/计数器复位）次数
+    uint64_t lost_packet_frames = 0;    // nLostPacket > 0 的帧数
+    uint64_t lost_packets = 0;
+    unsigned int sdk_queue_depth = 0;   // MV_CC_GetValidImageNum
+    uint64_t ring_backlog = 0;          // 帧环中尚未被逐帧读取的帧数
+    double delivered_fps = 0.0;         // 按实际交付间隔计算
+    LatencySummary arrival_to_handoff;  // 主机收齐 -> 交给本库
+    LatencySummary handoff_to_pickup;   // 交给本库 -> 使用方取走
+    LatencySummary arrival_to_pickup;   // 主机收齐 -> 使用方取走
+    LatencySummary frame_interval;      // 相邻两帧交付间隔
+    FrameStageTimes last_frame;
+};
+
+// 逐帧埋点：取流线程调用on_handoff()，读者调用on_pickup()，全部为无锁原子操作。
+// 交付时间按帧环序号保存在一个小的环形表中，以便在取走时计算排队时间。
+class FrameTelemetry {
+public:
+    FrameTelemetry();
+
+    // 帧交给本库（sequence为该帧在帧环中的序号）
+    void on_handoff(const MV_FRAME_OUT_INFO_EX& frameInfo, uint64_t sequence);
+    // 使用方取走帧环中的第sequence帧
+    void on_pickup(const MV_FRAME_OUT_INFO_EX& frameInfo, uint64_t sequence);
+    // 主动取图模式：交付与取走同时发生
+    void on_polled(const MV_FRAME_OUT_INFO_EX& frameInfo);
+
+    // 不含sdk_queue_depth/ring_backlog，由相机类补充
+    TelemetrySnapshot snapshot() const;
+    void reset();
+
+    static int64_t steady_now_us();
+
+private:
+    static const size_t kHandoffSlots = 256;
+
+    void record_sequence(const MV_FRAME_OUT_INFO_EX& frameInfo, int64_t now_us);
+    void record_pickup(const MV_FRAME_OUT_INFO_EX& frameInfo, int64_t now_us);
+
+    LatencyHistogram arrival_to_handoff_;
+    LatencyHistogram handoff_to_pickup_;
+    LatencyHistogram arrival_to_pickup_;
+    LatencyHistogram frame_interval_;
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> picked_up_{0};
+    std::atomic<uint64_t> gaps_{0};
+    std::atomic<uint64_t> resets_{0};
+    std::atomic<uint64_t> lost_packet_frames_{0};
+    std::atomic<uint64_t> lost_packets_{0};
+
+    // 以下只由交付线程写
+    std::atomic<int64_t> last_frame_num_{-1};
+    std::atomic<int64_t> last_handoff_us_{0};
+    std::atomic<uint64_t> interval_ewma_us_{0};
+
+    // 按序号保存交付时间：先写时间，再以release发布序号
+    std::atomic<uint64_t> handoff_sequence_[kHandoffSlots];
+    std::atomic<int64_t> handoff_time_us_[kHandoffSlots];
+
+    // 最近一次取走的帧
+    std::atomic<unsigned int> last_pickup_frame_num_{0};
+    std::atomic<uint64_t> last_pickup_device_ts_{0};
+    std::atomic<int64_t> last_pickup_arrival_ms_{0};
+    std::atomic<int64_t> last_pickup_handoff_us_{0};
+    std::atomic<int64_t> last_pickup_us_{0};
+};
+
+#endif // FRAME_TELEMETRY_H
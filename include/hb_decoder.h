@@ -0,0 +1,133 @@
+// hb_decoder.h
+#ifndef HB_DECODER_H
+#define HB_DECODER_H
+
+#include "bounded_queue.h"
+#include "frame_arena.h"
+#include "frame_telemetry.h"
+#include "MvCameraControl.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 压缩侧（收到的HB码流）与解码侧（按序交付的原始帧）的吞吐。帧率和MB/s按各自第一帧到最后一帧的时间计算
+struct HbDecodeStats {
+    uint64_t received = 0;              // 进入解码池的压缩帧
+    uint64_t decoded = 0;               // 解码成功并按序交付的帧
+    uint64_t failed = 0;                // MV_CC_HB_Decode失败（如丢包的帧）
+    uint64_t dropped = 0;               // 解码跟不上、缓冲区用尽而在入口丢弃的帧
+    uint64_t passthrough = 0;           // 非HB格式（未压缩）的帧，原样交付
+    uint64_t compressed_bytes = 0;
+    uint64_t decoded_bytes = 0;
+    double compressed_fps = 0.0;
+    double compressed_mb_per_s = 0.0;
+    double decoded_fps = 0.0;
+    double decoded_mb_per_s = 0.0;
+    double compression_ratio = 0.0;     // 解码后字节数 / 压缩字节数
+    size_t in_flight = 0;               // 等待解码或等待按序交付的帧数
+    bool serialized_decode = false;     // MV_CC_HB_Decode按句柄串行（set_serialized_decode），解码吞吐不超过单线程
+    LatencySummary decode;              // 单帧MV_CC_HB_Decode耗时
+    LatencySummary receive_to_delivery; // 收到到按序交付
+};
+
+// HB无损压缩帧的多线程解码池。取流线程调用submit()把压缩帧拷进池中的输入缓冲区后立即返回；
+// num_threads个解码线程并行调用MV_CC_HB_Decode，输出写入预分配的FrameArena槽，
+// 再按收到的顺序交给deliver（同一时刻只有一个线程在交付，可以直接作为FrameRing的生产者）。
+// 池中的帧全部在解码或等待交付时，新帧在入口丢弃并计数，取流线程从不等待。
+class HbDecoder {
+public:
+    using Deliver = std::function<void(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo)>;
+
+    // input_size为压缩帧的上限（PayloadSize），output_size为解码后一帧的上限
+    HbDecoder(void* handle, int num_threads, size_t pool_size, size_t input_size, size_t output_size, Deliver deliver);
+    ~HbDecoder();
+
+    HbDecoder(const HbDecoder&) = delete;
+    HbDecoder& operator=(const HbDecoder&) = delete;
+
+    // 清空上次停止时残留的帧，序号从0重新开始
+    bool start();
+    // 等进行中的submit()返回、处理完已入池的帧后停止解码线程
+    void stop();
+    bool running() const { return running_; }
+    void* handle() const { return handle_; }
+    size_t pool_size() const { return pool_size_; }
+    size_t frame_size() const { return output_size_; }
+
+    void submit(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo);
+
+    HbDecodeStats stats() const;
+    void reset_stats();
+
+    // HB格式即对应的标准格式加上MV_GVSP_PIX_CUSTOM位
+    static bool is_hb(MvGvspPixelType pixel_type);
+    // 单帧同步解码（主动取图路径）；成功时frameInfo改为解码后的格式、尺寸和长度
+    static bool decode(void* handle, const unsigned char* src, size_t src_len, unsigned char* dst, size_t dst_size,
+                       MV_FRAME_OUT_INFO_EX& frameInfo);
+
+    // 同一句柄上的MV_CC_HB_Decode是否串行执行（默认开启）。SDK没有说明同一句柄能否并发解码，
+    // 确认可以并发之前按句柄加锁，多个解码线程只重叠拷贝和交付
+    static void set_serialized_decode(bool enable);
+    static bool serialized_decode();
+
+private:
+    struct Job {
+        uint64_t sequence = 0;
+        int64_t received_us = 0;
+        MV_FRAME_OUT_INFO_EX info;
+        std::vector<unsigned char> input;
+        size_t input_length = 0;
+        unsigned char* output = nullptr;
+        bool compressed = false;        // false时原样从input交付
+        bool ok = false;
+    };
+
+    void worker_loop();
+    void complete(Job* job);
+    void deliver_ready();
+
+    void* handle_;
+    int num_threads_;
+    size_t output_size_;
+    Deliver deliver_;
+
+    std::vector<std::unique_ptr<Job>> jobs_;
+    FrameArena outputs_;
+    std::unique_ptr<BoundedQueue<Job*>> free_;
+    std::unique_ptr<BoundedQueue<Job*>> pending_;
+    // 解码完成的帧按sequence % pool_size放入，交付者按序取出
+    std::unique_ptr<std::atomic<Job*>[]> reorder_;
+    size_t pool_size_;
+    uint64_t next_sequence_ = 0;        // 只由取流线程修改
+    std::atomic<uint64_t> next_delivery_{0};
+    std::atomic<bool> delivering_{false};
+
+    std::vector<std::thread> workers_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stopping_{false};
+    std::atomic<int> submitting_{0};    // 正在submit()中的取流线程数
+    std::mutex work_mutex_;
+    std::condition_variable work_cv_;
+    std::atomic<int> work_waiters_{0};
+
+    std::atomic<uint64_t> received_{0};
+    std::atomic<uint64_t> decoded_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> passthrough_{0};
+    std::atomic<uint64_t> compressed_bytes_{0};
+    std::atomic<uint64_t> decoded_bytes_{0};
+    std::atomic<int64_t> first_received_us_{0};
+    std::atomic<int64_t> last_received_us_{0};
+    std::atomic<int64_t> first_delivered_us_{0};
+    std::atomic<int64_t> last_delivered_us_{0};
+    LatencyHistogram decode_latency_;
+    LatencyHistogram delivery_latency_;
+};
+
+#endif // HB_DECODER_H
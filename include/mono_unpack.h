@@ -0,0 +1,48 @@
+// mono_unpack.h
+#ifndef MONO_UNPACK_H
+#define MONO_UNPACK_H
+
+#include "MvCameraControl.h"
+#include <cstddef>
+#include <cstdint>
+
+// 与SDK转换结果的对比及每帧耗时
+struct UnpackCompareResult {
+    bool ok = false;                // SDK转换成功并完成对比
+    bool exact = false;             // 本类输出与合成参考数据逐像素一致
+    MvGvspPixelType sdk_pixel_type = PixelType_Gvsp_Undefined;   // SDK转换的目标格式
+    double mean_abs_diff = 0.0;     // 以SDK目标格式的单位计
+    double max_abs_diff = 0.0;
+    double unpack_ms = 0.0;
+    double sdk_ms = 0.0;
+};
+
+// 单色帧解包为uint16：Mono8、Mono10/Mono12（16位小端）以及Mono10_Packed/Mono12_Packed
+// （每2个像素3字节）。手写SIMD内核：x86上运行时选择AVX2或SSSE3，ARM上使用NEON，其余为标量实现。
+// 帧按连续像素流处理（Packed格式跨行连续打包），像素数为奇数时最后一组只有2字节。
+class MonoUnpacker {
+public:
+    static bool is_supported(MvGvspPixelType pixel_type);
+    static bool is_packed(MvGvspPixelType pixel_type);
+    // 有效位数：8/10/12，不支持的格式返回0
+    static int bit_depth(MvGvspPixelType pixel_type);
+    // pixel_count个像素在该格式下的字节数
+    static size_t frame_bytes(MvGvspPixelType pixel_type, size_t pixel_count);
+
+    // 解包到dst（pixel_count个uint16），每个值再左移shift位（0..16-bit_depth）；
+    // shift = 16 - bit_depth时数据占满16位。非Packed的16位格式可以原地处理（dst == src）
+    static bool unpack(const unsigned char* src, size_t src_len, MvGvspPixelType pixel_type, size_t pixel_count,
+                       uint16_t* dst, int shift = 0);
+    // 反向打包（用于合成测试帧），超出位数的高位被截掉
+    static bool pack(const uint16_t* src, size_t pixel_count, MvGvspPixelType pixel_type, unsigned char* dst);
+
+    // 当前使用的内核："avx2"、"ssse3"、"neon"或"scalar"
+    static const char* kernel_name();
+
+    // 用合成帧对比本类与MV_CC_ConvertPixelTypeEx（Packed格式转为对应的非Packed格式，否则转为Mono8），
+    // 并各自计时iterations次
+    static UnpackCompareResult compare_with_sdk(void* handle, int width, int height, MvGvspPixelType pixel_type,
+                                                int iterations = 20);
+};
+
+#endif // MONO_UNPACK_H
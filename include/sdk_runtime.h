@@ -0,0 +1,26 @@
+// sdk_runtime.h
+#ifndef SDK_RUNTIME_H
+#define SDK_RUNTIME_H
+
+#include "MvCameraControl.h"
+#include <string>
+#include <vector>
+
+// MV_CC_Initialize/MV_CC_Finalize是进程级的，多个相机对象共享一次初始化（引用计数）
+class SdkRuntime {
+public:
+    static bool acquire();      // 第一次调用时初始化SDK
+    static void release();      // 最后一次释放时反初始化SDK（同时清空设备缓存）
+
+    // 枚举结果按序列号缓存在进程内：已枚举过的传输层不再调用MV_CC_EnumDevices，
+    // refresh为true时强制重新枚举。返回序列号，顺序与枚举顺序一致。调用前需已acquire()
+    static std::vector<std::string> enumerate(unsigned int layer_types, bool refresh = false);
+    // 按序列号查找设备信息；缓存中没有时先重新枚举一次
+    static bool find_device(const std::string& serial, unsigned int layer_types, MV_CC_DEVICE_INFO& device_info,
+                            bool refresh = false);
+
+    // 设备序列号（USB3 Vision / GigE）
+    static std::string device_serial(const MV_CC_DEVICE_INFO& device_info);
+};
+
+#endif // SDK_RUNTIME_H
@@ -0,0 +1,128 @@
+// shared_frame_ring.h
+#ifndef SHARED_FRAME_RING_H
+#define SHARED_FRAME_RING_H
+
+#include "frame_sink.h"
+#include "MvCameraControl.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 跨进程帧环（POSIX共享内存，/dev/shm/<name>）。布局：
+//   [头部][槽头数组] —— 订阅者以读写方式映射，只写自己的等待计数
+//   [槽数据]         —— 订阅者只读映射，页对齐，每槽步长按页取整
+// 发布者是唯一的写者，与FrameRing相同的seqlock：写入前后更新槽版本号，从不等待订阅者；
+// 订阅者各自维护游标，落后超过环长度时跳过被覆盖的帧（计数），互不影响。
+// 发布者在后台定期更新头部的心跳时间，订阅者据此判断发布进程是否已退出（不依赖PID，跨PID命名空间有效）。
+// 目前只在Linux上实现（POSIX共享内存 + futex），其他平台open()返回false。
+struct SharedRingHeader;
+struct SharedSlotHeader;
+
+struct SharedFrameStats {
+    uint64_t published = 0;
+    uint64_t rejected = 0;          // 超过槽大小而被丢弃的帧数
+};
+
+// 订阅者看到的一帧：data指向共享内存（只读）。零拷贝读取在使用完数据后应调用
+// SharedFrameSubscriber::still_valid()确认期间没有被发布者覆盖
+struct SharedFrameView {
+    const unsigned char* data = nullptr;
+    size_t length = 0;
+    uint64_t sequence = 0;
+    MV_FRAME_OUT_INFO_EX info = {};
+};
+
+// 发布端：作为FrameSink挂到相机上，在取流线程上把每帧拷进共享内存
+class SharedFramePublisher : public FrameSink {
+public:
+    SharedFramePublisher() = default;
+    ~SharedFramePublisher();
+
+    SharedFramePublisher(const SharedFramePublisher&) = delete;
+    SharedFramePublisher& operator=(const SharedFramePublisher&) = delete;
+
+    // name为共享内存名（如"/sy011"）；已存在的同名环会被替换，已连接的订阅者看到它被关闭
+    bool open(const std::string& name, size_t slot_count, size_t slot_size);
+    void close();
+    bool is_open() const { return header_ != nullptr; }
+    const std::string& name() const { return name_; }
+
+    // on_frame（取流线程）和publish（调用方线程）可能同时调用，由写锁串行成单一写者
+    void on_frame(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo) override;
+    bool publish(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo);
+
+    SharedFrameStats stats() const;
+
+private:
+    void heartbeat_loop();
+    void stop_heartbeat();
+
+    std::mutex write_mutex_;
+    std::thread heartbeat_thread_;
+    std::mutex heartbeat_mutex_;
+    std::condition_variable heartbeat_cv_;
+    bool heartbeat_stop_ = false;
+
+    std::string name_;
+    unsigned char* base_ = nullptr;
+    size_t bytes_ = 0;
+    SharedRingHeader* header_ = nullptr;
+    SharedSlotHeader* slots_ = nullptr;
+    unsigned char* data_ = nullptr;
+    std::atomic<uint64_t> rejected_{0};
+};
+
+// 订阅端：映射已有的环，读取帧的零拷贝视图或拷贝
+class SharedFrameSubscriber {
+public:
+    SharedFrameSubscriber() = default;
+    ~SharedFrameSubscriber();
+
+    SharedFrameSubscriber(const SharedFrameSubscriber&) = delete;
+    SharedFrameSubscriber& operator=(const SharedFrameSubscriber&) = delete;
+
+    // 打开后游标位于最新一帧之后，只读取此后发布的帧
+    bool open(const std::string& name);
+    void close();
+    bool is_open() const { return header_ != nullptr; }
+    // 发布者已关闭（或以同名重新创建）；需要重新open()
+    bool publisher_closed() const;
+
+    size_t slot_count() const { return slot_count_; }
+    size_t slot_size() const { return slot_size_; }
+    uint64_t head() const;
+    uint64_t cursor() const { return cursor_; }
+    void set_cursor(uint64_t cursor) { cursor_ = cursor; }
+    uint64_t dropped() const { return dropped_; }
+
+    // 逐帧读取下一帧；无新帧时最多等待timeout_ms
+    bool read_next(SharedFrameView& view, unsigned int timeout_ms = 1000);
+    // 最新一帧（不等待），同时把游标移到其后
+    bool read_latest(SharedFrameView& view);
+    // 序号为sequence的帧仍未被覆盖（在此之前从视图读到的内容完整有效）
+    bool still_valid(uint64_t sequence) const;
+    // 拷贝一帧并在拷贝后校验，保证拷贝结果完整
+    bool copy(const SharedFrameView& view, unsigned char* pData, size_t size) const;
+
+private:
+    bool view_slot(uint64_t sequence, SharedFrameView& view) const;
+    bool wait_for(uint64_t sequence, unsigned int timeout_ms);
+
+    unsigned char* control_ = nullptr;      // 头部 + 槽头（读写）
+    size_t control_bytes_ = 0;
+    const unsigned char* data_ = nullptr;   // 槽数据（只读）
+    size_t data_bytes_ = 0;
+    SharedRingHeader* header_ = nullptr;
+    const SharedSlotHeader* slots_ = nullptr;
+    size_t slot_count_ = 0;
+    size_t slot_size_ = 0;
+    size_t slot_stride_ = 0;
+    uint64_t cursor_ = 0;
+    uint64_t dropped_ = 0;
+};
+
+#endif // SHARED_FRAME_RING_H
@@ -0,0 +1,118 @@
+// snapshot_encoder.h
+#ifndef SNAPSHOT_ENCODER_H
+#define SNAPSHOT_ENCODER_H
+
+#include "frame_sink.h"
+#include "MvCameraControl.h"
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class SnapshotFormat {
+    PNG,
+    JPEG,
+    TIFF,   // 无压缩TIFF
+    RAW     // 原始帧字节，不做任何转换
+};
+
+struct SnapshotResult {
+    bool ok = false;
+    std::string path;
+    double encode_ms = 0.0;     // 转换+编码+写文件耗时
+};
+
+struct SnapshotStats {
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    uint64_t failed = 0;
+    uint64_t rejected = 0;      // 队列满时被拒绝的提交
+    size_t queue_depth = 0;
+};
+
+// 异步快照编码池：提交时只把帧拷贝进复用的缓冲区并入队，由固定数量的编码线程完成
+// 像素格式转换、编码和写文件。队列有上限，满时立即拒绝（返回无效的future并计数），
+// 调用线程（采集/显示循环）从不等待编码。
+// 作为FrameSink挂到相机上时，arm_burst()可以保存接下来连续的N帧。
+class SnapshotEncoder : public FrameSink {
+public:
+    explicit SnapshotEncoder(int num_threads = 2, size_t max_queue = 8);
+    ~SnapshotEncoder();
+
+    SnapshotEncoder(const SnapshotEncoder&) = delete;
+    SnapshotEncoder& operator=(const SnapshotEncoder&) = delete;
+
+    // 文件名为 <path_prefix>_<帧号>.<扩展名>；quality仅对JPEG有效
+    std::future<SnapshotResult> submit(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo,
+                                       const std::string& path_prefix, SnapshotFormat format = SnapshotFormat::PNG,
+                                       int quality = 95);
+    // 已转换好的8位图像（单通道或BGR）
+    std::future<SnapshotResult> submit(const cv::Mat& image, const std::string& path_prefix,
+                                       SnapshotFormat format = SnapshotFormat::PNG, int quality = 95);
+
+    // 保存接下来到达on_frame()的连续count帧，全部完成（或被拒绝）后future就绪
+    std::future<std::vector<SnapshotResult>> arm_burst(size_t count, const std::string& path_prefix,
+                                                       SnapshotFormat format = SnapshotFormat::PNG, int quality = 95);
+    void on_frame(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo) override;
+
+    SnapshotStats stats() const;
+    size_t queue_depth() const;
+
+    static const char* extension(SnapshotFormat format);
+
+private:
+    struct Burst {
+        std::promise<std::vector<SnapshotResult>> promise;
+        std::vector<SnapshotResult> results;
+        std::atomic<size_t> remaining{0};
+    };
+
+    struct Job {
+        std::vector<unsigned char> data;
+        MV_FRAME_OUT_INFO_EX info;
+        std::string path;
+        SnapshotFormat format;
+        int quality;
+        std::promise<SnapshotResult> promise;
+        std::shared_ptr<Burst> burst;
+        size_t burst_index = 0;
+    };
+
+    // 获取一个空闲Job（复用其缓冲区）；队列满时返回nullptr
+    std::unique_ptr<Job> acquire_job();
+    std::future<SnapshotResult> enqueue(std::unique_ptr<Job> job);
+    void worker_loop();
+    SnapshotResult encode(Job& job);
+    void finish_burst(Burst& burst, size_t index, const SnapshotResult& result);
+
+    size_t max_queue_;
+    std::vector<std::thread> workers_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::unique_ptr<Job>> queue_;
+    std::vector<std::unique_ptr<Job>> free_jobs_;
+    size_t in_flight_ = 0;      // 已出队、正在编码的任务数
+    bool stopping_ = false;
+
+    // 连拍状态只由on_frame（采集线程）和arm_burst（加锁）访问
+    std::mutex burst_mutex_;
+    std::shared_ptr<Burst> burst_;
+    size_t burst_next_ = 0;
+    std::string burst_prefix_;
+    SnapshotFormat burst_format_ = SnapshotFormat::PNG;
+    int burst_quality_ = 95;
+    std::atomic<bool> burst_armed_{false};
+
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::atomic<uint64_t> rejected_{0};
+};
+
+#endif // SNAPSHOT_ENCODER_H
@@ -2,7 +2,11 @@
 #define UNDISTORT_H
 
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <opencv2/opencv.hpp>
+#include <vector>
 
 class ImageUndistorter {
 public:
@@ -10,14 +14,95 @@ public:
     ImageUndistorter(const std::string& calibrationFile);                       //加载标定参数，相机内参，畸变系数（已知）
     ~ImageUndistorter() = default;
 
-    void undistort_image(const cv::Mat& src, cv::Mat& dst);                     //图像去畸变
-    void add_calibration(const cv::Mat& dst, cv::Mat& calibratedImage);         //给图片中点添加光标
+    void undistort_image(const cv::Mat& src, cv::Mat& dst);                     //图像去畸变（保持原内参，与cv::undistort结果一致）
+
+    // 使用缓存的重映射表去畸变，dst尺寸/类型匹配时直接写入调用方缓冲区
+    // alpha < 0：新内参等于原内参；0..1：cv::getOptimalNewCameraMatrix的alpha
+    // crop_to_roi：只输出有效像素区域（validPixROI）
+    void undistort_image(const cv::Mat& src, cv::Mat& dst, double alpha,
+                         int interpolation = cv::INTER_LINEAR, bool crop_to_roi = false);
+
+    void set_num_threads(int num_threads);                                      //remap按行分块的线程数，0表示使用OpenCV默认
+    int num_threads() const { return num_threads_; }
+    void clear_cache();                                                         //清空已缓存的重映射表
+    bool is_loaded() const { return !camera_matrix_.empty() && !dist_coeffs_.empty(); }
+
+    cv::Mat get_new_camera_matrix(const cv::Size& size, double alpha);          //去畸变后图像对应的内参
+    cv::Rect get_valid_roi(const cv::Size& size, double alpha);                 //去畸变后的有效像素区域
+    void get_float_maps(const cv::Size& size, double alpha,
+                        cv::Mat& map_x, cv::Mat& map_y);                        //浮点查找表（CV_32FC1），供融合去马赛克使用
+
+    // 稀疏点坐标（交错的x, y像素坐标，src与dst可以是同一数组），不需要整幅图像去畸变
+    // 新内参由size/alpha决定，与undistort_image一致；alpha < 0时与原内参相同，size可以为空
+    bool undistort_points(const float* src, float* dst, size_t count, const cv::Size& size = cv::Size(),
+                          double alpha = -1.0, int iterations = 5);                 //畸变图像坐标 -> 去畸变图像坐标（迭代求解）
+    bool distort_points(const float* src, float* dst, size_t count, const cv::Size& size = cv::Size(),
+                        double alpha = -1.0);                                   //去畸变图像坐标 -> 畸变图像坐标（闭式）
+    bool undistort_points_lut(const float* src, float* dst, size_t count, const cv::Size& size,
+                              double alpha = -1.0, int grid_step = 8);          //近似去畸变：每grid_step像素一个网格点的逆映射表，双线性插值
+
+    void add_calibration(const cv::Mat& dst, cv::Mat& calibratedImage);         //给图片中点添加光标（dst与calibratedImage可以是同一图像，原地绘制）
+    static void draw_crosshair(cv::Mat& image, int size = 20,
+                               const cv::Scalar& color = cv::Scalar(0, 0, 255),
+                               int thickness = 2);                              //在图像中点原地画十字
     cv::Mat get_calibrated_image() const;                                       //获取带有光标的图片
 
 private:
+    // 重映射表缓存键：分辨率 + 新内参(alpha) + 插值方式
+    struct RemapKey {
+        int width;
+        int height;
+        double alpha;
+        int interpolation;
+
+        bool operator<(const RemapKey& other) const {
+            if (width != other.width) return width < other.width;
+            if (height != other.height) return height < other.height;
+            if (alpha != other.alpha) return alpha < other.alpha;
+            return interpolation < other.interpolation;
+        }
+    };
+
+    struct RemapTable {
+        cv::Mat map1;                                                           //CV_16SC2 定点坐标
+        cv::Mat map2;                                                           //CV_16UC1 插值表（最近邻时为空）
+        cv::Mat new_camera_matrix;
+        cv::Rect valid_roi;
+    };
+
+    // 点变换用的单精度参数，按(尺寸, alpha)缓存
+    struct PointModel {
+        float fx, fy, cx, cy;                                                   //原内参
+        float nfx, nfy, ncx, ncy;                                               //去畸变后内参
+        float k[8];                                                             //k1 k2 p1 p2 k3 k4 k5 k6，缺省为0
+        bool native;                                                            //false：含薄棱镜/倾斜项，交给OpenCV
+        cv::Mat new_camera_matrix;
+    };
+
+    // 逆映射表：畸变图像上的网格点 -> 去畸变图像坐标（交错x, y）
+    struct PointLut {
+        int step;
+        int cols;
+        int rows;
+        std::vector<float> xy;
+    };
+
+    // 返回共享的只读表，clear_cache()之后调用方持有的表仍然有效
+    std::shared_ptr<const RemapTable> get_remap_table(const cv::Size& size, double alpha, int interpolation);
+    // 新内参与有效像素区域，不构建映射表
+    cv::Mat compute_new_camera_matrix(const cv::Size& size, double alpha, cv::Rect& valid_roi) const;
+    bool get_point_model(const cv::Size& size, double alpha, PointModel& model);
+    std::shared_ptr<const PointLut> get_point_lut(const cv::Size& size, double alpha, int grid_step);
+
     cv::Mat camera_matrix_;                                                     //相机内参矩阵
     cv::Mat dist_coeffs_;                                                       //畸变系数
     cv::Mat calibrated_image_;                                                  //存储带有光标的图片
+
+    std::map<RemapKey, std::shared_ptr<const RemapTable>> remap_cache_;         //重映射表缓存
+    std::map<RemapKey, PointModel> point_models_;                               //点变换参数缓存（interpolation字段不用）
+    std::map<RemapKey, std::shared_ptr<const PointLut>> point_luts_;            //逆映射表缓存（interpolation字段为网格间距）
+    std::mutex cache_mutex_;
+    int num_threads_ = 0;
 };
 
 #endif // UNDISTORT_H
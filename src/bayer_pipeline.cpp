@@ -0,0 +1,210 @@
+// bayer_pipeline.cpp
+
+#include "bayer_pipeline.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// GenICam以左上角像素命名Bayer排列，OpenCV以第二行第二、三个像素命名，两者相差一个相位
+static int bayer_color_code(MvGvspPixelType pixel_type) {
+    switch (pixel_type) {
+        case PixelType_Gvsp_BayerRG8: return cv::COLOR_BayerBG2BGR;
+        case PixelType_Gvsp_BayerGB8: return cv::COLOR_BayerGR2BGR;
+        case PixelType_Gvsp_BayerGR8: return cv::COLOR_BayerGB2BGR;
+        case PixelType_Gvsp_BayerBG8: return cv::COLOR_BayerRG2BGR;
+        default: return -1;
+    }
+}
+
+// Bayer排列中(x, y)处像素的颜色通道：0=B，1=G，2=R
+static int bayer_channel(MvGvspPixelType pixel_type, int x, int y) {
+    int phase = ((y & 1) << 1) | (x & 1);   // 0:(0,0) 1:(1,0) 2:(0,1) 3:(1,1)
+    switch (pixel_type) {
+        case PixelType_Gvsp_BayerRG8: { static const int c[4] = { 2, 1, 1, 0 }; return c[phase]; }
+        case PixelType_Gvsp_BayerGB8: { static const int c[4] = { 1, 0, 2, 1 }; return c[phase]; }
+        case PixelType_Gvsp_BayerGR8: { static const int c[4] = { 1, 2, 0, 1 }; return c[phase]; }
+        default:                      { static const int c[4] = { 0, 1, 1, 2 }; return c[phase]; }
+    }
+}
+
+bool BayerDemosaicer::is_bayer8(MvGvspPixelType pixel_type) {
+    return bayer_color_code(pixel_type) >= 0;
+}
+
+void BayerDemosaicer::mosaic(const cv::Mat& bgr, MvGvspPixelType bayer_type, cv::Mat& bayer) {
+    bayer.create(bgr.rows, bgr.cols, CV_8UC1);
+    for (int y = 0; y < bgr.rows; ++y) {
+        const unsigned char* src = bgr.ptr<unsigned char>(y);
+        unsigned char* dst = bayer.ptr<unsigned char>(y);
+        for (int x = 0; x < bgr.cols; ++x) {
+            dst[x] = src[x * 3 + bayer_channel(bayer_type, x, y)];
+        }
+    }
+}
+
+void BayerDemosaicer::set_tile_rows(int tile_rows) {
+    // 在configure()之前调用才生效
+    tile_rows_ = std::max(tile_rows, 8);
+}
+
+bool BayerDemosaicer::configure(const cv::Size& input_size, MvGvspPixelType bayer_type, const cv::Size& output_size,
+                                const cv::Mat& map_x, const cv::Mat& map_y) {
+    color_code_ = -1;
+    tiles_.clear();
+
+    int code = bayer_color_code(bayer_type);
+    if (code < 0) {
+        std::cerr << "Unsupported Bayer pixel type: [0x" << std::hex << (unsigned int)bayer_type << "]" << std::dec << std::endl;
+        return false;
+    }
+    if (input_size.width < 4 || input_size.height < 4) {
+        std::cerr << "Bayer input is too small." << std::endl;
+        return false;
+    }
+
+    bool has_map = !map_x.empty() && !map_y.empty();
+    if (has_map && (map_x.size() != input_size || map_y.size() != input_size ||
+                    map_x.type() != CV_32FC1 || map_y.type() != CV_32FC1)) {
+        std::cerr << "Undistortion maps must be CV_32FC1 with the input size." << std::endl;
+        return false;
+    }
+
+    input_size_ = input_size;
+    output_size_ = output_size.empty() ? input_size : output_size;
+    identity_ = !has_map && output_size_ == input_size_;
+    if (!identity_ && !build_tiles(map_x, map_y)) {
+        return false;
+    }
+
+    color_code_ = code;
+    return true;
+}
+
+bool BayerDemosaicer::build_tiles(const cv::Mat& map_x, const cv::Mat& map_y) {
+    // 输出像素 -> 去畸变图像坐标（缩放，像素中心对齐）
+    cv::Mat out_x(output_size_, CV_32FC1);
+    cv::Mat out_y(output_size_, CV_32FC1);
+    double scale_x = (double)input_size_.width / output_size_.width;
+    double scale_y = (double)input_size_.height / output_size_.height;
+    for (int y = 0; y < output_size_.height; ++y) {
+        float* px = out_x.ptr<float>(y);
+        float* py = out_y.ptr<float>(y);
+        float sy = (float)((y + 0.5) * scale_y - 0.5);
+        for (int x = 0; x < output_size_.width; ++x) {
+            px[x] = (float)((x + 0.5) * scale_x - 0.5);
+            py[x] = sy;
+        }
+    }
+
+    // 去畸变图像坐标 -> 原始Bayer图像坐标（对查找表本身做双线性采样）
+    if (!map_x.empty()) {
+        cv::Mat src_x, src_y;
+        cv::remap(map_x, src_x, out_x, out_y, cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+        cv::remap(map_y, src_y, out_x, out_y, cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+        out_x = src_x;
+        out_y = src_y;
+    }
+
+    for (int row = 0; row < output_size_.height; row += tile_rows_) {
+        Tile tile;
+        tile.out_row_begin = row;
+        tile.out_row_end = std::min(row + tile_rows_, output_size_.height);
+
+        double y_min = 0.0, y_max = 0.0;
+        cv::minMaxLoc(out_y.rowRange(tile.out_row_begin, tile.out_row_end), &y_min, &y_max);
+
+        // 上下各留2行，使子图的去马赛克边界不落在采样区域内
+        int begin = std::max(0, (int)std::floor(y_min) - 2);
+        int end = std::min(input_size_.height, (int)std::ceil(y_max) + 3);
+        begin = std::min(begin, input_size_.height - 2) & ~1;
+        end = std::max(end, begin + 2);
+        tile.src_row_begin = begin;
+        tile.src_row_end = end;
+
+        cv::Mat tile_x = out_x.rowRange(tile.out_row_begin, tile.out_row_end).clone();
+        cv::Mat tile_y;
+        out_y.rowRange(tile.out_row_begin, tile.out_row_end).convertTo(tile_y, CV_32F, 1.0, -begin);
+        cv::convertMaps(tile_x, tile_y, tile.map1, tile.map2, CV_16SC2, false);
+
+        tiles_.push_back(tile);
+    }
+    return true;
+}
+
+bool BayerDemosaicer::process(const unsigned char* bayer, size_t stride, cv::Mat& dst) {
+    if (!is_configured() || !bayer) {
+        return false;
+    }
+
+    cv::Mat src(input_size_.height, input_size_.width, CV_8UC1, const_cast<unsigned char*>(bayer), stride);
+    dst.create(output_size_, CV_8UC3);
+
+    if (identity_) {
+        cv::cvtColor(src, dst, color_code_);
+        return true;
+    }
+
+    int stripes = num_threads_ > 0 ? num_threads_ : cv::getNumThreads();
+    cv::parallel_for_(cv::Range(0, (int)tiles_.size()), [&](const cv::Range& range) {
+        cv::Mat scratch;   // 只包含本块需要的源行，驻留在缓存中
+        for (int i = range.start; i < range.end; ++i) {
+            const Tile& tile = tiles_[i];
+            cv::cvtColor(src.rowRange(tile.src_row_begin, tile.src_row_end), scratch, color_code_);
+            cv::Mat dst_rows = dst.rowRange(tile.out_row_begin, tile.out_row_end);
+            cv::remap(scratch, dst_rows, tile.map1, tile.map2, cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+        }
+    }, stripes);
+    return true;
+}
+
+BayerCompareResult BayerDemosaicer::compare_with_sdk(void* handle, int width, int height, MvGvspPixelType bayer_type) {
+    BayerCompareResult result;
+
+    // 合成平滑的彩色渐变，再按Bayer排列采样
+    cv::Mat bgr(height, width, CV_8UC3);
+    for (int y = 0; y < height; ++y) {
+        unsigned char* row = bgr.ptr<unsigned char>(y);
+        for (int x = 0; x < width; ++x) {
+            row[x * 3 + 0] = (unsigned char)(x * 255 / std::max(width - 1, 1));
+            row[x * 3 + 1] = (unsigned char)(y * 255 / std::max(height - 1, 1));
+            row[x * 3 + 2] = (unsigned char)((x + y) * 255 / std::max(width + height - 2, 1));
+        }
+    }
+    cv::Mat bayer;
+    mosaic(bgr, bayer_type, bayer);
+
+    BayerDemosaicer demosaicer;
+    cv::Mat ours;
+    if (!demosaicer.configure(cv::Size(width, height), bayer_type, cv::Size(width, height)) ||
+        !demosaicer.process(bayer.ptr<unsigned char>(0), bayer.step, ours)) {
+        return result;
+    }
+
+    std::vector<unsigned char> sdk_buffer((size_t)width * height * 3);
+    MV_CC_PIXEL_CONVERT_PARAM_EX stConvertParam;
+    std::memset(&stConvertParam, 0, sizeof(stConvertParam));
+    stConvertParam.nWidth = width;
+    stConvertParam.nHeight = height;
+    stConvertParam.enSrcPixelType = bayer_type;
+    stConvertParam.pSrcData = bayer.ptr<unsigned char>(0);
+    stConvertParam.nSrcDataLen = (unsigned int)(width * height);
+    stConvertParam.enDstPixelType = PixelType_Gvsp_BGR8_Packed;
+    stConvertParam.pDstBuffer = sdk_buffer.data();
+    stConvertParam.nDstBufferSize = (unsigned int)sdk_buffer.size();
+    int nRet = MV_CC_ConvertPixelTypeEx(handle, &stConvertParam);
+    if (nRet != MV_OK) {
+        std::cerr << "MV_CC_ConvertPixelTypeEx failed! Error Code: [0x" << std::hex << nRet << "]" << std::dec << std::endl;
+        return result;
+    }
+
+    cv::Mat sdk(height, width, CV_8UC3, sdk_buffer.data());
+    cv::Rect inner(2, 2, width - 4, height - 4);
+    cv::Mat diff;
+    cv::absdiff(ours(inner), sdk(inner), diff);
+    cv::Scalar mean = cv::mean(diff);
+    result.mean_abs_diff = (mean[0] + mean[1] + mean[2]) / 3.0;
+    cv::minMaxLoc(diff.reshape(1), nullptr, &result.max_abs_diff);
+    result.ok = true;
+    return result;
+}
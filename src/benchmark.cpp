@@ -0,0 +1,269 @@
+// benchmark.cpp
+// 采集路径吞吐/延迟基准：使用模拟相机，无需硬件，结果可在CI中比较。
+// 用法: camera_benchmark [frames] [calibration.yml]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "bayer_pipeline.h"
+#include "device_camera_simulator.h"
+#include "frame_statistics.h"
+#include "mono_unpack.h"
+#include "undistort.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchResult {
+    std::string name;
+    size_t frames = 0;
+    double seconds = 0.0;
+    std::vector<double> latencies_us;   // 每次调用的耗时（微秒），与Python基准的延迟列含义相同
+    std::vector<double> frame_age_us;   // 出图（设备时间戳）到取到帧的时间，只有相机路径有
+    uint64_t bytes_out = 0;             // 交付给调用方的字节数（相机路径按nFrameLen累计）
+    TelemetrySnapshot telemetry;
+};
+
+static double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    size_t index = std::min(values.size() - 1, (size_t)(p / 100.0 * (values.size() - 1) + 0.5));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+// 相机自带的逐帧埋点，与按设备时间戳统计的延迟互相印证
+static void print_telemetry(const TelemetrySnapshot& telemetry) {
+    const LatencySummary& queued = telemetry.handoff_to_pickup;
+    std::printf("  telemetry: handoff->pickup p50 %.1f  p99 %.1f  max %.1f us, gaps %llu, backlog %llu\n",
+                queued.p50_us, queued.p99_us, queued.max_us,
+                (unsigned long long)telemetry.gaps, (unsigned long long)telemetry.ring_backlog);
+}
+
+static double max_of(const std::vector<double>& values) {
+    return values.empty() ? 0.0 : *std::max_element(values.begin(), values.end());
+}
+
+static void print_result(const BenchResult& result) {
+    double fps = result.seconds > 0 ? result.frames / result.seconds : 0.0;
+    uint64_t bytes_per_frame = result.frames > 0 ? result.bytes_out / result.frames : 0;
+    std::printf("%-34s %9.1f fps  call p50 %8.1f  p90 %8.1f  p99 %8.1f  max %8.1f us  out %9llu B/frame\n",
+                result.name.c_str(), fps,
+                percentile(result.latencies_us, 50), percentile(result.latencies_us, 90),
+                percentile(result.latencies_us, 99), max_of(result.latencies_us), (unsigned long long)bytes_per_frame);
+    if (!result.frame_age_us.empty()) {
+        std::printf("  frame age (device timestamp -> pickup): p50 %.1f  p90 %.1f  p99 %.1f  max %.1f us\n",
+                    percentile(result.frame_age_us, 50), percentile(result.frame_age_us, 90),
+                    percentile(result.frame_age_us, 99), max_of(result.frame_age_us));
+    }
+    if (result.telemetry.picked_up > 0 && result.telemetry.handoff_to_pickup.count > 0) {
+        print_telemetry(result.telemetry);
+    }
+}
+
+// 出图（设备时间戳）到取到帧之间的时间
+static double frame_latency_us(const DeviceCameraSimulator& camera, const MV_FRAME_OUT_INFO_EX& frameInfo) {
+    uint64_t device_ns = ((uint64_t)frameInfo.nDevTimeStampHigh << 32) | frameInfo.nDevTimeStampLow;
+    auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - camera.start_time()).count();
+    return (now_ns - (int64_t)device_ns) / 1000.0;
+}
+
+static void configure(DeviceCameraSimulator& camera, unsigned int pixel_format) {
+    camera.init();
+    camera.set_resolution(1440, 1080);
+    camera.set_pixel_format(pixel_format);
+    camera.set_frame_rate(0);
+}
+
+// 同步取图：调用线程生成并拷贝一帧
+static BenchResult bench_capture_image(size_t frames) {
+    BenchResult result;
+    result.name = "capture_image (polling)";
+    DeviceCameraSimulator camera;
+    configure(camera, PixelType_Gvsp_BGR8_Packed);
+    std::vector<unsigned char> buffer(camera.frame_size());
+    MV_FRAME_OUT_INFO_EX frameInfo = {0};
+
+    camera.start_grabbing();
+    auto start = Clock::now();
+    for (size_t i = 0; i < frames; ++i) {
+        auto t0 = Clock::now();
+        if (!camera.capture_image(buffer.data(), frameInfo)) {
+            break;
+        }
+        result.latencies_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+        result.frame_age_us.push_back(frame_latency_us(camera, frameInfo));
+        result.bytes_out += frameInfo.nFrameLen;
+        ++result.frames;
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    camera.close();
+    return result;
+}
+
+// 后台采集：生产线程写入FrameRing，消费者按序或取最新帧
+static BenchResult bench_ring(size_t frames, bool latest, double fps) {
+    BenchResult result;
+    result.name = std::string(latest ? "ring read_latest" : "ring read_next") +
+                  (fps > 0 ? " @" + std::to_string((int)fps) + "fps" : " (unthrottled)");
+    DeviceCameraSimulator camera;
+    configure(camera, PixelType_Gvsp_BGR8_Packed);
+    camera.set_frame_rate(fps);
+    std::vector<unsigned char> buffer(camera.frame_size());
+    MV_FRAME_OUT_INFO_EX frameInfo = {0};
+
+    camera.start_acquisition(8);
+    auto start = Clock::now();
+    unsigned int last_frame = UINT32_MAX;
+    while (result.frames < frames) {
+        auto t0 = Clock::now();
+        bool success = latest ? camera.read_latest_frame(buffer.data(), buffer.size(), frameInfo)
+                              : camera.read_next_frame(buffer.data(), buffer.size(), frameInfo, 1000);
+        if (!success) {
+            if (!latest) {
+                break;
+            }
+            continue;
+        }
+        if (latest && frameInfo.nFrameNum == last_frame) {
+            continue;   // 同一帧只统计一次
+        }
+        last_frame = frameInfo.nFrameNum;
+        result.latencies_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+        result.frame_age_us.push_back(frame_latency_us(camera, frameInfo));
+        result.bytes_out += frameInfo.nFrameLen;
+        ++result.frames;
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.telemetry = camera.telemetry();
+    camera.close();
+    return result;
+}
+
+// 处理阶段：对同一帧反复执行，延迟即单帧处理时间；bytes_per_frame为该阶段每帧写出的字节数
+template <typename Fn>
+static BenchResult bench_stage(const std::string& name, size_t frames, size_t bytes_per_frame, Fn fn) {
+    BenchResult result;
+    result.name = name;
+    fn();   // 预热（建表、分配输出）
+    auto start = Clock::now();
+    for (size_t i = 0; i < frames; ++i) {
+        auto t0 = Clock::now();
+        fn();
+        result.latencies_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+        ++result.frames;
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.bytes_out = (uint64_t)bytes_per_frame * result.frames;
+    return result;
+}
+
+int main(int argc, char** argv) {
+    size_t frames = argc > 1 ? (size_t)std::strtoul(argv[1], nullptr, 10) : 500;
+    std::string calibration_file = argc > 2 ? argv[2] : "";
+
+    std::printf("frames per run: %zu, resolution 1440x1080 (call = time spent in the call, as in benchmark.py)\n", frames);
+    print_result(bench_capture_image(frames));
+    print_result(bench_ring(frames, false, 0));
+    print_result(bench_ring(frames, true, 0));
+    print_result(bench_ring(std::min<size_t>(frames, 120), false, 60));
+
+    // 处理阶段使用模拟相机生成的帧
+    DeviceCameraSimulator camera;
+    configure(camera, PixelType_Gvsp_BayerRG8);
+    std::vector<unsigned char> bayer(camera.frame_size());
+    MV_FRAME_OUT_INFO_EX frameInfo = {0};
+    camera.start_grabbing();
+    camera.capture_image(bayer.data(), frameInfo);
+    camera.close();
+
+    cv::Size size(frameInfo.nWidth, frameInfo.nHeight);
+    cv::Mat bayer_mat(size, CV_8UC1, bayer.data());
+    cv::Mat bgr, out;
+    cv::cvtColor(bayer_mat, bgr, cv::COLOR_BayerBG2BGR);
+
+    BayerDemosaicer demosaic;
+    demosaic.configure(size, PixelType_Gvsp_BayerRG8, size);
+    print_result(bench_stage("bayer demosaic (identity)", frames, bgr.total() * 3, [&] {
+        demosaic.process(bayer.data(), size.width, out);
+    }));
+
+    // 单色解包（模拟相机生成的Packed/16位帧）；与MV_CC_ConvertPixelTypeEx的对比需要打开的设备，
+    // 见Python的DeviceCameraSY011.verify_mono_unpack()
+    std::printf("mono unpack kernel: %s\n", MonoUnpacker::kernel_name());
+    const MvGvspPixelType mono_types[] = { PixelType_Gvsp_Mono8, PixelType_Gvsp_Mono10, PixelType_Gvsp_Mono12,
+                                           PixelType_Gvsp_Mono10_Packed, PixelType_Gvsp_Mono12_Packed };
+    const char* mono_names[] = { "Mono8", "Mono10", "Mono12", "Mono10Packed", "Mono12Packed" };
+    std::vector<uint16_t> unpacked(size.area());
+    for (size_t t = 0; t < sizeof(mono_types) / sizeof(mono_types[0]); ++t) {
+        DeviceCameraSimulator mono_camera;
+        configure(mono_camera, mono_types[t]);
+        std::vector<unsigned char> raw(mono_camera.frame_size());
+        mono_camera.start_grabbing();
+        mono_camera.capture_image(raw.data(), frameInfo);
+        mono_camera.close();
+        int shift = 16 - MonoUnpacker::bit_depth(mono_types[t]);
+        print_result(bench_stage(std::string("unpack ") + mono_names[t] + " -> u16", frames, unpacked.size() * 2, [&] {
+            MonoUnpacker::unpack(raw.data(), raw.size(), mono_types[t], unpacked.size(), unpacked.data(), shift);
+        }));
+    }
+
+    // 帧统计：全幅与4像素网格，Bayer原始帧与解码后的BGR
+    std::printf("frame statistics kernel: %s\n", FrameStatisticsCalculator::kernel_name());
+    for (int step : { 1, 4 }) {
+        FrameStatisticsOptions options;
+        options.step = step;
+        FrameStatisticsCalculator statistics(options);
+        FrameStatistics result;
+        print_result(bench_stage("statistics Bayer8 step " + std::to_string(step), frames, 0, [&] {
+            statistics.compute(bayer.data(), size.width, size.height, 0, PixelType_Gvsp_BayerRG8, result);
+        }));
+        print_result(bench_stage("statistics BGR8 step " + std::to_string(step), frames, 0, [&] {
+            statistics.compute(bgr.data, size.width, size.height, bgr.step[0], PixelType_Gvsp_BGR8_Packed, result);
+        }));
+    }
+
+    if (!calibration_file.empty()) {
+        ImageUndistorter undistorter(calibration_file);
+        if (undistorter.is_loaded()) {
+            cv::Mat camera_matrix, dist_coeffs;
+            cv::FileStorage fs(calibration_file, cv::FileStorage::READ);
+            fs["camera_matrix"] >> camera_matrix;
+            fs["distortion_coefficients"] >> dist_coeffs;
+            print_result(bench_stage("cv::undistort (legacy)", frames, bgr.total() * 3, [&] {
+                cv::undistort(bgr, out, camera_matrix, dist_coeffs);
+            }));
+            print_result(bench_stage("undistort (cached remap)", frames, bgr.total() * 3, [&] {
+                undistorter.undistort_image(bgr, out);
+            }));
+
+            cv::Mat map_x, map_y;
+            undistorter.get_float_maps(size, -1.0, map_x, map_y);
+            BayerDemosaicer fused;
+            fused.configure(size, PixelType_Gvsp_BayerRG8, cv::Size(640, 480), map_x, map_y);
+            print_result(bench_stage("bayer fused undistort -> 640x480", frames, 640 * 480 * 3, [&] {
+                fused.process(bayer.data(), size.width, out);
+            }));
+
+            // 只需要特征点坐标时：4096个点的去畸变，与整幅图像去畸变对比
+            const size_t point_count = 4096;
+            std::vector<float> points(point_count * 2), corrected(point_count * 2);
+            for (size_t i = 0; i < point_count; ++i) {
+                points[2 * i] = (float)((i * 37) % size.width);
+                points[2 * i + 1] = (float)((i * 53) % size.height);
+            }
+            print_result(bench_stage("undistort_points x4096", frames, point_count * 2 * sizeof(float), [&] {
+                undistorter.undistort_points(points.data(), corrected.data(), point_count);
+            }));
+            print_result(bench_stage("undistort_points_lut x4096", frames, point_count * 2 * sizeof(float), [&] {
+                undistorter.undistort_points_lut(points.data(), corrected.data(), point_count, size);
+            }));
+        }
+    }
+    return 0;
+}
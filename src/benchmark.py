@@ -0,0 +1,112 @@
+import sys
+import os
+import time
+import argparse
+
+import numpy as np
+
+# Same module lookup as main.py: ../build relative to this file
+build_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', 'build'))
+if build_dir not in sys.path:
+    sys.path.insert(0, build_dir)
+
+try:
+    import hikvision_camera
+except ImportError as e:
+    print(f"Error importing module: {e}")
+    print(f"Ensure '{build_dir}' contains the compiled '.so' file and is in sys.path.")
+    sys.exit(1)
+
+
+def make_camera(fps=0.0):
+    camera = hikvision_camera.DeviceCameraSimulator()
+    camera.init()
+    camera.set_resolution(1440, 1080)
+    camera.set_pixel_format(hikvision_camera.PixelType_Gvsp_BGR8_Packed)
+    camera.set_frame_rate(fps)
+    return camera
+
+
+def report(name, latencies_us, elapsed, bytes_out):
+    # Same columns as camera_benchmark: call = time spent in the call, out = bytes returned per frame
+    lat = np.asarray(latencies_us, dtype=np.float64)
+    fps = len(lat) / elapsed if elapsed > 0 else 0.0
+    bytes_per_frame = bytes_out // len(lat) if len(lat) > 0 else 0
+    if len(lat) == 0:
+        lat = np.zeros(1)
+    p50, p90, p99 = np.percentile(lat, [50, 90, 99])
+    print(f"{name:<34} {fps:9.1f} fps  call p50 {p50:8.1f}  p90 {p90:8.1f}  p99 {p99:8.1f}  "
+          f"max {lat.max():8.1f} us  out {bytes_per_frame:9d} B/frame")
+
+
+def report_telemetry(camera):
+    # The camera's own handoff->pickup histogram, printed like camera_benchmark does for its ring runs
+    telemetry = camera.telemetry()
+    queued = telemetry.handoff_to_pickup
+    if queued.count > 0:
+        print(f"  telemetry: handoff->pickup p50 {queued.p50_us:.1f}  p99 {queued.p99_us:.1f}  max {queued.max_us:.1f} us, "
+              f"gaps {telemetry.gaps}, backlog {telemetry.ring_backlog}")
+
+
+def bench_capture_image(frames):
+    # Per-call latency of the synchronous path (generate + copy into a new NumPy array)
+    camera = make_camera()
+    camera.start_grabbing()
+    latencies = []
+    bytes_out = 0
+    start = time.perf_counter()
+    for _ in range(frames):
+        t0 = time.perf_counter()
+        ok, image = camera.capture_image()
+        if not ok:
+            break
+        latencies.append((time.perf_counter() - t0) * 1e6)
+        bytes_out += image.nbytes
+    elapsed = time.perf_counter() - start
+    report("py capture_image (polling)", latencies, elapsed, bytes_out)
+    camera.close()
+
+
+def bench_ring(frames, latest, fps):
+    camera = make_camera(fps)
+    camera.start_acquisition(8)
+    latencies = []
+    bytes_out = 0
+    last_frame = None
+    start = time.perf_counter()
+    while len(latencies) < frames:
+        t0 = time.perf_counter()
+        ok, image, info = camera.read_latest() if latest else camera.read_next(1000)
+        if not ok:
+            if latest:
+                continue
+            break
+        if latest and info.frame_num == last_frame:
+            continue
+        last_frame = info.frame_num
+        latencies.append((time.perf_counter() - t0) * 1e6)
+        bytes_out += image.nbytes
+    elapsed = time.perf_counter() - start
+    name = f"py ring {'read_latest' if latest else 'read_next'}" + (f" @{int(fps)}fps" if fps > 0 else " (unthrottled)")
+    report(name, latencies, elapsed, bytes_out)
+    report_telemetry(camera)
+    stats = camera.acquisition_stats()
+    print(f"{'':34} published {stats.published}, dropped {stats.dropped}, overwritten {stats.overwritten}")
+    camera.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Python-side capture throughput benchmark (simulated camera)")
+    parser.add_argument("--frames", type=int, default=500)
+    args = parser.parse_args()
+
+    print(f"frames per run: {args.frames}, resolution 1440x1080 (call = time spent in the call; "
+          f"camera_benchmark also prints the frame age)")
+    bench_capture_image(args.frames)
+    bench_ring(args.frames, False, 0)
+    bench_ring(args.frames, True, 0)
+    bench_ring(min(args.frames, 120), False, 60)
+
+
+if __name__ == "__main__":
+    main()
@@ -3,26 +3,726 @@
 #include <pybind11/numpy.h> // Needed for returning images as NumPy arrays
 #include <pybind11/stl_bind.h> // Include for vector bindings if needed elsewhere
 #include "device_camera_sy011.h" // Include your camera header
+#include "device_camera_simulator.h"
+#include "bayer_pipeline.h"
+#include "camera_manager.h"
+#include "frame_arena.h"
+#include "frame_lease.h"
+#include "frame_pipeline.h"
+#include "frame_recorder.h"
+#include "frame_statistics.h"
+#include "frame_telemetry.h"
+#include "hb_decoder.h"
+#include "mono_unpack.h"
+#include "snapshot_encoder.h"
+#include "undistort.h"
 #include "MvCameraControl.h"   // Include Hikvision SDK header
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
 #include <stdexcept> // For exceptions
 #include <vector> // Include vector
 
 namespace py = pybind11;
 
+// Shape and strides of a frame buffer as seen from NumPy, derived from its pixel type
+static void frame_layout(const MV_FRAME_OUT_INFO_EX& info,
+                         std::vector<py::ssize_t>& shape, std::vector<py::ssize_t>& strides) {
+    py::ssize_t h = info.nHeight;
+    py::ssize_t w = info.nWidth;
+    switch (info.enPixelType) {
+        case PixelType_Gvsp_BGR8_Packed:
+        case PixelType_Gvsp_RGB8_Packed:
+            shape = { h, w, 3 };
+            strides = { w * 3, 3, 1 };
+            break;
+        case PixelType_Gvsp_Mono8:
+        case PixelType_Gvsp_BayerGR8:
+        case PixelType_Gvsp_BayerRG8:
+        case PixelType_Gvsp_BayerGB8:
+        case PixelType_Gvsp_BayerBG8:
+            shape = { h, w };
+            strides = { w, 1 };
+            break;
+        case PixelType_Gvsp_Mono10:
+        case PixelType_Gvsp_Mono12:
+        case PixelType_Gvsp_Mono16:
+            // Little-endian 16-bit samples, exposed as uint16 (see frame_dtype)
+            shape = { h, w };
+            strides = { w * 2, 2 };
+            break;
+        default:
+            // Unknown layout, or Mono10/12_Packed seen through a zero-copy view (lease, recording, shared ring,
+            // arena slot): expose the raw bytes; unpack_mono() turns packed ones into uint16
+            shape = { (py::ssize_t)info.nFrameLen };
+            strides = { 1 };
+            break;
+    }
+}
+
+// Element type matching frame_layout(): uint16 for unpacked 10/12/16-bit mono, uint8 otherwise
+static py::dtype frame_dtype(const MV_FRAME_OUT_INFO_EX& info) {
+    switch (info.enPixelType) {
+        case PixelType_Gvsp_Mono10:
+        case PixelType_Gvsp_Mono12:
+        case PixelType_Gvsp_Mono16:
+            return py::dtype::of<uint16_t>();
+        default:
+            return py::dtype::of<unsigned char>();
+    }
+}
+
+// Wrap a frame buffer as a NumPy array without copying; `base` keeps the memory alive
+static py::array frame_array(const MV_FRAME_OUT_INFO_EX& info, unsigned char* data, py::handle base) {
+    std::vector<py::ssize_t> shape, strides;
+    frame_layout(info, shape, strides);
+    return py::array(frame_dtype(info), shape, strides, data, base);
+}
+
+// Unpack a Mono8/10/12 (packed or not) frame into a new (H, W) uint16 array; normalize shifts the
+// samples up to the full 16-bit range. The SIMD kernels run with the GIL released.
+static py::array unpack_mono_array(const MV_FRAME_OUT_INFO_EX& info, const unsigned char* data, size_t length, bool normalize) {
+    MvGvspPixelType pixel_type = info.enPixelType;
+    if (!MonoUnpacker::is_supported(pixel_type)) {
+        throw std::invalid_argument("Not a Mono8/Mono10/Mono12 (packed) frame");
+    }
+    py::array_t<uint16_t> image({ (py::ssize_t)info.nHeight, (py::ssize_t)info.nWidth });
+    uint16_t* dst = image.mutable_data();
+    size_t pixel_count = (size_t)info.nWidth * info.nHeight;
+    int shift = normalize ? 16 - MonoUnpacker::bit_depth(pixel_type) : 0;
+    bool success;
+    {
+        py::gil_scoped_release release;
+        success = MonoUnpacker::unpack(data, length, pixel_type, pixel_count, dst, shift);
+    }
+    if (!success) {
+        throw std::runtime_error("Failed to unpack the mono frame");
+    }
+    return image;
+}
+
+// Captured frame as returned to Python: packed mono formats (and 10/12-bit frames to be normalized)
+// are unpacked to uint16; everything else is a view of `buffer`
+static py::array captured_array(const MV_FRAME_OUT_INFO_EX& info, py::array_t<unsigned char>& buffer, bool normalize) {
+    MvGvspPixelType pixel_type = info.enPixelType;
+    if (MonoUnpacker::is_packed(pixel_type) || (normalize && MonoUnpacker::bit_depth(pixel_type) > 8)) {
+        size_t length = std::min<size_t>(info.nFrameLen, (size_t)buffer.size());
+        return unpack_mono_array(info, buffer.data(), length, normalize);
+    }
+    return frame_array(info, buffer.mutable_data(), buffer);
+}
+
+// Wrap a uint8 (H, W) or (H, W, C) NumPy array as a cv::Mat header (no copy)
+static cv::Mat mat_from_array(const py::array& array) {
+    if (!array.dtype().is(py::dtype::of<unsigned char>())) {
+        throw std::invalid_argument("Expected a uint8 array");
+    }
+    py::buffer_info info = array.request();
+    if (info.ndim != 2 && info.ndim != 3) {
+        throw std::invalid_argument("Expected an array of shape (H, W) or (H, W, C)");
+    }
+    int channels = info.ndim == 3 ? (int)info.shape[2] : 1;
+    if (info.strides[info.ndim - 1] != 1 || (info.ndim == 3 && info.strides[1] != channels)) {
+        throw std::invalid_argument("Array rows must be contiguous");
+    }
+    return cv::Mat((int)info.shape[0], (int)info.shape[1], CV_8UC(channels), info.ptr, (size_t)info.strides[0]);
+}
+
+// Apply a point transform to an (N, 2) float32 array. A C-contiguous float32 input is used in place (no copy);
+// other inputs are converted once. The result goes into `out` (may be `points` itself) or a new array.
+template <typename Transform>
+static py::array transform_points(py::array points, py::object out, Transform transform) {
+    auto src = py::array_t<float, py::array::c_style | py::array::forcecast>::ensure(points);
+    if (!src || src.ndim() != 2 || src.shape(1) != 2) {
+        throw std::invalid_argument("Expected points of shape (N, 2)");
+    }
+    py::array_t<float, py::array::c_style> dst;
+    if (out.is_none()) {
+        dst = py::array_t<float, py::array::c_style>(std::vector<py::ssize_t>{ src.shape(0), 2 });
+    } else {
+        if (!py::isinstance<py::array_t<float, py::array::c_style>>(out)) {
+            throw std::invalid_argument("out must be a C-contiguous float32 array");
+        }
+        dst = out.cast<py::array_t<float, py::array::c_style>>();
+        if (dst.ndim() != 2 || dst.shape(0) != src.shape(0) || dst.shape(1) != 2) {
+            throw std::invalid_argument("out does not match the shape of points");
+        }
+    }
+    const float* src_data = src.data();
+    float* dst_data = dst.mutable_data();
+    size_t count = (size_t)src.shape(0);
+    bool ok;
+    {
+        py::gil_scoped_release release;
+        ok = transform(src_data, dst_data, count);
+    }
+    if (!ok) {
+        throw std::runtime_error("Point transform failed (calibration not loaded or size missing)");
+    }
+    return dst;
+}
+
+// Read from a camera's acquisition ring into a new NumPy array: (success_flag, image_array, FrameInfo).
+// The GIL is released while copying/waiting, so the acquisition thread is never held up by Python.
+template <typename Camera>
+static py::tuple read_ring_frame(Camera& camera, size_t size, bool latest, unsigned int timeout_ms, bool statistics = false) {
+    if (size == 0) {
+        return statistics ? py::make_tuple(false, py::none(), py::none(), py::none())
+                          : py::make_tuple(false, py::none(), py::none());
+    }
+    py::array_t<unsigned char> buffer((py::ssize_t)size);
+    unsigned char* pData = buffer.mutable_data();
+    MV_FRAME_OUT_INFO_EX frameInfo = {0};
+    // Statistics are copied from the same ring slot as the frame, so they always belong to it
+    FrameStatistics frame_statistics;
+    FrameStatistics* statistics_out = statistics ? &frame_statistics : nullptr;
+
+    bool success;
+    {
+        py::gil_scoped_release release;
+        success = latest ? camera.read_latest_frame(pData, size, frameInfo, statistics_out)
+                         : camera.read_next_frame(pData, size, frameInfo, timeout_ms, statistics_out);
+    }
+    if (!success) {
+        return statistics ? py::make_tuple(false, py::none(), py::none(), py::none())
+                          : py::make_tuple(false, py::none(), py::none());
+    }
+    py::array image = captured_array(frameInfo, buffer, false);
+    if (statistics) {
+        py::object frame_stats = frame_statistics.valid ? py::cast(frame_statistics) : py::object(py::none());
+        return py::make_tuple(true, image, frameInfo, frame_stats);
+    }
+    return py::make_tuple(true, image, frameInfo);
+}
+
+// Read from a shared-memory ring: (success_flag, image_array, FrameInfo, sequence).
+// Without copy the array is a read-only view into the mapping; check still_valid(sequence) after using it.
+static py::tuple read_shared_frame(py::object self, bool latest, unsigned int timeout_ms, bool copy) {
+    SharedFrameSubscriber& subscriber = self.cast<SharedFrameSubscriber&>();
+    if (!subscriber.is_open()) {
+        throw std::runtime_error("SharedFrameSubscriber is closed");
+    }
+    SharedFrameView view;
+    bool success;
+    {
+        py::gil_scoped_release release;
+        success = latest ? subscriber.read_latest(view) : subscriber.read_next(view, timeout_ms);
+    }
+    if (!success) {
+        return py::make_tuple(false, py::none(), py::none(), py::none());
+    }
+    if (!copy) {
+        py::array array = frame_array(view.info, const_cast<unsigned char*>(view.data), self);
+        array.attr("setflags")(py::arg("write") = false);
+        return py::make_tuple(true, array, view.info, view.sequence);
+    }
+    py::array_t<unsigned char> buffer((py::ssize_t)std::max<size_t>(view.length, 1));
+    {
+        py::gil_scoped_release release;
+        success = subscriber.copy(view, buffer.mutable_data(), view.length);
+    }
+    if (!success) {
+        // Overwritten by the publisher while copying
+        return py::make_tuple(false, py::none(), py::none(), py::none());
+    }
+    return py::make_tuple(true, frame_array(view.info, buffer.mutable_data(), buffer), view.info, view.sequence);
+}
+
+// Waits for the next frame into a caller buffer of `size` bytes (timeout in ms); runs without the GIL
+using FrameSource = std::function<bool(unsigned char*, size_t, MV_FRAME_OUT_INFO_EX&, unsigned int)>;
+
+template <typename Camera>
+static FrameSource camera_frame_source(Camera& camera) {
+    return [&camera](unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo, unsigned int timeout_ms) {
+        // 后台采集模式下按序从帧环读取，否则主动取图
+        return camera.acquisition_running() ? camera.read_next_frame(pData, size, frameInfo, timeout_ms)
+                                            : camera.capture_image(pData, frameInfo, timeout_ms);
+    };
+}
+
+// True while the camera is grabbing; a FrameStream ends once this turns false
+template <typename Camera>
+static std::function<bool()> camera_streaming(Camera& camera) {
+    return [&camera]() { return camera.grabbing(); };
+}
+
+// Native downscaled preview next to the full frame, always BGR (or mono) for cv2; Bayer frames are demosaiced
+// on the way down
+class PreviewMaker {
+public:
+    explicit PreviewMaker(py::object size) {
+        if (!size.is_none()) {
+            auto wh = size.cast<std::pair<int, int>>();
+            size_ = cv::Size(wh.first, wh.second);
+            if (size_.width <= 0 || size_.height <= 0) {
+                throw std::invalid_argument("preview must be (width, height)");
+            }
+        }
+    }
+
+    bool enabled() const { return size_.area() > 0; }
+    const cv::Size& size() const { return size_; }
+    size_t max_bytes() const { return (size_t)size_.area() * 3; }
+    static int channels(const MV_FRAME_OUT_INFO_EX& info) { return info.enPixelType == PixelType_Gvsp_Mono8 ? 1 : 3; }
+
+    bool make(const MV_FRAME_OUT_INFO_EX& info, const unsigned char* data, unsigned char* dst) {
+        cv::Size input(info.nWidth, info.nHeight);
+        MvGvspPixelType pixel_type = info.enPixelType;
+        if (BayerDemosaicer::is_bayer8(pixel_type)) {
+            if (!bayer_.is_configured() || bayer_.input_size() != input || bayer_type_ != pixel_type) {
+                bayer_type_ = pixel_type;
+                if (!bayer_.configure(input, pixel_type, size_)) {
+                    return false;
+                }
+            }
+            cv::Mat out(size_, CV_8UC3, dst);
+            return bayer_.process(data, input.width, out);
+        }
+        int type;
+        switch (pixel_type) {
+            case PixelType_Gvsp_BGR8_Packed:
+            case PixelType_Gvsp_RGB8_Packed: type = CV_8UC3; break;
+            case PixelType_Gvsp_Mono8: type = CV_8UC1; break;
+            default: return false;
+        }
+        cv::Mat src(input, type, const_cast<unsigned char*>(data));
+        cv::Mat out(size_, type, dst);
+        cv::resize(src, out, size_, 0, 0, cv::INTER_AREA);
+        if (pixel_type == PixelType_Gvsp_RGB8_Packed) {
+            cv::cvtColor(out, out, cv::COLOR_RGB2BGR);
+        }
+        return true;
+    }
+
+    py::array preview_array(const MV_FRAME_OUT_INFO_EX& info, unsigned char* data, py::handle base) const {
+        int c = channels(info);
+        std::vector<py::ssize_t> shape = { size_.height, size_.width };
+        std::vector<py::ssize_t> strides = { (py::ssize_t)size_.width * c, c };
+        if (c > 1) {
+            shape.push_back(c);
+            strides.push_back(1);
+        }
+        return py::array_t<unsigned char>(shape, strides, data, base);
+    }
+
+private:
+    cv::Size size_;
+    BayerDemosaicer bayer_;
+    MvGvspPixelType bayer_type_ = PixelType_Gvsp_Undefined;
+};
+
+// Grab one frame (and optional preview) into fresh arrays: (image, info) / (image, preview, info), None on timeout
+static py::object grab_frame(const FrameSource& source, size_t frame_size, unsigned int timeout_ms, PreviewMaker& preview) {
+    if (frame_size == 0) {
+        return py::none();
+    }
+    py::array_t<unsigned char> buffer((py::ssize_t)frame_size);
+    py::array_t<unsigned char> preview_buffer((py::ssize_t)std::max<size_t>(preview.max_bytes(), 1));
+    unsigned char* pData = buffer.mutable_data();
+    unsigned char* pPreview = preview_buffer.mutable_data();
+    MV_FRAME_OUT_INFO_EX frameInfo = {0};
+
+    bool success, has_preview = false;
+    {
+        py::gil_scoped_release release;
+        success = source(pData, frame_size, frameInfo, timeout_ms);
+        if (success && preview.enabled()) {
+            has_preview = preview.make(frameInfo, pData, pPreview);
+        }
+    }
+    if (!success) {
+        return py::none();
+    }
+    py::array image = captured_array(frameInfo, buffer, false);
+    if (!preview.enabled()) {
+        return py::make_tuple(image, frameInfo);
+    }
+    py::object preview_image = has_preview ? py::object(preview.preview_array(frameInfo, pPreview, preview_buffer)) : py::none();
+    return py::make_tuple(image, preview_image, frameInfo);
+}
+
+// Destination of a multi-frame capture: the caller's (N, ...) array, or a FrameArena owned by a capsule
+struct BatchBuffer {
+    unsigned char* base = nullptr;
+    size_t frame_stride = 0;
+    py::object owner;
+};
+
+static BatchBuffer batch_buffer(size_t frame_size, size_t n, py::object out, unsigned int pixel_format) {
+    BatchBuffer buffer;
+    buffer.frame_stride = frame_size;
+    if (!out.is_none()) {
+        // 打包格式的结果是解包后的新uint16数组，不能写进调用方的uint8数组
+        if (MonoUnpacker::is_packed((MvGvspPixelType)pixel_format)) {
+            throw std::invalid_argument("out is not supported for Mono10/12_Packed; frames are returned unpacked as uint16");
+        }
+        py::array out_array = out.cast<py::array>();
+        if (!out_array.dtype().is(py::dtype::of<unsigned char>()) || !(out_array.flags() & py::array::c_style) ||
+            out_array.ndim() < 2 || (size_t)out_array.shape(0) < n) {
+            throw std::invalid_argument("out must be a C-contiguous uint8 array with at least n frames");
+        }
+        buffer.frame_stride = (size_t)out_array.strides(0);
+        if (buffer.frame_stride < frame_size) {
+            throw std::invalid_argument("out frames are smaller than the camera frame size");
+        }
+        buffer.base = static_cast<unsigned char*>(out_array.mutable_data());
+        buffer.owner = out_array;
+    } else {
+        // 页对齐、预先缺页的内存池，每帧一个槽
+        auto* storage = new FrameArena();
+        if (!storage->allocate(n, frame_size)) {
+            delete storage;
+            throw std::runtime_error("Failed to allocate the batch buffer");
+        }
+        buffer.base = storage->data();
+        buffer.frame_stride = storage->slot_stride();
+        buffer.owner = py::capsule(storage, [](void* p) { delete static_cast<FrameArena*>(p); });
+    }
+    return buffer;
+}
+
+// Packed mono frames of a batch unpacked into one new (N, H, W) uint16 array, with the GIL released
+static py::array unpack_mono_batch(const BatchBuffer& buffer, const std::vector<MV_FRAME_OUT_INFO_EX>& infos, size_t count) {
+    const MV_FRAME_OUT_INFO_EX& first = infos[0];
+    py::array_t<uint16_t> frames({ (py::ssize_t)count, (py::ssize_t)first.nHeight, (py::ssize_t)first.nWidth });
+    uint16_t* dst = frames.mutable_data();
+    size_t pixel_count = (size_t)first.nWidth * first.nHeight;
+    bool success = true;
+    {
+        py::gil_scoped_release release;
+        for (size_t i = 0; i < count && success; ++i) {
+            const MV_FRAME_OUT_INFO_EX& info = infos[i];
+            success = info.nWidth == first.nWidth && info.nHeight == first.nHeight && info.enPixelType == first.enPixelType &&
+                      MonoUnpacker::unpack(buffer.base + i * buffer.frame_stride, std::min<size_t>(info.nFrameLen, buffer.frame_stride),
+                                           info.enPixelType, pixel_count, dst + i * pixel_count);
+        }
+    }
+    if (!success) {
+        throw std::runtime_error("Failed to unpack the batch (frame size or pixel format changed)");
+    }
+    return frames;
+}
+
+// The first `count` frames of a batch as one array (a slice of `out` when given), plus the list of FrameInfo.
+// Packed mono frames come back unpacked to uint16, as from capture_image().
+static py::tuple batch_frames(const BatchBuffer& buffer, const std::vector<MV_FRAME_OUT_INFO_EX>& infos, size_t count,
+                              py::object out) {
+    py::list info_list;
+    for (size_t i = 0; i < count; ++i) {
+        info_list.append(infos[i]);
+    }
+
+    py::object frames;
+    if (!out.is_none()) {
+        frames = out[py::slice(0, (py::ssize_t)count, 1)];
+    } else if (count == 0) {
+        frames = py::array_t<unsigned char>(std::vector<py::ssize_t>{ 0 });
+    } else if (MonoUnpacker::is_packed(infos[0].enPixelType)) {
+        frames = unpack_mono_batch(buffer, infos, count);
+    } else {
+        // 以第一帧的布局为准，在前面加上帧维
+        std::vector<py::ssize_t> shape, strides;
+        frame_layout(infos[0], shape, strides);
+        shape.insert(shape.begin(), (py::ssize_t)count);
+        strides.insert(strides.begin(), (py::ssize_t)buffer.frame_stride);
+        frames = py::array(frame_dtype(infos[0]), shape, strides, buffer.base, buffer.owner);
+    }
+    return py::make_tuple(frames, info_list);
+}
+
+// Capture up to n frames into one (N, H, W[, C]) array with a single GIL release.
+// Returns (frames, infos) or (frames, previews, infos); fewer than n frames on timeout.
+static py::tuple capture_batch(const FrameSource& source, size_t frame_size, unsigned int pixel_format, size_t n,
+                               unsigned int timeout_ms, py::object out, py::object preview_size) {
+    if (frame_size == 0 || n == 0) {
+        throw std::invalid_argument("capture_batch needs n > 0 and a configured camera");
+    }
+    PreviewMaker preview(preview_size);
+
+    // 输出缓冲区：调用方提供的(N, ...)数组，或一次性分配、由capsule交给NumPy管理
+    BatchBuffer buffer = batch_buffer(frame_size, n, out, pixel_format);
+    unsigned char* base = buffer.base;
+    size_t frame_stride = buffer.frame_stride;
+    auto* preview_storage = new std::vector<unsigned char>(preview.enabled() ? n * preview.max_bytes() : 0);
+    py::capsule preview_owner(preview_storage, [](void* p) { delete static_cast<std::vector<unsigned char>*>(p); });
+
+    std::vector<MV_FRAME_OUT_INFO_EX> infos(n);
+    size_t count = 0;
+    {
+        py::gil_scoped_release release;
+        for (; count < n; ++count) {
+            std::memset(&infos[count], 0, sizeof(MV_FRAME_OUT_INFO_EX));
+            unsigned char* frame = base + count * frame_stride;
+            if (!source(frame, frame_stride, infos[count], timeout_ms)) {
+                break;
+            }
+            if (preview.enabled()) {
+                preview.make(infos[count], frame, preview_storage->data() + count * preview.max_bytes());
+            }
+        }
+    }
+
+    py::tuple result = batch_frames(buffer, infos, count, out);
+    if (!preview.enabled()) {
+        return result;
+    }
+
+    py::object previews = py::none();
+    if (count > 0) {
+        int c = PreviewMaker::channels(infos[0]);
+        cv::Size size = preview.size();
+        std::vector<py::ssize_t> shape = { (py::ssize_t)count, size.height, size.width };
+        std::vector<py::ssize_t> strides = { (py::ssize_t)preview.max_bytes(), (py::ssize_t)size.width * c, c };
+        if (c > 1) {
+            shape.push_back(c);
+            strides.push_back(1);
+        }
+        previews = py::array_t<unsigned char>(shape, strides, preview_storage->data(), preview_owner);
+    }
+    return py::make_tuple(result[0], previews, result[1]);
+}
+
+// Iterator over frames: each step waits with the GIL released. A wait that times out raises TimeoutError and
+// the stream can be advanced again; StopIteration only after max_frames or once the camera stops grabbing.
+class FrameStream {
+public:
+    FrameStream(py::object camera, FrameSource source, std::function<bool()> streaming, size_t frame_size,
+                unsigned int timeout_ms, size_t max_frames, py::object preview_size)
+        : camera_(std::move(camera)), source_(std::move(source)), streaming_(std::move(streaming)),
+          frame_size_(frame_size), timeout_ms_(timeout_ms), max_frames_(max_frames), preview_(preview_size) {}
+
+    py::object next() {
+        if (finished_ || (max_frames_ > 0 && count_ >= max_frames_) || !streaming_()) {
+            finished_ = true;
+            throw py::stop_iteration();
+        }
+        py::object frame = grab_frame(source_, frame_size_, timeout_ms_, preview_);
+        if (frame.is_none()) {
+            if (!streaming_()) {
+                finished_ = true;
+                throw py::stop_iteration();
+            }
+            PyErr_SetString(PyExc_TimeoutError, "no frame within timeout_ms");
+            throw py::error_already_set();
+        }
+        ++count_;
+        return frame;
+    }
+
+private:
+    py::object camera_;     // keeps the camera alive while iterating
+    FrameSource source_;
+    std::function<bool()> streaming_;
+    size_t frame_size_;
+    unsigned int timeout_ms_;
+    size_t max_frames_;
+    size_t count_ = 0;
+    bool finished_ = false; // once exhausted, stays exhausted
+    PreviewMaker preview_;
+};
+
+// asyncio awaitable: the blocking grab runs on the loop's default executor with the GIL released
+static py::object grab_frame_async(py::object camera, FrameSource source, size_t frame_size, unsigned int timeout_ms,
+                                   py::object preview_size) {
+    auto preview = std::make_shared<PreviewMaker>(preview_size);
+    py::object loop = py::module_::import("asyncio").attr("get_running_loop")();
+    py::cpp_function task([camera, source, frame_size, timeout_ms, preview]() {
+        return grab_frame(source, frame_size, timeout_ms, *preview);
+    });
+    return loop.attr("run_in_executor")(py::none(), task);
+}
+
+// Python view of a std::future: done() polls, result() waits with the GIL released
+template <typename T>
+class PyFuture {
+public:
+    explicit PyFuture(std::future<T> future) : future_(future.share()) {}
+
+    bool done() const {
+        return future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    T result(py::object timeout) const {
+        {
+            py::gil_scoped_release release;
+            if (timeout.is_none()) {
+                future_.wait();
+            } else if (future_.wait_for(std::chrono::duration<double>(timeout.cast<double>())) != std::future_status::ready) {
+                throw std::runtime_error("timed out waiting for the result");
+            }
+        }
+        return future_.get();
+    }
+
+private:
+    std::shared_future<T> future_;
+};
+
+// Pipeline whose workers may call back into Python: the GIL is released while stopping so that
+// a worker blocked on it in a Python stage can finish
+class PyFramePipeline : public FramePipeline {
+public:
+    using FramePipeline::FramePipeline;
+
+    ~PyFramePipeline() {
+        py::gil_scoped_release release;
+        stop();
+    }
+};
+
+// Keeps a pipeline output (and the pipeline) alive while NumPy views of it exist
+struct PipelineView {
+    PipelineOutput output;
+    py::object pipeline;
+};
+
+static py::array pipeline_frame_array(const cv::Mat& image, py::handle base) {
+    std::vector<py::ssize_t> shape = { image.rows, image.cols };
+    std::vector<py::ssize_t> strides = { (py::ssize_t)image.step[0], (py::ssize_t)image.elemSize() };
+    if (image.channels() > 1) {
+        shape.push_back(image.channels());
+        strides.push_back(1);
+    }
+    return py::array_t<unsigned char>(shape, strides, image.data, base);
+}
+
+// (success_flag, image_array, FrameInfo[, FrameStatistics]); the array is a view of the pooled buffer, returned
+// to the pool once the array is garbage collected
+static py::tuple read_pipeline(py::object self, bool latest, unsigned int timeout_ms, bool statistics) {
+    FramePipeline& pipeline = self.cast<FramePipeline&>();
+    PipelineOutput output;
+    {
+        py::gil_scoped_release release;
+        output = latest ? pipeline.read_latest(timeout_ms) : pipeline.read(timeout_ms);
+    }
+    if (!output.valid()) {
+        return statistics ? py::make_tuple(false, py::none(), py::none(), py::none())
+                          : py::make_tuple(false, py::none(), py::none());
+    }
+    MV_FRAME_OUT_INFO_EX info = output.info();
+    FrameStatistics frame_statistics = output.statistics();
+    cv::Mat image = output.image();
+    PipelineView* view = new PipelineView{ std::move(output), self };
+    py::capsule owner(view, [](void* p) { delete static_cast<PipelineView*>(p); });
+    if (statistics) {
+        return py::make_tuple(true, pipeline_frame_array(image, owner), info, frame_statistics);
+    }
+    return py::make_tuple(true, pipeline_frame_array(image, owner), info);
+}
+
+// Statistics of the frame with the given FrameInfo or frame number, or of the newest frame for None
+template <typename Camera>
+static py::object camera_frame_statistics(const Camera& camera, py::object frame) {
+    FrameStatistics statistics;
+    bool found;
+    if (frame.is_none()) {
+        found = camera.latest_frame_statistics(statistics);
+    } else {
+        // A FrameInfo is matched by frame number and timestamps; a bare frame number (reset on reconnect) by number only
+        if (py::isinstance<MV_FRAME_OUT_INFO_EX>(frame)) {
+            found = camera.frame_statistics(frame.cast<MV_FRAME_OUT_INFO_EX>(), statistics);
+        } else {
+            found = camera.frame_statistics(frame.cast<unsigned int>(), statistics);
+        }
+    }
+    return found ? py::cast(statistics) : py::object(py::none());
+}
+
+// Sinks attached from Python are referenced from the camera's _frame_sinks list until removed, so the sink
+// outlives its registration but not the remove_frame_sink() call
+static py::list frame_sink_refs(py::object self) {
+    if (!py::hasattr(self, "_frame_sinks")) {
+        self.attr("_frame_sinks") = py::list();
+    }
+    return self.attr("_frame_sinks");
+}
+
+template <typename Camera>
+static bool add_frame_sink_py(py::object self, py::object sink) {
+    if (!self.cast<Camera&>().add_frame_sink(sink.cast<FrameSink*>())) {
+        return false;
+    }
+    frame_sink_refs(self).append(sink);
+    return true;
+}
+
+template <typename Camera>
+static void remove_frame_sink_py(py::object self, py::object sink) {
+    self.cast<Camera&>().remove_frame_sink(sink.cast<FrameSink*>());
+    py::list refs = frame_sink_refs(self);
+    py::list kept;
+    for (py::handle ref : refs) {
+        if (!ref.is(sink)) {
+            kept.append(ref);
+        }
+    }
+    self.attr("_frame_sinks") = kept;
+}
+
+// Python side of a FrameLease. The SDK buffer goes back once the lease is released (release()/__exit__)
+// and every view of it is gone, whichever happens last: views hold their own reference on the shared
+// lease, release() only drops this object's reference.
+class PyFrameLease {
+public:
+    explicit PyFrameLease(FrameLease lease) : lease_(std::make_shared<FrameLease>(std::move(lease))) {}
+
+    bool valid() const { return lease_ && lease_->valid(); }
+    // Views created before release() keep the buffer until they are garbage collected
+    bool release_pending() const { return !lease_ && !pending_.expired(); }
+
+    const FrameLease& lease() const {
+        if (!valid()) {
+            throw std::runtime_error("FrameLease has already been released");
+        }
+        return *lease_;
+    }
+
+    // Read-only NumPy view; its base owns a reference on the lease
+    py::array array() const {
+        const FrameLease& frame = lease();
+        auto* view = new std::shared_ptr<FrameLease>(lease_);
+        py::capsule owner(view, [](void* p) { delete static_cast<std::shared_ptr<FrameLease>*>(p); });
+        py::array image = frame_array(frame.info(), frame.data(), owner);
+        image.attr("setflags")(py::arg("write") = false);
+        return image;
+    }
+
+    void release() {
+        pending_ = lease_;
+        lease_.reset();
+    }
+
+private:
+    std::shared_ptr<FrameLease> lease_;
+    std::weak_ptr<FrameLease> pending_;
+};
+
 // Wrapper class to manage buffer allocation for capture_image
 class PyDeviceCameraSY011 : public DeviceCameraSY011 {
 public:
     using DeviceCameraSY011::DeviceCameraSY011; // Inherit constructors
 
     // Wrapper for capture_image that returns a NumPy array
-    py::tuple capture_image_py() {
-        // Estimate buffer size (adjust if necessary, e.g., based on current resolution)
-        // Consider getting width/height after setting resolution if possible
-        int buffer_size = 1440 * 1080 * 3; // Max resolution buffer * 3 channels (BGR)
-        std::vector<unsigned char> buffer(buffer_size);
+    py::tuple capture_image_py(bool normalize) {
+        // Sized from the camera's PayloadSize (follows set_resolution/set_roi/set_pixel_format)
+        size_t buffer_size = acquisition_running() ? frame_buffer_size() : payload_size();
+        if (buffer_size == 0) {
+            return py::make_tuple(false, py::none());
+        }
+        // The SDK writes straight into the NumPy-owned buffer, so no extra copy is needed
+        py::array_t<unsigned char> buffer((py::ssize_t)buffer_size);
+        unsigned char* pData = buffer.mutable_data();
         MV_FRAME_OUT_INFO_EX frameInfo = {0};
 
-        bool success = capture_image(buffer.data(), frameInfo);
+        bool success;
+        {
+            py::gil_scoped_release release;
+            success = capture_image(pData, frameInfo);
+        }
 
         if (!success) {
             // Return None or raise an exception on failure
@@ -36,22 +736,41 @@ public:
             // Or: throw std::runtime_error("Captured frame has invalid dimensions");
         }
 
-        // Explicitly define shape and strides using std::vector
-        std::vector<py::ssize_t> shape = { (py::ssize_t)frameInfo.nHeight, (py::ssize_t)frameInfo.nWidth, 3 };
-        std::vector<py::ssize_t> strides = { (py::ssize_t)frameInfo.nWidth * 3, 3, 1 };
+        // View of the captured data shaped as (rows, cols, channels); `buffer` stays alive as its base.
+        // Packed mono formats come back unpacked to uint16.
+        return py::make_tuple(true, captured_array(frameInfo, buffer, normalize));
+    }
+
+    // Zero-copy capture: returns (success_flag, FrameLease) borrowing the SDK buffer
+    py::tuple capture_lease_py(unsigned int timeout_ms) {
+        if (lossless_compression()) {
+            throw std::runtime_error("capture_lease() cannot lend HB-compressed buffers; use capture() while lossless compression is on");
+        }
+        FrameLease lease;
+        {
+            py::gil_scoped_release release;
+            lease = acquire_frame(timeout_ms);
+        }
+        if (!lease.valid()) {
+            return py::make_tuple(false, py::none());
+        }
+        return py::make_tuple(true, PyFrameLease(std::move(lease)));
+    }
+
+    py::tuple read_frame_py(bool latest, unsigned int timeout_ms, bool statistics) {
+        return read_ring_frame(*this, frame_buffer_size(), latest, timeout_ms, statistics);
+    }
 
-        // Create a NumPy array from the captured data
-        // Assuming BGR8 format is set in C++
-        py::array_t<unsigned char> result = py::array_t<unsigned char>(
-            shape,           // Shape (rows, cols, channels)
-            strides,         // Strides (bytes per row, bytes per pixel, bytes per channel)
-            buffer.data(),   // Pointer to data
-            py::cast(*this)  // Keep the C++ object alive
-        );
+    // Compare BayerDemosaicer against MV_CC_ConvertPixelTypeEx on a synthetic frame: (ok, mean_abs_diff, max_abs_diff)
+    py::tuple verify_bayer_demosaic_py(int width, int height, unsigned int pixel_type) {
+        BayerCompareResult result = BayerDemosaicer::compare_with_sdk(handle, width, height, (MvGvspPixelType)pixel_type);
+        return py::make_tuple(result.ok, result.mean_abs_diff, result.max_abs_diff);
+    }
 
-        // Important: Copy the data, as the buffer vector will go out of scope.
-        // If performance is critical, more advanced buffer management might be needed.
-        return py::make_tuple(true, result.attr("copy")());
+    // Compare and time MonoUnpacker against MV_CC_ConvertPixelTypeEx on a synthetic frame
+    UnpackCompareResult verify_mono_unpack_py(int width, int height, unsigned int pixel_type, int iterations) {
+        py::gil_scoped_release release;
+        return MonoUnpacker::compare_with_sdk(handle, width, height, (MvGvspPixelType)pixel_type, iterations);
     }
 };
 
@@ -59,17 +778,960 @@ public:
 PYBIND11_MODULE(hikvision_camera, m) {
     m.doc() = "Python bindings for Hikvision Camera Control"; // Optional module docstring
 
-    py::class_<PyDeviceCameraSY011>(m, "DeviceCameraSY011")
+    py::class_<MV_FRAME_OUT_INFO_EX>(m, "FrameInfo")
+        .def_readonly("width", &MV_FRAME_OUT_INFO_EX::nWidth)
+        .def_readonly("height", &MV_FRAME_OUT_INFO_EX::nHeight)
+        .def_property_readonly("pixel_type", [](const MV_FRAME_OUT_INFO_EX& info) { return (unsigned int)info.enPixelType; })
+        .def_readonly("frame_num", &MV_FRAME_OUT_INFO_EX::nFrameNum)
+        .def_property_readonly("dev_timestamp", [](const MV_FRAME_OUT_INFO_EX& info) {
+            return ((uint64_t)info.nDevTimeStampHigh << 32) | info.nDevTimeStampLow;
+        })
+        .def_readonly("host_timestamp", &MV_FRAME_OUT_INFO_EX::nHostTimeStamp)
+        .def_readonly("frame_len", &MV_FRAME_OUT_INFO_EX::nFrameLen)
+        .def_readonly("lost_packet", &MV_FRAME_OUT_INFO_EX::nLostPacket)
+        .def_readonly("exposure_time", &MV_FRAME_OUT_INFO_EX::fExposureTime)
+        .def_readonly("gain", &MV_FRAME_OUT_INFO_EX::fGain)
+        .def_readonly("trigger_index", &MV_FRAME_OUT_INFO_EX::nTriggerIndex)
+        .def_readonly("offset_x", &MV_FRAME_OUT_INFO_EX::nOffsetX)
+        .def_readonly("offset_y", &MV_FRAME_OUT_INFO_EX::nOffsetY);
+
+    py::class_<FrameStream>(m, "FrameStream")
+        .def("__iter__", [](py::object self) { return self; })
+        .def("__next__", &FrameStream::next);
+
+    py::class_<CameraRoi>(m, "CameraRoi")
+        .def(py::init<>())
+        .def_readwrite("width", &CameraRoi::width)
+        .def_readwrite("height", &CameraRoi::height)
+        .def_readwrite("offset_x", &CameraRoi::offset_x)
+        .def_readwrite("offset_y", &CameraRoi::offset_y)
+        .def_readwrite("binning_horizontal", &CameraRoi::binning_horizontal)
+        .def_readwrite("binning_vertical", &CameraRoi::binning_vertical)
+        .def_readwrite("decimation_horizontal", &CameraRoi::decimation_horizontal)
+        .def_readwrite("decimation_vertical", &CameraRoi::decimation_vertical)
+        .def("__repr__", [](const CameraRoi& roi) {
+            return "CameraRoi(" + std::to_string(roi.width) + "x" + std::to_string(roi.height) + "+" +
+                   std::to_string(roi.offset_x) + "+" + std::to_string(roi.offset_y) + ", binning " +
+                   std::to_string(roi.binning_horizontal) + "x" + std::to_string(roi.binning_vertical) + ", decimation " +
+                   std::to_string(roi.decimation_horizontal) + "x" + std::to_string(roi.decimation_vertical) + ")";
+        });
+
+    py::class_<FrameRingStats>(m, "AcquisitionStats")
+        .def_readonly("published", &FrameRingStats::published)
+        .def_readonly("overwritten", &FrameRingStats::overwritten)
+        .def_readonly("dropped", &FrameRingStats::dropped)
+        .def_readonly("rejected", &FrameRingStats::rejected);
+
+    py::class_<LatencySummary>(m, "LatencySummary")
+        .def_readonly("count", &LatencySummary::count)
+        .def_readonly("mean_us", &LatencySummary::mean_us)
+        .def_readonly("p50_us", &LatencySummary::p50_us)
+        .def_readonly("p90_us", &LatencySummary::p90_us)
+        .def_readonly("p99_us", &LatencySummary::p99_us)
+        .def_readonly("max_us", &LatencySummary::max_us)
+        .def("__repr__", [](const LatencySummary& summary) {
+            char text[160];
+            std::snprintf(text, sizeof(text), "LatencySummary(n=%llu, p50=%.1fus, p99=%.1fus, max=%.1fus)",
+                          (unsigned long long)summary.count, summary.p50_us, summary.p99_us, summary.max_us);
+            return std::string(text);
+        });
+
+    // Timestamps of the most recently picked-up frame; handoff_us/pickup_us are steady-clock microseconds
+    py::class_<FrameStageTimes>(m, "FrameStageTimes")
+        .def_readonly("frame_num", &FrameStageTimes::frame_num)
+        .def_readonly("device_timestamp", &FrameStageTimes::device_timestamp)
+        .def_readonly("host_arrival_ms", &FrameStageTimes::host_arrival_ms)
+        .def_readonly("handoff_us", &FrameStageTimes::handoff_us)
+        .def_readonly("pickup_us", &FrameStageTimes::pickup_us);
+
+    py::class_<TriggerStats>(m, "TriggerStats")
+        .def_readonly("triggers", &TriggerStats::triggers)
+        .def_readonly("frames", &TriggerStats::frames)
+        .def_readonly("timeouts", &TriggerStats::timeouts)
+        .def_readonly("trigger_to_delivery", &TriggerStats::trigger_to_delivery);
+
+    // Compressed side = HB frames received from the camera, decoded side = frames delivered in order
+    py::class_<HbDecodeStats>(m, "HbDecodeStats")
+        .def_readonly("received", &HbDecodeStats::received)
+        .def_readonly("decoded", &HbDecodeStats::decoded)
+        .def_readonly("failed", &HbDecodeStats::failed)
+        .def_readonly("dropped", &HbDecodeStats::dropped)
+        .def_readonly("passthrough", &HbDecodeStats::passthrough)
+        .def_readonly("compressed_bytes", &HbDecodeStats::compressed_bytes)
+        .def_readonly("decoded_bytes", &HbDecodeStats::decoded_bytes)
+        .def_readonly("compressed_fps", &HbDecodeStats::compressed_fps)
+        .def_readonly("compressed_mb_per_s", &HbDecodeStats::compressed_mb_per_s)
+        .def_readonly("decoded_fps", &HbDecodeStats::decoded_fps)
+        .def_readonly("decoded_mb_per_s", &HbDecodeStats::decoded_mb_per_s)
+        .def_readonly("compression_ratio", &HbDecodeStats::compression_ratio)
+        .def_readonly("in_flight", &HbDecodeStats::in_flight)
+        .def_readonly("serialized_decode", &HbDecodeStats::serialized_decode)
+        .def_readonly("decode", &HbDecodeStats::decode)
+        .def_readonly("receive_to_delivery", &HbDecodeStats::receive_to_delivery)
+        .def("__repr__", [](const HbDecodeStats& stats) {
+            char text[224];
+            std::snprintf(text, sizeof(text), "HbDecodeStats(compressed=%.1ffps %.1fMB/s, decoded=%.1ffps %.1fMB/s, ratio=%.2f, dropped=%llu, serialized=%s)",
+                          stats.compressed_fps, stats.compressed_mb_per_s, stats.decoded_fps, stats.decoded_mb_per_s,
+                          stats.compression_ratio, (unsigned long long)stats.dropped, stats.serialized_decode ? "True" : "False");
+            return std::string(text);
+        });
+
+    py::class_<TelemetrySnapshot>(m, "TelemetrySnapshot")
+        .def_readonly("frames", &TelemetrySnapshot::frames)
+        .def_readonly("picked_up", &TelemetrySnapshot::picked_up)
+        .def_readonly("gaps", &TelemetrySnapshot::gaps)
+        .def_readonly("frame_num_resets", &TelemetrySnapshot::frame_num_resets)
+        .def_readonly("lost_packet_frames", &TelemetrySnapshot::lost_packet_frames)
+        .def_readonly("lost_packets", &TelemetrySnapshot::lost_packets)
+        .def_readonly("sdk_queue_depth", &TelemetrySnapshot::sdk_queue_depth)
+        .def_readonly("ring_backlog", &TelemetrySnapshot::ring_backlog)
+        .def_readonly("delivered_fps", &TelemetrySnapshot::delivered_fps)
+        .def_readonly("arrival_to_handoff", &TelemetrySnapshot::arrival_to_handoff)
+        .def_readonly("handoff_to_pickup", &TelemetrySnapshot::handoff_to_pickup)
+        .def_readonly("arrival_to_pickup", &TelemetrySnapshot::arrival_to_pickup)
+        .def_readonly("frame_interval", &TelemetrySnapshot::frame_interval)
+        .def_readonly("last_frame", &TelemetrySnapshot::last_frame);
+
+    py::class_<UnpackCompareResult>(m, "UnpackCompareResult")
+        .def_readonly("ok", &UnpackCompareResult::ok)
+        .def_readonly("exact", &UnpackCompareResult::exact)
+        .def_property_readonly("sdk_pixel_type", [](const UnpackCompareResult& r) { return (unsigned int)r.sdk_pixel_type; })
+        .def_readonly("mean_abs_diff", &UnpackCompareResult::mean_abs_diff)
+        .def_readonly("max_abs_diff", &UnpackCompareResult::max_abs_diff)
+        .def_readonly("unpack_ms", &UnpackCompareResult::unpack_ms)
+        .def_readonly("sdk_ms", &UnpackCompareResult::sdk_ms);
+
+    m.def("set_hb_decode_serialized", &HbDecoder::set_serialized_decode,
+          "Serialize MV_CC_HB_Decode per camera handle (default True) until concurrent decoding on one handle is confirmed safe",
+          py::arg("enable"));
+    m.def("hb_decode_serialized", &HbDecoder::serialized_decode);
+
+    m.def("unpack_mono", [](py::array array, const MV_FRAME_OUT_INFO_EX& info, bool normalize) {
+        if (!(array.flags() & py::array::c_style)) {
+            throw std::invalid_argument("Expected a C-contiguous array");
+        }
+        size_t length = (size_t)array.nbytes();
+        if (info.nFrameLen > 0) {
+            length = std::min<size_t>(length, info.nFrameLen);
+        }
+        return unpack_mono_array(info, static_cast<const unsigned char*>(array.data()), length, normalize);
+    }, "Unpack a raw Mono8/10/12 or Mono10/12 packed frame to an (H, W) uint16 array", py::arg("array"), py::arg("info"),
+       py::arg("normalize") = false);
+    m.attr("mono_unpack_kernel") = MonoUnpacker::kernel_name();
+
+    py::enum_<FocusMeasure>(m, "FocusMeasure")
+        .value("NONE", FocusMeasure::None)
+        .value("LAPLACIAN_VARIANCE", FocusMeasure::LaplacianVariance)
+        .value("TENENGRAD", FocusMeasure::Tenengrad);
+
+    py::class_<FrameStatisticsOptions>(m, "FrameStatisticsOptions")
+        .def(py::init<>())
+        .def_readwrite("roi_x", &FrameStatisticsOptions::roi_x)
+        .def_readwrite("roi_y", &FrameStatisticsOptions::roi_y)
+        .def_readwrite("roi_width", &FrameStatisticsOptions::roi_width, "0 = to the right edge")
+        .def_readwrite("roi_height", &FrameStatisticsOptions::roi_height, "0 = to the bottom edge")
+        .def_readwrite("step", &FrameStatisticsOptions::step, "Sampling grid spacing in pixels")
+        .def_readwrite("focus", &FrameStatisticsOptions::focus)
+        .def_readwrite("saturation_level", &FrameStatisticsOptions::saturation_level, "8-bit luma counted as saturated");
+
+    py::class_<FrameStatistics>(m, "FrameStatistics")
+        .def_readonly("valid", &FrameStatistics::valid)
+        .def_readonly("frame_num", &FrameStatistics::frame_num)
+        .def_readonly("samples", &FrameStatistics::samples)
+        .def_readonly("mean", &FrameStatistics::mean)
+        .def_readonly("min", &FrameStatistics::min)
+        .def_readonly("max", &FrameStatistics::max)
+        .def_readonly("focus", &FrameStatistics::focus)
+        .def_readonly("saturated", &FrameStatistics::saturated)
+        .def_readonly("compute_us", &FrameStatistics::compute_us)
+        .def_property_readonly("saturated_fraction", &FrameStatistics::saturated_fraction)
+        .def_property_readonly("histogram", [](const FrameStatistics& self) {
+            py::array_t<uint32_t> histogram(256);
+            std::memcpy(histogram.mutable_data(), self.histogram, sizeof(self.histogram));
+            return histogram;
+        }, "256-bin luma histogram of the sampled grid (uint32 array)")
+        .def("percentile", &FrameStatistics::percentile, "Luma at the given fraction (0..1) of the histogram",
+             py::arg("fraction"));
+
+    m.def("frame_statistics", [](py::array array, py::object info, const FrameStatisticsOptions& options) {
+        if (!(array.flags() & py::array::c_style)) {
+            throw std::invalid_argument("Expected a C-contiguous array");
+        }
+        const unsigned char* data = static_cast<const unsigned char*>(array.data());
+        MV_FRAME_OUT_INFO_EX frame_info;
+        std::memset(&frame_info, 0, sizeof(frame_info));
+        if (!info.is_none()) {
+            // Raw frame in the camera's pixel format
+            frame_info = info.cast<MV_FRAME_OUT_INFO_EX>();
+            if (frame_info.nFrameLen == 0 || frame_info.nFrameLen > (size_t)array.nbytes()) {
+                frame_info.nFrameLen = (unsigned int)array.nbytes();
+            }
+        } else if (array.itemsize() == 1 && (array.ndim() == 2 || (array.ndim() == 3 && array.shape(2) == 3))) {
+            frame_info.nWidth = (unsigned short)array.shape(1);
+            frame_info.nHeight = (unsigned short)array.shape(0);
+            frame_info.enPixelType = array.ndim() == 3 ? PixelType_Gvsp_BGR8_Packed : PixelType_Gvsp_Mono8;
+            frame_info.nFrameLen = (unsigned int)array.nbytes();
+        } else {
+            throw std::invalid_argument("Expected a uint8 (H, W) or (H, W, 3) array, or info for a raw frame");
+        }
+        FrameStatistics statistics;
+        {
+            py::gil_scoped_release release;
+            FrameStatisticsCalculator(options).compute(data, frame_info, statistics);
+        }
+        return statistics;
+    }, "Frame statistics of a uint8 (H, W) mono / (H, W, 3) BGR image, or of a raw frame described by info",
+       py::arg("array"), py::arg("info") = py::none(), py::arg("options") = FrameStatisticsOptions());
+    m.attr("frame_statistics_kernel") = FrameStatisticsCalculator::kernel_name();
+
+    py::class_<FrameSink>(m, "FrameSink");
+
+    py::class_<RecorderStats>(m, "RecorderStats")
+        .def_readonly("submitted", &RecorderStats::submitted)
+        .def_readonly("written", &RecorderStats::written)
+        .def_readonly("dropped", &RecorderStats::dropped)
+        .def_readonly("failed", &RecorderStats::failed, "Frames lost to write errors (not in the recording)")
+        .def_readonly("last_error", &RecorderStats::last_error, "errno of the last failed write, 0 when none failed")
+        .def_readonly("bytes_written", &RecorderStats::bytes_written)
+        .def_readonly("chunks", &RecorderStats::chunks);
+
+    // Streaming raw recorder; attach to a camera with add_frame_sink() to record every acquired frame
+    py::class_<FrameRecorder, FrameSink>(m, "FrameRecorder")
+        .def(py::init<>())
+        .def("start", &FrameRecorder::start, "Start recording into <base_path>_NNNNN.hkraw chunk files",
+             py::arg("base_path"), py::arg("slot_size"), py::arg("queue_slots") = 32, py::arg("chunk_size") = (uint64_t)1 << 30)
+        .def("stop", &FrameRecorder::stop, "Flush queued frames and write the chunk index", py::call_guard<py::gil_scoped_release>())
+        .def("recording", &FrameRecorder::recording)
+        .def("submit", [](FrameRecorder& self, py::array array, const MV_FRAME_OUT_INFO_EX& info) {
+            py::buffer_info buffer = array.request();
+            if (!array.dtype().is(py::dtype::of<unsigned char>()) || !(array.flags() & py::array::c_style)) {
+                throw std::invalid_argument("Expected a C-contiguous uint8 array");
+            }
+            if ((size_t)buffer.size < info.nFrameLen) {
+                throw std::invalid_argument("Array is smaller than info.frame_len");
+            }
+            return self.submit(static_cast<const unsigned char*>(buffer.ptr), info);
+        }, "Queue a frame without blocking; False when the queue is full", py::arg("array"), py::arg("info"))
+        .def("stats", &FrameRecorder::stats)
+        .def("queue_depth", &FrameRecorder::queue_depth);
+
+    // Memory-mapped recording; frames are read-only NumPy views into the mapping (no copy, no decode)
+    py::class_<RawRecording>(m, "RawRecording")
+        .def(py::init([](const std::string& path) {
+            auto recording = std::unique_ptr<RawRecording>(new RawRecording());
+            if (!recording->open(path)) {
+                throw std::runtime_error("Failed to open recording: " + path);
+            }
+            return recording;
+        }), py::arg("path"))
+        .def("__len__", &RawRecording::frame_count)
+        .def("__getitem__", [](py::object self, py::ssize_t index) {
+            RawRecording& recording = self.cast<RawRecording&>();
+            if (index < 0) {
+                index += (py::ssize_t)recording.frame_count();
+            }
+            size_t length = 0;
+            MV_FRAME_OUT_INFO_EX info;
+            const unsigned char* data = index < 0 ? nullptr : recording.frame((size_t)index, length, info);
+            if (!data) {
+                throw py::index_error("frame index out of range");
+            }
+            py::array array = frame_array(info, const_cast<unsigned char*>(data), self);
+            array.attr("setflags")(py::arg("write") = false);
+            return py::make_tuple(array, info);
+        }, "(image_array, FrameInfo) of frame N; the array keeps the recording mapped")
+        .def("close", &RawRecording::close, "Unmap the recording; arrays taken from it must no longer be used");
+
+    py::class_<SharedFrameStats>(m, "SharedFrameStats")
+        .def_readonly("published", &SharedFrameStats::published)
+        .def_readonly("rejected", &SharedFrameStats::rejected);
+
+    // Publishes every acquired frame into a POSIX shared-memory ring (/dev/shm/<name>) for other processes;
+    // attach with add_frame_sink(). Never waits for subscribers.
+    py::class_<SharedFramePublisher, FrameSink>(m, "SharedFramePublisher")
+        .def(py::init([](const std::string& name, size_t slot_count, size_t slot_size) {
+            std::unique_ptr<SharedFramePublisher> publisher(new SharedFramePublisher());
+            if (!publisher->open(name, slot_count, slot_size)) {
+                throw std::runtime_error("Failed to create shared ring: " + name);
+            }
+            return publisher;
+        }), py::arg("name"), py::arg("slot_count"), py::arg("slot_size"))
+        .def_property_readonly("name", &SharedFramePublisher::name)
+        .def("is_open", &SharedFramePublisher::is_open)
+        .def("publish", [](SharedFramePublisher& self, py::array array, const MV_FRAME_OUT_INFO_EX& info) {
+            py::buffer_info buffer = array.request();
+            if (!array.dtype().is(py::dtype::of<unsigned char>()) || !(array.flags() & py::array::c_style)) {
+                throw std::invalid_argument("Expected a C-contiguous uint8 array");
+            }
+            if ((size_t)buffer.size < info.nFrameLen) {
+                throw std::invalid_argument("Array is smaller than info.frame_len");
+            }
+            // may wait for the grab thread's on_frame() to finish writing its slot
+            py::gil_scoped_release release;
+            return self.publish(static_cast<const unsigned char*>(buffer.ptr), info);
+        }, "Publish a frame; False when it exceeds the slot size. Safe while attached as a frame sink",
+        py::arg("array"), py::arg("info"))
+        .def("stats", &SharedFramePublisher::stats)
+        .def("close", &SharedFramePublisher::close, "Mark the ring closed, wake subscribers and remove the name");
+
+    // Maps a ring created by SharedFramePublisher (possibly in another process). Zero-copy arrays are
+    // read-only views that the publisher may overwrite once they fall slot_count frames behind.
+    py::class_<SharedFrameSubscriber>(m, "SharedFrameSubscriber")
+        .def(py::init([](const std::string& name) {
+            std::unique_ptr<SharedFrameSubscriber> subscriber(new SharedFrameSubscriber());
+            if (!subscriber->open(name)) {
+                throw std::runtime_error("Failed to open shared ring: " + name);
+            }
+            return subscriber;
+        }), py::arg("name"))
+        .def("read_next", [](py::object self, unsigned int timeout_ms, bool copy) {
+            return read_shared_frame(self, false, timeout_ms, copy);
+        }, "(success_flag, image_array, FrameInfo, sequence) of the next frame; skips frames that were overwritten",
+           py::arg("timeout_ms") = 1000, py::arg("copy") = false)
+        .def("read_latest", [](py::object self, bool copy) {
+            return read_shared_frame(self, true, 0, copy);
+        }, "(success_flag, image_array, FrameInfo, sequence) of the newest frame, without waiting", py::arg("copy") = false)
+        .def("still_valid", &SharedFrameSubscriber::still_valid,
+             "True if frame `sequence` has not been overwritten, i.e. data read from its view so far is consistent",
+             py::arg("sequence"))
+        .def("publisher_closed", &SharedFrameSubscriber::publisher_closed, "The publisher closed, replaced the ring or exited")
+        .def_property_readonly("slot_count", &SharedFrameSubscriber::slot_count)
+        .def_property_readonly("slot_size", &SharedFrameSubscriber::slot_size)
+        .def_property_readonly("head", &SharedFrameSubscriber::head, "Number of frames published so far")
+        .def_property("cursor", &SharedFrameSubscriber::cursor, &SharedFrameSubscriber::set_cursor, "Sequence read_next() returns next")
+        .def_property_readonly("dropped", &SharedFrameSubscriber::dropped, "Frames skipped because this subscriber fell behind")
+        .def("close", &SharedFrameSubscriber::close, "Unmap the ring; arrays taken from it must no longer be used");
+
+    py::enum_<SnapshotFormat>(m, "SnapshotFormat")
+        .value("PNG", SnapshotFormat::PNG)
+        .value("JPEG", SnapshotFormat::JPEG)
+        .value("TIFF", SnapshotFormat::TIFF)
+        .value("RAW", SnapshotFormat::RAW);
+
+    py::class_<SnapshotResult>(m, "SnapshotResult")
+        .def_readonly("ok", &SnapshotResult::ok)
+        .def_readonly("path", &SnapshotResult::path)
+        .def_readonly("encode_ms", &SnapshotResult::encode_ms);
+
+    py::class_<SnapshotStats>(m, "SnapshotStats")
+        .def_readonly("submitted", &SnapshotStats::submitted)
+        .def_readonly("completed", &SnapshotStats::completed)
+        .def_readonly("failed", &SnapshotStats::failed)
+        .def_readonly("rejected", &SnapshotStats::rejected)
+        .def_readonly("queue_depth", &SnapshotStats::queue_depth);
+
+    py::class_<PyFuture<SnapshotResult>>(m, "SnapshotFuture")
+        .def("done", &PyFuture<SnapshotResult>::done)
+        .def("result", &PyFuture<SnapshotResult>::result, "Wait for the SnapshotResult (timeout in seconds)", py::arg("timeout") = py::none());
+
+    py::class_<PyFuture<std::vector<SnapshotResult>>>(m, "BurstFuture")
+        .def("done", &PyFuture<std::vector<SnapshotResult>>::done)
+        .def("result", &PyFuture<std::vector<SnapshotResult>>::result, "Wait for all burst results (timeout in seconds)",
+             py::arg("timeout") = py::none());
+
+    // Encoder thread pool for snapshots; attach with add_frame_sink() to use arm_burst()
+    py::class_<SnapshotEncoder, FrameSink>(m, "SnapshotEncoder")
+        .def(py::init<int, size_t>(), py::arg("num_threads") = 2, py::arg("max_queue") = 8)
+        .def("save", [](SnapshotEncoder& self, py::array image, const std::string& path_prefix, SnapshotFormat format, int quality) -> py::object {
+            cv::Mat mat = mat_from_array(image);
+            std::future<SnapshotResult> future;
+            {
+                py::gil_scoped_release release;
+                future = self.submit(mat, path_prefix, format, quality);
+            }
+            if (!future.valid()) {
+                return py::none();
+            }
+            return py::cast(PyFuture<SnapshotResult>(std::move(future)));
+        }, "Queue a uint8 mono/BGR image for encoding; returns a SnapshotFuture, or None when the queue is full",
+           py::arg("image"), py::arg("path_prefix"), py::arg("format") = SnapshotFormat::PNG, py::arg("quality") = 95)
+        .def("arm_burst", [](SnapshotEncoder& self, size_t count, const std::string& path_prefix, SnapshotFormat format, int quality) {
+            return PyFuture<std::vector<SnapshotResult>>(self.arm_burst(count, path_prefix, format, quality));
+        }, "Save the next `count` consecutive frames delivered to this sink",
+           py::arg("count"), py::arg("path_prefix"), py::arg("format") = SnapshotFormat::PNG, py::arg("quality") = 95)
+        .def("stats", &SnapshotEncoder::stats)
+        .def("queue_depth", &SnapshotEncoder::queue_depth);
+
+    py::class_<ImageUndistorter, std::shared_ptr<ImageUndistorter>>(m, "ImageUndistorter")
+        .def(py::init<const std::string&>(), py::arg("calibration_file"))
+        .def("undistort", [](ImageUndistorter& self, py::array src, py::object dst, double alpha, int interpolation, bool crop_to_roi) {
+            cv::Mat src_mat = mat_from_array(src);
+            cv::Size out_size = crop_to_roi ? self.get_valid_roi(src_mat.size(), alpha).size() : src_mat.size();
+
+            py::array out;
+            if (dst.is_none()) {
+                std::vector<py::ssize_t> shape = { out_size.height, out_size.width };
+                if (src_mat.channels() > 1) {
+                    shape.push_back(src_mat.channels());
+                }
+                out = py::array_t<unsigned char>(shape);
+            } else {
+                out = dst.cast<py::array>();
+            }
+            cv::Mat dst_mat = mat_from_array(out);
+            if (dst_mat.size() != out_size || dst_mat.type() != src_mat.type()) {
+                throw std::invalid_argument("dst does not match the undistorted image shape");
+            }
+            {
+                py::gil_scoped_release release;
+                self.undistort_image(src_mat, dst_mat, alpha, interpolation, crop_to_roi);
+            }
+            return out;
+        }, "Undistort with cached remap tables, writing into dst when given",
+           py::arg("src"), py::arg("dst") = py::none(), py::arg("alpha") = -1.0,
+           py::arg("interpolation") = (int)cv::INTER_LINEAR, py::arg("crop_to_roi") = false)
+        .def("set_num_threads", &ImageUndistorter::set_num_threads, "Row stripes used by remap (0 = OpenCV default)", py::arg("num_threads"))
+        .def("clear_cache", &ImageUndistorter::clear_cache)
+        .def("is_loaded", &ImageUndistorter::is_loaded)
+        .def("undistort_points", [](ImageUndistorter& self, py::array points, py::object out, int width, int height,
+                                    double alpha, int iterations) {
+            return transform_points(points, out, [&](const float* src, float* dst, size_t count) {
+                return self.undistort_points(src, dst, count, cv::Size(width, height), alpha, iterations);
+            });
+        }, "Distorted -> undistorted pixel coordinates for (N, 2) float32 points (no copy when contiguous float32)",
+           py::arg("points"), py::arg("out") = py::none(), py::arg("width") = 0, py::arg("height") = 0,
+           py::arg("alpha") = -1.0, py::arg("iterations") = 5)
+        .def("distort_points", [](ImageUndistorter& self, py::array points, py::object out, int width, int height,
+                                  double alpha) {
+            return transform_points(points, out, [&](const float* src, float* dst, size_t count) {
+                return self.distort_points(src, dst, count, cv::Size(width, height), alpha);
+            });
+        }, "Undistorted -> distorted pixel coordinates for (N, 2) float32 points",
+           py::arg("points"), py::arg("out") = py::none(), py::arg("width") = 0, py::arg("height") = 0,
+           py::arg("alpha") = -1.0)
+        .def("undistort_points_lut", [](ImageUndistorter& self, py::array points, int width, int height, py::object out,
+                                        double alpha, int grid_step) {
+            return transform_points(points, out, [&](const float* src, float* dst, size_t count) {
+                return self.undistort_points_lut(src, dst, count, cv::Size(width, height), alpha, grid_step);
+            });
+        }, "Approximate undistort_points from a cached inverse-map grid (bilinear, one cell every grid_step pixels)",
+           py::arg("points"), py::arg("width"), py::arg("height"), py::arg("out") = py::none(),
+           py::arg("alpha") = -1.0, py::arg("grid_step") = 8)
+        .def("valid_roi", [](ImageUndistorter& self, int width, int height, double alpha) {
+            cv::Rect roi = self.get_valid_roi(cv::Size(width, height), alpha);
+            return py::make_tuple(roi.x, roi.y, roi.width, roi.height);
+        }, "Valid pixel ROI (x, y, w, h) after undistortion", py::arg("width"), py::arg("height"), py::arg("alpha") = -1.0);
+
+    py::class_<BayerDemosaicer>(m, "BayerDemosaicer")
+        .def(py::init<>())
+        .def("configure", [](BayerDemosaicer& self, int width, int height, unsigned int pixel_type,
+                             int output_width, int output_height, ImageUndistorter* undistorter, double alpha) {
+            cv::Size input_size(width, height);
+            cv::Mat map_x, map_y;
+            if (undistorter) {
+                undistorter->get_float_maps(input_size, alpha, map_x, map_y);
+            }
+            return self.configure(input_size, (MvGvspPixelType)pixel_type, cv::Size(output_width, output_height), map_x, map_y);
+        }, "Configure input size, Bayer pattern, output size (0 = input size) and optional undistortion",
+           py::arg("width"), py::arg("height"), py::arg("pixel_type"), py::arg("output_width") = 0,
+           py::arg("output_height") = 0, py::arg("undistorter") = nullptr, py::arg("alpha") = -1.0)
+        .def("process", [](BayerDemosaicer& self, py::array bayer, py::object dst) {
+            cv::Mat src_mat = mat_from_array(bayer);
+            if (src_mat.channels() != 1 || src_mat.size() != self.input_size()) {
+                throw std::invalid_argument("bayer does not match the configured input size");
+            }
+            cv::Size out_size = self.output_size();
+            py::array out = dst.is_none()
+                ? py::array(py::array_t<unsigned char>(std::vector<py::ssize_t>{ out_size.height, out_size.width, 3 }))
+                : dst.cast<py::array>();
+            cv::Mat dst_mat = mat_from_array(out);
+            if (dst_mat.size() != out_size || dst_mat.type() != CV_8UC3) {
+                throw std::invalid_argument("dst does not match the configured output shape");
+            }
+            bool success;
+            {
+                py::gil_scoped_release release;
+                success = self.process(src_mat.ptr<unsigned char>(0), src_mat.step, dst_mat);
+            }
+            if (!success) {
+                throw std::runtime_error("BayerDemosaicer is not configured");
+            }
+            return out;
+        }, "Demosaic (+ undistort + resize) a Bayer8 frame into a BGR8 array", py::arg("bayer"), py::arg("dst") = py::none())
+        .def("set_num_threads", &BayerDemosaicer::set_num_threads, py::arg("num_threads"))
+        .def("set_tile_rows", &BayerDemosaicer::set_tile_rows, "Output rows per tile (call before configure)", py::arg("tile_rows"));
+
+    py::class_<PipelineStageStats>(m, "PipelineStageStats")
+        .def_readonly("name", &PipelineStageStats::name)
+        .def_readonly("processed", &PipelineStageStats::processed)
+        .def_readonly("queue_depth", &PipelineStageStats::queue_depth)
+        .def_readonly("latency", &PipelineStageStats::latency);
+
+    py::class_<PipelineStats>(m, "PipelineStats")
+        .def_readonly("submitted", &PipelineStats::submitted)
+        .def_readonly("completed", &PipelineStats::completed)
+        .def_readonly("failed", &PipelineStats::failed)
+        .def_readonly("dropped_input", &PipelineStats::dropped_input)
+        .def_readonly("dropped_stage", &PipelineStats::dropped_stage)
+        .def_readonly("dropped_output", &PipelineStats::dropped_output)
+        .def_readonly("output_depth", &PipelineStats::output_depth)
+        .def_readonly("end_to_end", &PipelineStats::end_to_end)
+        .def_readonly("stages", &PipelineStats::stages);
+
+    // Native processing pipeline: decode -> configured stages on a worker pool; attach with add_frame_sink()
+    py::class_<PyFramePipeline, FrameSink>(m, "FramePipeline")
+        .def(py::init<int, size_t>(), py::arg("num_threads") = 2, py::arg("queue_capacity") = 4)
+        .def("add_undistort", [](PyFramePipeline& self, std::shared_ptr<ImageUndistorter> undistorter, double alpha,
+                                 int interpolation, bool crop_to_roi) {
+            return self.add_undistort(undistorter, alpha, interpolation, crop_to_roi);
+        }, py::arg("undistorter"), py::arg("alpha") = -1.0, py::arg("interpolation") = (int)cv::INTER_LINEAR,
+           py::arg("crop_to_roi") = false)
+        .def("add_undistort", [](PyFramePipeline& self, const std::string& calibration_file, double alpha,
+                                 int interpolation, bool crop_to_roi) {
+            return self.add_undistort(calibration_file, alpha, interpolation, crop_to_roi);
+        }, py::arg("calibration_file"), py::arg("alpha") = -1.0, py::arg("interpolation") = (int)cv::INTER_LINEAR,
+           py::arg("crop_to_roi") = false)
+        .def("add_overlay", [](PyFramePipeline& self, bool crosshair, int crosshair_size, bool frame_info,
+                               const std::string& text, std::vector<double> color, int thickness) {
+            OverlayOptions options;
+            options.crosshair = crosshair;
+            options.crosshair_size = crosshair_size;
+            options.frame_info = frame_info;
+            options.text = text;
+            color.resize(3, 0.0);
+            options.color = cv::Scalar(color[0], color[1], color[2]);
+            options.thickness = thickness;
+            return self.add_overlay(options);
+        }, "Draw a center crosshair / frame number and fps / text in place",
+           py::arg("crosshair") = true, py::arg("crosshair_size") = 20, py::arg("frame_info") = false,
+           py::arg("text") = "", py::arg("color") = std::vector<double>{ 0, 0, 255 }, py::arg("thickness") = 2)
+        .def("add_color_convert", &PyFramePipeline::add_color_convert, "cv2.cvtColor conversion code", py::arg("code"))
+        .def("add_resize", [](PyFramePipeline& self, int width, int height, int interpolation) {
+            return self.add_resize(cv::Size(width, height), interpolation);
+        }, py::arg("width"), py::arg("height"), py::arg("interpolation") = (int)cv::INTER_AREA)
+        .def("add_callback", [](PyFramePipeline& self, const std::string& name, py::function fn) {
+            // Runs on a worker thread with the GIL held; the array is a writable view that is only valid during
+            // the call. Returning a uint8 array replaces the frame's image with a copy of it.
+            auto holder = std::make_shared<py::function>(std::move(fn));
+            return self.add_callback(name, [holder](PipelineFrame& frame) {
+                py::gil_scoped_acquire acquire;
+                try {
+                    py::object result = (*holder)(pipeline_frame_array(frame.image, py::none()), frame.info);
+                    if (!result.is_none()) {
+                        mat_from_array(result.cast<py::array>()).copyTo(frame.image);
+                    }
+                } catch (py::error_already_set& e) {
+                    // The pipeline logs the message and counts the frame as failed
+                    throw std::runtime_error(e.what());
+                }
+            });
+        }, "Python stage fn(image, info) -> None or replacement image", py::arg("name"), py::arg("fn"))
+        .def("add_statistics", &PyFramePipeline::add_statistics,
+             "Luma histogram / brightness / focus / saturation of the current image, returned by read(statistics=True)",
+             py::arg("options") = FrameStatisticsOptions())
+        .def("set_mono_to_bgr", &PyFramePipeline::set_mono_to_bgr, py::arg("enable"))
+        .def("stage_names", &PyFramePipeline::stage_names)
+        .def("start", &PyFramePipeline::start)
+        .def("stop", &PyFramePipeline::stop, py::call_guard<py::gil_scoped_release>())
+        .def("running", &PyFramePipeline::running)
+        .def("submit", [](PyFramePipeline& self, py::array image, py::object info) {
+            cv::Mat mat = mat_from_array(image);
+            MV_FRAME_OUT_INFO_EX frame_info;
+            bool has_info = !info.is_none();
+            if (has_info) {
+                frame_info = info.cast<MV_FRAME_OUT_INFO_EX>();
+            }
+            py::gil_scoped_release release;
+            return self.submit(mat, has_info ? &frame_info : nullptr);
+        }, "Queue a decoded uint8 mono/BGR image (copied); False when dropped", py::arg("image"), py::arg("info") = py::none())
+        .def("read", [](py::object self, unsigned int timeout_ms, bool statistics) {
+            return read_pipeline(self, false, timeout_ms, statistics);
+        }, "Next result in order: (ok, image_view, FrameInfo), plus FrameStatistics when statistics=True",
+           py::arg("timeout_ms") = 1000, py::arg("statistics") = false)
+        .def("read_latest", [](py::object self, unsigned int timeout_ms, bool statistics) {
+            return read_pipeline(self, true, timeout_ms, statistics);
+        }, "Newest result, discarding older ones: (ok, image_view, FrameInfo), plus FrameStatistics when statistics=True",
+           py::arg("timeout_ms") = 1000, py::arg("statistics") = false)
+        .def("stats", &PyFramePipeline::stats);
+
+    py::class_<CameraManager>(m, "CameraManager")
+        .def(py::init<>())
+        .def("enumerate", &CameraManager::enumerate, "Serial numbers of attached devices (cached per process; refresh=True re-enumerates)",
+             py::arg("layer_types") = (unsigned int)(MV_USB_DEVICE | MV_GIGE_DEVICE), py::arg("refresh") = false)
+        .def("open", &CameraManager::open, "Open the devices with the given serials (all when empty)",
+             py::arg("serials") = std::vector<std::string>(), py::arg("layer_types") = (unsigned int)(MV_USB_DEVICE | MV_GIGE_DEVICE))
+        .def("camera_count", &CameraManager::camera_count)
+        .def("serial", &CameraManager::serial, py::arg("index"))
+        .def("set_resolution", [](CameraManager& self, size_t index, int width, int height) {
+            DeviceCameraSY011* camera = self.camera(index);
+            return camera && camera->set_resolution(width, height);
+        }, py::arg("index"), py::arg("width"), py::arg("height"))
+        .def("set_exposure_time", [](CameraManager& self, size_t index, int exposure_time) {
+            DeviceCameraSY011* camera = self.camera(index);
+            return camera && camera->set_exposure_time(exposure_time);
+        }, py::arg("index"), py::arg("exposure_time"))
+        .def("set_pixel_format", [](CameraManager& self, size_t index, unsigned int pixel_format) {
+            DeviceCameraSY011* camera = self.camera(index);
+            return camera && camera->set_pixel_format(pixel_format);
+        }, py::arg("index"), py::arg("pixel_format"))
+        .def("set_cpu_affinity", &CameraManager::set_cpu_affinity, "Pin a device's acquisition thread to a CPU (-1 = no pinning)",
+             py::arg("index"), py::arg("cpu"))
+        .def("acquisition_stats", [](CameraManager& self, size_t index) {
+            DeviceCameraSY011* camera = self.camera(index);
+            return camera ? camera->acquisition_stats() : FrameRingStats();
+        }, py::arg("index"))
+        .def("telemetry", [](CameraManager& self, size_t index) {
+            DeviceCameraSY011* camera = self.camera(index);
+            return camera ? camera->telemetry() : TelemetrySnapshot();
+        }, py::arg("index"))
+        .def("set_lossless_compression", [](CameraManager& self, size_t index, bool enable, int decode_threads) {
+            DeviceCameraSY011* camera = self.camera(index);
+            return camera && camera->set_lossless_compression(enable, decode_threads);
+        }, py::arg("index"), py::arg("enable"), py::arg("decode_threads") = 2)
+        .def("hb_decode_stats", [](CameraManager& self, size_t index) {
+            DeviceCameraSY011* camera = self.camera(index);
+            return camera ? camera->hb_decode_stats() : HbDecodeStats();
+        }, py::arg("index"))
+        .def("start", &CameraManager::start, "Start acquisition on every device", py::arg("slot_count") = 8)
+        .def("stop", &CameraManager::stop)
+        .def("close", &CameraManager::close)
+        .def("set_skew_tolerance", &CameraManager::set_skew_tolerance, "Maximum timestamp difference within a frame set", py::arg("tolerance"))
+        .def("set_use_host_timestamp", &CameraManager::set_use_host_timestamp, py::arg("use_host_timestamp"))
+        .def("unmatched_count", &CameraManager::unmatched_count)
+        .def("grab_frame_set", [](CameraManager& self, unsigned int timeout_ms) {
+            FrameSet frame_set;
+            bool success;
+            {
+                py::gil_scoped_release release;
+                success = self.grab_frame_set(frame_set, timeout_ms);
+            }
+            if (!success) {
+                return py::make_tuple(false, py::none(), 0);
+            }
+            py::list frames;
+            for (CameraFrame& frame : frame_set.frames) {
+                // 把帧缓冲区的所有权交给NumPy，避免再次拷贝
+                if (MonoUnpacker::is_packed(frame.info.enPixelType)) {
+                    size_t length = std::min<size_t>(frame.info.nFrameLen, frame.data.size());
+                    frames.append(py::make_tuple(frame.serial, unpack_mono_array(frame.info, frame.data.data(), length, false), frame.info));
+                    continue;
+                }
+                auto* data = new std::vector<unsigned char>(std::move(frame.data));
+                py::capsule owner(data, [](void* p) { delete static_cast<std::vector<unsigned char>*>(p); });
+                frames.append(py::make_tuple(frame.serial, frame_array(frame.info, data->data(), owner), frame.info));
+            }
+            return py::make_tuple(true, frames, frame_set.skew);
+        }, "Wait for a timestamp-aligned frame set: (success_flag, [(serial, image_array, FrameInfo)], skew)",
+           py::arg("timeout_ms") = 1000);
+
+    m.attr("MV_USB_DEVICE") = py::int_(MV_USB_DEVICE);
+    m.attr("MV_GIGE_DEVICE") = py::int_(MV_GIGE_DEVICE);
+    m.attr("PixelType_Gvsp_Mono8") = py::int_((unsigned int)PixelType_Gvsp_Mono8);
+    m.attr("PixelType_Gvsp_BayerGR8") = py::int_((unsigned int)PixelType_Gvsp_BayerGR8);
+    m.attr("PixelType_Gvsp_BayerRG8") = py::int_((unsigned int)PixelType_Gvsp_BayerRG8);
+    m.attr("PixelType_Gvsp_BayerGB8") = py::int_((unsigned int)PixelType_Gvsp_BayerGB8);
+    m.attr("PixelType_Gvsp_BayerBG8") = py::int_((unsigned int)PixelType_Gvsp_BayerBG8);
+    m.attr("PixelType_Gvsp_BGR8_Packed") = py::int_((unsigned int)PixelType_Gvsp_BGR8_Packed);
+    m.attr("PixelType_Gvsp_RGB8_Packed") = py::int_((unsigned int)PixelType_Gvsp_RGB8_Packed);
+    m.attr("MV_TRIGGER_SOURCE_LINE0") = py::int_((unsigned int)MV_TRIGGER_SOURCE_LINE0);
+    m.attr("MV_TRIGGER_SOURCE_LINE1") = py::int_((unsigned int)MV_TRIGGER_SOURCE_LINE1);
+    m.attr("MV_TRIGGER_SOURCE_LINE2") = py::int_((unsigned int)MV_TRIGGER_SOURCE_LINE2);
+    m.attr("MV_TRIGGER_SOURCE_LINE3") = py::int_((unsigned int)MV_TRIGGER_SOURCE_LINE3);
+    m.attr("MV_TRIGGER_SOURCE_SOFTWARE") = py::int_((unsigned int)MV_TRIGGER_SOURCE_SOFTWARE);
+    m.attr("PixelType_Gvsp_Mono10") = py::int_((unsigned int)PixelType_Gvsp_Mono10);
+    m.attr("PixelType_Gvsp_Mono10_Packed") = py::int_((unsigned int)PixelType_Gvsp_Mono10_Packed);
+    m.attr("PixelType_Gvsp_Mono12") = py::int_((unsigned int)PixelType_Gvsp_Mono12);
+    m.attr("PixelType_Gvsp_Mono12_Packed") = py::int_((unsigned int)PixelType_Gvsp_Mono12_Packed);
+
+    // Page-aligned, pre-faulted frame slots (optionally huge pages); views are NumPy arrays backed by the arena
+    py::class_<FrameArena>(m, "FrameArena")
+        .def(py::init([](size_t slot_count, size_t slot_size, bool huge_pages, size_t alignment) {
+            std::unique_ptr<FrameArena> arena(new FrameArena());
+            if (!arena->allocate(slot_count, slot_size, alignment, huge_pages)) {
+                throw std::runtime_error("Failed to allocate the frame arena");
+            }
+            return arena;
+        }), py::arg("slot_count"), py::arg("slot_size"), py::arg("huge_pages") = false, py::arg("alignment") = 64)
+        .def_property_readonly("slot_count", &FrameArena::slot_count)
+        .def_property_readonly("slot_size", &FrameArena::slot_size)
+        .def_property_readonly("slot_stride", &FrameArena::slot_stride)
+        .def_property_readonly("huge_pages", &FrameArena::huge_pages, "True when backed by reserved (MAP_HUGETLB) huge pages")
+        .def_property_readonly("array", [](py::object self) {
+            FrameArena& arena = self.cast<FrameArena&>();
+            std::vector<py::ssize_t> shape = { (py::ssize_t)arena.slot_count(), (py::ssize_t)arena.slot_size() };
+            std::vector<py::ssize_t> strides = { (py::ssize_t)arena.slot_stride(), 1 };
+            return py::array_t<unsigned char>(shape, strides, arena.data(), self);
+        }, "(slot_count, slot_size) view of all slots; usable as capture_batch(out=...)")
+        .def("slot", [](py::object self, size_t index, py::object info) {
+            FrameArena& arena = self.cast<FrameArena&>();
+            if (index >= arena.slot_count()) {
+                throw py::index_error("slot index out of range");
+            }
+            if (info.is_none()) {
+                return py::array(py::array_t<unsigned char>((py::ssize_t)arena.slot_size(), arena.slot(index), self));
+            }
+            MV_FRAME_OUT_INFO_EX frame_info = info.cast<MV_FRAME_OUT_INFO_EX>();
+            return frame_array(frame_info, arena.slot(index), self);
+        }, "View of one slot: flat bytes, or shaped as an image when a FrameInfo is given",
+           py::arg("index"), py::arg("info") = py::none());
+
+    // SDK buffer lease. Views (array, memoryview) are read-only and keep the buffer until they are collected;
+    // the buffer goes back to the SDK once the lease is released and the last view is gone.
+    py::class_<PyFrameLease>(m, "FrameLease", py::buffer_protocol())
+        .def_buffer([](PyFrameLease& lease) -> py::buffer_info {
+            // Export through a view array: releasing the Python buffer drops the array and with it the
+            // reference on the lease
+            py::array image = lease.array();
+            Py_buffer* view = new Py_buffer();
+            if (PyObject_GetBuffer(image.ptr(), view, PyBUF_RECORDS_RO) != 0) {
+                delete view;
+                throw py::error_already_set();
+            }
+            return py::buffer_info(view, true);
+        })
+        .def_property_readonly("array", &PyFrameLease::array,
+                               "Read-only NumPy view of the SDK buffer (no copy); holds the buffer until collected")
+        .def_property_readonly("info", [](const PyFrameLease& lease) { return lease.lease().info(); }, "Frame metadata (FrameInfo)")
+        .def_property_readonly("valid", &PyFrameLease::valid)
+        .def_property_readonly("release_pending", &PyFrameLease::release_pending,
+                               "Released, but views still hold the buffer")
+        .def("release", &PyFrameLease::release, "Release the lease; the buffer returns to the SDK once no view is left")
+        .def("__enter__", [](py::object self) { return self; })
+        .def("__exit__", [](PyFrameLease& lease, py::args) { lease.release(); });
+
+    py::class_<PyDeviceCameraSY011>(m, "DeviceCameraSY011", py::dynamic_attr())
         .def(py::init<>()) // Bind constructor
         .def("init", &PyDeviceCameraSY011::init, "Initialize the camera SDK and find devices")
+        .def("init_serial", &PyDeviceCameraSY011::init_serial, "Open the device with the given serial, using the cached enumeration",
+             py::arg("serial"), py::arg("layer_types") = (unsigned int)(MV_USB_DEVICE | MV_GIGE_DEVICE))
+        .def("serial_number", &PyDeviceCameraSY011::serial_number)
+        .def("load_profile", &PyDeviceCameraSY011::load_profile, "Apply a saved feature file (.mfs) in one step via MV_CC_FeatureLoadEx", py::arg("path"))
+        .def("save_profile", &PyDeviceCameraSY011::save_profile, "Save the current device features to a file", py::arg("path"))
+        .def("set_auto_reconnect", &PyDeviceCameraSY011::set_auto_reconnect,
+             "Reopen the device and resume streaming in the background after a disconnect; buffers stay allocated", py::arg("enable"))
+        .def("auto_reconnect", &PyDeviceCameraSY011::auto_reconnect)
+        .def("reconnect", &PyDeviceCameraSY011::reconnect, "Reopen the device now and restore its settings and streaming state",
+             py::call_guard<py::gil_scoped_release>())
+        .def("is_connected", &PyDeviceCameraSY011::is_connected)
+        .def("reconnect_count", &PyDeviceCameraSY011::reconnect_count)
+        .def("last_reconnect_ms", &PyDeviceCameraSY011::last_reconnect_ms)
         .def("set_resolution", &PyDeviceCameraSY011::set_resolution, "Set camera resolution", py::arg("width"), py::arg("height"))
         .def("set_exposure_time", &PyDeviceCameraSY011::set_exposure_time, "Set camera exposure time", py::arg("exposure_time")) // Uncommented as per suggestion
+        .def("set_roi", [](PyDeviceCameraSY011& self, int width, int height, int offset_x, int offset_y,
+                           int binning_horizontal, int binning_vertical, int decimation_horizontal, int decimation_vertical) {
+            CameraRoi roi;
+            roi.width = width;
+            roi.height = height;
+            roi.offset_x = offset_x;
+            roi.offset_y = offset_y;
+            roi.binning_horizontal = binning_horizontal;
+            roi.binning_vertical = binning_vertical;
+            roi.decimation_horizontal = decimation_horizontal;
+            roi.decimation_vertical = decimation_vertical;
+            CameraRoi applied;
+            bool success;
+            {
+                py::gil_scoped_release release;
+                success = self.set_roi(roi, &applied);
+            }
+            return py::make_tuple(success, applied);
+        }, "Set readout window, offset, binning and decimation (aligned to the camera's increments); "
+           "costs one stop/start while grabbing. Returns (success_flag, applied CameraRoi)",
+           py::arg("width"), py::arg("height"), py::arg("offset_x") = 0, py::arg("offset_y") = 0,
+           py::arg("binning_horizontal") = 1, py::arg("binning_vertical") = 1,
+           py::arg("decimation_horizontal") = 1, py::arg("decimation_vertical") = 1)
+        .def("get_roi", &PyDeviceCameraSY011::get_roi)
+        .def("payload_size", &PyDeviceCameraSY011::payload_size, "Bytes per frame (PayloadSize) for the current configuration")
+        .def("set_pixel_format", &PyDeviceCameraSY011::set_pixel_format, "Set the camera PixelFormat (e.g. PixelType_Gvsp_BayerRG8); applied at open if called before init", py::arg("pixel_format"))
+        .def("get_pixel_format", &PyDeviceCameraSY011::get_pixel_format)
+        .def("verify_bayer_demosaic", &PyDeviceCameraSY011::verify_bayer_demosaic_py,
+             "Compare BayerDemosaicer with MV_CC_ConvertPixelTypeEx on a synthetic frame (ok, mean_abs_diff, max_abs_diff)",
+             py::arg("width") = 1440, py::arg("height") = 1080, py::arg("pixel_type") = (unsigned int)PixelType_Gvsp_BayerRG8)
+        .def("verify_mono_unpack", &PyDeviceCameraSY011::verify_mono_unpack_py,
+             "Compare and time the SIMD mono unpack kernels against MV_CC_ConvertPixelTypeEx on a synthetic frame",
+             py::arg("width") = 1440, py::arg("height") = 1080, py::arg("pixel_type") = (unsigned int)PixelType_Gvsp_Mono12_Packed,
+             py::arg("iterations") = 20)
         .def("start_grabbing", &PyDeviceCameraSY011::start_grabbing, "Start image grabbing")
-        .def("stop_grabbing", &PyDeviceCameraSY011::stop_grabbing, "Stop image grabbing")
-        .def("capture_image", &PyDeviceCameraSY011::capture_image_py, "Capture an image and return as NumPy array (success_flag, image_array)")
-        .def("close", &PyDeviceCameraSY011::close, "Close the device and release SDK resources")
+        .def("stop_grabbing", &PyDeviceCameraSY011::stop_grabbing, "Stop image grabbing; the device stays open for a fast restart")
+        .def("capture_image", &PyDeviceCameraSY011::capture_image_py,
+             "Capture an image and return as NumPy array (success_flag, image_array); Mono10/12 come back as uint16, "
+             "normalize shifts them to the full 16-bit range", py::arg("normalize") = false)
+        .def("use_registered_buffers", &PyDeviceCameraSY011::use_registered_buffers,
+             "Let the camera write into library-allocated, page-aligned slots registered with the SDK (0 = SDK buffers); call while not grabbing",
+             py::arg("slot_count"), py::arg("huge_pages") = false)
+        .def("registered_buffers_active", &PyDeviceCameraSY011::registered_buffers_active)
+        .def("capture_lease", &PyDeviceCameraSY011::capture_lease_py, "Borrow the SDK frame buffer without copying (success_flag, FrameLease)", py::arg("timeout_ms") = 1000)
+        .def("start_acquisition", &PyDeviceCameraSY011::start_acquisition, "Start grabbing through the SDK callback into a preallocated frame ring (replaces start_grabbing)", py::arg("slot_count") = 8)
+        .def("read_latest", [](PyDeviceCameraSY011& self, bool statistics) { return self.read_frame_py(true, 0, statistics); },
+             "Non-blocking read of the newest frame in the ring (success_flag, image_array, FrameInfo[, FrameStatistics or None])",
+             py::arg("statistics") = false)
+        .def("read_next", [](PyDeviceCameraSY011& self, unsigned int timeout_ms, bool statistics) {
+            return self.read_frame_py(false, timeout_ms, statistics);
+        }, "Read the next frame in order, waiting up to timeout_ms with the GIL released "
+           "(success_flag, image_array, FrameInfo[, FrameStatistics or None])",
+           py::arg("timeout_ms") = 1000, py::arg("statistics") = false)
+        .def("acquisition_stats", &PyDeviceCameraSY011::acquisition_stats, "Frame ring counters (published/overwritten/dropped/rejected)")
+        .def("telemetry", &PyDeviceCameraSY011::telemetry,
+             "Lock-free snapshot of per-stage latency histograms, frame gaps, lost packets and SDK/ring queue depth")
+        .def("reset_telemetry", &PyDeviceCameraSY011::reset_telemetry)
+        .def("capture_batch", [](PyDeviceCameraSY011& self, size_t n, unsigned int timeout_ms, py::object out, py::object preview) {
+            return capture_batch(camera_frame_source(self), self.acquisition_running() ? self.frame_buffer_size() : self.payload_size(),
+                                 self.get_pixel_format(), n, timeout_ms, out, preview);
+        }, "Capture n frames into one (N, H, W[, C]) array with a single GIL release: (frames, infos) or, "
+           "with preview=(w, h), (frames, previews, infos)",
+           py::arg("n"), py::arg("timeout_ms") = 1000, py::arg("out") = py::none(), py::arg("preview") = py::none())
+        .def("set_trigger_mode", &PyDeviceCameraSY011::set_trigger_mode,
+             "Enable/disable trigger mode (TriggerMode/TriggerSource); source is one of MV_TRIGGER_SOURCE_*",
+             py::arg("enable"), py::arg("source") = (unsigned int)MV_TRIGGER_SOURCE_SOFTWARE)
+        .def("trigger_mode", &PyDeviceCameraSY011::trigger_mode)
+        .def("trigger_source", &PyDeviceCameraSY011::trigger_source)
+        .def("set_burst_frame_count", &PyDeviceCameraSY011::set_burst_frame_count,
+             "Frames produced per trigger (AcquisitionBurstFrameCount)", py::arg("count"))
+        .def("burst_frame_count", &PyDeviceCameraSY011::burst_frame_count)
+        .def("trigger_software", &PyDeviceCameraSY011::trigger_software, "Issue TriggerSoftware without waiting",
+             py::call_guard<py::gil_scoped_release>())
+        .def("trigger_and_wait", [](PyDeviceCameraSY011& self, unsigned int timeout_ms, bool normalize) {
+            size_t size = self.acquisition_running() ? self.frame_buffer_size() : self.payload_size();
+            if (size == 0) {
+                return py::make_tuple(false, py::none(), py::none());
+            }
+            py::array_t<unsigned char> buffer((py::ssize_t)size);
+            unsigned char* pData = buffer.mutable_data();
+            MV_FRAME_OUT_INFO_EX frameInfo = {0};
+            bool success;
+            {
+                py::gil_scoped_release release;
+                success = self.trigger_and_wait(pData, size, frameInfo, timeout_ms);
+            }
+            if (!success) {
+                return py::make_tuple(false, py::none(), py::none());
+            }
+            return py::make_tuple(true, captured_array(frameInfo, buffer, normalize), frameInfo);
+        }, "Software-trigger and wait for the frame of that trigger: (success_flag, image_array, FrameInfo)",
+           py::arg("timeout_ms") = 1000, py::arg("normalize") = false)
+        .def("trigger_burst", [](PyDeviceCameraSY011& self, size_t n, unsigned int timeout_ms, py::object out) {
+            size_t size = self.acquisition_running() ? self.frame_buffer_size() : self.payload_size();
+            if (size == 0 || n == 0) {
+                throw std::invalid_argument("trigger_burst needs n > 0 and a configured camera");
+            }
+            BatchBuffer buffer = batch_buffer(size, n, out, self.get_pixel_format());
+            std::vector<MV_FRAME_OUT_INFO_EX> infos(n);
+            size_t count;
+            {
+                py::gil_scoped_release release;
+                count = self.trigger_burst(buffer.base, buffer.frame_stride, n, infos.data(), timeout_ms);
+            }
+            return batch_frames(buffer, infos, count, out);
+        }, "Capture n triggered frames (one software trigger per burst_frame_count() frames) into preallocated slots: (frames, infos)",
+           py::arg("n"), py::arg("timeout_ms") = 1000, py::arg("out") = py::none())
+        .def("capture_bracket", [](PyDeviceCameraSY011& self, const std::vector<double>& exposure_times, unsigned int timeout_ms,
+                                   py::object out) {
+            size_t size = self.acquisition_running() ? self.frame_buffer_size() : self.payload_size();
+            if (size == 0 || exposure_times.empty()) {
+                throw std::invalid_argument("capture_bracket needs exposure times and a configured camera");
+            }
+            BatchBuffer buffer = batch_buffer(size, exposure_times.size(), out, self.get_pixel_format());
+            std::vector<MV_FRAME_OUT_INFO_EX> infos(exposure_times.size());
+            size_t count;
+            {
+                py::gil_scoped_release release;
+                count = self.capture_bracket(exposure_times, buffer.base, buffer.frame_stride, infos.data(), timeout_ms);
+            }
+            return batch_frames(buffer, infos, count, out);
+        }, "Exposure bracketing: one software-triggered frame per exposure time (us), then restore the exposure: (frames, infos)",
+           py::arg("exposure_times"), py::arg("timeout_ms") = 1000, py::arg("out") = py::none())
+        .def("trigger_stats", &PyDeviceCameraSY011::trigger_stats, "Trigger counts and trigger-to-delivery latency")
+        .def("reset_trigger_stats", &PyDeviceCameraSY011::reset_trigger_stats)
+        .def("set_lossless_compression", &PyDeviceCameraSY011::set_lossless_compression,
+             "HB lossless transport: the camera sends compressed frames, decoded in parallel and delivered in order (call while not grabbing)",
+             py::arg("enable"), py::arg("decode_threads") = 2)
+        .def("lossless_compression", &PyDeviceCameraSY011::lossless_compression)
+        .def("hb_decode_stats", &PyDeviceCameraSY011::hb_decode_stats, "Compressed vs decoded throughput and decode latency")
+        .def("reset_hb_decode_stats", &PyDeviceCameraSY011::reset_hb_decode_stats)
+        .def("stream", [](py::object self, unsigned int timeout_ms, size_t max_frames, py::object preview) {
+            PyDeviceCameraSY011& camera = self.cast<PyDeviceCameraSY011&>();
+            size_t size = camera.acquisition_running() ? camera.frame_buffer_size() : camera.payload_size();
+            return FrameStream(self, camera_frame_source(camera), camera_streaming(camera), size, timeout_ms, max_frames, preview);
+        }, "Iterate over frames as (image, info) or (image, preview, info); raises TimeoutError when no frame arrives "
+           "within timeout_ms, ends after max_frames (0 = unlimited) or when grabbing stops",
+           py::arg("timeout_ms") = 1000, py::arg("max_frames") = 0, py::arg("preview") = py::none())
+        .def("read_next_async", [](py::object self, unsigned int timeout_ms, py::object preview) {
+            PyDeviceCameraSY011& camera = self.cast<PyDeviceCameraSY011&>();
+            size_t size = camera.acquisition_running() ? camera.frame_buffer_size() : camera.payload_size();
+            return grab_frame_async(self, camera_frame_source(camera), size, timeout_ms, preview);
+        }, "Awaitable next frame for asyncio: (image, info) / (image, preview, info), or None on timeout",
+           py::arg("timeout_ms") = 1000, py::arg("preview") = py::none())
+        .def("frame_buffer_size", &PyDeviceCameraSY011::frame_buffer_size, "Bytes per frame slot in acquisition mode")
+        .def("set_frame_statistics", &PyDeviceCameraSY011::set_frame_statistics,
+             "Compute luma histogram / brightness / focus / saturation on the grab thread for every frame",
+             py::arg("enable"), py::arg("options") = FrameStatisticsOptions())
+        .def("frame_statistics", [](const PyDeviceCameraSY011& self, py::object frame) {
+            return camera_frame_statistics(self, frame);
+        }, "FrameStatistics of the frame with this FrameInfo (matched by number and timestamps) or frame number "
+           "(newest match), of the newest frame when None; None when not found",
+           py::arg("frame") = py::none())
+        .def("add_frame_sink", &add_frame_sink_py<PyDeviceCameraSY011>,
+             "Deliver every acquired frame to a sink (e.g. FrameRecorder) on the grab thread", py::arg("sink"))
+        .def("remove_frame_sink", &remove_frame_sink_py<PyDeviceCameraSY011>, py::arg("sink"))
+        .def("close", &PyDeviceCameraSY011::close, "Close the device; the SDK stays initialized so init() can reopen it quickly")
         .def("get_fps", &PyDeviceCameraSY011::get_fps, "Get the current frame rate reported by the camera (ResultingFrameRate/AcquisitionFrameRate)"); // Added as per suggestion
 
+    // Simulated camera: same capture/acquisition API as DeviceCameraSY011, no hardware required
+    py::class_<DeviceCameraSimulator>(m, "DeviceCameraSimulator", py::dynamic_attr())
+        .def(py::init<>())
+        .def("init", &DeviceCameraSimulator::init)
+        .def("set_resolution", &DeviceCameraSimulator::set_resolution, py::arg("width"), py::arg("height"))
+        .def("set_exposure_time", &DeviceCameraSimulator::set_exposure_time, py::arg("exposure_time"))
+        .def("set_pixel_format", &DeviceCameraSimulator::set_pixel_format, "BGR8/RGB8/Mono8/Bayer8 formats", py::arg("pixel_format"))
+        .def("get_pixel_format", &DeviceCameraSimulator::get_pixel_format)
+        .def("set_frame_rate", &DeviceCameraSimulator::set_frame_rate, "Frame rate to emulate (0 = as fast as possible)", py::arg("fps"))
+        .def("set_drop_probability", &DeviceCameraSimulator::set_drop_probability, py::arg("probability"))
+        .def("set_lost_packet_probability", &DeviceCameraSimulator::set_lost_packet_probability, py::arg("probability"))
+        .def("set_jitter", &DeviceCameraSimulator::set_jitter, "Frame interval jitter (standard deviation, us)", py::arg("jitter_us"))
+        .def("set_seed", &DeviceCameraSimulator::set_seed, py::arg("seed"))
+        .def("load_replay", &DeviceCameraSimulator::load_replay, "Replay the given image files in a loop", py::arg("image_paths"))
+        .def("clear_replay", &DeviceCameraSimulator::clear_replay)
+        .def("start_grabbing", &DeviceCameraSimulator::start_grabbing)
+        .def("stop_grabbing", &DeviceCameraSimulator::stop_grabbing)
+        .def("capture_image", [](DeviceCameraSimulator& self, bool normalize) {
+            py::array_t<unsigned char> buffer((py::ssize_t)self.frame_size());
+            unsigned char* pData = buffer.mutable_data();
+            MV_FRAME_OUT_INFO_EX frameInfo = {0};
+            bool success;
+            {
+                py::gil_scoped_release release;
+                success = self.capture_image(pData, frameInfo);
+            }
+            if (!success) {
+                return py::make_tuple(false, py::none());
+            }
+            return py::make_tuple(true, captured_array(frameInfo, buffer, normalize));
+        }, "Capture an image and return as NumPy array (success_flag, image_array)", py::arg("normalize") = false)
+        .def("start_acquisition", &DeviceCameraSimulator::start_acquisition, py::arg("slot_count") = 8)
+        .def("read_latest", [](DeviceCameraSimulator& self, bool statistics) {
+            return read_ring_frame(self, self.frame_size(), true, 0, statistics);
+        }, py::arg("statistics") = false)
+        .def("read_next", [](DeviceCameraSimulator& self, unsigned int timeout_ms, bool statistics) {
+            return read_ring_frame(self, self.frame_size(), false, timeout_ms, statistics);
+        }, py::arg("timeout_ms") = 1000, py::arg("statistics") = false)
+        .def("acquisition_stats", &DeviceCameraSimulator::acquisition_stats)
+        .def("telemetry", &DeviceCameraSimulator::telemetry)
+        .def("set_frame_statistics", &DeviceCameraSimulator::set_frame_statistics,
+             py::arg("enable"), py::arg("options") = FrameStatisticsOptions())
+        .def("frame_statistics", [](const DeviceCameraSimulator& self, py::object frame) {
+            return camera_frame_statistics(self, frame);
+        }, py::arg("frame") = py::none())
+        .def("reset_telemetry", &DeviceCameraSimulator::reset_telemetry)
+        .def("capture_batch", [](DeviceCameraSimulator& self, size_t n, unsigned int timeout_ms, py::object out, py::object preview) {
+            return capture_batch(camera_frame_source(self), self.frame_size(), self.get_pixel_format(), n, timeout_ms, out, preview);
+        }, py::arg("n"), py::arg("timeout_ms") = 1000, py::arg("out") = py::none(), py::arg("preview") = py::none())
+        .def("stream", [](py::object self, unsigned int timeout_ms, size_t max_frames, py::object preview) {
+            DeviceCameraSimulator& camera = self.cast<DeviceCameraSimulator&>();
+            return FrameStream(self, camera_frame_source(camera), camera_streaming(camera), camera.frame_size(), timeout_ms,
+                               max_frames, preview);
+        }, py::arg("timeout_ms") = 1000, py::arg("max_frames") = 0, py::arg("preview") = py::none())
+        .def("read_next_async", [](py::object self, unsigned int timeout_ms, py::object preview) {
+            DeviceCameraSimulator& camera = self.cast<DeviceCameraSimulator&>();
+            return grab_frame_async(self, camera_frame_source(camera), camera.frame_size(), timeout_ms, preview);
+        }, py::arg("timeout_ms") = 1000, py::arg("preview") = py::none())
+        .def("add_frame_sink", &add_frame_sink_py<DeviceCameraSimulator>, py::arg("sink"))
+        .def("remove_frame_sink", &remove_frame_sink_py<DeviceCameraSimulator>, py::arg("sink"))
+        .def("frame_size", &DeviceCameraSimulator::frame_size)
+        .def("generated_frames", &DeviceCameraSimulator::generated_frames)
+        .def("dropped_frames", &DeviceCameraSimulator::dropped_frames)
+        .def("close", &DeviceCameraSimulator::close)
+        .def("get_fps", &DeviceCameraSimulator::get_fps);
+
     // You might need to bind constants or enums from MvCameraControl.h if your Python code needs them
     // Example: m.attr("MV_OK") = py::int_(MV_OK);
 }
\ No newline at end of file
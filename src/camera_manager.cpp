@@ -0,0 +1,206 @@
+// camera_manager.cpp
+
+#include "camera_manager.h"
+#include "sdk_runtime.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+CameraManager::CameraManager() {}
+
+CameraManager::~CameraManager() {
+    close();
+    if (sdk_acquired_) {
+        SdkRuntime::release();
+        sdk_acquired_ = false;
+    }
+}
+
+std::vector<std::string> CameraManager::enumerate(unsigned int layer_types, bool refresh) {
+    if (!sdk_acquired_) {
+        if (!SdkRuntime::acquire()) {
+            return std::vector<std::string>();
+        }
+        sdk_acquired_ = true;
+    }
+    return SdkRuntime::enumerate(layer_types, refresh);
+}
+
+bool CameraManager::open(const std::vector<std::string>& serials, unsigned int layer_types) {
+    close();
+    // 使用缓存的枚举结果；请求的序列号不在缓存中时才重新枚举
+    std::vector<std::string> available = enumerate(layer_types);
+    bool missing = std::any_of(serials.begin(), serials.end(), [&](const std::string& serial) {
+        return std::find(available.begin(), available.end(), serial) == available.end();
+    });
+    if (available.empty() || missing) {
+        available = enumerate(layer_types, true);
+    }
+    if (available.empty()) {
+        std::cerr << "No devices found!" << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> wanted = serials.empty() ? available : serials;
+    for (const std::string& serial : wanted) {
+        auto it = std::find(available.begin(), available.end(), serial);
+        if (it == available.end()) {
+            std::cerr << "Device with serial " << serial << " not found!" << std::endl;
+            close();
+            return false;
+        }
+
+        std::unique_ptr<DeviceCameraSY011> camera(new DeviceCameraSY011());
+        if (!camera->init_serial(serial, layer_types)) {
+            std::cerr << "Failed to open device " << serial << std::endl;
+            close();
+            return false;
+        }
+        cameras_.push_back(std::move(camera));
+    }
+    next_sequence_.assign(cameras_.size(), 0);
+    return true;
+}
+
+DeviceCameraSY011* CameraManager::camera(size_t index) {
+    return index < cameras_.size() ? cameras_[index].get() : nullptr;
+}
+
+std::string CameraManager::serial(size_t index) const {
+    return index < cameras_.size() ? cameras_[index]->serial_number() : std::string();
+}
+
+bool CameraManager::set_cpu_affinity(size_t index, int cpu) {
+    if (index >= cameras_.size()) {
+        return false;
+    }
+    cameras_[index]->set_cpu_affinity(cpu);
+    return true;
+}
+
+bool CameraManager::start(size_t slot_count) {
+    for (size_t i = 0; i < cameras_.size(); ++i) {
+        if (!cameras_[i]->start_acquisition(slot_count)) {
+            std::cerr << "Failed to start acquisition on device " << cameras_[i]->serial_number() << std::endl;
+            stop();
+            return false;
+        }
+        next_sequence_[i] = cameras_[i]->acquisition_cursor();
+    }
+    return true;
+}
+
+void CameraManager::stop() {
+    for (auto& camera : cameras_) {
+        camera->stop_grabbing();
+    }
+}
+
+void CameraManager::close() {
+    for (auto& camera : cameras_) {
+        camera->close();
+    }
+    cameras_.clear();
+    next_sequence_.clear();
+    // SDK引用保留到析构，重新open()无需再次初始化
+}
+
+bool CameraManager::try_align(FrameSet& frame_set, size_t& blocking_camera) {
+    const size_t count = cameras_.size();
+
+    // 参考时间戳：各相机最新一帧中最早的那个（最慢的相机）
+    size_t reference = 0;
+    uint64_t reference_timestamp = UINT64_MAX;
+    for (size_t i = 0; i < count; ++i) {
+        std::shared_ptr<FrameRing> ring = cameras_[i]->frame_ring();
+        uint64_t head = ring ? ring->head() : 0;
+        MV_FRAME_OUT_INFO_EX info;
+        if (head <= next_sequence_[i] || !ring->peek_info(head - 1, info)) {
+            blocking_camera = i;
+            return false;
+        }
+        uint64_t timestamp = FrameRing::frame_timestamp(info, use_host_timestamp_);
+        if (timestamp < reference_timestamp) {
+            reference_timestamp = timestamp;
+            reference = i;
+        }
+    }
+
+    std::vector<uint64_t> sequences(count);
+    std::vector<uint64_t> timestamps(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::shared_ptr<FrameRing> ring = cameras_[i]->frame_ring();
+        if (!ring->find_closest(reference_timestamp, use_host_timestamp_, sequences[i], timestamps[i]) ||
+            sequences[i] < next_sequence_[i]) {
+            blocking_camera = i;
+            return false;
+        }
+        uint64_t distance = timestamps[i] > reference_timestamp ? timestamps[i] - reference_timestamp
+                                                                : reference_timestamp - timestamps[i];
+        if (distance > skew_tolerance_) {
+            // 该相机没有与参考帧对应的帧（可能丢帧），等参考相机的下一帧
+            uint64_t reference_sequence = cameras_[reference]->frame_ring()->head() - 1;
+            if (reference_sequence != last_unmatched_reference_) {
+                last_unmatched_reference_ = reference_sequence;
+                ++unmatched_;
+            }
+            blocking_camera = reference;
+            return false;
+        }
+    }
+
+    frame_set.frames.resize(count);
+    frame_set.reference_timestamp = reference_timestamp;
+    uint64_t min_timestamp = UINT64_MAX;
+    uint64_t max_timestamp = 0;
+    for (size_t i = 0; i < count; ++i) {
+        std::shared_ptr<FrameRing> ring = cameras_[i]->frame_ring();
+        CameraFrame& frame = frame_set.frames[i];
+        if (frame.data.size() < ring->slot_size()) {
+            frame.data.resize(ring->slot_size());
+        }
+        if (!ring->read(sequences[i], frame.data.data(), frame.data.size(), frame.info)) {
+            // 读取期间被覆盖，重新对齐
+            next_sequence_[i] = sequences[i] + 1;
+            blocking_camera = i;
+            return false;
+        }
+        frame.serial = cameras_[i]->serial_number();
+        frame.sequence = sequences[i];
+        frame.timestamp = timestamps[i];
+        min_timestamp = std::min(min_timestamp, timestamps[i]);
+        max_timestamp = std::max(max_timestamp, timestamps[i]);
+    }
+    frame_set.skew = max_timestamp - min_timestamp;
+
+    for (size_t i = 0; i < count; ++i) {
+        next_sequence_[i] = sequences[i] + 1;
+    }
+    return true;
+}
+
+bool CameraManager::grab_frame_set(FrameSet& frame_set, unsigned int timeout_ms) {
+    if (cameras_.empty()) {
+        return false;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true) {
+        size_t blocking_camera = 0;
+        if (try_align(frame_set, blocking_camera)) {
+            return true;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            return false;
+        }
+        std::shared_ptr<FrameRing> ring = cameras_[blocking_camera]->frame_ring();
+        if (!ring) {
+            return false;
+        }
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+        ring->wait_for(std::max(ring->head(), next_sequence_[blocking_camera]), (unsigned int)remaining + 1);
+    }
+}
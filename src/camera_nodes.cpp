@@ -0,0 +1,177 @@
+// camera_nodes.cpp
+
+#include "camera_nodes.h"
+#include <cmath>
+
+// 每个节点的候选名，按优先顺序
+static const char* const kNodeNames[(int)CameraNode::Count][2] = {
+    { "Width", nullptr },
+    { "Height", nullptr },
+    { "OffsetX", nullptr },
+    { "OffsetY", nullptr },
+    { "BinningHorizontal", nullptr },
+    { "BinningVertical", nullptr },
+    { "DecimationHorizontal", nullptr },
+    { "DecimationVertical", nullptr },
+    { "PixelFormat", nullptr },
+    { "PayloadSize", nullptr },
+    { "ExposureTime", "ExposureTimeAbs" },
+    { "Gain", "GainRaw" },
+    { "ResultingFrameRate", "AcquisitionFrameRate" },
+    { "GevSCPSPacketSize", nullptr },
+    { "TriggerMode", nullptr },
+    { "TriggerSource", nullptr },
+    { "TriggerSoftware", nullptr },
+    { "AcquisitionBurstFrameCount", nullptr },
+    { "ImageCompressionMode", nullptr },
+};
+
+void CameraNodeCache::attach(void* handle) {
+    handle_ = handle;
+    for (Entry& entry : entries_) {
+        entry = Entry();
+    }
+    last_error_ = MV_OK;
+}
+
+CameraNodeCache::Entry& CameraNodeCache::resolve(CameraNode node) {
+    Entry& entry = entries_[(int)node];
+    if (entry.type != NodeType::Unresolved || !handle_) {
+        return entry;
+    }
+
+    entry.type = NodeType::Missing;
+    for (const char* name : kNodeNames[(int)node]) {
+        if (!name) {
+            break;
+        }
+        // 只排除未实现的节点；不可用（AM_NA）可能只是当前状态下暂时不可访问
+        MV_XML_AccessMode access = AM_NI;
+        if (MV_XML_GetNodeAccessMode(handle_, name, &access) != MV_OK || access == AM_NI) {
+            continue;
+        }
+        MV_XML_InterfaceType interface_type = IFT_IBase;
+        if (MV_XML_GetNodeInterfaceType(handle_, name, &interface_type) != MV_OK) {
+            continue;
+        }
+        switch (interface_type) {
+            case IFT_IInteger: entry.type = NodeType::Integer; break;
+            case IFT_IFloat: entry.type = NodeType::Float; break;
+            case IFT_IEnumeration: entry.type = NodeType::Enumeration; break;
+            case IFT_IBoolean: entry.type = NodeType::Boolean; break;
+            case IFT_ICommand: entry.type = NodeType::Command; break;
+            default: continue;
+        }
+        entry.name = name;
+        break;
+    }
+    return entry;
+}
+
+bool CameraNodeCache::supported(CameraNode node) {
+    return handle_ && resolve(node).type != NodeType::Missing;
+}
+
+const char* CameraNodeCache::name(CameraNode node) {
+    return resolve(node).name;
+}
+
+const char* CameraNodeCache::label(CameraNode node) {
+    return kNodeNames[(int)node][0];
+}
+
+bool CameraNodeCache::get_int(CameraNode node, MVCC_INTVALUE_EX& value) {
+    Entry& entry = resolve(node);
+    if (entry.type != NodeType::Integer) {
+        last_error_ = MV_E_SUPPORT;
+        return false;
+    }
+    last_error_ = MV_CC_GetIntValueEx(handle_, entry.name, &value);
+    return last_error_ == MV_OK;
+}
+
+bool CameraNodeCache::set_int(CameraNode node, int64_t value) {
+    Entry& entry = resolve(node);
+    if (entry.type != NodeType::Integer) {
+        last_error_ = MV_E_SUPPORT;
+        return false;
+    }
+    last_error_ = MV_CC_SetIntValueEx(handle_, entry.name, value);
+    return last_error_ == MV_OK;
+}
+
+bool CameraNodeCache::get_number(CameraNode node, double& value) {
+    Entry& entry = resolve(node);
+    switch (entry.type) {
+        case NodeType::Integer: {
+            MVCC_INTVALUE_EX stIntValue = {0};
+            last_error_ = MV_CC_GetIntValueEx(handle_, entry.name, &stIntValue);
+            value = (double)stIntValue.nCurValue;
+            break;
+        }
+        case NodeType::Float: {
+            MVCC_FLOATVALUE stFloatValue = {0};
+            last_error_ = MV_CC_GetFloatValue(handle_, entry.name, &stFloatValue);
+            value = stFloatValue.fCurValue;
+            break;
+        }
+        case NodeType::Enumeration: {
+            MVCC_ENUMVALUE stEnumValue = {0};
+            last_error_ = MV_CC_GetEnumValue(handle_, entry.name, &stEnumValue);
+            value = stEnumValue.nCurValue;
+            break;
+        }
+        case NodeType::Boolean: {
+            bool bValue = false;
+            last_error_ = MV_CC_GetBoolValue(handle_, entry.name, &bValue);
+            value = bValue ? 1.0 : 0.0;
+            break;
+        }
+        default:
+            last_error_ = MV_E_SUPPORT;
+            break;
+    }
+    return last_error_ == MV_OK;
+}
+
+bool CameraNodeCache::set_number(CameraNode node, double value) {
+    Entry& entry = resolve(node);
+    switch (entry.type) {
+        case NodeType::Integer:
+            last_error_ = MV_CC_SetIntValueEx(handle_, entry.name, (int64_t)std::llround(value));
+            break;
+        case NodeType::Float:
+            last_error_ = MV_CC_SetFloatValue(handle_, entry.name, (float)value);
+            break;
+        case NodeType::Enumeration:
+            last_error_ = MV_CC_SetEnumValue(handle_, entry.name, (unsigned int)std::llround(value));
+            break;
+        case NodeType::Boolean:
+            last_error_ = MV_CC_SetBoolValue(handle_, entry.name, value != 0.0);
+            break;
+        default:
+            last_error_ = MV_E_SUPPORT;
+            break;
+    }
+    return last_error_ == MV_OK;
+}
+
+bool CameraNodeCache::set_enum_string(CameraNode node, const char* value) {
+    Entry& entry = resolve(node);
+    if (entry.type != NodeType::Enumeration) {
+        last_error_ = MV_E_SUPPORT;
+        return false;
+    }
+    last_error_ = MV_CC_SetEnumValueByString(handle_, entry.name, value);
+    return last_error_ == MV_OK;
+}
+
+bool CameraNodeCache::execute(CameraNode node) {
+    Entry& entry = resolve(node);
+    if (entry.type != NodeType::Command) {
+        last_error_ = MV_E_SUPPORT;
+        return false;
+    }
+    last_error_ = MV_CC_SetCommandValue(handle_, entry.name);
+    return last_error_ == MV_OK;
+}
@@ -0,0 +1,790 @@
+// camera_tests.cpp
+// 不依赖硬件的单元测试，每个组件一组。失败时打印位置并以非0退出，由ctest运行。
+// 用法: camera_tests
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "bounded_queue.h"
+#include "frame_pipeline.h"
+#include "frame_recorder.h"
+#include "frame_ring.h"
+#include "frame_statistics.h"
+#include "hb_decoder.h"
+#include "mono_unpack.h"
+#include "shared_frame_ring.h"
+#include "snapshot_encoder.h"
+#include "undistort.h"
+
+static int g_failures = 0;
+
+#define CHECK(condition)                                                                     \
+    do {                                                                                     \
+        if (!(condition)) {                                                                  \
+            std::printf("  FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition);             \
+            ++g_failures;                                                                    \
+        }                                                                                    \
+    } while (0)
+
+static MV_FRAME_OUT_INFO_EX make_info(unsigned int frame_num, size_t length, uint64_t device_ns = 0) {
+    MV_FRAME_OUT_INFO_EX info;
+    std::memset(&info, 0, sizeof(info));
+    info.nFrameNum = frame_num;
+    info.nFrameLen = (unsigned int)length;
+    info.nDevTimeStampHigh = (unsigned int)(device_ns >> 32);
+    info.nDevTimeStampLow = (unsigned int)(device_ns & 0xffffffffu);
+    info.enPixelType = PixelType_Gvsp_Mono8;
+    return info;
+}
+
+// 帧内容由帧号和长度决定，读出后可以逐字节核对
+static std::vector<unsigned char> make_frame(unsigned int frame_num, size_t length) {
+    std::vector<unsigned char> frame(length);
+    for (size_t i = 0; i < length; ++i) {
+        frame[i] = (unsigned char)(frame_num * 31 + i);
+    }
+    return frame;
+}
+
+// ---- 帧环 ----
+
+static void test_frame_ring() {
+    std::printf("frame ring\n");
+    const size_t slots = 4, frame_size = 1000;
+    FrameRing ring(slots, frame_size);
+    std::vector<unsigned char> buffer(frame_size);
+    MV_FRAME_OUT_INFO_EX info;
+    uint64_t cursor = 0;
+
+    // 空环：读不到帧，等待超时
+    CHECK(!ring.read_latest(buffer.data(), buffer.size(), info));
+    CHECK(!ring.read_next(cursor, buffer.data(), buffer.size(), info, 1));
+
+    // 逐帧读取按序交付，统计随帧返回
+    for (unsigned int n = 0; n < 3; ++n) {
+        std::vector<unsigned char> frame = make_frame(n, frame_size);
+        FrameStatistics stats;
+        stats.valid = true;
+        stats.frame_num = n;
+        stats.mean = n + 0.5;
+        CHECK(ring.publish(frame.data(), make_info(n, frame.size(), 1000 + n), &stats));
+    }
+    for (unsigned int n = 0; n < 3; ++n) {
+        FrameStatistics stats;
+        CHECK(ring.read_next(cursor, buffer.data(), buffer.size(), info, 0, &stats));
+        CHECK(info.nFrameNum == n);
+        CHECK(buffer == make_frame(n, frame_size));
+        CHECK(stats.valid && stats.frame_num == n && stats.mean == n + 0.5);
+    }
+    CHECK(cursor == 3);
+
+    // 超过槽大小的帧被拒绝，不占用序号
+    std::vector<unsigned char> oversized(frame_size + 1);
+    CHECK(!ring.publish(oversized.data(), make_info(99, oversized.size())));
+    CHECK(ring.head() == 3);
+
+    // 落后超过环长度的读者跳到最旧的帧，并计数丢帧
+    for (unsigned int n = 3; n < 10; ++n) {
+        std::vector<unsigned char> frame = make_frame(n, frame_size);
+        CHECK(ring.publish(frame.data(), make_info(n, frame.size(), 1000 + n)));
+    }
+    CHECK(ring.read_next(cursor, buffer.data(), buffer.size(), info, 0));
+    CHECK(info.nFrameNum == 10 - slots);
+    FrameRingStats stats = ring.stats();
+    CHECK(stats.published == 10);
+    CHECK(stats.dropped == 10 - slots - 3);
+    CHECK(stats.rejected == 1);
+
+    uint64_t sequence = 0;
+    CHECK(ring.read_latest(buffer.data(), buffer.size(), info, &sequence));
+    CHECK(info.nFrameNum == 9 && sequence == 9);
+    CHECK(buffer == make_frame(9, frame_size));
+    CHECK(!ring.read(0, buffer.data(), buffer.size(), info));    // 已被覆盖
+    CHECK(!ring.read(9, buffer.data(), 10, info));               // 缓冲区太小
+
+    // 重连后帧号重新计数：按帧号查找得到最新的同号帧，按帧号+时间戳查找得到原来那一帧
+    std::vector<unsigned char> frame = make_frame(8, frame_size);
+    MV_FRAME_OUT_INFO_EX restarted = make_info(8, frame.size(), 50);
+    CHECK(ring.publish(frame.data(), restarted));
+    MV_FRAME_OUT_INFO_EX original = make_info(8, frame_size, 1000 + 8);
+    CHECK(ring.find_frame(8u, sequence) && sequence == 10);
+    CHECK(ring.find_frame(original, sequence) && sequence == 8);
+    CHECK(ring.find_frame(restarted, sequence) && sequence == 10);
+    MV_FRAME_OUT_INFO_EX missing = make_info(8, frame_size, 7);
+    CHECK(!ring.find_frame(missing, sequence));
+
+    // close()唤醒等待中的读者
+    std::thread closer([&ring] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ring.close();
+    });
+    uint64_t tail = ring.head();
+    auto start = std::chrono::steady_clock::now();
+    CHECK(!ring.read_next(tail, buffer.data(), buffer.size(), info, 5000));
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(4));
+    closer.join();
+}
+
+// ---- 录像 ----
+
+static void test_recorder() {
+    std::printf("frame recorder\n");
+    char directory[] = "/tmp/camera_tests_XXXXXX";
+    if (!mkdtemp(directory)) {
+        CHECK(!"mkdtemp failed");
+        return;
+    }
+    const std::string base = std::string(directory) + "/rec";
+    const size_t frame_size = 10000, frame_count = 40, queue_slots = 8;
+
+    {
+        FrameRecorder recorder;
+        // 分块很小，录像跨多个分块文件
+        CHECK(recorder.start(base, frame_size, queue_slots, 64 * 1024));
+        for (unsigned int n = 0; n < frame_count; ++n) {
+            // 队列满时submit()丢帧，测试中等写线程腾出槽
+            while (recorder.queue_depth() + 1 >= queue_slots) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            size_t length = frame_size - n;     // 长度各不相同
+            std::vector<unsigned char> frame = make_frame(n, length);
+            CHECK(recorder.submit(frame.data(), make_info(n, length, 1000 + n)));
+        }
+        recorder.stop();
+        RecorderStats stats = recorder.stats();
+        CHECK(stats.written == frame_count);
+        CHECK(stats.dropped == 0 && stats.failed == 0);
+        CHECK(stats.chunks > 1);
+    }
+
+    RawRecording recording;
+    CHECK(recording.open(base));
+    CHECK(recording.frame_count() == frame_count);
+    for (size_t n = 0; n < recording.frame_count(); ++n) {
+        size_t length = 0;
+        MV_FRAME_OUT_INFO_EX info;
+        const unsigned char* data = recording.frame(n, length, info);
+        CHECK(data != nullptr);
+        CHECK(info.nFrameNum == n && length == frame_size - n);
+        if (data && length == frame_size - n) {
+            std::vector<unsigned char> expected = make_frame((unsigned int)n, length);
+            CHECK(std::memcmp(data, expected.data(), length) == 0);
+        }
+    }
+    recording.close();
+
+    for (uint32_t chunk = 0;; ++chunk) {
+        if (unlink(FrameRecorder::chunk_path(base, chunk).c_str()) != 0) {
+            break;
+        }
+    }
+    rmdir(directory);
+}
+
+// ---- 快照 ----
+
+static void test_snapshot_burst() {
+    std::printf("snapshot burst\n");
+    char directory[] = "/tmp/camera_tests_XXXXXX";
+    if (!mkdtemp(directory)) {
+        CHECK(!"mkdtemp failed");
+        return;
+    }
+    const std::string prefix = std::string(directory) + "/shot";
+    const size_t frame_size = 5000, burst = 5;
+    std::vector<std::string> paths;
+    {
+        SnapshotEncoder encoder(2, 8);
+        // 空帧直接返回无效的future，不占用队列
+        CHECK(!encoder.submit(nullptr, make_info(0, frame_size), prefix).valid());
+
+        // 连拍只保存arm_burst()之后到达的连续count帧
+        std::vector<unsigned char> frame = make_frame(100, frame_size);
+        encoder.on_frame(frame.data(), make_info(100, frame_size));
+        std::future<std::vector<SnapshotResult>> future = encoder.arm_burst(burst, prefix, SnapshotFormat::RAW);
+        for (unsigned int n = 0; n < burst + 3; ++n) {
+            frame = make_frame(n, frame_size);
+            encoder.on_frame(frame.data(), make_info(n, frame_size));
+        }
+        CHECK(future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        std::vector<SnapshotResult> results = future.get();
+        CHECK(results.size() == burst);
+        for (size_t n = 0; n < results.size(); ++n) {
+            CHECK(results[n].ok);
+            CHECK(results[n].path == prefix + "_" + std::to_string(n) + ".raw");
+            std::vector<unsigned char> saved(frame_size + 1);
+            FILE* file = std::fopen(results[n].path.c_str(), "rb");
+            saved.resize(file ? std::fread(saved.data(), 1, saved.size(), file) : 0);
+            if (file) {
+                std::fclose(file);
+            }
+            CHECK(saved == make_frame((unsigned int)n, frame_size));
+            paths.push_back(results[n].path);
+        }
+
+        // Mono12_Packed保存为16位PNG，保留原始数值
+        const int width = 64, height = 4;
+        std::vector<uint16_t> pixels(width * height);
+        for (size_t i = 0; i < pixels.size(); ++i) {
+            pixels[i] = (uint16_t)(i * 17 % 4096);
+        }
+        std::vector<unsigned char> packed(MonoUnpacker::frame_bytes(PixelType_Gvsp_Mono12_Packed, pixels.size()));
+        CHECK(MonoUnpacker::pack(pixels.data(), pixels.size(), PixelType_Gvsp_Mono12_Packed, packed.data()));
+        MV_FRAME_OUT_INFO_EX info = make_info(7, packed.size());
+        info.nWidth = width;
+        info.nHeight = height;
+        info.enPixelType = PixelType_Gvsp_Mono12_Packed;
+        std::future<SnapshotResult> mono = encoder.submit(packed.data(), info, prefix + "_mono12");
+        CHECK(mono.valid());
+        if (mono.valid()) {
+            SnapshotResult result = mono.get();
+            CHECK(result.ok);
+            cv::Mat image = cv::imread(result.path, cv::IMREAD_UNCHANGED);
+            CHECK(image.type() == CV_16UC1 && image.cols == width && image.rows == height);
+            if (image.type() == CV_16UC1 && image.total() == pixels.size()) {
+                CHECK(std::equal(pixels.begin(), pixels.end(), image.ptr<uint16_t>()));
+            }
+            paths.push_back(result.path);
+        }
+
+        SnapshotStats stats = encoder.stats();
+        CHECK(stats.submitted == burst + 1 && stats.completed == burst + 1);
+        CHECK(stats.failed == 0 && stats.rejected == 0);
+    }
+
+    for (const std::string& path : paths) {
+        unlink(path.c_str());
+    }
+    rmdir(directory);
+}
+
+// ---- 无锁队列与流水线 ----
+
+static void test_bounded_queue() {
+    std::printf("bounded queue\n");
+    BoundedQueue<int> queue(5);
+    CHECK(queue.capacity() == 8);
+    for (int i = 0; i < 8; ++i) {
+        CHECK(queue.push(i));
+    }
+    CHECK(!queue.push(8));      // 满时立即失败
+    int value = -1;
+    for (int i = 0; i < 8; ++i) {
+        CHECK(queue.pop(value) && value == i);
+    }
+    CHECK(!queue.pop(value) && queue.empty());
+
+    // 多生产者多消费者：每个值恰好被取出一次
+    const int producers = 4, consumers = 4, per_producer = 20000;
+    BoundedQueue<int> shared(64);
+    std::vector<std::atomic<int>> seen(producers * per_producer);
+    for (std::atomic<int>& count : seen) {
+        count.store(0);
+    }
+    std::atomic<int> popped{0};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&shared, p] {
+            for (int i = 0; i < per_producer; ++i) {
+                while (!shared.push(p * per_producer + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            int item = 0;
+            while (popped.load() < producers * per_producer) {
+                if (shared.pop(item)) {
+                    seen[item].fetch_add(1);
+                    popped.fetch_add(1);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    CHECK(std::all_of(seen.begin(), seen.end(), [](const std::atomic<int>& count) { return count.load() == 1; }));
+    CHECK(shared.empty());
+}
+
+static void test_frame_pipeline() {
+    std::printf("frame pipeline\n");
+    const int width = 16, height = 8;
+    const unsigned int frames = 300;
+    // 每个阶段同一时刻只在一个线程上运行，记录无需加锁
+    std::vector<uint64_t> first_order, second_order;
+    FramePipeline pipeline(3, 4);
+    CHECK(pipeline.add_callback("first", [&first_order](PipelineFrame& frame) {
+        first_order.push_back(frame.sequence);
+    }));
+    CHECK(pipeline.add_callback("second", [&second_order](PipelineFrame& frame) {
+        second_order.push_back(frame.sequence);
+        frame.image.at<unsigned char>(0, 0) += 1;
+    }));
+    CHECK(pipeline.start());
+    CHECK(!pipeline.add_callback("late", [](PipelineFrame&) {}));   // start()之后不能再加阶段
+
+    std::vector<uint64_t> outputs;
+    bool content_ok = true;
+    std::atomic<bool> producing{true};
+    std::thread reader([&] {
+        while (true) {
+            PipelineOutput output = pipeline.read(50);
+            if (!output.valid()) {
+                if (!producing.load()) {
+                    break;
+                }
+                continue;
+            }
+            outputs.push_back(output.sequence());
+            // 原始帧经解码阶段成为Mono8图像，第二个阶段把首个像素加1
+            unsigned int frame_num = output.info().nFrameNum;
+            const cv::Mat& image = output.image();
+            content_ok = content_ok && image.cols == width && image.rows == height && image.channels() == 1 &&
+                         image.at<unsigned char>(0, 0) == (unsigned char)(make_frame(frame_num, 1)[0] + 1);
+        }
+    });
+    for (unsigned int n = 0; n < frames; ++n) {
+        std::vector<unsigned char> frame = make_frame(n, width * height);
+        MV_FRAME_OUT_INFO_EX info = make_info(n, frame.size());
+        info.nWidth = width;
+        info.nHeight = height;
+        pipeline.on_frame(frame.data(), info);
+        if (n % 8 == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+    // 等流水线排空后再停止读取
+    for (int i = 0; i < 200; ++i) {
+        PipelineStats stats = pipeline.stats();
+        if (stats.completed + stats.failed + stats.dropped_stage == stats.submitted) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    producing = false;
+    reader.join();
+    pipeline.stop();
+
+    // 每一帧要么在入口被丢弃，要么进入流水线；进入的帧要么交付，要么在输出队列满时被顶替
+    PipelineStats stats = pipeline.stats();
+    CHECK(stats.submitted + stats.dropped_input == frames);
+    CHECK(stats.failed == 0);
+    CHECK(stats.completed == outputs.size() + stats.dropped_output);
+    CHECK(!outputs.empty());
+    CHECK(content_ok);
+    CHECK(std::is_sorted(outputs.begin(), outputs.end()));
+    CHECK(std::adjacent_find(outputs.begin(), outputs.end()) == outputs.end());
+    CHECK(std::is_sorted(first_order.begin(), first_order.end()));
+    CHECK(std::is_sorted(second_order.begin(), second_order.end()));
+    CHECK(second_order.size() == stats.completed);
+    CHECK(first_order.size() >= second_order.size());
+}
+
+// ---- 点去畸变 ----
+
+static void test_undistort_points() {
+    std::printf("undistort points\n");
+    char directory[] = "/tmp/camera_tests_XXXXXX";
+    if (!mkdtemp(directory)) {
+        CHECK(!"mkdtemp failed");
+        return;
+    }
+    const std::string path = std::string(directory) + "/calibration.yaml";
+    FILE* file = std::fopen(path.c_str(), "w");
+    CHECK(file != nullptr);
+    if (!file) {
+        rmdir(directory);
+        return;
+    }
+    std::fputs("%YAML:1.0\n---\n"
+               "camera_matrix: !!opencv-matrix\n   rows: 3\n   cols: 3\n   dt: d\n"
+               "   data: [ 800., 0., 320., 0., 800., 240., 0., 0., 1. ]\n"
+               "distortion_coefficients: !!opencv-matrix\n   rows: 1\n   cols: 5\n   dt: d\n"
+               "   data: [ -0.2, 0.05, 0.001, -0.001, 0. ]\n", file);
+    std::fclose(file);
+
+    ImageUndistorter undistorter(path);
+    unlink(path.c_str());
+    rmdir(directory);
+    CHECK(undistorter.is_loaded());
+    if (!undistorter.is_loaded()) {
+        return;
+    }
+
+    // 640x480图像上每隔10像素一个点，包括图像边界
+    const cv::Size size(640, 480);
+    std::vector<float> points;
+    for (int y = 0; y <= size.height; y += 10) {
+        for (int x = 0; x <= size.width; x += 10) {
+            points.push_back((float)x);
+            points.push_back((float)y);
+        }
+    }
+    const size_t count = points.size() / 2;
+    auto max_diff = [](const std::vector<float>& a, const std::vector<float>& b) {
+        float diff = 0.0f;
+        for (size_t i = 0; i < a.size(); ++i) {
+            diff = std::max(diff, std::fabs(a[i] - b[i]));
+        }
+        return diff;
+    };
+
+    // 去畸变后再畸变回到原坐标
+    std::vector<float> undistorted(points.size()), restored(points.size());
+    CHECK(undistorter.undistort_points(points.data(), undistorted.data(), count, cv::Size(), -1.0, 20));
+    CHECK(undistorter.distort_points(undistorted.data(), restored.data(), count));
+    CHECK(max_diff(points, restored) < 0.01f);
+
+    // 主点不动，边角的点被径向畸变明显移动
+    float principal[2] = { 320.0f, 240.0f };
+    CHECK(undistorter.undistort_points(principal, principal, 1));
+    CHECK(std::fabs(principal[0] - 320.0f) < 1e-3f && std::fabs(principal[1] - 240.0f) < 1e-3f);
+    CHECK(std::fabs(undistorted[0] - points[0]) > 1.0f);
+
+    // 原地处理与分开的输出一致
+    std::vector<float> in_place = points;
+    CHECK(undistorter.undistort_points(in_place.data(), in_place.data(), count, cv::Size(), -1.0, 20));
+    CHECK(in_place == undistorted);
+
+    // 查找表的双线性插值与逐点求解相差远小于一个像素，图像外的点也能外推
+    std::vector<float> approximated(points.size());
+    CHECK(undistorter.undistort_points_lut(points.data(), approximated.data(), count, size, -1.0, 8));
+    CHECK(max_diff(undistorted, approximated) < 0.05f);
+    float outside[2] = { -4.0f, 484.0f }, outside_exact[2];
+    CHECK(undistorter.undistort_points(outside, outside_exact, 1, cv::Size(), -1.0, 20));
+    CHECK(undistorter.undistort_points_lut(outside, outside, 1, size));
+    CHECK(std::fabs(outside[0] - outside_exact[0]) < 0.1f && std::fabs(outside[1] - outside_exact[1]) < 0.1f);
+    CHECK(!undistorter.undistort_points_lut(points.data(), approximated.data(), count, cv::Size()));
+}
+
+// ---- 跨进程帧环 ----
+
+// 发布者和订阅者在同一进程内，通过同一块共享内存交换帧
+static void test_shared_frame_ring() {
+    std::printf("shared frame ring\n");
+#if !defined(__linux__)
+    std::printf("  skipped: POSIX shared memory ring is Linux-only\n");
+#else
+    const std::string name = "/camera_tests_" + std::to_string(getpid());
+    const size_t slots = 4, frame_size = 3000;
+    SharedFrameSubscriber subscriber;
+    CHECK(!subscriber.open(name));      // 发布者尚未创建
+
+    SharedFramePublisher publisher;
+    CHECK(publisher.open(name, slots, frame_size));
+    CHECK(subscriber.open(name));
+    CHECK(subscriber.slot_count() == slots && subscriber.slot_size() >= frame_size);
+    CHECK(!subscriber.publisher_closed());
+
+    // 逐帧读取零拷贝视图，拷贝结果经过校验
+    SharedFrameView view;
+    std::vector<unsigned char> buffer(frame_size);
+    for (unsigned int n = 0; n < 3; ++n) {
+        std::vector<unsigned char> frame = make_frame(n, frame_size - n);
+        CHECK(publisher.publish(frame.data(), make_info(n, frame.size())));
+    }
+    for (unsigned int n = 0; n < 3; ++n) {
+        CHECK(subscriber.read_next(view, 0));
+        CHECK(view.info.nFrameNum == n && view.length == frame_size - n);
+        CHECK(view.length == frame_size - n &&
+              std::memcmp(view.data, make_frame(n, view.length).data(), view.length) == 0);
+        CHECK(subscriber.still_valid(view.sequence));
+        CHECK(subscriber.copy(view, buffer.data(), buffer.size()));
+    }
+    CHECK(!subscriber.read_next(view, 1));
+
+    // 超过槽大小的帧被拒绝
+    std::vector<unsigned char> oversized(frame_size + 1);
+    CHECK(!publisher.publish(oversized.data(), make_info(99, oversized.size())));
+    CHECK(publisher.stats().rejected == 1 && publisher.stats().published == 3);
+
+    // 落后的订阅者跳到最旧的帧并计数丢帧，被覆盖的视图不再有效
+    uint64_t old_sequence = view.sequence;
+    for (unsigned int n = 3; n < 10; ++n) {
+        std::vector<unsigned char> frame = make_frame(n, frame_size);
+        CHECK(publisher.publish(frame.data(), make_info(n, frame.size())));
+    }
+    CHECK(!subscriber.still_valid(old_sequence));
+    CHECK(subscriber.read_next(view, 0));
+    CHECK(view.info.nFrameNum == 10 - slots);
+    CHECK(subscriber.dropped() == 10 - slots - 3);
+    CHECK(subscriber.read_latest(view) && view.info.nFrameNum == 9);
+    CHECK(subscriber.cursor() == subscriber.head());
+
+    // 等待中的订阅者被新帧唤醒
+    std::thread writer([&publisher, frame_size] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::vector<unsigned char> frame = make_frame(10, frame_size);
+        publisher.publish(frame.data(), make_info(10, frame.size()));
+    });
+    CHECK(subscriber.read_next(view, 5000) && view.info.nFrameNum == 10);
+    writer.join();
+
+    // 发布者关闭后订阅者能发现，并且不再读到帧
+    publisher.close();
+    CHECK(subscriber.publisher_closed());
+    CHECK(!subscriber.read_next(view, 1));
+    subscriber.close();
+#endif
+}
+
+// ---- 单色解包 ----
+
+// 按相机文档的格式逐像素解包，作为SIMD内核的参考
+static void unpack_reference(const unsigned char* src, MvGvspPixelType pixel_type, size_t count, uint16_t* dst, int shift) {
+    const int bits = MonoUnpacker::bit_depth(pixel_type);
+    for (size_t i = 0; i < count; ++i) {
+        unsigned int value;
+        if (pixel_type == PixelType_Gvsp_Mono8) {
+            value = src[i];
+        } else if (MonoUnpacker::is_packed(pixel_type)) {
+            const unsigned char* group = src + i / 2 * 3;
+            const unsigned int low_mask = (1u << (bits - 8)) - 1;
+            value = (i % 2 == 0) ? ((unsigned int)group[0] << (bits - 8)) | (group[1] & low_mask)
+                                 : ((unsigned int)group[2] << (bits - 8)) | ((group[1] >> 4) & low_mask);
+        } else {
+            value = ((unsigned int)src[2 * i] | ((unsigned int)src[2 * i + 1] << 8)) & ((1u << bits) - 1);
+        }
+        dst[i] = (uint16_t)(value << shift);
+    }
+}
+
+static void test_mono_unpack() {
+    std::printf("mono unpack (kernel %s)\n", MonoUnpacker::kernel_name());
+    const MvGvspPixelType types[] = { PixelType_Gvsp_Mono8, PixelType_Gvsp_Mono10, PixelType_Gvsp_Mono12,
+                                      PixelType_Gvsp_Mono10_Packed, PixelType_Gvsp_Mono12_Packed };
+    // 覆盖各内核的整块、尾部和奇数像素数
+    const size_t counts[] = { 1, 2, 3, 7, 8, 15, 16, 17, 31, 33, 63, 65, 1001, 1440 * 3 + 1 };
+    std::mt19937 rng(7);
+    for (MvGvspPixelType type : types) {
+        const int bits = MonoUnpacker::bit_depth(type);
+        for (size_t count : counts) {
+            std::vector<unsigned char> src(MonoUnpacker::frame_bytes(type, count));
+            for (unsigned char& byte : src) {
+                byte = (unsigned char)rng();
+            }
+            for (int shift : { 0, 16 - bits }) {
+                std::vector<uint16_t> expected(count), actual(count, 0xBEEF);
+                unpack_reference(src.data(), type, count, expected.data(), shift);
+                CHECK(MonoUnpacker::unpack(src.data(), src.size(), type, count, actual.data(), shift));
+                CHECK(actual == expected);
+            }
+
+            // pack是unpack的逆
+            std::vector<uint16_t> values(count);
+            for (uint16_t& value : values) {
+                value = (uint16_t)(rng() & ((1u << bits) - 1));
+            }
+            std::vector<unsigned char> packed(MonoUnpacker::frame_bytes(type, count));
+            std::vector<uint16_t> round_trip(count);
+            CHECK(MonoUnpacker::pack(values.data(), count, type, packed.data()));
+            CHECK(MonoUnpacker::unpack(packed.data(), packed.size(), type, count, round_trip.data()));
+            CHECK(round_trip == values);
+        }
+    }
+
+    // 16位格式原地解包
+    std::vector<uint16_t> values(1001);
+    for (uint16_t& value : values) {
+        value = (uint16_t)rng();
+    }
+    std::vector<uint16_t> in_place = values;
+    std::vector<uint16_t> expected(values.size());
+    unpack_reference(reinterpret_cast<const unsigned char*>(values.data()), PixelType_Gvsp_Mono12, values.size(),
+                     expected.data(), 4);
+    CHECK(MonoUnpacker::unpack(reinterpret_cast<const unsigned char*>(in_place.data()), in_place.size() * 2,
+                               PixelType_Gvsp_Mono12, in_place.size(), in_place.data(), 4));
+    CHECK(in_place == expected);
+}
+
+// ---- 帧统计 ----
+
+struct ReferenceStatistics {
+    uint64_t samples = 0;
+    double mean = 0.0;
+    int min = 255;
+    int max = 0;
+    uint64_t saturated = 0;
+    double laplacian_variance = 0.0;
+    double tenengrad = 0.0;
+    std::vector<uint32_t> histogram = std::vector<uint32_t>(256, 0);
+};
+
+// Mono8的逐点参考实现：边缘处相邻像素取边缘值
+static ReferenceStatistics statistics_reference(const std::vector<unsigned char>& image, int width, int height,
+                                                const FrameStatisticsOptions& options) {
+    auto at = [&](int x, int y) {
+        x = std::min(std::max(x, 0), width - 1);
+        y = std::min(std::max(y, 0), height - 1);
+        return (int)image[(size_t)y * width + x];
+    };
+    const int x1 = options.roi_width > 0 ? std::min(width, options.roi_x + options.roi_width) : width;
+    const int y1 = options.roi_height > 0 ? std::min(height, options.roi_y + options.roi_height) : height;
+    ReferenceStatistics ref;
+    uint64_t sum = 0;
+    int64_t lap_sum = 0;
+    uint64_t lap_squares = 0, gradient_squares = 0;
+    for (int y = options.roi_y; y < y1; y += options.step) {
+        for (int x = options.roi_x; x < x1; x += options.step) {
+            int c = at(x, y);
+            ++ref.samples;
+            sum += c;
+            ref.min = std::min(ref.min, c);
+            ref.max = std::max(ref.max, c);
+            ref.saturated += c >= options.saturation_level ? 1 : 0;
+            ++ref.histogram[c];
+            int lap = 4 * c - at(x - 1, y) - at(x + 1, y) - at(x, y - 1) - at(x, y + 1);
+            lap_sum += lap;
+            lap_squares += (uint64_t)(lap * lap);
+            int gx = (at(x + 1, y - 1) + 2 * at(x + 1, y) + at(x + 1, y + 1)) - (at(x - 1, y - 1) + 2 * at(x - 1, y) + at(x - 1, y + 1));
+            int gy = (at(x - 1, y + 1) + 2 * at(x, y + 1) + at(x + 1, y + 1)) - (at(x - 1, y - 1) + 2 * at(x, y - 1) + at(x + 1, y - 1));
+            gradient_squares += (uint64_t)(gx * gx + gy * gy);
+        }
+    }
+    ref.mean = (double)sum / ref.samples;
+    double lap_mean = (double)lap_sum / ref.samples;
+    ref.laplacian_variance = std::max((double)lap_squares / ref.samples - lap_mean * lap_mean, 0.0);
+    ref.tenengrad = (double)gradient_squares / ref.samples;
+    return ref;
+}
+
+static bool close_to(double a, double b) {
+    return std::fabs(a - b) <= 1e-6 * std::max(1.0, std::fabs(b));
+}
+
+static void test_frame_statistics() {
+    std::printf("frame statistics (kernel %s)\n", FrameStatisticsCalculator::kernel_name());
+    const int width = 203, height = 61;     // 宽度不是SIMD块长的整数倍
+    std::mt19937 rng(11);
+    std::vector<unsigned char> mono8((size_t)width * height);
+    for (unsigned char& p : mono8) {
+        p = (unsigned char)rng();
+    }
+
+    FrameStatisticsOptions variants[4];
+    variants[1].step = 3;
+    variants[2].step = 1;
+    variants[2].roi_x = 17;
+    variants[2].roi_y = 5;
+    variants[2].roi_width = 101;
+    variants[2].roi_height = 33;
+    variants[3].step = 1;
+    variants[3].saturation_level = 200;
+    for (FrameStatisticsOptions options : variants) {
+        for (FocusMeasure focus : { FocusMeasure::LaplacianVariance, FocusMeasure::Tenengrad }) {
+            options.focus = focus;
+            FrameStatisticsCalculator calculator(options);
+            FrameStatistics stats;
+            ReferenceStatistics ref = statistics_reference(mono8, width, height, calculator.options());
+            CHECK(calculator.compute(mono8.data(), width, height, 0, PixelType_Gvsp_Mono8, stats));
+            CHECK(stats.samples == ref.samples);
+            CHECK(close_to(stats.mean, ref.mean));
+            CHECK(stats.min == ref.min);
+            CHECK(stats.max == ref.max);
+            CHECK(stats.saturated == ref.saturated);
+            CHECK(std::equal(ref.histogram.begin(), ref.histogram.end(), stats.histogram));
+            CHECK(close_to(stats.focus, focus == FocusMeasure::Tenengrad ? ref.tenengrad : ref.laplacian_variance));
+        }
+    }
+
+    // Mono12（16位与Packed）取高8位，结果与对应的Mono8一致
+    std::vector<uint16_t> mono12(mono8.size());
+    for (size_t i = 0; i < mono8.size(); ++i) {
+        mono12[i] = (uint16_t)((mono8[i] << 4) | (rng() & 0xF));
+    }
+    std::vector<unsigned char> packed(MonoUnpacker::frame_bytes(PixelType_Gvsp_Mono12_Packed, mono12.size()));
+    CHECK(MonoUnpacker::pack(mono12.data(), mono12.size(), PixelType_Gvsp_Mono12_Packed, packed.data()));
+    FrameStatisticsOptions options;
+    options.step = 1;
+    FrameStatisticsCalculator calculator(options);
+    FrameStatistics from8, from16, from_packed;
+    CHECK(calculator.compute(mono8.data(), width, height, 0, PixelType_Gvsp_Mono8, from8));
+    CHECK(calculator.compute(reinterpret_cast<const unsigned char*>(mono12.data()), width, height, 0,
+                             PixelType_Gvsp_Mono12, from16));
+    CHECK(calculator.compute(packed.data(), width, height, 0, PixelType_Gvsp_Mono12_Packed, from_packed));
+    CHECK(close_to(from16.mean, from8.mean) && close_to(from16.focus, from8.focus));
+    CHECK(close_to(from_packed.mean, from8.mean) && close_to(from_packed.focus, from8.focus));
+    CHECK(from8.percentile(0.5) == from16.percentile(0.5));
+}
+
+// ---- HB解码池 ----
+
+// 非HB格式的帧不调用MV_CC_HB_Decode，原样经过解码池，用来检查多线程下的按序交付
+static void test_hb_decoder_order() {
+    std::printf("hb decoder ordering\n");
+    const size_t frame_size = 4096;
+    std::mutex delivered_mutex;
+    std::vector<unsigned int> delivered;
+    bool data_ok = true;
+    HbDecoder decoder(nullptr, 4, 8, frame_size, frame_size,
+        [&](const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo) {
+            std::lock_guard<std::mutex> lock(delivered_mutex);
+            delivered.push_back(frameInfo.nFrameNum);
+            data_ok = data_ok && make_frame(frameInfo.nFrameNum, frameInfo.nFrameLen) ==
+                                 std::vector<unsigned char>(pData, pData + frameInfo.nFrameLen);
+        });
+
+    // 第二轮检查stop()/start()之后序号重新开始，交付不会等待上一轮的帧
+    for (int run = 0; run < 2; ++run) {
+        delivered.clear();
+        decoder.reset_stats();
+        CHECK(decoder.start());
+        const unsigned int frames = 500;
+        for (unsigned int n = 0; n < frames; ++n) {
+            std::vector<unsigned char> frame = make_frame(n, frame_size - n % 7);
+            decoder.submit(frame.data(), make_info(n, frame.size()));
+            if (n % 16 == 0) {
+                std::this_thread::yield();
+            }
+        }
+        decoder.stop();
+
+        // 解码池满时在入口丢帧；入池的帧在stop()之前全部按提交顺序交付
+        HbDecodeStats stats = decoder.stats();
+        std::lock_guard<std::mutex> lock(delivered_mutex);
+        CHECK(stats.received + stats.dropped == frames);
+        CHECK(delivered.size() == stats.received);
+        CHECK(stats.passthrough == stats.received);
+        CHECK(!delivered.empty());
+        CHECK(std::is_sorted(delivered.begin(), delivered.end()));
+        CHECK(std::adjacent_find(delivered.begin(), delivered.end()) == delivered.end());
+        CHECK(data_ok);
+        CHECK(stats.serialized_decode == HbDecoder::serialized_decode());
+    }
+}
+
+int main() {
+    test_frame_ring();
+    test_recorder();
+    test_snapshot_burst();
+    test_bounded_queue();
+    test_frame_pipeline();
+    test_undistort_points();
+    test_shared_frame_ring();
+    test_mono_unpack();
+    test_frame_statistics();
+    test_hb_decoder_order();
+    if (g_failures > 0) {
+        std::printf("%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("all tests passed\n");
+    return 0;
+}
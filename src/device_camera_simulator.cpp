@@ -0,0 +1,402 @@
+// device_camera_simulator.cpp
+
+#include "device_camera_simulator.h"
+#include "bayer_pipeline.h"
+#include "mono_unpack.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// 预生成的合成帧数量，循环输出
+static const int kSyntheticFrameCount = 8;
+
+DeviceCameraSimulator::DeviceCameraSimulator() : DeviceCamera() {}
+
+DeviceCameraSimulator::~DeviceCameraSimulator() {
+    close();
+}
+
+bool DeviceCameraSimulator::init() {
+    initialized_ = true;
+    return true;
+}
+
+bool DeviceCameraSimulator::set_resolution(int width, int height) {
+    if (grabbing_ || width <= 0 || height <= 0) {
+        std::cerr << "Failed to set simulator resolution!" << std::endl;
+        return false;
+    }
+    width_ = width;
+    height_ = height;
+    frames_.clear();
+    return true;
+}
+
+bool DeviceCameraSimulator::set_pixel_format(unsigned int pixel_format) {
+    switch (pixel_format) {
+        case PixelType_Gvsp_BGR8_Packed:
+        case PixelType_Gvsp_RGB8_Packed:
+        case PixelType_Gvsp_Mono8:
+        case PixelType_Gvsp_BayerGR8:
+        case PixelType_Gvsp_BayerRG8:
+        case PixelType_Gvsp_BayerGB8:
+        case PixelType_Gvsp_BayerBG8:
+        case PixelType_Gvsp_Mono10:
+        case PixelType_Gvsp_Mono10_Packed:
+        case PixelType_Gvsp_Mono12:
+        case PixelType_Gvsp_Mono12_Packed:
+            break;
+        default:
+            std::cerr << "Simulator does not support PixelFormat [0x" << std::hex << pixel_format << "]" << std::dec << std::endl;
+            return false;
+    }
+    if (grabbing_) {
+        return false;
+    }
+    pixel_format_ = pixel_format;
+    frames_.clear();
+    return true;
+}
+
+bool DeviceCameraSimulator::set_exposure_time(int exposure_time) {
+    exposure_time_ = (float)exposure_time;
+    return true;
+}
+
+void DeviceCameraSimulator::set_frame_rate(double fps) {
+    frame_rate_ = fps < 0 ? 0 : fps;
+}
+
+void DeviceCameraSimulator::set_drop_probability(double probability) {
+    drop_probability_ = probability;
+}
+
+void DeviceCameraSimulator::set_lost_packet_probability(double probability) {
+    lost_packet_probability_ = probability;
+}
+
+void DeviceCameraSimulator::set_jitter(double jitter_us) {
+    jitter_us_ = jitter_us < 0 ? 0 : jitter_us;
+}
+
+void DeviceCameraSimulator::set_seed(unsigned int seed) {
+    seed_ = seed;
+}
+
+bool DeviceCameraSimulator::load_replay(const std::vector<std::string>& image_paths) {
+    if (grabbing_) {
+        return false;
+    }
+    replay_paths_ = image_paths;
+    frames_.clear();
+    build_frames();
+    return !frames_.empty();
+}
+
+void DeviceCameraSimulator::clear_replay() {
+    replay_paths_.clear();
+    frames_.clear();
+}
+
+size_t DeviceCameraSimulator::frame_size() const {
+    if (MonoUnpacker::bit_depth((MvGvspPixelType)pixel_format_) > 8) {
+        return MonoUnpacker::frame_bytes((MvGvspPixelType)pixel_format_, (size_t)width_ * height_);
+    }
+    size_t bytes_per_pixel = 1;
+    if (pixel_format_ == PixelType_Gvsp_BGR8_Packed || pixel_format_ == PixelType_Gvsp_RGB8_Packed) {
+        bytes_per_pixel = 3;
+    }
+    return (size_t)width_ * height_ * bytes_per_pixel;
+}
+
+void DeviceCameraSimulator::build_frames() {
+    std::vector<cv::Mat> sources;
+    for (const std::string& path : replay_paths_) {
+        cv::Mat image = cv::imread(path);
+        if (image.empty()) {
+            std::cerr << "Failed to load replay frame: " << path << std::endl;
+            continue;
+        }
+        if (image.cols != width_ || image.rows != height_) {
+            cv::resize(image, image, cv::Size(width_, height_));
+        }
+        sources.push_back(image);
+    }
+
+    if (sources.empty()) {
+        // 合成帧：缓慢移动的彩色渐变和一个亮方块，便于肉眼和去畸变/去马赛克检查
+        for (int k = 0; k < kSyntheticFrameCount; ++k) {
+            cv::Mat image(height_, width_, CV_8UC3);
+            int shift = k * 16;
+            for (int y = 0; y < height_; ++y) {
+                unsigned char* row = image.ptr<unsigned char>(y);
+                for (int x = 0; x < width_; ++x) {
+                    row[x * 3 + 0] = (unsigned char)((x + shift) * 255 / std::max(width_ - 1, 1));
+                    row[x * 3 + 1] = (unsigned char)(y * 255 / std::max(height_ - 1, 1));
+                    row[x * 3 + 2] = (unsigned char)(((x + y) / 8 + k) & 0xff);
+                }
+            }
+            int size = std::max(std::min(width_, height_) / 8, 4);
+            int left = (k * width_ / kSyntheticFrameCount) % std::max(width_ - size, 1);
+            cv::rectangle(image, cv::Rect(left, (height_ - size) / 2, size, size), cv::Scalar(255, 255, 255), -1);
+            sources.push_back(image);
+        }
+    }
+
+    frames_.clear();
+    for (const cv::Mat& bgr : sources) {
+        cv::Mat converted;
+        if (pixel_format_ == PixelType_Gvsp_BGR8_Packed) {
+            converted = bgr;
+        } else if (pixel_format_ == PixelType_Gvsp_RGB8_Packed) {
+            cv::cvtColor(bgr, converted, cv::COLOR_BGR2RGB);
+        } else if (pixel_format_ == PixelType_Gvsp_Mono8) {
+            cv::cvtColor(bgr, converted, cv::COLOR_BGR2GRAY);
+        } else if (MonoUnpacker::is_supported((MvGvspPixelType)pixel_format_)) {
+            // 10/12位：灰度放到高位，低位填入随位置变化的值，使Packed格式共享字节中的低位也有内容
+            int bits = MonoUnpacker::bit_depth((MvGvspPixelType)pixel_format_);
+            cv::Mat gray;
+            cv::cvtColor(bgr, gray, cv::COLOR_BGR2GRAY);
+            std::vector<uint16_t> values((size_t)width_ * height_);
+            for (int y = 0; y < height_; ++y) {
+                const unsigned char* row = gray.ptr<unsigned char>(y);
+                for (int x = 0; x < width_; ++x) {
+                    values[(size_t)y * width_ + x] = (uint16_t)((row[x] << (bits - 8)) | ((x + y) & ((1 << (bits - 8)) - 1)));
+                }
+            }
+            std::vector<unsigned char> frame(frame_size());
+            MonoUnpacker::pack(values.data(), values.size(), (MvGvspPixelType)pixel_format_, frame.data());
+            frames_.push_back(std::move(frame));
+            continue;
+        } else {
+            BayerDemosaicer::mosaic(bgr, (MvGvspPixelType)pixel_format_, converted);
+        }
+        size_t row_bytes = (size_t)converted.cols * converted.elemSize();
+        std::vector<unsigned char> frame(frame_size());
+        for (int y = 0; y < converted.rows; ++y) {
+            std::memcpy(frame.data() + y * row_bytes, converted.ptr<unsigned char>(y), row_bytes);
+        }
+        frames_.push_back(std::move(frame));
+    }
+}
+
+bool DeviceCameraSimulator::start_grabbing() {
+    if (!initialized_) {
+        std::cerr << "Simulator is not initialized!" << std::endl;
+        return false;
+    }
+    if (grabbing_) {
+        return true;
+    }
+    if (frames_.empty()) {
+        build_frames();
+    }
+
+    rng_.seed(seed_);
+    frame_counter_.store(0, std::memory_order_relaxed);
+    dropped_.store(0, std::memory_order_relaxed);
+    start_time_ = std::chrono::steady_clock::now();
+    next_due_ = start_time_;
+    grabbing_ = true;
+    return true;
+}
+
+void DeviceCameraSimulator::stop_grabbing() {
+    grabbing_ = false;
+    if (std::shared_ptr<FrameRing> ring = current_ring()) {
+        ring->close();
+    }
+    if (acquisition_thread_.joinable()) {
+        acquisition_thread_.join();
+    }
+}
+
+const unsigned char* DeviceCameraSimulator::next_frame(MV_FRAME_OUT_INFO_EX& frameInfo) {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::normal_distribution<double> jitter(0.0, jitter_us_ > 0 ? jitter_us_ : 1.0);
+
+    while (true) {
+        // 按帧率等待到该帧的出图时间（加抖动）
+        if (frame_rate_ > 0) {
+            next_due_ += std::chrono::microseconds((int64_t)(1e6 / frame_rate_));
+            auto due = next_due_;
+            if (jitter_us_ > 0) {
+                due += std::chrono::microseconds((int64_t)jitter(rng_));
+            }
+            std::this_thread::sleep_until(due);
+        }
+
+        // 丢帧：相机帧号照常递增，但这一帧不输出
+        if (drop_probability_ > 0 && uniform(rng_) < drop_probability_) {
+            frame_counter_.fetch_add(1, std::memory_order_relaxed);
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            if (!grabbing_) {
+                return nullptr;
+            }
+            continue;
+        }
+        break;
+    }
+
+    auto now_steady = std::chrono::steady_clock::now();
+    uint64_t device_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now_steady - start_time_).count();
+    int64_t host_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // 只有生成帧的线程修改帧号，其他线程只读取计数
+    uint64_t frame_number = frame_counter_.load(std::memory_order_relaxed);
+    std::memset(&frameInfo, 0, sizeof(frameInfo));
+    frameInfo.nWidth = (unsigned short)width_;
+    frameInfo.nHeight = (unsigned short)height_;
+    frameInfo.nExtendWidth = (unsigned int)width_;
+    frameInfo.nExtendHeight = (unsigned int)height_;
+    frameInfo.enPixelType = (MvGvspPixelType)pixel_format_;
+    frameInfo.nFrameNum = (unsigned int)frame_number;
+    frameInfo.nFrameCounter = (unsigned int)frame_number;
+    frameInfo.nDevTimeStampHigh = (unsigned int)(device_ns >> 32);
+    frameInfo.nDevTimeStampLow = (unsigned int)(device_ns & 0xffffffffu);
+    frameInfo.nHostTimeStamp = host_ms;
+    frameInfo.nFrameLen = (unsigned int)frame_size();
+    frameInfo.nFrameLenEx = frame_size();
+    frameInfo.fExposureTime = exposure_time_;
+    frameInfo.fGain = 0.0f;
+    if (lost_packet_probability_ > 0 && uniform(rng_) < lost_packet_probability_) {
+        frameInfo.nLostPacket = 1 + rng_() % 8;
+    }
+
+    const unsigned char* data = frames_[frame_number % frames_.size()].data();
+    frame_counter_.store(frame_number + 1, std::memory_order_relaxed);
+    return data;
+}
+
+bool DeviceCameraSimulator::capture_image(unsigned char* pData, MV_FRAME_OUT_INFO_EX& frameInfo) {
+    return capture_image(pData, frameInfo, 1000);
+}
+
+bool DeviceCameraSimulator::capture_image(unsigned char* pData, MV_FRAME_OUT_INFO_EX& frameInfo, unsigned int timeout_ms) {
+    if (!grabbing_) {
+        return false;
+    }
+    if (acquisition_thread_.joinable()) {
+        return read_next_frame(pData, frame_size(), frameInfo, timeout_ms);
+    }
+    const unsigned char* data = next_frame(frameInfo);
+    if (!data) {
+        return false;
+    }
+    std::memcpy(pData, data, frameInfo.nFrameLen);
+    telemetry_.on_polled(frameInfo);
+    return true;
+}
+
+bool DeviceCameraSimulator::start_acquisition(size_t slot_count) {
+    if (acquisition_thread_.joinable()) {
+        return true;
+    }
+    if (!start_grabbing()) {
+        return false;
+    }
+    std::shared_ptr<FrameRing> ring = current_ring();
+    if (!ring || ring->slot_count() != slot_count || ring->slot_size() < frame_size()) {
+        // 旧环可能仍被停止前开始的读取持有，由最后一个引用释放
+        ring = std::make_shared<FrameRing>(slot_count, frame_size());
+        std::atomic_store(&ring_, ring);
+    }
+    ring->reopen();
+    capture_cursor_.store(ring->head(), std::memory_order_release);
+    acquisition_thread_ = std::thread(&DeviceCameraSimulator::acquisition_loop, this);
+    return true;
+}
+
+void DeviceCameraSimulator::acquisition_loop() {
+    // 采集线程运行期间环不会被替换
+    std::shared_ptr<FrameRing> ring = current_ring();
+    while (grabbing_) {
+        MV_FRAME_OUT_INFO_EX frameInfo;
+        const unsigned char* data = next_frame(frameInfo);
+        if (!data || !grabbing_) {
+            break;
+        }
+        telemetry_.on_handoff(frameInfo, ring->head());
+        std::shared_ptr<const FrameStatisticsCalculator> statistics = std::atomic_load(&statistics_);
+        FrameStatistics frame_statistics;
+        bool has_statistics = statistics && statistics->compute(data, frameInfo, frame_statistics);
+        ring->publish(data, frameInfo, has_statistics ? &frame_statistics : nullptr);
+        sinks_.dispatch(data, frameInfo);
+    }
+}
+
+bool DeviceCameraSimulator::read_latest_frame(unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo,
+                                              FrameStatistics* statistics) {
+    std::shared_ptr<FrameRing> ring = current_ring();
+    uint64_t sequence = 0;
+    if (!ring || !ring->read_latest(pData, size, frameInfo, &sequence, statistics)) {
+        return false;
+    }
+    telemetry_.on_pickup(frameInfo, sequence);
+    return true;
+}
+
+bool DeviceCameraSimulator::read_next_frame(unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo,
+                                            unsigned int timeout_ms, FrameStatistics* statistics) {
+    std::shared_ptr<FrameRing> ring = current_ring();
+    if (!ring) {
+        return false;
+    }
+    uint64_t cursor = capture_cursor_.load(std::memory_order_acquire);
+    bool ok = ring->read_next(cursor, pData, size, frameInfo, timeout_ms, statistics);
+    capture_cursor_.store(cursor, std::memory_order_release);
+    if (!ok) {
+        return false;
+    }
+    telemetry_.on_pickup(frameInfo, cursor - 1);
+    return true;
+}
+
+void DeviceCameraSimulator::set_frame_statistics(bool enable, const FrameStatisticsOptions& options) {
+    std::shared_ptr<const FrameStatisticsCalculator> statistics;
+    if (enable) {
+        statistics = std::make_shared<FrameStatisticsCalculator>(options);
+    }
+    std::atomic_store(&statistics_, statistics);
+}
+
+bool DeviceCameraSimulator::frame_statistics(unsigned int frame_num, FrameStatistics& statistics) const {
+    std::shared_ptr<FrameRing> ring = current_ring();
+    uint64_t sequence = 0;
+    return ring && ring->find_frame(frame_num, sequence) && ring->read_statistics(sequence, statistics);
+}
+
+bool DeviceCameraSimulator::frame_statistics(const MV_FRAME_OUT_INFO_EX& frameInfo, FrameStatistics& statistics) const {
+    std::shared_ptr<FrameRing> ring = current_ring();
+    uint64_t sequence = 0;
+    return ring && ring->find_frame(frameInfo, sequence) && ring->read_statistics(sequence, statistics);
+}
+
+bool DeviceCameraSimulator::latest_frame_statistics(FrameStatistics& statistics) const {
+    std::shared_ptr<FrameRing> ring = current_ring();
+    uint64_t head = ring ? ring->head() : 0;
+    return head > 0 && ring->read_statistics(head - 1, statistics);
+}
+
+FrameRingStats DeviceCameraSimulator::acquisition_stats() const {
+    std::shared_ptr<FrameRing> ring = current_ring();
+    return ring ? ring->stats() : FrameRingStats();
+}
+
+TelemetrySnapshot DeviceCameraSimulator::telemetry() const {
+    TelemetrySnapshot snapshot = telemetry_.snapshot();
+    std::shared_ptr<FrameRing> ring = current_ring();
+    if (ring && acquisition_thread_.joinable()) {
+        uint64_t head = ring->head();
+        uint64_t cursor = capture_cursor_.load(std::memory_order_acquire);
+        uint64_t backlog = head > cursor ? head - cursor : 0;
+        snapshot.ring_backlog = std::min<uint64_t>(backlog, ring->slot_count());
+    }
+    return snapshot;
+}
+
+void DeviceCameraSimulator::close() {
+    stop_grabbing();
+    initialized_ = false;
+}
@@ -1,55 +1,142 @@
 // device_camera_sy011.cpp
 
 #include "device_camera_sy011.h"
+#include "sdk_runtime.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <string> // Required for std::string
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 DeviceCameraSY011::DeviceCameraSY011() : DeviceCamera() {}
 
 DeviceCameraSY011::~DeviceCameraSY011() {
     close();
+    if (sdk_acquired_) {
+        SdkRuntime::release();
+        sdk_acquired_ = false;
+    }
 }
 
 bool DeviceCameraSY011::init() {
-    int nRet = MV_CC_Initialize();
-    if (nRet = MV_OK) {
-        std::cerr << "Failed to initialize SDK! Error Code: [0x" << std::hex << nRet << "]" << std::endl;
-        return false;
+    if (!sdk_acquired_) {
+        if (!SdkRuntime::acquire()) {
+            return false;
+        }
+        sdk_acquired_ = true;
     }
 
-    nRet = MV_CC_EnumDevices(MV_USB_DEVICE, &device_list);
-    std::cerr << "cam_num:"<<device_list.nDeviceNum<< std::endl;
-    if (nRet != MV_OK || device_list.nDeviceNum <= 0) {
-        std::cerr << "No devices found! Error Code: [0x" << std::hex << nRet << "]" << std::endl;
+    // 枚举结果在进程内按序列号缓存，close()后再次init()不会重新枚举
+    std::vector<std::string> serials = SdkRuntime::enumerate(MV_USB_DEVICE);
+    if (serials.empty()) {
+        std::cerr << "No devices found!" << std::endl;
         return false;
     }
+    return open_serial(serials[0], MV_USB_DEVICE);
+}
 
+bool DeviceCameraSY011::init_serial(const std::string& serial, unsigned int layer_types) {
+    if (!sdk_acquired_) {
+        if (!SdkRuntime::acquire()) {
+            return false;
+        }
+        sdk_acquired_ = true;
+    }
+    return open_serial(serial, layer_types);
+}
 
+bool DeviceCameraSY011::open_serial(const std::string& serial, unsigned int layer_types) {
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    MV_CC_DEVICE_INFO device_info;
+    if (!SdkRuntime::find_device(serial, layer_types, device_info)) {
+        std::cerr << "Device with serial " << serial << " not found!" << std::endl;
+        return false;
+    }
+    if (openDevice(device_info)) {
+        return true;
+    }
+    // 缓存的设备信息可能已过期（USB重新插拔后地址变化、GigE改IP），重新枚举后再试一次
+    return SdkRuntime::find_device(serial, layer_types, device_info, true) && openDevice(device_info);
+}
 
-    return openDevice();
+bool DeviceCameraSY011::init_device(const MV_CC_DEVICE_INFO& device_info) {
+    if (!sdk_acquired_) {
+        if (!SdkRuntime::acquire()) {
+            return false;
+        }
+        sdk_acquired_ = true;
+    }
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    return openDevice(device_info);
 }
 
-bool DeviceCameraSY011::openDevice() {
-    MV_CC_DEVICE_INFO* device_info = device_list.pDeviceInfo[0];
-    int nRet = MV_CC_CreateHandle(&handle, device_info);
+std::string DeviceCameraSY011::serial_number() const {
+    return SdkRuntime::device_serial(device_info_);
+}
+
+bool DeviceCameraSY011::openDevice(const MV_CC_DEVICE_INFO& device_info) {
+    if (handle) {
+        release_handle();
+    }
+    device_info_ = device_info;
+    int nRet = MV_CC_CreateHandle(&handle, &device_info_);
     if (nRet != MV_OK) {
         std::cerr << "Create handle failed! Error Code: [0x" << std::hex << nRet << "]" << std::endl;
+        handle = nullptr;
         return false;
     }
 
     nRet = MV_CC_OpenDevice(handle);
     if (nRet != MV_OK) {
         std::cerr << "Open device failed! Error Code: [0x" << std::hex << nRet << "]" << std::endl;
+        MV_CC_DestroyHandle(handle);
+        handle = nullptr;
         return false;
     }
 
-    // 设置像素格式为 BGR8
-    nRet = MV_CC_SetEnumValue(handle, "PixelFormat", PixelType_Gvsp_BGR8_Packed);
-    if (nRet != MV_OK)
+    nodes_.attach(handle);
+
+    // GigE相机使用最佳网络包大小
+    if (device_info_.nTLayerType == MV_GIGE_DEVICE) {
+        int nPacketSize = MV_CC_GetOptimalPacketSize(handle);
+        if (nPacketSize > 0) {
+            nodes_.set_int(CameraNode::GevSCPSPacketSize, nPacketSize);
+        }
+    }
+
+    // 设置像素格式（默认 BGR8）
+    if (!nodes_.set_number(CameraNode::PixelFormat, pixel_format_))
     {
-        std::cerr << "Failed to set PixelFormat to BGR8! Error Code: [0x" << std::hex << nRet << "]" << std::endl;
+        std::cerr << "Failed to set PixelFormat to [0x" << std::hex << pixel_format_ << "]! Error Code: [0x" << std::hex << nodes_.last_error() << "]" << std::endl;
+        release_handle();
         return false;
     }
+    if (hb_configured_) {
+        apply_compression_settings();
+    }
+    payload_size_ = query_payload_size();
+    if (trigger_configured_) {
+        apply_trigger_settings();
+    }
+
+    // 设备掉线由SDK通过异常回调通知，重连在后台线程完成
+    nRet = MV_CC_RegisterExceptionCallBack(handle, exception_callback, this);
+    if (nRet != MV_OK) {
+        std::cerr << "Register exception callback failed! Error Code: [0x" << std::hex << nRet << "]" << std::dec << std::endl;
+    }
+    connected_ = true;
+    {
+        // 新连接建立，此前记下的断线已无意义
+        std::lock_guard<std::mutex> reconnect_lock(reconnect_mutex_);
+        reconnect_pending_ = false;
+    }
+    if (auto_reconnect_) {
+        start_reconnect_thread();
+    }
 
     // nRet = MV_CC_SetEnumValue(handle, "ExposureAuto", MV_EXPOSURE_AUTO_MODE_OFF); // 设置 ExposureAuto
     // if (MV_OK != nRet) {
@@ -68,109 +155,1198 @@ bool DeviceCameraSY011::openDevice() {
 }
 
 bool DeviceCameraSY011::set_resolution(int width, int height) {
-    int nRet = MV_CC_SetIntValueEx(handle, "Width", width);
-    if (nRet != MV_OK) {
-        std::cerr << "Failed to set width! Error Code: [0x" << std::hex << nRet << "]" << std::endl;
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    CameraRoi roi = get_roi();
+    roi.width = width;
+    roi.height = height;
+    return set_roi(roi);
+}
+
+bool DeviceCameraSY011::set_int_aligned(CameraNode node, int64_t value, int64_t* actual) {
+    const char* name = CameraNodeCache::label(node);
+    MVCC_INTVALUE_EX stIntValue = {0};
+    if (!nodes_.get_int(node, stIntValue)) {
+        std::cerr << "Failed to read " << name << "! Error Code: [0x" << std::hex << nodes_.last_error() << "]" << std::dec << std::endl;
         return false;
     }
 
-    nRet = MV_CC_SetIntValueEx(handle, "Height", height);
-    if (nRet != MV_OK) {
-        std::cerr << "Failed to set height! Error Code: [0x" << std::hex << nRet << "]" << std::endl;
+    // 限制在[min, max]内，并向下对齐到min + k * inc
+    int64_t aligned = std::max(stIntValue.nMin, std::min(stIntValue.nMax, value));
+    if (stIntValue.nInc > 1) {
+        aligned = stIntValue.nMin + (aligned - stIntValue.nMin) / stIntValue.nInc * stIntValue.nInc;
+    }
+    if (aligned != value) {
+        std::cerr << name << " " << value << " adjusted to " << aligned << " (min " << stIntValue.nMin
+                  << ", max " << stIntValue.nMax << ", inc " << stIntValue.nInc << ")" << std::endl;
+    }
+
+    if (aligned != stIntValue.nCurValue) {
+        if (!nodes_.set_int(node, aligned)) {
+            std::cerr << "Failed to set " << name << "! Error Code: [0x" << std::hex << nodes_.last_error() << "]" << std::dec << std::endl;
+            return false;
+        }
+    }
+    if (actual) {
+        *actual = aligned;
+    }
+    return true;
+}
+
+bool DeviceCameraSY011::set_binning(CameraNode node, int value) {
+    // 合并/抽样在多数机型上是枚举节点（1/2/4），部分机型是整型节点，由节点缓存按实际类型写入；
+    // 不支持的相机只接受1
+    if (nodes_.set_number(node, value)) {
+        return true;
+    }
+    if (value <= 1) {
+        return true;
+    }
+    std::cerr << "Failed to set " << CameraNodeCache::label(node) << " to " << value << "!" << std::endl;
+    return false;
+}
+
+int DeviceCameraSY011::get_binning(CameraNode node) {
+    double value = 1.0;
+    return nodes_.get_number(node, value) ? (int)value : 1;
+}
+
+CameraRoi DeviceCameraSY011::get_roi() {
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    CameraRoi roi;
+    if (!handle) {
+        return roi;
+    }
+    MVCC_INTVALUE_EX stIntValue = {0};
+    if (nodes_.get_int(CameraNode::Width, stIntValue)) roi.width = (int)stIntValue.nCurValue;
+    if (nodes_.get_int(CameraNode::Height, stIntValue)) roi.height = (int)stIntValue.nCurValue;
+    if (nodes_.get_int(CameraNode::OffsetX, stIntValue)) roi.offset_x = (int)stIntValue.nCurValue;
+    if (nodes_.get_int(CameraNode::OffsetY, stIntValue)) roi.offset_y = (int)stIntValue.nCurValue;
+    roi.binning_horizontal = get_binning(CameraNode::BinningHorizontal);
+    roi.binning_vertical = get_binning(CameraNode::BinningVertical);
+    roi.decimation_horizontal = get_binning(CameraNode::DecimationHorizontal);
+    roi.decimation_vertical = get_binning(CameraNode::DecimationVertical);
+    return roi;
+}
+
+bool DeviceCameraSY011::set_roi(const CameraRoi& roi, CameraRoi* applied) {
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    if (!handle) {
+        std::cerr << "Error: Camera handle is not valid for setting ROI." << std::endl;
         return false;
     }
 
+    // Width/Height/Offset/Binning在取流中不可写：只停止取流，设备保持打开
+    bool was_grabbing = grab_session_ != nullptr;
+    if (was_grabbing) {
+        end_grab_session();
+        MV_CC_StopGrabbing(handle);
+    }
+
+    // 先设合并/抽样（决定宽高上限），再把偏移清零以释放宽高范围，最后设宽高和偏移
+    bool ok = set_binning(CameraNode::BinningHorizontal, roi.binning_horizontal) &&
+              set_binning(CameraNode::BinningVertical, roi.binning_vertical) &&
+              set_binning(CameraNode::DecimationHorizontal, roi.decimation_horizontal) &&
+              set_binning(CameraNode::DecimationVertical, roi.decimation_vertical);
+    ok = ok && set_int_aligned(CameraNode::OffsetX, 0) && set_int_aligned(CameraNode::OffsetY, 0);
+    ok = ok && set_int_aligned(CameraNode::Width, roi.width) && set_int_aligned(CameraNode::Height, roi.height);
+    ok = ok && set_int_aligned(CameraNode::OffsetX, roi.offset_x) && set_int_aligned(CameraNode::OffsetY, roi.offset_y);
+    if (ok) {
+        // 重连后按同样的请求重新设置
+        roi_ = roi;
+        roi_applied_ = true;
+    }
+
+    // 缓冲区按新的负载大小一次性重新分配，此后每帧不再分配
+    payload_size_ = query_payload_size();
+    std::shared_ptr<FrameRing> ring = current_ring();
+    if (ring && ring->slot_size() != payload_size_) {
+        ring->close();
+        std::shared_ptr<FrameRing> resized = std::make_shared<FrameRing>(ring->slot_count(), payload_size_);
+        std::atomic_store(&ring_, resized);
+        capture_cursor_.store(0, std::memory_order_release);
+    } else if (ring && !resuming_) {
+        capture_cursor_.store(ring->head(), std::memory_order_release);
+    }
+    // 解码池的输出缓冲区同样按新的负载大小重建，在重新开始取流之前
+    if (ring) {
+        update_hb_decoder(ring->slot_count());
+    }
+
+    if (applied) {
+        *applied = get_roi();
+    }
+
+    if (was_grabbing) {
+        // 新负载下注册不了缓存时不回退：调用方要求了注册缓存，取流保持停止并报告失败
+        if (!prepare_registered_buffers()) {
+            std::cerr << "Restart grabbing after ROI change failed: registered frame buffers unavailable" << std::endl;
+            return false;
+        }
+        int nRet = MV_CC_StartGrabbing(handle);
+        if (nRet != MV_OK) {
+            std::cerr << "Restart grabbing after ROI change failed! Error Code: [0x" << std::hex << nRet << "]" << std::dec << std::endl;
+            return false;
+        }
+        grab_session_ = std::make_shared<GrabSession>();
+    }
+    return ok;
+}
+
+bool DeviceCameraSY011::set_pixel_format(unsigned int pixel_format) {
+    // 句柄未创建时只记录，openDevice()时生效；取流过程中修改会被相机拒绝
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    if (handle) {
+        if (!nodes_.set_number(CameraNode::PixelFormat, pixel_format)) {
+            std::cerr << "Failed to set PixelFormat to [0x" << std::hex << pixel_format << "]! Error Code: [0x" << std::hex << nodes_.last_error() << "]" << std::endl;
+            return false;
+        }
+        payload_size_ = query_payload_size();
+        if (std::shared_ptr<FrameRing> ring = current_ring()) {
+            update_hb_decoder(ring->slot_count());
+        }
+    }
+    pixel_format_ = pixel_format;
     return true;
 }
 
 bool DeviceCameraSY011::set_exposure_time(int exposure_time) {
-    // 暂时注释掉曝光时间设置功能
-    int nRet = MV_CC_SetIntValueEx(handle, "ExposureTime", exposure_time);
+    // ExposureTime在多数机型上是浮点节点，节点缓存按实际类型写入；与上次相同的值不再下发
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    exposure_time_ = exposure_time;
+    if (!handle) {
+        return true;    // openDevice()/重连后生效
+    }
+    if (!nodes_.set_number(CameraNode::ExposureTime, exposure_time)) {
+        std::cerr << "Failed to set exposure time! Error Code: [0x" << std::hex << nodes_.last_error() << "]" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool DeviceCameraSY011::set_trigger_mode(bool enable, unsigned int source) {
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    trigger_configured_ = true;
+    trigger_enabled_ = enable;
+    trigger_source_ = source;
+    if (!handle) {
+        return true;    // openDevice()/重连后生效
+    }
+    return apply_trigger_settings();
+}
+
+bool DeviceCameraSY011::set_burst_frame_count(int count) {
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    if (count < 1) {
+        return false;
+    }
+    if (handle && !nodes_.supported(CameraNode::AcquisitionBurstFrameCount)) {
+        if (count > 1) {
+            std::cerr << "Device does not support AcquisitionBurstFrameCount" << std::endl;
+            return false;
+        }
+    } else if (handle && !nodes_.set_number(CameraNode::AcquisitionBurstFrameCount, count)) {
+        std::cerr << "Failed to set AcquisitionBurstFrameCount to " << std::dec << count << "! Error Code: [0x" << std::hex << nodes_.last_error() << "]" << std::dec << std::endl;
+        return false;
+    }
+    trigger_configured_ = true;
+    burst_frame_count_ = count;
+    return true;
+}
+
+bool DeviceCameraSY011::apply_trigger_settings() {
+    // 先选触发源再打开触发模式，避免打开的瞬间按旧触发源（如外部输入线）出图
+    if (trigger_enabled_ && !nodes_.set_number(CameraNode::TriggerSource, trigger_source_)) {
+        std::cerr << "Failed to set TriggerSource to " << std::dec << trigger_source_ << "! Error Code: [0x" << std::hex << nodes_.last_error() << "]" << std::dec << std::endl;
+        return false;
+    }
+    if (!nodes_.set_number(CameraNode::TriggerMode, trigger_enabled_ ? MV_TRIGGER_MODE_ON : MV_TRIGGER_MODE_OFF)) {
+        std::cerr << "Failed to set TriggerMode! Error Code: [0x" << std::hex << nodes_.last_error() << "]" << std::dec << std::endl;
+        return false;
+    }
+    if (nodes_.supported(CameraNode::AcquisitionBurstFrameCount)) {
+        nodes_.set_number(CameraNode::AcquisitionBurstFrameCount, burst_frame_count_);
+    } else {
+        burst_frame_count_ = 1;
+    }
+    return true;
+}
+
+bool DeviceCameraSY011::set_lossless_compression(bool enable, int decode_threads) {
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    if (grab_session_) {
+        std::cerr << "Error: Lossless compression can only be changed while not grabbing." << std::endl;
+        return false;
+    }
+    hb_configured_ = true;
+    hb_enabled_ = enable;
+    hb_decode_threads_ = std::max(decode_threads, 1);
+    if (!handle) {
+        return true;    // openDevice()/重连后生效
+    }
+    bool ok = apply_compression_settings();
+    if (!ok && enable) {
+        hb_enabled_ = false;
+    }
+    payload_size_ = query_payload_size();
+    return ok;
+}
+
+bool DeviceCameraSY011::apply_compression_settings() {
+    if (!nodes_.supported(CameraNode::ImageCompressionMode)) {
+        if (hb_enabled_) {
+            std::cerr << "Device does not support ImageCompressionMode (HB)" << std::endl;
+            return false;
+        }
+        return true;
+    }
+    if (!nodes_.set_enum_string(CameraNode::ImageCompressionMode, hb_enabled_ ? "HB" : "Off")) {
+        std::cerr << "Failed to set ImageCompressionMode to " << (hb_enabled_ ? "HB" : "Off") << "! Error Code: [0x" << std::hex << nodes_.last_error() << "]" << std::dec << std::endl;
+        return false;
+    }
+    return true;
+}
+
+HbDecodeStats DeviceCameraSY011::hb_decode_stats() const {
+    std::shared_ptr<HbDecoder> decoder = std::atomic_load(&hb_decoder_);
+    return decoder ? decoder->stats() : HbDecodeStats();
+}
+
+void DeviceCameraSY011::reset_hb_decode_stats() {
+    if (std::shared_ptr<HbDecoder> decoder = std::atomic_load(&hb_decoder_)) {
+        decoder->reset_stats();
+    }
+}
+
+bool DeviceCameraSY011::load_profile(const std::string& path) {
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    if (!handle) {
+        std::cerr << "Error: Camera handle is not valid for loading a profile." << std::endl;
+        return false;
+    }
+    MVCC_NODE_ERROR_LIST stErrorList;
+    std::memset(&stErrorList, 0, sizeof(stErrorList));
+    int nRet = MV_CC_FeatureLoadEx(handle, path.c_str(), &stErrorList);
+    if (nRet != MV_OK) {
+        std::cerr << "Failed to load profile " << path << "! Error Code: [0x" << std::hex << nRet << "]" << std::dec << std::endl;
+        return false;
+    }
+    // 部分节点导入失败时接口仍返回MV_OK（如取流中不可写的节点），逐个报告
+    for (unsigned int i = 0; i < stErrorList.nErrorNum && i < MV_MAX_NODE_ERROR_NUM; ++i) {
+        const MVCC_NODE_ERROR& error = stErrorList.stNodeError[i];
+        std::cerr << "Profile node " << std::string(error.strName, strnlen(error.strName, sizeof(error.strName)))
+                  << " not applied (error type " << std::dec << error.enErrType << ")" << std::endl;
+    }
+
+    profile_path_ = path;
+    // 配置文件可能改写了像素格式、ROI和曝光，此后以设备上的值为准
+    double value = 0.0;
+    if (nodes_.get_number(CameraNode::PixelFormat, value)) {
+        pixel_format_ = (unsigned int)value;
+    }
+    roi_applied_ = false;
+    exposure_time_ = -1.0;
+    payload_size_ = query_payload_size();
+    if (std::shared_ptr<FrameRing> ring = current_ring()) {
+        update_hb_decoder(ring->slot_count());
+    }
+    return true;
+}
+
+bool DeviceCameraSY011::save_profile(const std::string& path) {
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    if (!handle) {
+        std::cerr << "Error: Camera handle is not valid for saving a profile." << std::endl;
+        return false;
+    }
+    int nRet = MV_CC_FeatureSave(handle, path.c_str());
     if (nRet != MV_OK) {
-        std::cerr << "Failed to set exposure time! Error Code: [0x" << std::hex << nRet << "]" << std::endl;
+        std::cerr << "Failed to save profile " << path << "! Error Code: [0x" << std::hex << nRet << "]" << std::dec << std::endl;
         return false;
     }
-    return true;  // 直接返回 true 以绕过曝光时间设置
+    return true;
 }
 
 
 bool DeviceCameraSY011::start_grabbing() {
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    if (!handle) {
+        std::cerr << "Error: Camera handle is not valid for grabbing." << std::endl;
+        return false;
+    }
+    if (!prepare_registered_buffers()) {
+        std::cerr << "Start grabbing failed: registered frame buffers unavailable" << std::endl;
+        return false;
+    }
+    // 新的取流会话：设备的触发计数可能重新开始
+    last_trigger_index_.store(0, std::memory_order_relaxed);
+    expected_trigger_index_ = 0;
     int nRet = MV_CC_StartGrabbing(handle);
     if (nRet != MV_OK) {
         std::cerr << "Start grabbing failed! Error Code: [0x" << std::hex << nRet << "]" << std::endl;
         return false;
     }
+    grab_session_ = std::make_shared<GrabSession>();
+    grab_wanted_ = true;
     return true;
 }
 
+bool DeviceCameraSY011::start_acquisition(size_t slot_count) {
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    if (!handle) {
+        std::cerr << "Error: Camera handle is not valid for acquisition." << std::endl;
+        return false;
+    }
+    // 正在取流（可能已注册回调）：先停止取流并注销回调，回调不再写环之后才重置帧环和读游标，
+    // 再重新注册回调
+    if (grab_session_) {
+        stop_grabbing();
+    }
+
+    // 环的槽大小按相机实际负载分配，只在开始采集时分配一次
+    payload_size_ = query_payload_size();
+    std::shared_ptr<FrameRing> ring = current_ring();
+    bool new_ring = !ring || ring->slot_count() != slot_count || ring->slot_size() != payload_size_;
+    if (new_ring) {
+        ring = std::make_shared<FrameRing>(slot_count, payload_size_);
+        std::atomic_store(&ring_, ring);
+    }
+    ring->reopen();
+    if (new_ring || !resuming_) {
+        capture_cursor_.store(ring->head(), std::memory_order_release);
+    }
+    affinity_applied_.store(false);
+
+    // HB压缩时回调只把压缩帧拷进解码池
+    std::shared_ptr<HbDecoder> decoder = update_hb_decoder(slot_count);
+    if (decoder && !decoder->start()) {
+        std::cerr << "Failed to start HB decoder!" << std::endl;
+        return false;
+    }
+
+    int nRet = MV_CC_RegisterImageCallBackEx(handle, image_callback, this);
+    if (nRet != MV_OK) {
+        std::cerr << "Register image callback failed! Error Code: [0x" << std::hex << nRet << "]" << std::endl;
+        if (decoder) {
+            decoder->stop();
+        }
+        return false;
+    }
+
+    acquisition_ = true;
+    if (!start_grabbing()) {
+        MV_CC_RegisterImageCallBackEx(handle, NULL, NULL);
+        if (decoder) {
+            decoder->stop();
+        }
+        acquisition_ = false;
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<HbDecoder> DeviceCameraSY011::update_hb_decoder(size_t slot_count) {
+    // 池比环多出每个解码线程一帧，解码线程全忙时环仍能缓冲
+    std::shared_ptr<HbDecoder> decoder;
+    if (hb_enabled_) {
+        decoder = std::atomic_load(&hb_decoder_);
+        size_t pool_size = slot_count + (size_t)hb_decode_threads_;
+        if (!decoder || decoder->handle() != handle || decoder->pool_size() != pool_size ||
+            decoder->frame_size() != payload_size_) {
+            // 负载大小只在停止取流时改变，旧池不会再收到帧；处理完已入池的帧后由新池接替
+            bool restart = decoder && decoder->running();
+            if (restart) {
+                decoder->stop();
+            }
+            decoder = std::make_shared<HbDecoder>(handle, hb_decode_threads_, pool_size, payload_size_, payload_size_,
+                [this](const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo) { deliver_frame(pData, frameInfo); });
+            if (restart && !decoder->start()) {
+                std::cerr << "Failed to restart HB decoder!" << std::endl;
+            }
+        }
+    }
+    std::atomic_store(&hb_decoder_, decoder);
+    return decoder;
+}
+
+void DeviceCameraSY011::set_cpu_affinity(int cpu) {
+    affinity_cpu_ = cpu;
+    affinity_applied_.store(false);
+}
+
+void DeviceCameraSY011::pin_current_thread(int cpu) {
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    int nRet = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    if (nRet != 0) {
+        std::cerr << "Failed to pin acquisition thread to CPU " << std::dec << cpu << "! Error Code: " << nRet << std::endl;
+    }
+#else
+    (void)cpu;
+#endif
+}
+
+size_t DeviceCameraSY011::query_payload_size() {
+    MVCC_INTVALUE_EX stIntValue = {0};
+    if (nodes_.get_int(CameraNode::PayloadSize, stIntValue) && stIntValue.nCurValue > 0) {
+        size_t payload = (size_t)stIntValue.nCurValue;
+        // HB压缩时缓冲区还要放得下解码后的帧：按宽高和像素格式的位数计算
+        MVCC_INTVALUE_EX stWidth = {0};
+        MVCC_INTVALUE_EX stHeight = {0};
+        if (hb_enabled_ && nodes_.get_int(CameraNode::Width, stWidth) && nodes_.get_int(CameraNode::Height, stHeight)) {
+            size_t bits = (pixel_format_ & MV_GVSP_PIX_EFFECTIVE_PIXEL_SIZE_MASK) >> MV_GVSP_PIX_EFFECTIVE_PIXEL_SIZE_SHIFT;
+            payload = std::max(payload, (size_t)(stWidth.nCurValue * stHeight.nCurValue) * bits / 8);
+        }
+        return payload;
+    }
+
+    // PayloadSize不可读时按当前宽高的BGR8估算
+    MVCC_INTVALUE_EX stWidth = {0};
+    MVCC_INTVALUE_EX stHeight = {0};
+    if (nodes_.get_int(CameraNode::Width, stWidth) && nodes_.get_int(CameraNode::Height, stHeight)) {
+        return (size_t)(stWidth.nCurValue * stHeight.nCurValue * 3);
+    }
+    return 0;
+}
+
+bool DeviceCameraSY011::read_latest_frame(unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo,
+                                          FrameStatistics* statistics) {
+    std::shared_ptr<FrameRing> ring = current_ring();
+    uint64_t sequence = 0;
+    if (!ring || !ring->read_latest(pData, size, frameInfo, &sequence, statistics)) {
+        return false;
+    }
+    telemetry_.on_pickup(frameInfo, sequence);
+    return true;
+}
+
+bool DeviceCameraSY011::read_next_frame(unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo,
+                                        unsigned int timeout_ms, FrameStatistics* statistics) {
+    uint64_t cursor = capture_cursor_.load(std::memory_order_acquire);
+    bool ok = read_next_frame(cursor, pData, size, frameInfo, timeout_ms, statistics);
+    // trigger_burst()可能同时把游标前移，只向前更新
+    uint64_t current = capture_cursor_.load(std::memory_order_acquire);
+    while (current < cursor && !capture_cursor_.compare_exchange_weak(current, cursor, std::memory_order_acq_rel)) {
+    }
+    return ok;
+}
+
+bool DeviceCameraSY011::read_next_frame(uint64_t& cursor, unsigned char* pData, size_t size,
+                                        MV_FRAME_OUT_INFO_EX& frameInfo, unsigned int timeout_ms,
+                                        FrameStatistics* statistics) {
+    std::shared_ptr<FrameRing> ring = current_ring();
+    if (!ring || !ring->read_next(cursor, pData, size, frameInfo, timeout_ms, statistics)) {
+        return false;
+    }
+    telemetry_.on_pickup(frameInfo, cursor - 1);
+    return true;
+}
+
+uint64_t DeviceCameraSY011::acquisition_cursor() const {
+    std::shared_ptr<FrameRing> ring = current_ring();
+    return ring ? ring->head() : 0;
+}
+
+FrameRingStats DeviceCameraSY011::acquisition_stats() const {
+    std::shared_ptr<FrameRing> ring = current_ring();
+    return ring ? ring->stats() : FrameRingStats();
+}
+
+TelemetrySnapshot DeviceCameraSY011::telemetry() const {
+    TelemetrySnapshot snapshot = telemetry_.snapshot();
+    // 重连期间不等待设备锁，只是不报告SDK队列深度
+    std::unique_lock<std::recursive_mutex> lock(device_mutex_, std::try_to_lock);
+    if (lock.owns_lock() && handle) {
+        unsigned int valid_images = 0;
+        if (MV_CC_GetValidImageNum(handle, &valid_images) == MV_OK) {
+            snapshot.sdk_queue_depth = valid_images;
+        }
+    }
+    std::shared_ptr<FrameRing> ring = current_ring();
+    if (ring && acquisition_) {
+        uint64_t head = ring->head();
+        uint64_t cursor = capture_cursor_.load(std::memory_order_acquire);
+        uint64_t backlog = head > cursor ? head - cursor : 0;
+        snapshot.ring_backlog = std::min<uint64_t>(backlog, ring->slot_count());
+    }
+    return snapshot;
+}
+
+size_t DeviceCameraSY011::frame_buffer_size() const {
+    std::shared_ptr<FrameRing> ring = current_ring();
+    return ring ? ring->slot_size() : payload_size_;
+}
+
 void DeviceCameraSY011::stop_grabbing() {
+    // 只停止取流：句柄、节点缓存和帧环都保留，再次start_grabbing()/start_acquisition()无需重新打开设备
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    end_grab_session();
+    grab_wanted_ = false;
+    if (std::shared_ptr<FrameRing> ring = current_ring()) {
+        ring->close();
+    }
     if (handle) {
         MV_CC_StopGrabbing(handle);
+        if (acquisition_) {
+            MV_CC_RegisterImageCallBackEx(handle, NULL, NULL);
+        }
+    }
+    // 取流停止后不再有新的压缩帧，解码池交付完已收到的帧再停
+    if (std::shared_ptr<HbDecoder> decoder = std::atomic_load(&hb_decoder_)) {
+        decoder->stop();
+    }
+    acquisition_ = false;
+}
+
+void DeviceCameraSY011::end_grab_session() {
+    // 等进行中的FrameLease归还结束，之后的归还不再调用SDK
+    if (grab_session_) {
+        grab_session_->end();
+        grab_session_.reset();
+    }
+}
+
+void DeviceCameraSY011::release_handle() {
+    end_grab_session();
+    if (handle) {
+        MV_CC_StopGrabbing(handle);
+        // 停止取流后阻塞中的主动取图很快返回；新的取图要先拿device_mutex_，不会再进来
+        while (polls_in_flight_.load(std::memory_order_acquire) > 0) {
+            std::this_thread::yield();
+        }
+        // 解码线程仍在使用句柄，必须在销毁句柄之前停止
+        if (std::shared_ptr<HbDecoder> decoder = std::atomic_load(&hb_decoder_)) {
+            decoder->stop();
+        }
+        if (arena_) {
+            arena_->unregister_buffers();
+        }
         MV_CC_CloseDevice(handle);
         MV_CC_DestroyHandle(handle);
+        handle = nullptr;
     }
+    nodes_.attach(nullptr);
+    connected_ = false;
 }
 
 bool DeviceCameraSY011::capture_image(unsigned char* pData, MV_FRAME_OUT_INFO_EX& frameInfo) {
-    // Increased buffer size assumption for safety, adjust if needed based on max resolution
-    int nRet = MV_CC_GetOneFrameTimeout(handle, pData, 1440 * 1080 * 3 + 2048, &frameInfo, 1000); // Added buffer margin
+    return capture_image(pData, frameInfo, 1000);
+}
+
+bool DeviceCameraSY011::capture_image(unsigned char* pData, MV_FRAME_OUT_INFO_EX& frameInfo, unsigned int timeout_ms) {
+    if (acquisition_) {
+        // 回调模式下SDK不再支持主动取图，改为从帧环逐帧读取
+        return read_next_frame(pData, frame_buffer_size(), frameInfo, timeout_ms);
+    }
+
+    // 调用方的缓冲区按payload_size()分配
+    return grab_frame(pData, payload_size_, frameInfo, timeout_ms);
+}
+
+namespace {
+// 主动取图期间句柄不得销毁：析构时减少计数，release_handle()等计数归零
+struct PollScope {
+    std::atomic<int>& in_flight;
+    explicit PollScope(std::atomic<int>& counter) : in_flight(counter) {}
+    ~PollScope() { in_flight.fetch_sub(1, std::memory_order_release); }
+};
+}
+
+bool DeviceCameraSY011::grab_frame(unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo,
+                                   unsigned int timeout_ms) {
+    // SDK里最长阻塞timeout_ms，期间不持有device_mutex_，setter和重连线程不受影响
+    std::lock_guard<std::mutex> poll_lock(poll_mutex_);
+    void* grab_handle = nullptr;
+    bool registered = false;
+    {
+        std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+        if (!handle) {
+            return false;
+        }
+        grab_handle = handle;
+        registered = arena_ && arena_->registered();
+        polls_in_flight_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    PollScope poll_scope(polls_in_flight_);
+
+    if (registered) {
+        // 注册了外部缓存后SDK只支持GetImageBuffer取图：从已注册的槽拷出后立即归还
+        MV_FRAME_OUT frame;
+        std::memset(&frame, 0, sizeof(frame));
+        int nRet = MV_CC_GetImageBuffer(grab_handle, &frame, timeout_ms);
+        if (nRet != MV_OK) {
+            return false;
+        }
+        note_trigger_delivery();
+        frameInfo = frame.stFrameInfo;
+        last_trigger_index_.store(frameInfo.nTriggerIndex, std::memory_order_relaxed);
+        bool ok = true;
+        if (HbDecoder::is_hb(frameInfo.enPixelType)) {
+            ok = HbDecoder::decode(grab_handle, frame.pBufAddr, frameInfo.nFrameLen, pData, size, frameInfo);
+        } else {
+            std::memcpy(pData, frame.pBufAddr, std::min<size_t>(frame.stFrameInfo.nFrameLen, size));
+        }
+        MV_CC_FreeImageBuffer(grab_handle, &frame);
+        if (!ok) {
+            return false;
+        }
+        telemetry_.on_polled(frameInfo);
+        update_polled_statistics(pData, frameInfo);
+        return true;
+    }
+
+    int nRet = MV_CC_GetOneFrameTimeout(grab_handle, pData, (unsigned int)size, &frameInfo, timeout_ms);
     if (nRet != MV_OK) {
          // Optionally print error code here
          // std::cerr << "MV_CC_GetOneFrameTimeout failed! Error Code: [0x" << std::hex << nRet << "]" << std::endl;
+        return false;
+    }
+    if (HbDecoder::is_hb(frameInfo.enPixelType)) {
+        // 压缩帧先移到暂存区，再解码回调用方的缓冲区
+        hb_buffer_.assign(pData, pData + std::min<size_t>(frameInfo.nFrameLen, size));
+        if (!HbDecoder::decode(grab_handle, hb_buffer_.data(), hb_buffer_.size(), pData, size, frameInfo)) {
+            return false;
+        }
+    }
+    note_trigger_delivery();
+    last_trigger_index_.store(frameInfo.nTriggerIndex, std::memory_order_relaxed);
+    telemetry_.on_polled(frameInfo);
+    update_polled_statistics(pData, frameInfo);
+    return true;
+}
+
+void DeviceCameraSY011::update_polled_statistics(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo) {
+    std::shared_ptr<const FrameStatisticsCalculator> statistics = std::atomic_load(&statistics_);
+    if (!statistics) {
+        return;
+    }
+    FrameStatistics frame_statistics;
+    statistics->compute(pData, frameInfo, frame_statistics);
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    polled_statistics_ = frame_statistics;
+}
+
+void DeviceCameraSY011::set_frame_statistics(bool enable, const FrameStatisticsOptions& options) {
+    std::shared_ptr<const FrameStatisticsCalculator> statistics;
+    if (enable) {
+        statistics = std::make_shared<FrameStatisticsCalculator>(options);
+    }
+    std::atomic_store(&statistics_, statistics);
+}
+
+bool DeviceCameraSY011::frame_statistics(unsigned int frame_num, FrameStatistics& statistics) const {
+    std::shared_ptr<FrameRing> ring = current_ring();
+    uint64_t sequence = 0;
+    if (ring && ring->find_frame(frame_num, sequence) && ring->read_statistics(sequence, statistics)) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    if (polled_statistics_.valid && polled_statistics_.frame_num == frame_num) {
+        statistics = polled_statistics_;
+        return true;
+    }
+    return false;
+}
+
+bool DeviceCameraSY011::frame_statistics(const MV_FRAME_OUT_INFO_EX& frameInfo, FrameStatistics& statistics) const {
+    std::shared_ptr<FrameRing> ring = current_ring();
+    uint64_t sequence = 0;
+    if (ring && ring->find_frame(frameInfo, sequence) && ring->read_statistics(sequence, statistics)) {
+        return true;
+    }
+    // 主动取图路径只保存最近一帧的统计
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    if (polled_statistics_.valid && polled_statistics_.frame_num == frameInfo.nFrameNum) {
+        statistics = polled_statistics_;
+        return true;
+    }
+    return false;
+}
+
+bool DeviceCameraSY011::latest_frame_statistics(FrameStatistics& statistics) const {
+    std::shared_ptr<FrameRing> ring = current_ring();
+    if (acquisition_ && ring) {
+        uint64_t head = ring->head();
+        return head > 0 && ring->read_statistics(head - 1, statistics);
+    }
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    statistics = polled_statistics_;
+    return statistics.valid;
+}
+
+void DeviceCameraSY011::note_trigger_delivery() {
+    if (pending_trigger_us_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    int64_t triggered_us = pending_trigger_us_.exchange(0);
+    if (triggered_us != 0) {
+        trigger_latency_.record((uint64_t)std::max<int64_t>(FrameTelemetry::steady_now_us() - triggered_us, 0));
+    }
+}
+
+bool DeviceCameraSY011::trigger_software() {
+    uint32_t trigger_index = 0;
+    return issue_trigger(trigger_index);
+}
+
+bool DeviceCameraSY011::issue_trigger(uint32_t& trigger_index) {
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    if (!handle) {
+        return false;
+    }
+    // 这次触发的帧应带的触发计数：比已交付的帧和之前等待过（可能超时）的触发都新
+    uint32_t delivered = last_trigger_index_.load(std::memory_order_relaxed);
+    uint32_t newest = (int32_t)(delivered - expected_trigger_index_) > 0 ? delivered : expected_trigger_index_;
+    trigger_index = newest + 1;
+    // 先记时间再发命令：该触发的帧最早在命令返回前就可能被回调交付
+    pending_trigger_us_.store(FrameTelemetry::steady_now_us());
+    if (!nodes_.execute(CameraNode::TriggerSoftware)) {
+        pending_trigger_us_.store(0);
+        std::cerr << "TriggerSoftware failed! Error Code: [0x" << std::hex << nodes_.last_error() << "]" << std::dec << std::endl;
+        return false;
+    }
+    expected_trigger_index_ = trigger_index;
+    triggers_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool DeviceCameraSY011::wait_trigger_frame(bool from_ring, uint64_t& cursor, uint32_t trigger_index, unsigned char* pData,
+                                           size_t size, MV_FRAME_OUT_INFO_EX& frameInfo, unsigned int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true) {
+        auto now = std::chrono::steady_clock::now();
+        unsigned int remaining = now < deadline
+            ? (unsigned int)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count() : 0;
+        std::memset(&frameInfo, 0, sizeof(MV_FRAME_OUT_INFO_EX));
+        bool ok = from_ring ? read_next_frame(cursor, pData, size, frameInfo, remaining)
+                            : grab_frame(pData, size, frameInfo, remaining);
+        if (!ok) {
+            return false;
+        }
+        // 设备不填触发计数（恒为0）时无法区分，直接接受
+        if (frameInfo.nTriggerIndex == 0 || (int32_t)(frameInfo.nTriggerIndex - trigger_index) >= 0) {
+            return true;
+        }
+        // 之前超时的触发迟到的帧，跳过
+        if (remaining == 0) {
+            return false;
+        }
     }
-    return nRet == MV_OK;
+}
+
+bool DeviceCameraSY011::trigger_and_wait(unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo,
+                                         unsigned int timeout_ms) {
+    return trigger_burst(pData, size, 1, &frameInfo, timeout_ms) == 1;
+}
+
+size_t DeviceCameraSY011::trigger_burst(unsigned char* base, size_t stride, size_t count, MV_FRAME_OUT_INFO_EX* infos,
+                                        unsigned int timeout_ms) {
+    if (!base || !infos || count == 0) {
+        return 0;
+    }
+    size_t frames_per_trigger;
+    std::shared_ptr<FrameRing> ring;
+    {
+        std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+        // 连续采集或外部触发时无法确定哪一帧属于这次软触发
+        if (!trigger_enabled_ || trigger_source_ != MV_TRIGGER_SOURCE_SOFTWARE) {
+            std::cerr << "Triggered capture needs trigger mode on with source MV_TRIGGER_SOURCE_SOFTWARE" << std::endl;
+            return 0;
+        }
+        frames_per_trigger = (size_t)std::max(burst_frame_count_, 1);
+        ring = acquisition_ ? current_ring() : nullptr;
+    }
+    uint64_t cursor = 0;
+    uint32_t trigger_index = 0;
+    size_t received = 0;
+    for (; received < count; ++received) {
+        if (received % frames_per_trigger == 0) {
+            // 等待的起点在触发之前确定：帧环的当前head，或清空SDK缓存中残留的帧
+            if (ring) {
+                cursor = ring->head();
+            } else {
+                std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+                if (handle) {
+                    MV_CC_ClearImageBuffer(handle);
+                }
+            }
+            if (!issue_trigger(trigger_index)) {
+                break;
+            }
+        }
+        unsigned char* pData = base + received * stride;
+        if (!wait_trigger_frame(ring != nullptr, cursor, trigger_index, pData, stride, infos[received], timeout_ms)) {
+            pending_trigger_us_.store(0);
+            trigger_timeouts_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+    }
+    if (ring) {
+        uint64_t current = capture_cursor_.load(std::memory_order_acquire);
+        while (current < cursor && !capture_cursor_.compare_exchange_weak(current, cursor, std::memory_order_acq_rel)) {
+        }
+    }
+    trigger_frames_.fetch_add(received, std::memory_order_relaxed);
+    return received;
+}
+
+size_t DeviceCameraSY011::capture_bracket(const std::vector<double>& exposure_times, unsigned char* base, size_t stride,
+                                          MV_FRAME_OUT_INFO_EX* infos, unsigned int timeout_ms) {
+    double original = -1.0;
+    {
+        std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+        if (burst_frame_count_ != 1) {
+            std::cerr << "Exposure bracketing needs a burst frame count of 1" << std::endl;
+            return 0;
+        }
+        if (!handle || !nodes_.get_number(CameraNode::ExposureTime, original)) {
+            std::cerr << "Failed to read exposure time! Error Code: [0x" << std::hex << nodes_.last_error() << "]" << std::dec << std::endl;
+            return 0;
+        }
+    }
+
+    // 触发模式下曝光在下一次触发时生效，写入后立即触发即可
+    size_t received = 0;
+    for (; received < exposure_times.size(); ++received) {
+        {
+            std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+            if (!handle || !nodes_.set_number(CameraNode::ExposureTime, exposure_times[received])) {
+                std::cerr << "Failed to set exposure time to " << exposure_times[received] << "! Error Code: [0x" << std::hex << nodes_.last_error() << "]" << std::dec << std::endl;
+                break;
+            }
+        }
+        if (trigger_burst(base + received * stride, stride, 1, &infos[received], timeout_ms) != 1) {
+            break;
+        }
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    if (handle) {
+        nodes_.set_number(CameraNode::ExposureTime, exposure_time_ >= 0 ? exposure_time_ : original);
+    }
+    return received;
+}
+
+TriggerStats DeviceCameraSY011::trigger_stats() const {
+    TriggerStats stats;
+    stats.triggers = triggers_.load(std::memory_order_relaxed);
+    stats.frames = trigger_frames_.load(std::memory_order_relaxed);
+    stats.timeouts = trigger_timeouts_.load(std::memory_order_relaxed);
+    stats.trigger_to_delivery = trigger_latency_.summary();
+    return stats;
+}
+
+void DeviceCameraSY011::reset_trigger_stats() {
+    triggers_.store(0, std::memory_order_relaxed);
+    trigger_frames_.store(0, std::memory_order_relaxed);
+    trigger_timeouts_.store(0, std::memory_order_relaxed);
+    trigger_latency_.reset();
+}
+
+bool DeviceCameraSY011::use_registered_buffers(size_t slot_count, bool huge_pages) {
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    if (grab_session_) {
+        std::cerr << "Registered frame buffers can only be changed while not grabbing." << std::endl;
+        return false;
+    }
+    // 双USB接口相机要求至少注册3块缓存
+    arena_slots_ = slot_count == 0 ? 0 : std::max<size_t>(slot_count, 3);
+    arena_huge_pages_ = huge_pages;
+    if (arena_) {
+        arena_->unregister_buffers();
+        arena_.reset();
+    }
+    if (handle && !prepare_registered_buffers()) {
+        // 这里就报告失败并撤销请求，之后按SDK分配的缓存取流
+        arena_slots_ = 0;
+        return false;
+    }
+    return true;
+}
+
+bool DeviceCameraSY011::registered_buffers_active() const {
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    return arena_ && arena_->registered();
+}
+
+std::shared_ptr<const FrameArena> DeviceCameraSY011::registered_buffers() const {
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    return arena_;
+}
+
+bool DeviceCameraSY011::prepare_registered_buffers() {
+    // 调用方持有device_mutex_且未在取流
+    if (arena_slots_ == 0 || !handle) {
+        return arena_slots_ == 0;
+    }
+    uint64_t payload = 0;
+    unsigned int alignment = 0;
+    int nRet = MV_CC_GetPayloadSize(handle, &payload, &alignment);
+    if (nRet != MV_OK || payload == 0) {
+        payload = query_payload_size();
+        alignment = 64;
+    }
+    if (arena_ && arena_->registered_handle() == handle && arena_->slot_size() >= payload) {
+        return true;
+    }
+
+    // 负载变大或换了句柄：整体重新分配，旧内存池在最后一个FrameLease归还后释放
+    if (arena_) {
+        arena_->unregister_buffers();
+    }
+    std::shared_ptr<FrameArena> arena = std::make_shared<FrameArena>();
+    if (!arena->allocate(arena_slots_, (size_t)payload, std::max(alignment, 64u), arena_huge_pages_) ||
+        !arena->register_buffers(handle)) {
+        std::cerr << "Failed to prepare " << std::dec << arena_slots_ << " registered frame buffers of " << payload << " bytes" << std::endl;
+        arena_.reset();
+        return false;
+    }
+    arena_ = arena;
+    return true;
+}
+
+FrameLease DeviceCameraSY011::acquire_frame(unsigned int timeout_ms) {
+    // 与grab_frame相同：等待帧时不持有device_mutex_
+    void* grab_handle = nullptr;
+    std::shared_ptr<GrabSession> session;
+    std::shared_ptr<FrameArena> arena;
+    {
+        std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+        // HB压缩时SDK缓冲区里是压缩码流，不能作为图像借出；改用capture()取解码后的帧
+        if (!handle || !grab_session_ || acquisition_ || hb_enabled_) {
+            return FrameLease();
+        }
+        grab_handle = handle;
+        session = grab_session_;
+        arena = arena_;
+        polls_in_flight_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    PollScope poll_scope(polls_in_flight_);
+
+    MV_FRAME_OUT frame;
+    std::memset(&frame, 0, sizeof(frame));
+    int nRet = MV_CC_GetImageBuffer(grab_handle, &frame, timeout_ms);
+    if (nRet != MV_OK) {
+        // std::cerr << "MV_CC_GetImageBuffer failed! Error Code: [0x" << std::hex << nRet << "]" << std::endl;
+        return FrameLease();
+    }
+    if (HbDecoder::is_hb(frame.stFrameInfo.enPixelType)) {
+        MV_CC_FreeImageBuffer(grab_handle, &frame);
+        return FrameLease();
+    }
+    telemetry_.on_polled(frame.stFrameInfo);
+    return FrameLease(grab_handle, frame, session, arena);
 }
 
 float DeviceCameraSY011::get_fps() {
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
     if (!handle) {
         std::cerr << "Error: Camera handle is not valid for getting FPS." << std::endl;
         return -1.0f; // Indicate error: Not connected or initialized
     }
 
-    MVCC_FLOATVALUE stFloatValue = {0};
-    int nRet = MV_OK;
-    // Parameter names can vary. Common ones are "ResultingFrameRate" or "AcquisitionFrameRate".
-    // Check your camera's documentation or MVS client software for the exact name.
-    const char* fpsParamName1 = "ResultingFrameRate";
-    const char* fpsParamName2 = "AcquisitionFrameRate";
+    // 节点名因机型而异（ResultingFrameRate或AcquisitionFrameRate），由节点缓存在第一次调用时确定
+    double fps = 0.0;
+    if (!nodes_.get_number(CameraNode::ResultingFrameRate, fps)) {
+        std::cerr << "Failed to get FPS using 'ResultingFrameRate' or 'AcquisitionFrameRate'! Error Code: [0x" << std::hex << nodes_.last_error() << "]" << std::endl;
+        return -2.0f; // Indicate error: Parameter not found or other SDK error
+    }
+    return (float)fps;
+}
 
-    // Try the first parameter name
-    nRet = MV_CC_GetFloatValue(handle, fpsParamName1, &stFloatValue);
-    if (nRet != MV_OK) {
-        // If the first one failed, try the second one
-        // std::cerr << "Warning: Failed to get FPS using '" << fpsParamName1 << "'. Trying '" << fpsParamName2 << "'... Error Code: [0x" << std::hex << nRet << "]" << std::endl;
-        nRet = MV_CC_GetFloatValue(handle, fpsParamName2, &stFloatValue);
-        if (nRet != MV_OK) {
-            // If both failed, report the error for the second attempt
-            std::cerr << "Failed to get FPS using '" << fpsParamName1 << "' or '" << fpsParamName2 << "'! Error Code: [0x" << std::hex << nRet << "]" << std::endl;
-            return -2.0f; // Indicate error: Parameter not found or other SDK error
-        }
-         // std::cout << "Successfully retrieved FPS using parameter: " << fpsParamName2 << std::endl;
+void DeviceCameraSY011::close() {
+    // 先停掉重连线程，避免它在关闭过程中重新打开设备
+    stop_reconnect_thread();
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    if (std::shared_ptr<FrameRing> ring = current_ring()) {
+        ring->close();
+    }
+    acquisition_ = false;
+    grab_wanted_ = false;
+    release_handle();
+    {
+        // 主动关闭的设备不再重连
+        std::lock_guard<std::mutex> reconnect_lock(reconnect_mutex_);
+        reconnect_pending_ = false;
+    }
+    // SDK保持初始化、设备枚举缓存保留（对象析构时才释放），再次init()可直接打开设备
+}
+
+void DeviceCameraSY011::set_auto_reconnect(bool enable) {
+    auto_reconnect_ = enable;
+    if (enable) {
+        start_reconnect_thread();
     } else {
-         // std::cout << "Successfully retrieved FPS using parameter: " << fpsParamName1 << std::endl;
+        stop_reconnect_thread();
     }
+}
 
+double DeviceCameraSY011::last_reconnect_ms() const {
+    return last_reconnect_us_.load(std::memory_order_relaxed) / 1000.0;
+}
 
-    return stFloatValue.fCurValue;
+void DeviceCameraSY011::start_reconnect_thread() {
+    std::lock_guard<std::mutex> lock(reconnect_mutex_);
+    if (reconnect_thread_.joinable()) {
+        return;
+    }
+    // 不清除reconnect_pending_：开启自动重连之前发生的断线由新线程立即处理
+    reconnect_stop_ = false;
+    reconnect_thread_ = std::thread(&DeviceCameraSY011::reconnect_loop, this);
 }
 
-void DeviceCameraSY011::close() {
-    if (handle) {
-        MV_CC_StopGrabbing(handle);
-        MV_CC_CloseDevice(handle);
-        MV_CC_DestroyHandle(handle);
+void DeviceCameraSY011::stop_reconnect_thread() {
+    {
+        std::lock_guard<std::mutex> lock(reconnect_mutex_);
+        if (!reconnect_thread_.joinable()) {
+            return;
+        }
+        reconnect_stop_ = true;
     }
-    MV_CC_Finalize();
+    reconnect_cv_.notify_all();
+    reconnect_thread_.join();
 }
 
-void DeviceCameraSY011::image_callback(unsigned char* pData, MV_FRAME_OUT_INFO_EX& frameInfo, void* pUser) {
+void __stdcall DeviceCameraSY011::exception_callback(unsigned int nMsgType, void* pUser) {
     DeviceCameraSY011* camera_device = static_cast<DeviceCameraSY011*>(pUser);
-    if (camera_device) {
-        camera_device->image_callback_handler(pData, frameInfo);
+    if (!camera_device || nMsgType != MV_EXCEPTION_DEV_DISCONNECT) {
+        return;
+    }
+    std::cerr << "Device disconnected! Exception: [0x" << std::hex << nMsgType << "]" << std::dec << std::endl;
+    camera_device->connected_ = false;
+    // 不能在SDK线程里销毁句柄，交给重连线程处理
+    std::lock_guard<std::mutex> lock(camera_device->reconnect_mutex_);
+    camera_device->reconnect_pending_ = true;
+    camera_device->reconnect_cv_.notify_one();
+}
+
+void DeviceCameraSY011::reconnect_loop() {
+    std::unique_lock<std::mutex> lock(reconnect_mutex_);
+    while (true) {
+        reconnect_cv_.wait(lock, [&] { return reconnect_stop_ || reconnect_pending_; });
+        if (reconnect_stop_) {
+            return;
+        }
+        reconnect_pending_ = false;
+
+        // 设备重新上电、重新枚举需要时间：重试间隔从20ms起加倍，最长1s
+        std::chrono::milliseconds delay(20);
+        while (true) {
+            lock.unlock();
+            bool ok = reconnect();
+            lock.lock();
+            if (ok || reconnect_stop_) {
+                break;
+            }
+            if (reconnect_cv_.wait_for(lock, delay, [&] { return reconnect_stop_; })) {
+                return;
+            }
+            delay = std::min(delay * 2, std::chrono::milliseconds(1000));
+        }
+    }
+}
+
+bool DeviceCameraSY011::reconnect() {
+    std::lock_guard<std::recursive_mutex> lock(device_mutex_);
+    std::string serial = serial_number();
+    if (serial.empty()) {
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    bool resume_acquisition = acquisition_;
+
+    // 旧句柄已失效，只释放它；帧环不关闭，阻塞中的读者继续等待重连后的新帧
+    release_handle();
+    MV_CC_DEVICE_INFO device_info = device_info_;
+    if (!openDevice(device_info)) {
+        // USB重新枚举后设备地址会变，按序列号只重新枚举该传输层
+        if (!SdkRuntime::find_device(serial, device_info.nTLayerType, device_info, true) || !openDevice(device_info)) {
+            return false;
+        }
+    }
+    // 帧环和读游标沿用断线前的：消费者还没读的帧不丢
+    resuming_ = true;
+    reapply_settings();
+
+    bool ok = true;
+    if (grab_wanted_ && resume_acquisition) {
+        std::shared_ptr<FrameRing> ring = current_ring();
+        ok = start_acquisition(ring ? ring->slot_count() : 8);
+    } else if (grab_wanted_) {
+        ok = start_grabbing();
+    }
+    resuming_ = false;
+    if (!ok) {
+        acquisition_ = resume_acquisition;
+        return false;
+    }
+
+    int64_t elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    last_reconnect_us_.store(elapsed_us, std::memory_order_relaxed);
+    reconnect_count_.fetch_add(1, std::memory_order_relaxed);
+    std::cerr << "Device " << serial << " reconnected in " << std::dec << elapsed_us / 1000 << " ms" << std::endl;
+    return true;
+}
+
+void DeviceCameraSY011::reapply_settings() {
+    // 与首次配置的顺序相同：配置文件 -> 像素格式 -> 压缩 -> ROI -> 曝光
+    if (!profile_path_.empty()) {
+        int nRet = MV_CC_FeatureLoadEx(handle, profile_path_.c_str(), NULL);
+        if (nRet != MV_OK) {
+            std::cerr << "Failed to reload profile " << profile_path_ << "! Error Code: [0x" << std::hex << nRet << "]" << std::dec << std::endl;
+        }
+    }
+    set_pixel_format(pixel_format_);
+    if (hb_configured_) {
+        apply_compression_settings();
+    }
+    if (roi_applied_) {
+        set_roi(roi_);
+    }
+    if (exposure_time_ >= 0) {
+        set_exposure_time((int)exposure_time_);
+    }
+    if (trigger_configured_) {
+        apply_trigger_settings();
+    }
+    payload_size_ = query_payload_size();
+}
+
+void __stdcall DeviceCameraSY011::image_callback(unsigned char* pData, MV_FRAME_OUT_INFO_EX* pFrameInfo, void* pUser) {
+    DeviceCameraSY011* camera_device = static_cast<DeviceCameraSY011*>(pUser);
+    if (camera_device && pData && pFrameInfo) {
+        camera_device->image_callback_handler(pData, *pFrameInfo);
     }
 }
 
 void DeviceCameraSY011::image_callback_handler(unsigned char* pData, MV_FRAME_OUT_INFO_EX& frameInfo) {
-    std::lock_guard<std::mutex> lock(image_mutex_);
-    latest_image_ = cv::Mat(frameInfo.nHeight, frameInfo.nWidth, CV_8UC3, pData);
-}
\ No newline at end of file
+    // 回调运行在该设备的SDK取流线程上，第一次回调时按需绑定CPU
+    if (affinity_cpu_ >= 0 && !affinity_applied_.exchange(true)) {
+        pin_current_thread(affinity_cpu_);
+    }
+
+    // HB压缩帧拷进解码池后立即返回，由解码线程按帧序调用deliver_frame
+    if (std::shared_ptr<HbDecoder> decoder = std::atomic_load(&hb_decoder_)) {
+        decoder->submit(pData, frameInfo);
+        return;
+    }
+    deliver_frame(pData, frameInfo);
+}
+
+void DeviceCameraSY011::deliver_frame(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo) {
+    // pData只在回调期间有效，必须在返回前拷贝进环
+    // 交付线程是帧环唯一的生产者，发布前的head就是这一帧的序号
+    note_trigger_delivery();
+    last_trigger_index_.store(frameInfo.nTriggerIndex, std::memory_order_relaxed);
+    std::shared_ptr<FrameRing> ring = current_ring();
+    if (ring) {
+        telemetry_.on_handoff(frameInfo, ring->head());
+        // 统计在帧仍在缓存中时计算，随帧写入环
+        std::shared_ptr<const FrameStatisticsCalculator> statistics = std::atomic_load(&statistics_);
+        FrameStatistics frame_statistics;
+        bool has_statistics = statistics && statistics->compute(pData, frameInfo, frame_statistics);
+        ring->publish(pData, frameInfo, has_statistics ? &frame_statistics : nullptr);
+    }
+    sinks_.dispatch(pData, frameInfo);
+}
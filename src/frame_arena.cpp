@@ -0,0 +1,154 @@
+// frame_arena.cpp
+
+#include "frame_arena.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static const size_t kHugePageSize = 2 * 1024 * 1024;
+
+static size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+FrameArena::~FrameArena() {
+    release();
+}
+
+bool FrameArena::allocate(size_t slot_count, size_t slot_size, size_t alignment, bool huge_pages) {
+    release();
+    if (slot_count == 0 || slot_size == 0) {
+        return false;
+    }
+
+    // 槽起始地址至少按页对齐：SDK要求的对齐、SIMD加载和DMA都满足
+    size_t page_size = 4096;
+#ifdef __linux__
+    page_size = (size_t)sysconf(_SC_PAGESIZE);
+#endif
+    size_t slot_alignment = std::max(alignment, page_size);
+    slot_stride_ = round_up(slot_size, slot_alignment);
+    bytes_ = slot_stride_ * slot_count;
+
+#ifdef __linux__
+    void* p = MAP_FAILED;
+    if (huge_pages) {
+        size_t huge_bytes = round_up(bytes_, kHugePageSize);
+        p = mmap(nullptr, huge_bytes, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+        if (p != MAP_FAILED) {
+            bytes_ = huge_bytes;
+            huge_pages_ = true;
+        }
+    }
+    if (p == MAP_FAILED && huge_pages) {
+        // 没有预留大页时交给透明大页，需在缺页之前请求。透明大页只覆盖2MiB对齐的整块区域，
+        // 而mmap只保证按页对齐：多映射一个大页，裁掉首尾，留下起止都按2MiB对齐的区域
+        size_t huge_bytes = round_up(bytes_, kHugePageSize);
+        void* raw = mmap(nullptr, huge_bytes + kHugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw != MAP_FAILED) {
+            uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+            uintptr_t aligned = (uintptr_t)round_up((size_t)start, kHugePageSize);
+            uintptr_t end = start + huge_bytes + kHugePageSize;
+            if (aligned > start) {
+                munmap(raw, aligned - start);
+            }
+            if (end > aligned + huge_bytes) {
+                munmap(reinterpret_cast<void*>(aligned + huge_bytes), end - (aligned + huge_bytes));
+            }
+            p = reinterpret_cast<void*>(aligned);
+            bytes_ = huge_bytes;
+            madvise(p, bytes_, MADV_HUGEPAGE);
+        }
+    }
+    if (p == MAP_FAILED) {
+        p = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            std::cerr << "Failed to map " << bytes_ << " bytes for the frame arena" << std::endl;
+            bytes_ = 0;
+            return false;
+        }
+    }
+    if (!huge_pages_) {
+        std::memset(p, 0, bytes_);
+    }
+    base_ = static_cast<unsigned char*>(p);
+    mapped_ = true;
+#else
+    (void)huge_pages;
+    base_ = static_cast<unsigned char*>(MV_CC_AllocAlignedBuffer(bytes_, (unsigned int)slot_alignment));
+    if (!base_) {
+        std::cerr << "MV_CC_AllocAlignedBuffer failed for " << bytes_ << " bytes" << std::endl;
+        bytes_ = 0;
+        return false;
+    }
+    std::memset(base_, 0, bytes_);
+#endif
+
+    slot_count_ = slot_count;
+    slot_size_ = slot_size;
+    return true;
+}
+
+void FrameArena::release() {
+    unregister_buffers();
+    if (base_) {
+#ifdef __linux__
+        if (mapped_) {
+            munmap(base_, bytes_);
+        }
+#else
+        MV_CC_FreeAlignedBuffer(base_);
+#endif
+    }
+    base_ = nullptr;
+    bytes_ = 0;
+    slot_count_ = 0;
+    slot_size_ = 0;
+    slot_stride_ = 0;
+    huge_pages_ = false;
+    mapped_ = false;
+}
+
+int FrameArena::slot_index(const void* p) const {
+    const unsigned char* byte = static_cast<const unsigned char*>(p);
+    if (!base_ || byte < base_ || byte >= base_ + slot_stride_ * slot_count_) {
+        return -1;
+    }
+    return (int)((size_t)(byte - base_) / slot_stride_);
+}
+
+bool FrameArena::register_buffers(void* handle) {
+    if (!handle || !base_) {
+        return false;
+    }
+    if (registered_handle_ == handle) {
+        return true;
+    }
+    unregister_buffers();
+
+    registered_handle_ = handle;
+    for (size_t i = 0; i < slot_count_; ++i) {
+        int nRet = MV_CC_RegisterBuffer(handle, slot(i), slot_size_, this);
+        if (nRet != MV_OK) {
+            std::cerr << "MV_CC_RegisterBuffer failed for slot " << std::dec << i << "! Error Code: [0x" << std::hex << nRet << "]" << std::dec << std::endl;
+            unregister_buffers();
+            return false;
+        }
+        ++registered_count_;
+    }
+    return true;
+}
+
+void FrameArena::unregister_buffers() {
+    for (size_t i = 0; i < registered_count_; ++i) {
+        MV_CC_UnRegisterBuffer(registered_handle_, slot(i));
+    }
+    registered_count_ = 0;
+    registered_handle_ = nullptr;
+}
@@ -0,0 +1,503 @@
+// frame_pipeline.cpp
+
+#include "frame_pipeline.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+// 生产者进入/离开计数，与stop()的running_检查配对
+struct ProducerScope {
+    std::atomic<int>& producers;
+    explicit ProducerScope(std::atomic<int>& counter) : producers(counter) { producers.fetch_add(1); }
+    ~ProducerScope() { producers.fetch_sub(1); }
+};
+}
+
+PipelineOutput::PipelineOutput(PipelineOutput&& other) noexcept
+    : pipeline_(other.pipeline_), frame_(other.frame_) {
+    other.pipeline_ = nullptr;
+    other.frame_ = nullptr;
+}
+
+PipelineOutput& PipelineOutput::operator=(PipelineOutput&& other) noexcept {
+    if (this != &other) {
+        release();
+        pipeline_ = other.pipeline_;
+        frame_ = other.frame_;
+        other.pipeline_ = nullptr;
+        other.frame_ = nullptr;
+    }
+    return *this;
+}
+
+void PipelineOutput::release() {
+    if (frame_) {
+        pipeline_->recycle(frame_);
+        frame_ = nullptr;
+        pipeline_ = nullptr;
+    }
+}
+
+FramePipeline::FramePipeline(int num_threads, size_t queue_capacity)
+    : num_threads_(std::max(num_threads, 1)), queue_capacity_(std::max<size_t>(queue_capacity, 1)) {
+    // 解码阶段总是第一个
+    add_stage("decode", [this](PipelineFrame& frame) { decode(frame); });
+}
+
+FramePipeline::~FramePipeline() {
+    stop();
+}
+
+bool FramePipeline::add_stage(const std::string& name, Callback process) {
+    if (configured_) {
+        std::cerr << "Pipeline stages must be added before start()" << std::endl;
+        return false;
+    }
+    std::unique_ptr<Stage> stage(new Stage());
+    stage->name = name;
+    stage->process = std::move(process);
+    stage->input.reset(new BoundedQueue<PipelineFrame*>(queue_capacity_));
+    stages_.push_back(std::move(stage));
+    return true;
+}
+
+bool FramePipeline::add_undistort(std::shared_ptr<ImageUndistorter> undistorter, double alpha,
+                                  int interpolation, bool crop_to_roi) {
+    if (!undistorter || !undistorter->is_loaded()) {
+        std::cerr << "Undistort stage requires loaded calibration parameters" << std::endl;
+        return false;
+    }
+    return add_stage("undistort", [undistorter, alpha, interpolation, crop_to_roi](PipelineFrame& frame) {
+        undistorter->undistort_image(frame.image, frame.scratch, alpha, interpolation, crop_to_roi);
+        std::swap(frame.image, frame.scratch);
+    });
+}
+
+bool FramePipeline::add_undistort(const std::string& calibration_file, double alpha,
+                                  int interpolation, bool crop_to_roi) {
+    return add_undistort(std::make_shared<ImageUndistorter>(calibration_file), alpha, interpolation, crop_to_roi);
+}
+
+bool FramePipeline::add_overlay(const OverlayOptions& options) {
+    // 同一阶段不会并发执行，帧率状态直接放在闭包里
+    int64_t last_us = 0;
+    double interval_us = 0.0;
+    return add_stage("overlay", [options, last_us, interval_us](PipelineFrame& frame) mutable {
+        if (options.crosshair) {
+            ImageUndistorter::draw_crosshair(frame.image, options.crosshair_size, options.color, options.thickness);
+        }
+        int line = 0;
+        if (options.frame_info) {
+            int64_t now_us = FrameTelemetry::steady_now_us();
+            if (last_us > 0) {
+                double delta = (double)(now_us - last_us);
+                interval_us = interval_us > 0.0 ? interval_us * 0.9 + delta * 0.1 : delta;
+            }
+            last_us = now_us;
+            char text[96];
+            std::snprintf(text, sizeof(text), "#%u  %.1f fps", frame.info.nFrameNum,
+                          interval_us > 0.0 ? 1e6 / interval_us : 0.0);
+            cv::putText(frame.image, text, cv::Point(10, 30 + 30 * line++), cv::FONT_HERSHEY_SIMPLEX,
+                        0.8, options.color, options.thickness);
+        }
+        if (!options.text.empty()) {
+            cv::putText(frame.image, options.text, cv::Point(10, 30 + 30 * line++), cv::FONT_HERSHEY_SIMPLEX,
+                        0.8, options.color, options.thickness);
+        }
+    });
+}
+
+bool FramePipeline::add_color_convert(int code) {
+    return add_stage("color_convert", [code](PipelineFrame& frame) {
+        cv::cvtColor(frame.image, frame.scratch, code);
+        std::swap(frame.image, frame.scratch);
+    });
+}
+
+bool FramePipeline::add_resize(const cv::Size& size, int interpolation) {
+    if (size.width <= 0 || size.height <= 0) {
+        std::cerr << "Invalid resize target " << size.width << "x" << size.height << std::endl;
+        return false;
+    }
+    return add_stage("resize", [size, interpolation](PipelineFrame& frame) {
+        if (frame.image.size() == size) {
+            return;
+        }
+        cv::resize(frame.image, frame.scratch, size, 0, 0, interpolation);
+        std::swap(frame.image, frame.scratch);
+    });
+}
+
+bool FramePipeline::add_callback(const std::string& name, Callback callback) {
+    if (!callback) {
+        return false;
+    }
+    return add_stage(name, std::move(callback));
+}
+
+bool FramePipeline::add_statistics(const FrameStatisticsOptions& options) {
+    auto statistics = std::make_shared<FrameStatisticsCalculator>(options);
+    return add_stage("statistics", [statistics](PipelineFrame& frame) {
+        const cv::Mat& image = frame.image;
+        MvGvspPixelType type = image.type() == CV_8UC3 ? PixelType_Gvsp_BGR8_Packed : PixelType_Gvsp_Mono8;
+        frame.statistics.frame_num = frame.info.nFrameNum;
+        if (image.type() != CV_8UC1 && image.type() != CV_8UC3) {
+            frame.statistics.valid = false;
+            return;
+        }
+        statistics->compute(image.data, image.cols, image.rows, image.step[0], type, frame.statistics);
+    });
+}
+
+std::vector<std::string> FramePipeline::stage_names() const {
+    std::vector<std::string> names;
+    for (const auto& stage : stages_) {
+        names.push_back(stage->name);
+    }
+    return names;
+}
+
+bool FramePipeline::start() {
+    if (running_) {
+        return true;
+    }
+    if (!configured_) {
+        // 每个阶段的输入队列和输出队列都可能排满，另加每个阶段正在处理的一帧和调用方持有的几帧
+        size_t stage_count = stages_.size();
+        size_t pool_size = queue_capacity_ * (stage_count + 1) + stage_count + 4;
+        free_.reset(new BoundedQueue<PipelineFrame*>(pool_size));
+        output_.reset(new BoundedQueue<PipelineFrame*>(queue_capacity_));
+        for (size_t i = 0; i < pool_size; ++i) {
+            frames_.emplace_back(new PipelineFrame());
+            free_->push(frames_.back().get());
+        }
+        configured_ = true;
+    }
+    running_ = true;
+    for (int i = 0; i < num_threads_; ++i) {
+        workers_.emplace_back(&FramePipeline::worker_loop, this);
+    }
+    return true;
+}
+
+void FramePipeline::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    // 相机可能仍把本对象当作FrameSink调用：等进行中的on_frame()/submit()返回，之后它们看到running_为false直接返回，
+    // 下面回收队列时不会再有帧入队
+    while (producers_.load() > 0) {
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard<std::mutex> lock(work_mutex_);
+    }
+    work_cv_.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(output_mutex_);
+    }
+    output_cv_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+
+    // 未处理完和未取走的帧归还帧池；调用方持有的PipelineOutput仍然有效
+    PipelineFrame* frame = nullptr;
+    for (auto& stage : stages_) {
+        while (stage->input->pop(frame)) {
+            recycle(frame);
+        }
+    }
+    while (output_->pop(frame)) {
+        recycle(frame);
+    }
+}
+
+void FramePipeline::recycle(PipelineFrame* frame) {
+    // 直接引用raw的图像头必须释放，raw下次可能重新分配
+    const unsigned char* raw_begin = frame->raw.data();
+    const unsigned char* raw_end = raw_begin + frame->raw.size();
+    for (cv::Mat* mat : { &frame->image, &frame->scratch }) {
+        if (mat->data && mat->data >= raw_begin && mat->data < raw_end) {
+            mat->release();
+        }
+    }
+    free_->push(frame);
+}
+
+bool FramePipeline::enqueue(PipelineFrame* frame) {
+    frame->sequence = next_sequence_.fetch_add(1, std::memory_order_relaxed);
+    frame->submit_us = FrameTelemetry::steady_now_us();
+    if (!stages_[0]->input->push(frame)) {
+        recycle(frame);
+        dropped_input_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    notify_work();
+    return true;
+}
+
+void FramePipeline::on_frame(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo) {
+    ProducerScope scope(producers_);
+    if (!running_ || !pData) {
+        return;
+    }
+    PipelineFrame* frame = nullptr;
+    if (!free_->pop(frame)) {
+        dropped_input_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // raw容量只增不减，同尺寸的帧不再分配
+    frame->raw.resize(frameInfo.nFrameLen);
+    std::memcpy(frame->raw.data(), pData, frameInfo.nFrameLen);
+    frame->info = frameInfo;
+    frame->from_raw = true;
+    enqueue(frame);
+}
+
+bool FramePipeline::submit(const cv::Mat& image, const MV_FRAME_OUT_INFO_EX* frameInfo) {
+    ProducerScope scope(producers_);
+    if (!running_ || image.empty() || image.depth() != CV_8U || (image.channels() != 1 && image.channels() != 3)) {
+        return false;
+    }
+    PipelineFrame* frame = nullptr;
+    if (!free_->pop(frame)) {
+        dropped_input_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    image.copyTo(frame->image);
+    if (frameInfo) {
+        frame->info = *frameInfo;
+    } else {
+        frame->info = MV_FRAME_OUT_INFO_EX();
+        frame->info.nWidth = (unsigned short)image.cols;
+        frame->info.nHeight = (unsigned short)image.rows;
+        frame->info.enPixelType = image.channels() == 1 ? PixelType_Gvsp_Mono8 : PixelType_Gvsp_BGR8_Packed;
+        frame->info.nFrameNum = (unsigned int)next_sequence_.load(std::memory_order_relaxed);
+    }
+    frame->from_raw = false;
+    return enqueue(frame);
+}
+
+void FramePipeline::decode(PipelineFrame& frame) {
+    if (!frame.from_raw) {
+        return;
+    }
+    int width = frame.info.nWidth;
+    int height = frame.info.nHeight;
+    MvGvspPixelType pixel_type = frame.info.enPixelType;
+    int channels = (pixel_type == PixelType_Gvsp_BGR8_Packed || pixel_type == PixelType_Gvsp_RGB8_Packed) ? 3 : 1;
+    if ((size_t)width * height * channels > frame.raw.size()) {
+        std::cerr << "Pipeline frame " << frame.info.nFrameNum << " is truncated" << std::endl;
+        frame.image.release();
+        return;
+    }
+
+    // BGR8/Mono8直接引用raw，不拷贝；image原有的缓冲区留给scratch，下一个非原地阶段复用
+    cv::Mat raw(height, width, CV_8UC(channels), frame.raw.data());
+    if (frame.scratch.empty()) {
+        std::swap(frame.image, frame.scratch);
+    }
+    if (pixel_type == PixelType_Gvsp_BGR8_Packed) {
+        frame.image = raw;
+    } else if (pixel_type == PixelType_Gvsp_RGB8_Packed) {
+        cv::cvtColor(raw, frame.image, cv::COLOR_RGB2BGR);
+    } else if (pixel_type == PixelType_Gvsp_Mono8) {
+        if (mono_to_bgr_) {
+            cv::cvtColor(raw, frame.image, cv::COLOR_GRAY2BGR);
+        } else {
+            frame.image = raw;
+        }
+    } else if (BayerDemosaicer::is_bayer8(pixel_type)) {
+        cv::Size size(width, height);
+        if (!demosaicer_.is_configured() || demosaicer_.input_size() != size || demosaic_type_ != pixel_type) {
+            demosaicer_.configure(size, pixel_type, size);
+            demosaic_type_ = pixel_type;
+        }
+        if (!demosaicer_.process(frame.raw.data(), width, frame.image)) {
+            frame.image.release();
+        }
+    } else {
+        std::cerr << "Unsupported pixel type for pipeline: 0x" << std::hex << pixel_type << std::dec << std::endl;
+        frame.image.release();
+    }
+}
+
+bool FramePipeline::runnable(size_t index) const {
+    const Stage& stage = *stages_[index];
+    if (stage.busy.load(std::memory_order_relaxed) || stage.input->empty()) {
+        return false;
+    }
+    // 输出队列满时丢弃最旧的结果，不阻塞最后一个阶段
+    return index + 1 == stages_.size() ||
+           stages_[index + 1]->input->size() < stages_[index + 1]->input->capacity();
+}
+
+bool FramePipeline::has_work() const {
+    for (size_t i = 0; i < stages_.size(); ++i) {
+        if (runnable(i)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FramePipeline::run_stage(size_t index) {
+    Stage& stage = *stages_[index];
+    if (!runnable(index) || stage.busy.exchange(true, std::memory_order_acquire)) {
+        return false;
+    }
+    // 只有持有busy的线程从该阶段出队并向下一阶段入队，所以顺序不变，且下一阶段的队列不会被其他线程填满
+    PipelineFrame* frame = nullptr;
+    if (!stage.input->pop(frame)) {
+        stage.busy.store(false, std::memory_order_release);
+        return false;
+    }
+
+    int64_t begin_us = FrameTelemetry::steady_now_us();
+    bool ok = true;
+    try {
+        stage.process(*frame);
+        ok = !frame->image.empty();
+    } catch (const std::exception& e) {
+        std::cerr << "Pipeline stage '" << stage.name << "' failed: " << e.what() << std::endl;
+        ok = false;
+    }
+    stage.latency.record((uint64_t)std::max<int64_t>(FrameTelemetry::steady_now_us() - begin_us, 0));
+    stage.processed.fetch_add(1, std::memory_order_relaxed);
+
+    if (!ok) {
+        failed_.fetch_add(1, std::memory_order_relaxed);
+        recycle(frame);
+    } else if (index + 1 < stages_.size()) {
+        // runnable()已确认下一阶段有空位；仍然失败时与入口相同：归还帧池并计数，不能让帧丢出帧池
+        if (!stages_[index + 1]->input->push(frame)) {
+            recycle(frame);
+            dropped_stage_.fetch_add(1, std::memory_order_relaxed);
+        }
+    } else {
+        deliver(frame);
+    }
+    stage.busy.store(false, std::memory_order_release);
+    return true;
+}
+
+void FramePipeline::deliver(PipelineFrame* frame) {
+    end_to_end_.record((uint64_t)std::max<int64_t>(FrameTelemetry::steady_now_us() - frame->submit_us, 0));
+    completed_.fetch_add(1, std::memory_order_relaxed);
+    while (!output_->push(frame)) {
+        PipelineFrame* oldest = nullptr;
+        if (output_->pop(oldest)) {
+            recycle(oldest);
+            dropped_output_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    notify_output();
+}
+
+void FramePipeline::notify_work() {
+    // 与等待方的work_waiters_递增配对：二者之一必然看到对方的写入
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (work_waiters_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(work_mutex_);
+        work_cv_.notify_all();
+    }
+}
+
+void FramePipeline::notify_output() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (output_waiters_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        output_cv_.notify_all();
+    }
+}
+
+void FramePipeline::worker_loop() {
+    while (running_) {
+        bool worked = false;
+        // 从下游往上游扫描，优先腾出下游队列
+        for (size_t i = stages_.size(); i-- > 0;) {
+            if (run_stage(i)) {
+                worked = true;
+            }
+        }
+        if (worked) {
+            notify_work();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(work_mutex_);
+        work_waiters_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        work_cv_.wait_for(lock, std::chrono::milliseconds(10), [this] { return !running_ || has_work(); });
+        work_waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+PipelineFrame* FramePipeline::wait_output(unsigned int timeout_ms) {
+    PipelineFrame* frame = nullptr;
+    if (!output_) {
+        return nullptr;
+    }
+    if (output_->pop(frame)) {
+        return frame;
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    std::unique_lock<std::mutex> lock(output_mutex_);
+    output_waiters_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (!output_->pop(frame)) {
+        if (!running_ || output_cv_.wait_until(lock, deadline) == std::cv_status::timeout) {
+            if (!output_->pop(frame)) {
+                frame = nullptr;
+            }
+            break;
+        }
+    }
+    output_waiters_.fetch_sub(1, std::memory_order_relaxed);
+    return frame;
+}
+
+PipelineOutput FramePipeline::read(unsigned int timeout_ms) {
+    PipelineFrame* frame = wait_output(timeout_ms);
+    return frame ? PipelineOutput(this, frame) : PipelineOutput();
+}
+
+PipelineOutput FramePipeline::read_latest(unsigned int timeout_ms) {
+    PipelineFrame* frame = wait_output(timeout_ms);
+    if (!frame) {
+        return PipelineOutput();
+    }
+    PipelineFrame* newer = nullptr;
+    while (output_->pop(newer)) {
+        recycle(frame);
+        frame = newer;
+    }
+    return PipelineOutput(this, frame);
+}
+
+PipelineStats FramePipeline::stats() const {
+    PipelineStats stats;
+    stats.submitted = submitted_.load(std::memory_order_relaxed);
+    stats.completed = completed_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.dropped_input = dropped_input_.load(std::memory_order_relaxed);
+    stats.dropped_stage = dropped_stage_.load(std::memory_order_relaxed);
+    stats.dropped_output = dropped_output_.load(std::memory_order_relaxed);
+    stats.output_depth = output_ ? output_->size() : 0;
+    stats.end_to_end = end_to_end_.summary();
+    for (const auto& stage : stages_) {
+        PipelineStageStats stage_stats;
+        stage_stats.name = stage->name;
+        stage_stats.processed = stage->processed.load(std::memory_order_relaxed);
+        stage_stats.queue_depth = stage->input->size();
+        stage_stats.latency = stage->latency.summary();
+        stats.stages.push_back(stage_stats);
+    }
+    return stats;
+}
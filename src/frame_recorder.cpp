@@ -0,0 +1,442 @@
+// frame_recorder.cpp
+
+#include "frame_recorder.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+static const char kChunkMagic[8] = { 'H', 'K', 'R', 'A', 'W', 'C', 'H', 'K' };
+static const char kTrailerMagic[8] = { 'H', 'K', 'R', 'A', 'W', 'E', 'N', 'D' };
+static const uint32_t kRawFormatVersion = 1;
+static const size_t kMaxBatchFrames = 16;
+
+static uint64_t align_up(uint64_t value) {
+    return (value + kRawRecordAlignment - 1) & ~(kRawRecordAlignment - 1);
+}
+
+// pwritev直到全部写完（处理部分写入和IOV_MAX）
+static bool pwritev_all(int fd, std::vector<iovec>& iov, uint64_t offset) {
+    size_t first = 0;
+    while (first < iov.size()) {
+        int count = (int)std::min<size_t>(iov.size() - first, IOV_MAX);
+        ssize_t written = pwritev(fd, &iov[first], count, (off_t)offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        offset += (uint64_t)written;
+        size_t remaining = (size_t)written;
+        while (first < iov.size() && remaining >= iov[first].iov_len) {
+            remaining -= iov[first].iov_len;
+            ++first;
+        }
+        if (remaining > 0) {
+            iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + remaining;
+            iov[first].iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+FrameRecorder::FrameRecorder() {}
+
+FrameRecorder::~FrameRecorder() {
+    stop();
+}
+
+std::string FrameRecorder::chunk_path(const std::string& base_path, uint32_t chunk_index) {
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "_%05u.hkraw", chunk_index);
+    return base_path + suffix;
+}
+
+bool FrameRecorder::start(const std::string& base_path, size_t slot_size, size_t queue_slots, uint64_t chunk_size) {
+    if (running_ || writer_.joinable()) {
+        std::cerr << "Recorder is already running!" << std::endl;
+        return false;
+    }
+    if (slot_size == 0) {
+        std::cerr << "Recorder slot size must be non-zero!" << std::endl;
+        return false;
+    }
+
+    base_path_ = base_path;
+    chunk_size_ = std::max<uint64_t>(chunk_size, align_up(slot_size + sizeof(RawRecordHeader)) + 2 * kRawRecordAlignment);
+    slots_.clear();
+    slots_.resize(std::max<size_t>(queue_slots, 2));
+    for (Slot& slot : slots_) {
+        slot.data.resize(slot_size);
+        std::memset(&slot.info, 0, sizeof(slot.info));
+    }
+    head_ = 0;
+    tail_ = 0;
+    dropped_ = 0;
+    written_ = 0;
+    failed_ = 0;
+    last_error_ = 0;
+    bytes_written_ = 0;
+    chunks_ = 0;
+    chunk_index_ = 0;
+    frame_index_ = 0;
+
+    // 在调用线程上打开第一个分块，路径错误等问题可以立即返回
+    if (!open_chunk()) {
+        return false;
+    }
+    running_ = true;
+    writer_ = std::thread(&FrameRecorder::writer_loop, this);
+    return true;
+}
+
+void FrameRecorder::stop() {
+    if (!writer_.joinable()) {
+        return;
+    }
+    running_ = false;
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        wait_cv_.notify_all();
+    }
+    writer_.join();
+}
+
+bool FrameRecorder::submit(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo) {
+    if (!running_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    size_t length = frameInfo.nFrameLen;
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    if (length > slots_[0].data.size() || head - tail_.load(std::memory_order_acquire) >= slots_.size()) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Slot& slot = slots_[head % slots_.size()];
+    std::memcpy(slot.data.data(), pData, length);
+    slot.length = length;
+    slot.info = frameInfo;
+
+    // 与writer_loop中的writer_waiting_/head_组成seq_cst配对，避免丢失唤醒
+    head_.store(head + 1);
+    if (writer_waiting_.load()) {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        wait_cv_.notify_one();
+    }
+    return true;
+}
+
+void FrameRecorder::writer_loop() {
+    while (true) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        uint64_t head = head_.load(std::memory_order_acquire);
+        if (tail == head) {
+            if (!running_) {
+                break;
+            }
+            writer_waiting_.store(true);
+            {
+                std::unique_lock<std::mutex> lock(wait_mutex_);
+                wait_cv_.wait_for(lock, std::chrono::milliseconds(100),
+                                  [&] { return head_.load() != tail || !running_.load(); });
+            }
+            writer_waiting_.store(false);
+            continue;
+        }
+
+        uint64_t end = std::min<uint64_t>(head, tail + kMaxBatchFrames);
+        write_batch(tail, end);
+        tail_.store(end, std::memory_order_release);
+    }
+    finish_chunk();
+}
+
+bool FrameRecorder::write_batch(uint64_t begin, uint64_t end) {
+    static const unsigned char zeros[kRawRecordAlignment] = {};
+
+    std::vector<iovec> iov;
+    iov.reserve((size_t)(end - begin) * 3);
+    record_headers_.resize((size_t)(end - begin));
+    // 本批待写的索引项：只有pwritev成功后才并入index_并计入统计，尾部索引不会指向未落盘的记录
+    std::vector<RawIndexEntry> pending;
+    pending.reserve((size_t)(end - begin));
+    uint64_t pending_bytes = 0;
+    uint64_t batch_offset = write_offset_;
+    uint64_t batch_bytes = 0;
+    bool ok = true;
+
+    auto flush = [&]() {
+        if (iov.empty()) {
+            return;
+        }
+        if (fd_ >= 0 && pwritev_all(fd_, iov, batch_offset)) {
+            write_offset_ = batch_offset + batch_bytes;
+            index_.insert(index_.end(), pending.begin(), pending.end());
+            frame_index_ += pending.size();
+            written_.fetch_add(pending.size(), std::memory_order_relaxed);
+            bytes_written_.fetch_add(pending_bytes, std::memory_order_relaxed);
+#ifdef __linux__
+            // 尽早开始回写本批；上一批回写完成后从页缓存中丢弃，长时间录像不会挤占内存
+            sync_file_range(fd_, (off64_t)batch_offset, (off64_t)batch_bytes, SYNC_FILE_RANGE_WRITE);
+            if (batch_offset > synced_offset_) {
+                sync_file_range(fd_, (off64_t)synced_offset_, (off64_t)(batch_offset - synced_offset_),
+                                SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+                posix_fadvise(fd_, (off_t)synced_offset_, (off_t)(batch_offset - synced_offset_), POSIX_FADV_DONTNEED);
+                synced_offset_ = batch_offset;
+            }
+#endif
+        } else {
+            // 写入失败：这些帧不进索引，write_offset_不前进，下一批覆盖写失败的区域
+            int error = fd_ >= 0 ? errno : EBADF;
+            std::cerr << "Failed to write recording chunk: " << std::strerror(error) << std::endl;
+            failed_.fetch_add(pending.size(), std::memory_order_relaxed);
+            last_error_.store(error, std::memory_order_relaxed);
+            ok = false;
+        }
+        iov.clear();
+        pending.clear();
+        pending_bytes = 0;
+        batch_offset = write_offset_;
+        batch_bytes = 0;
+    };
+
+    for (uint64_t s = begin; s < end; ++s) {
+        Slot& slot = slots_[s % slots_.size()];
+        uint64_t record_size = sizeof(RawRecordHeader) + slot.length;
+        uint64_t padded_size = align_up(record_size);
+
+        // 分块写满（需为尾部索引留出空间）时切换到下一个分块
+        size_t records = index_.size() + pending.size();
+        uint64_t index_bytes = (records + 1) * sizeof(RawIndexEntry) + sizeof(RawChunkTrailer);
+        if (records > 0 && batch_offset + batch_bytes + padded_size + index_bytes > chunk_size_) {
+            flush();
+            finish_chunk();
+            if (!open_chunk()) {
+                // 本批剩余的帧无处可写
+                failed_.fetch_add(end - s, std::memory_order_relaxed);
+                last_error_.store(errno, std::memory_order_relaxed);
+                return false;
+            }
+            batch_offset = write_offset_;
+        }
+
+        RawRecordHeader& header = record_headers_[(size_t)(s - begin)];
+        std::memset(&header, 0, sizeof(header));
+        header.magic = kRawRecordMagic;
+        header.header_size = sizeof(RawRecordHeader);
+        header.length = slot.length;
+        header.frame_index = frame_index_ + pending.size();
+        header.info = slot.info;
+
+        iov.push_back({ &header, sizeof(header) });
+        if (slot.length > 0) {
+            iov.push_back({ slot.data.data(), slot.length });
+        }
+        if (padded_size > record_size) {
+            iov.push_back({ const_cast<unsigned char*>(zeros), (size_t)(padded_size - record_size) });
+        }
+
+        RawIndexEntry entry;
+        entry.data_offset = batch_offset + batch_bytes + sizeof(RawRecordHeader);
+        entry.length = slot.length;
+        entry.info = slot.info;
+        pending.push_back(entry);
+
+        batch_bytes += padded_size;
+        pending_bytes += slot.length;
+    }
+    flush();
+    return ok;
+}
+
+bool FrameRecorder::open_chunk() {
+    std::string path = chunk_path(base_path_, chunk_index_);
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Failed to create recording chunk " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+#ifdef __linux__
+    // 预分配整个分块，避免写入过程中文件系统反复分配块；不支持时忽略
+    fallocate(fd_, 0, 0, (off_t)chunk_size_);
+#endif
+
+    std::vector<unsigned char> page(kRawRecordAlignment, 0);
+    RawChunkHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kChunkMagic, sizeof(header.magic));
+    header.version = kRawFormatVersion;
+    header.chunk_index = chunk_index_;
+    header.record_alignment = kRawRecordAlignment;
+    std::memcpy(page.data(), &header, sizeof(header));
+    if (pwrite(fd_, page.data(), page.size(), 0) != (ssize_t)page.size()) {
+        std::cerr << "Failed to write recording chunk header: " << path << std::endl;
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    write_offset_ = kRawRecordAlignment;
+    synced_offset_ = kRawRecordAlignment;
+    index_.clear();
+    chunks_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool FrameRecorder::finish_chunk() {
+    if (fd_ < 0) {
+        return true;
+    }
+
+    RawChunkTrailer trailer;
+    std::memset(&trailer, 0, sizeof(trailer));
+    trailer.index_offset = write_offset_;
+    trailer.frame_count = index_.size();
+    std::memcpy(trailer.magic, kTrailerMagic, sizeof(trailer.magic));
+
+    std::vector<iovec> iov;
+    if (!index_.empty()) {
+        iov.push_back({ index_.data(), index_.size() * sizeof(RawIndexEntry) });
+    }
+    iov.push_back({ &trailer, sizeof(trailer) });
+    uint64_t end = write_offset_ + index_.size() * sizeof(RawIndexEntry) + sizeof(trailer);
+
+    bool ok = pwritev_all(fd_, iov, write_offset_);
+    // 截掉预分配但未使用的部分
+    if (!ok || ftruncate(fd_, (off_t)end) != 0) {
+        std::cerr << "Failed to finalize recording chunk " << chunk_path(base_path_, chunk_index_) << std::endl;
+        ok = false;
+    }
+    ::close(fd_);
+    fd_ = -1;
+    index_.clear();
+    ++chunk_index_;
+    return ok;
+}
+
+RecorderStats FrameRecorder::stats() const {
+    RecorderStats stats;
+    stats.submitted = head_.load(std::memory_order_relaxed);
+    stats.written = written_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.last_error = last_error_.load(std::memory_order_relaxed);
+    stats.bytes_written = bytes_written_.load(std::memory_order_relaxed);
+    stats.chunks = chunks_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+size_t FrameRecorder::queue_depth() const {
+    return (size_t)(head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_relaxed));
+}
+
+RawRecording::~RawRecording() {
+    close();
+}
+
+bool RawRecording::open(const std::string& path) {
+    close();
+    struct stat st;
+    if (path.size() > 6 && path.compare(path.size() - 6, 6, ".hkraw") == 0 && ::stat(path.c_str(), &st) == 0) {
+        map_chunk(path);
+    } else {
+        for (uint32_t i = 0;; ++i) {
+            std::string chunk = FrameRecorder::chunk_path(path, i);
+            if (::stat(chunk.c_str(), &st) != 0 || !map_chunk(chunk)) {
+                break;
+            }
+        }
+    }
+    if (mappings_.empty()) {
+        std::cerr << "No recording found at " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool RawRecording::map_chunk(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < kRawRecordAlignment) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = (size_t)st.st_size;
+    void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        std::cerr << "Failed to map recording chunk " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    Mapping mapping;
+    mapping.base = static_cast<unsigned char*>(base);
+    mapping.size = size;
+    if (std::memcmp(mapping.base, kChunkMagic, sizeof(kChunkMagic)) != 0) {
+        std::cerr << "Not a raw recording chunk: " << path << std::endl;
+        munmap(base, size);
+        return false;
+    }
+    mappings_.push_back(mapping);
+
+    RawChunkTrailer trailer;
+    std::memcpy(&trailer, mapping.base + size - sizeof(trailer), sizeof(trailer));
+    bool indexed = std::memcmp(trailer.magic, kTrailerMagic, sizeof(kTrailerMagic)) == 0 &&
+                   trailer.index_offset + trailer.frame_count * sizeof(RawIndexEntry) + sizeof(trailer) <= size;
+    if (indexed) {
+        for (uint64_t i = 0; i < trailer.frame_count; ++i) {
+            RawIndexEntry entry;
+            std::memcpy(&entry, mapping.base + trailer.index_offset + i * sizeof(RawIndexEntry), sizeof(entry));
+            if (entry.data_offset + entry.length > trailer.index_offset) {
+                break;
+            }
+            frames_.push_back({ mapping.base + entry.data_offset, entry.length, entry.info });
+        }
+        return true;
+    }
+
+    // 没有尾部索引（录像未正常结束）：按记录头顺序扫描
+    uint64_t offset = kRawRecordAlignment;
+    while (offset + sizeof(RawRecordHeader) <= size) {
+        RawRecordHeader header;
+        std::memcpy(&header, mapping.base + offset, sizeof(header));
+        if (header.magic != kRawRecordMagic || header.header_size != sizeof(RawRecordHeader) ||
+            offset + header.header_size + header.length > size) {
+            break;
+        }
+        frames_.push_back({ mapping.base + offset + header.header_size, header.length, header.info });
+        offset = align_up(offset + header.header_size + header.length);
+    }
+    return true;
+}
+
+void RawRecording::close() {
+    for (Mapping& mapping : mappings_) {
+        munmap(mapping.base, mapping.size);
+    }
+    mappings_.clear();
+    frames_.clear();
+}
+
+const unsigned char* RawRecording::frame(size_t index, size_t& length, MV_FRAME_OUT_INFO_EX& frameInfo) const {
+    if (index >= frames_.size()) {
+        return nullptr;
+    }
+    const FrameRef& ref = frames_[index];
+    length = (size_t)ref.length;
+    frameInfo = ref.info;
+    return ref.data;
+}
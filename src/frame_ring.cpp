@@ -0,0 +1,280 @@
+// frame_ring.cpp
+
+#include "frame_ring.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+FrameRing::FrameRing(size_t slot_count, size_t slot_size, bool huge_pages)
+    : slot_count_(std::max<size_t>(slot_count, 2)),
+      slot_size_(slot_size),
+      slots_(new Slot[std::max<size_t>(slot_count, 2)]) {
+    if (!storage_.allocate(slot_count_, slot_size_, 64, huge_pages)) {
+        slot_size_ = 0;     // 所有帧按超出槽大小拒绝
+    }
+    for (size_t i = 0; i < slot_count_; ++i) {
+        std::memset(&slots_[i].info, 0, sizeof(MV_FRAME_OUT_INFO_EX));
+        slots_[i].data = storage_.empty() ? nullptr : storage_.slot(i);
+    }
+}
+
+bool FrameRing::publish(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo,
+                        const FrameStatistics* statistics) {
+    size_t length = frameInfo.nFrameLen;
+    if (length > slot_size_) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint64_t sequence = head_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[sequence % slot_count_];
+    if (sequence >= slot_count_ && !slot.consumed.load(std::memory_order_relaxed)) {
+        overwritten_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    slot.version.store(2 * sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(slot.data, pData, length);
+    slot.info = frameInfo;
+    if (statistics) {
+        slot.statistics = *statistics;
+    } else {
+        slot.statistics.valid = false;
+    }
+    slot.length = length;
+    slot.consumed.store(false, std::memory_order_relaxed);
+    slot.version.store(2 * sequence + 2, std::memory_order_release);
+
+    // seq_cst store/load pair with wait_for() so a reader going to sleep is never missed
+    head_.store(sequence + 1);
+    if (waiters_.load() > 0) {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        wait_cv_.notify_all();
+    }
+    return true;
+}
+
+FrameRing::ReadResult FrameRing::read_slot(uint64_t sequence, unsigned char* pData, size_t size,
+                                           MV_FRAME_OUT_INFO_EX& frameInfo, FrameStatistics* statistics) {
+    Slot& slot = slots_[sequence % slot_count_];
+    const uint64_t expected = 2 * sequence + 2;
+
+    if (slot.version.load(std::memory_order_acquire) != expected) {
+        return ReadResult::Overwritten;
+    }
+    size_t length = std::min(slot.length, slot_size_);
+    if (length > size) {
+        return ReadResult::TooSmall;
+    }
+    std::memcpy(pData, slot.data, length);
+    MV_FRAME_OUT_INFO_EX info = slot.info;
+    FrameStatistics frame_statistics;
+    if (statistics) {
+        frame_statistics = slot.statistics;
+    }
+
+    // 版本号未变说明拷贝期间该槽没有被生产者改写
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.version.load(std::memory_order_relaxed) != expected) {
+        return ReadResult::Overwritten;
+    }
+    frameInfo = info;
+    if (statistics) {
+        *statistics = frame_statistics;
+    }
+    slot.consumed.store(true, std::memory_order_relaxed);
+    return ReadResult::Ok;
+}
+
+bool FrameRing::read_latest(unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo, uint64_t* sequence,
+                            FrameStatistics* statistics) {
+    // 读取过程中被覆盖时重试更新的一帧
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        if (head == 0) {
+            return false;
+        }
+        ReadResult result = read_slot(head - 1, pData, size, frameInfo, statistics);
+        if (result == ReadResult::Ok) {
+            if (sequence) {
+                *sequence = head - 1;
+            }
+            return true;
+        }
+        if (result == ReadResult::TooSmall) {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool FrameRing::read_next(uint64_t& cursor, unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo,
+                          unsigned int timeout_ms, FrameStatistics* statistics) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true) {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        if (cursor >= head) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                return false;
+            }
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+            if (!wait_for(cursor, (unsigned int)remaining + 1)) {
+                return false;
+            }
+            continue;
+        }
+
+        // 落后超过环长度：跳到仍保留在环中的最旧一帧
+        if (head - cursor > slot_count_) {
+            dropped_.fetch_add(head - slot_count_ - cursor, std::memory_order_relaxed);
+            cursor = head - slot_count_;
+        }
+
+        ReadResult result = read_slot(cursor, pData, size, frameInfo, statistics);
+        if (result == ReadResult::Ok) {
+            ++cursor;
+            return true;
+        }
+        if (result == ReadResult::TooSmall) {
+            return false;
+        }
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        ++cursor;
+    }
+}
+
+bool FrameRing::read(uint64_t sequence, unsigned char* pData, size_t size, MV_FRAME_OUT_INFO_EX& frameInfo) {
+    if (sequence >= head_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    return read_slot(sequence, pData, size, frameInfo) == ReadResult::Ok;
+}
+
+bool FrameRing::peek_info(uint64_t sequence, MV_FRAME_OUT_INFO_EX& frameInfo) {
+    if (sequence >= head_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    Slot& slot = slots_[sequence % slot_count_];
+    const uint64_t expected = 2 * sequence + 2;
+    if (slot.version.load(std::memory_order_acquire) != expected) {
+        return false;
+    }
+    MV_FRAME_OUT_INFO_EX info = slot.info;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.version.load(std::memory_order_relaxed) != expected) {
+        return false;
+    }
+    frameInfo = info;
+    return true;
+}
+
+bool FrameRing::read_statistics(uint64_t sequence, FrameStatistics& statistics) {
+    if (sequence >= head_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    Slot& slot = slots_[sequence % slot_count_];
+    const uint64_t expected = 2 * sequence + 2;
+    if (slot.version.load(std::memory_order_acquire) != expected || !slot.statistics.valid) {
+        return false;
+    }
+    FrameStatistics copy = slot.statistics;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.version.load(std::memory_order_relaxed) != expected) {
+        return false;
+    }
+    statistics = copy;
+    return statistics.valid;
+}
+
+bool FrameRing::find_frame(unsigned int frame_num, uint64_t& sequence) {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint64_t oldest = head > slot_count_ ? head - slot_count_ : 0;
+    MV_FRAME_OUT_INFO_EX info;
+    for (uint64_t s = head; s > oldest; --s) {
+        if (peek_info(s - 1, info) && info.nFrameNum == frame_num) {
+            sequence = s - 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FrameRing::find_frame(const MV_FRAME_OUT_INFO_EX& frameInfo, uint64_t& sequence) {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint64_t oldest = head > slot_count_ ? head - slot_count_ : 0;
+    MV_FRAME_OUT_INFO_EX info;
+    for (uint64_t s = head; s > oldest; --s) {
+        if (peek_info(s - 1, info) && info.nFrameNum == frameInfo.nFrameNum &&
+            info.nDevTimeStampHigh == frameInfo.nDevTimeStampHigh && info.nDevTimeStampLow == frameInfo.nDevTimeStampLow &&
+            info.nHostTimeStamp == frameInfo.nHostTimeStamp) {
+            sequence = s - 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FrameRing::find_closest(uint64_t timestamp, bool host_timestamp, uint64_t& sequence, uint64_t& found_timestamp) {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint64_t oldest = head > slot_count_ ? head - slot_count_ : 0;
+    bool found = false;
+    uint64_t best_distance = 0;
+
+    // 从最新往旧查找，时间戳单调时一旦距离开始变大即可停止
+    for (uint64_t s = head; s > oldest; --s) {
+        MV_FRAME_OUT_INFO_EX info;
+        if (!peek_info(s - 1, info)) {
+            continue;
+        }
+        uint64_t ts = frame_timestamp(info, host_timestamp);
+        uint64_t distance = ts > timestamp ? ts - timestamp : timestamp - ts;
+        if (found && distance > best_distance && ts < timestamp) {
+            break;
+        }
+        if (!found || distance < best_distance) {
+            found = true;
+            best_distance = distance;
+            sequence = s - 1;
+            found_timestamp = ts;
+        }
+    }
+    return found;
+}
+
+uint64_t FrameRing::frame_timestamp(const MV_FRAME_OUT_INFO_EX& frameInfo, bool host_timestamp) {
+    if (host_timestamp) {
+        return (uint64_t)frameInfo.nHostTimeStamp;
+    }
+    return ((uint64_t)frameInfo.nDevTimeStampHigh << 32) | frameInfo.nDevTimeStampLow;
+}
+
+bool FrameRing::wait_for(uint64_t sequence, unsigned int timeout_ms) {
+    if (head_.load() > sequence) {
+        return true;
+    }
+    waiters_.fetch_add(1);
+    bool ready;
+    {
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        ready = wait_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                                  [&] { return head_.load() > sequence || closed_.load(); });
+    }
+    waiters_.fetch_sub(1);
+    return ready && head_.load() > sequence;
+}
+
+FrameRingStats FrameRing::stats() const {
+    FrameRingStats stats;
+    stats.published = head_.load(std::memory_order_relaxed);
+    stats.overwritten = overwritten_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void FrameRing::close() {
+    closed_.store(true);
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    wait_cv_.notify_all();
+}
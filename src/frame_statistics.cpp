@@ -0,0 +1,428 @@
+// frame_statistics.cpp
+
+#include "frame_statistics.h"
+#include "bayer_pipeline.h"
+#include "frame_telemetry.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#define FRAME_STATISTICS_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#define FRAME_STATISTICS_NEON 1
+#include <arm_neon.h>
+#endif
+
+// 每块的采样点数：块内16位累加不会溢出，9个缓冲区共4.5KB，留在L1中
+static const int kChunk = 256;
+
+// 一块采样点及其相邻像素的亮度；只有对焦度量需要的相邻缓冲区会被填写
+struct SampleChunk {
+    int count = 0;
+    alignas(16) int16_t c[kChunk];
+    alignas(16) int16_t l[kChunk];
+    alignas(16) int16_t r[kChunk];
+    alignas(16) int16_t u[kChunk];
+    alignas(16) int16_t d[kChunk];
+    alignas(16) int16_t ul[kChunk];
+    alignas(16) int16_t ur[kChunk];
+    alignas(16) int16_t dl[kChunk];
+    alignas(16) int16_t dr[kChunk];
+};
+
+struct StatisticsSums {
+    uint64_t sum = 0;
+    uint64_t saturated = 0;
+    int64_t focus_sum = 0;          // 拉普拉斯之和（求方差用）
+    uint64_t focus_squares = 0;     // 拉普拉斯平方和，或Sobel梯度平方和
+};
+
+static void accumulate_scalar(const SampleChunk& chunk, int begin, FocusMeasure focus, int level, StatisticsSums& sums) {
+    for (int k = begin; k < chunk.count; ++k) {
+        int c = chunk.c[k];
+        sums.sum += (uint64_t)c;
+        sums.saturated += c >= level ? 1 : 0;
+        if (focus == FocusMeasure::LaplacianVariance) {
+            int lap = 4 * c - chunk.l[k] - chunk.r[k] - chunk.u[k] - chunk.d[k];
+            sums.focus_sum += lap;
+            sums.focus_squares += (uint64_t)(lap * lap);
+        } else if (focus == FocusMeasure::Tenengrad) {
+            int gx = (chunk.ur[k] + 2 * chunk.r[k] + chunk.dr[k]) - (chunk.ul[k] + 2 * chunk.l[k] + chunk.dl[k]);
+            int gy = (chunk.dl[k] + 2 * chunk.d[k] + chunk.dr[k]) - (chunk.ul[k] + 2 * chunk.u[k] + chunk.ur[k]);
+            sums.focus_squares += (uint64_t)(gx * gx + gy * gy);
+        }
+    }
+}
+
+#if defined(FRAME_STATISTICS_SSE2)
+
+static int64_t horizontal_sum_epi32(__m128i v) {
+    alignas(16) int32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+    return (int64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+// 亮度与拉普拉斯在16位通道内计算（|lap| <= 1020，Sobel分量 <= 1020），平方和用pmaddwd累加到32位：
+// 每块最多32次迭代，单个32位通道最多累加32 * 4 * 1020^2，不会溢出
+static void accumulate_chunk(const SampleChunk& chunk, FocusMeasure focus, int level, StatisticsSums& sums) {
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i threshold = _mm_set1_epi16((short)std::max(std::min(level, 256), 0) - 1);
+    __m128i sum = _mm_setzero_si128();
+    __m128i saturated = _mm_setzero_si128();
+    __m128i focus_sum = _mm_setzero_si128();
+    __m128i focus_squares = _mm_setzero_si128();
+    int k = 0;
+    for (; k + 8 <= chunk.count; k += 8) {
+        __m128i c = _mm_load_si128(reinterpret_cast<const __m128i*>(chunk.c + k));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(c, ones));
+        saturated = _mm_sub_epi16(saturated, _mm_cmpgt_epi16(c, threshold));
+        if (focus == FocusMeasure::LaplacianVariance) {
+            __m128i l = _mm_load_si128(reinterpret_cast<const __m128i*>(chunk.l + k));
+            __m128i r = _mm_load_si128(reinterpret_cast<const __m128i*>(chunk.r + k));
+            __m128i u = _mm_load_si128(reinterpret_cast<const __m128i*>(chunk.u + k));
+            __m128i d = _mm_load_si128(reinterpret_cast<const __m128i*>(chunk.d + k));
+            __m128i lap = _mm_sub_epi16(_mm_slli_epi16(c, 2), _mm_add_epi16(_mm_add_epi16(l, r), _mm_add_epi16(u, d)));
+            focus_sum = _mm_add_epi32(focus_sum, _mm_madd_epi16(lap, ones));
+            focus_squares = _mm_add_epi32(focus_squares, _mm_madd_epi16(lap, lap));
+        } else if (focus == FocusMeasure::Tenengrad) {
+            __m128i l = _mm_load_si128(reinterpret_cast<const __m128i*>(chunk.l + k));
+            __m128i r = _mm_load_si128(reinterpret_cast<const __m128i*>(chunk.r + k));
+            __m128i u = _mm_load_si128(reinterpret_cast<const __m128i*>(chunk.u + k));
+            __m128i d = _mm_load_si128(reinterpret_cast<const __m128i*>(chunk.d + k));
+            __m128i ul = _mm_load_si128(reinterpret_cast<const __m128i*>(chunk.ul + k));
+            __m128i ur = _mm_load_si128(reinterpret_cast<const __m128i*>(chunk.ur + k));
+            __m128i dl = _mm_load_si128(reinterpret_cast<const __m128i*>(chunk.dl + k));
+            __m128i dr = _mm_load_si128(reinterpret_cast<const __m128i*>(chunk.dr + k));
+            __m128i gx = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(ur, dr), _mm_slli_epi16(r, 1)),
+                                       _mm_add_epi16(_mm_add_epi16(ul, dl), _mm_slli_epi16(l, 1)));
+            __m128i gy = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(dl, dr), _mm_slli_epi16(d, 1)),
+                                       _mm_add_epi16(_mm_add_epi16(ul, ur), _mm_slli_epi16(u, 1)));
+            focus_squares = _mm_add_epi32(focus_squares, _mm_add_epi32(_mm_madd_epi16(gx, gx), _mm_madd_epi16(gy, gy)));
+        }
+    }
+    sums.sum += (uint64_t)horizontal_sum_epi32(sum);
+    sums.saturated += (uint64_t)horizontal_sum_epi32(_mm_madd_epi16(saturated, ones));
+    sums.focus_sum += horizontal_sum_epi32(focus_sum);
+    sums.focus_squares += (uint64_t)horizontal_sum_epi32(focus_squares);
+    accumulate_scalar(chunk, k, focus, level, sums);
+}
+
+#elif defined(FRAME_STATISTICS_NEON)
+
+static int64_t horizontal_sum_s32(int32x4_t v) {
+    return (int64_t)vgetq_lane_s32(v, 0) + vgetq_lane_s32(v, 1) + vgetq_lane_s32(v, 2) + vgetq_lane_s32(v, 3);
+}
+
+static void accumulate_chunk(const SampleChunk& chunk, FocusMeasure focus, int level, StatisticsSums& sums) {
+    const int16x8_t threshold = vdupq_n_s16((int16_t)std::max(std::min(level, 256), 0));
+    int32x4_t sum = vdupq_n_s32(0);
+    uint16x8_t saturated = vdupq_n_u16(0);
+    int32x4_t focus_sum = vdupq_n_s32(0);
+    int32x4_t focus_squares = vdupq_n_s32(0);
+    int k = 0;
+    for (; k + 8 <= chunk.count; k += 8) {
+        int16x8_t c = vld1q_s16(chunk.c + k);
+        sum = vpadalq_s16(sum, c);
+        saturated = vsubq_u16(saturated, vcgeq_s16(c, threshold));
+        if (focus == FocusMeasure::LaplacianVariance) {
+            int16x8_t neighbours = vaddq_s16(vaddq_s16(vld1q_s16(chunk.l + k), vld1q_s16(chunk.r + k)),
+                                             vaddq_s16(vld1q_s16(chunk.u + k), vld1q_s16(chunk.d + k)));
+            int16x8_t lap = vsubq_s16(vshlq_n_s16(c, 2), neighbours);
+            focus_sum = vpadalq_s16(focus_sum, lap);
+            focus_squares = vmlal_s16(focus_squares, vget_low_s16(lap), vget_low_s16(lap));
+            focus_squares = vmlal_s16(focus_squares, vget_high_s16(lap), vget_high_s16(lap));
+        } else if (focus == FocusMeasure::Tenengrad) {
+            int16x8_t l = vld1q_s16(chunk.l + k);
+            int16x8_t r = vld1q_s16(chunk.r + k);
+            int16x8_t u = vld1q_s16(chunk.u + k);
+            int16x8_t d = vld1q_s16(chunk.d + k);
+            int16x8_t ul = vld1q_s16(chunk.ul + k);
+            int16x8_t ur = vld1q_s16(chunk.ur + k);
+            int16x8_t dl = vld1q_s16(chunk.dl + k);
+            int16x8_t dr = vld1q_s16(chunk.dr + k);
+            int16x8_t gx = vsubq_s16(vaddq_s16(vaddq_s16(ur, dr), vshlq_n_s16(r, 1)), vaddq_s16(vaddq_s16(ul, dl), vshlq_n_s16(l, 1)));
+            int16x8_t gy = vsubq_s16(vaddq_s16(vaddq_s16(dl, dr), vshlq_n_s16(d, 1)), vaddq_s16(vaddq_s16(ul, ur), vshlq_n_s16(u, 1)));
+            focus_squares = vmlal_s16(focus_squares, vget_low_s16(gx), vget_low_s16(gx));
+            focus_squares = vmlal_s16(focus_squares, vget_high_s16(gx), vget_high_s16(gx));
+            focus_squares = vmlal_s16(focus_squares, vget_low_s16(gy), vget_low_s16(gy));
+            focus_squares = vmlal_s16(focus_squares, vget_high_s16(gy), vget_high_s16(gy));
+        }
+    }
+    sums.sum += (uint64_t)horizontal_sum_s32(sum);
+    sums.saturated += (uint64_t)horizontal_sum_s32(vreinterpretq_s32_u32(vpaddlq_u16(saturated)));
+    sums.focus_sum += horizontal_sum_s32(focus_sum);
+    sums.focus_squares += (uint64_t)horizontal_sum_s32(focus_squares);
+    accumulate_scalar(chunk, k, focus, level, sums);
+}
+
+#else
+
+static void accumulate_chunk(const SampleChunk& chunk, FocusMeasure focus, int level, StatisticsSums& sums) {
+    accumulate_scalar(chunk, 0, focus, level, sums);
+}
+
+#endif
+
+// 各格式的8位亮度，坐标为亮度平面坐标（Bayer为2x2单元）。row()取一行的起点，
+// 同一行的采样点及其左右相邻像素共用
+struct Mono8Luma {
+    const unsigned char* data;
+    size_t stride;
+    const unsigned char* row(int y) const { return data + (size_t)y * stride; }
+    int operator()(const unsigned char* row, int x) const { return row[x]; }
+};
+
+struct Mono16Luma {
+    const unsigned char* data;
+    size_t stride;
+    unsigned int mask;
+    int shift;
+    const unsigned char* row(int y) const { return data + (size_t)y * stride; }
+    int operator()(const unsigned char* row, int x) const {
+        const unsigned char* p = row + 2 * (size_t)x;
+        return (int)((((unsigned int)p[0] | ((unsigned int)p[1] << 8)) & mask) >> shift);
+    }
+};
+
+// Packed：每组3字节的b0/b2就是两个像素的高8位。帧按连续像素流打包，行以起始像素下标表示
+struct PackedLuma {
+    const unsigned char* data;
+    size_t width;
+    size_t row(int y) const { return (size_t)y * width; }
+    int operator()(size_t row, int x) const {
+        size_t i = row + x;
+        return data[i / 2 * 3 + (i & 1) * 2];
+    }
+};
+
+struct ColorLuma {
+    const unsigned char* data;
+    size_t stride;
+    int red;
+    int blue;
+    const unsigned char* row(int y) const { return data + (size_t)y * stride; }
+    int operator()(const unsigned char* row, int x) const {
+        const unsigned char* p = row + 3 * (size_t)x;
+        return (77 * p[red] + 150 * p[1] + 29 * p[blue] + 128) >> 8;
+    }
+};
+
+struct BayerLuma {
+    const unsigned char* data;
+    size_t stride;
+    const unsigned char* row(int y) const { return data + 2 * (size_t)y * stride; }
+    int operator()(const unsigned char* row, int x) const {
+        const unsigned char* p = row + 2 * (size_t)x;
+        return (p[0] + p[1] + p[stride] + p[stride + 1] + 2) >> 2;
+    }
+};
+
+struct SampleGrid {
+    int width;              // 亮度平面尺寸
+    int height;
+    int x0, y0, x1, y1;     // 统计区域（亮度平面坐标，右下不含）
+    int step;
+};
+
+// 逐行收集采样点（边缘处相邻像素取边缘值），每满一块交给SIMD内核累加；
+// 直方图用4份交替写入的子直方图，避免相邻相同值造成的存储转发停顿
+template <class Luma>
+static void sample_grid(const Luma& luma, const SampleGrid& grid, FocusMeasure focus, int level,
+                        uint32_t (&histograms)[4][256], StatisticsSums& sums) {
+    SampleChunk chunk;
+    for (int y = grid.y0; y < grid.y1; y += grid.step) {
+        const auto center = luma.row(y);
+        const auto up = luma.row(std::max(y - 1, 0));
+        const auto down = luma.row(std::min(y + 1, grid.height - 1));
+        int x = grid.x0;
+        while (x < grid.x1) {
+            chunk.count = 0;
+            for (; x < grid.x1 && chunk.count < kChunk; x += grid.step) {
+                const int k = chunk.count++;
+                chunk.c[k] = (int16_t)luma(center, x);
+                if (focus == FocusMeasure::None) {
+                    continue;
+                }
+                const int xl = std::max(x - 1, 0);
+                const int xr = std::min(x + 1, grid.width - 1);
+                chunk.l[k] = (int16_t)luma(center, xl);
+                chunk.r[k] = (int16_t)luma(center, xr);
+                chunk.u[k] = (int16_t)luma(up, x);
+                chunk.d[k] = (int16_t)luma(down, x);
+                if (focus == FocusMeasure::Tenengrad) {
+                    chunk.ul[k] = (int16_t)luma(up, xl);
+                    chunk.ur[k] = (int16_t)luma(up, xr);
+                    chunk.dl[k] = (int16_t)luma(down, xl);
+                    chunk.dr[k] = (int16_t)luma(down, xr);
+                }
+            }
+            accumulate_chunk(chunk, focus, level, sums);
+            int k = 0;
+            for (; k + 4 <= chunk.count; k += 4) {
+                ++histograms[0][chunk.c[k]];
+                ++histograms[1][chunk.c[k + 1]];
+                ++histograms[2][chunk.c[k + 2]];
+                ++histograms[3][chunk.c[k + 3]];
+            }
+            for (; k < chunk.count; ++k) {
+                ++histograms[0][chunk.c[k]];
+            }
+        }
+    }
+}
+
+int FrameStatistics::percentile(double fraction) const {
+    if (samples == 0) {
+        return 0;
+    }
+    fraction = std::min(std::max(fraction, 0.0), 1.0);
+    uint64_t target = std::max<uint64_t>((uint64_t)std::ceil(fraction * samples), 1);
+    uint64_t cumulative = 0;
+    for (int i = 0; i < 256; ++i) {
+        cumulative += histogram[i];
+        if (cumulative >= target) {
+            return i;
+        }
+    }
+    return 255;
+}
+
+FrameStatisticsCalculator::FrameStatisticsCalculator(const FrameStatisticsOptions& options) : options_(options) {
+    options_.step = std::max(options_.step, 1);
+}
+
+bool FrameStatisticsCalculator::is_supported(MvGvspPixelType pixel_type) {
+    switch (pixel_type) {
+        case PixelType_Gvsp_Mono8:
+        case PixelType_Gvsp_Mono10:
+        case PixelType_Gvsp_Mono12:
+        case PixelType_Gvsp_Mono10_Packed:
+        case PixelType_Gvsp_Mono12_Packed:
+        case PixelType_Gvsp_BGR8_Packed:
+        case PixelType_Gvsp_RGB8_Packed:
+            return true;
+        default:
+            return BayerDemosaicer::is_bayer8(pixel_type);
+    }
+}
+
+const char* FrameStatisticsCalculator::kernel_name() {
+#if defined(FRAME_STATISTICS_SSE2)
+    return "sse2";
+#elif defined(FRAME_STATISTICS_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+bool FrameStatisticsCalculator::compute(const unsigned char* data, int width, int height, size_t row_stride,
+                                        MvGvspPixelType pixel_type, FrameStatistics& stats) const {
+    stats.valid = false;
+    if (!data || width <= 0 || height <= 0 || !is_supported(pixel_type)) {
+        return false;
+    }
+    const int64_t start_us = FrameTelemetry::steady_now_us();
+
+    // Bayer在2x2单元平面上统计，ROI和步长按单元换算
+    const int scale = BayerDemosaicer::is_bayer8(pixel_type) ? 2 : 1;
+    SampleGrid grid;
+    grid.width = width / scale;
+    grid.height = height / scale;
+    grid.x0 = std::max(options_.roi_x, 0) / scale;
+    grid.y0 = std::max(options_.roi_y, 0) / scale;
+    grid.x1 = options_.roi_width > 0 ? std::min(grid.width, (options_.roi_x + options_.roi_width) / scale) : grid.width;
+    grid.y1 = options_.roi_height > 0 ? std::min(grid.height, (options_.roi_y + options_.roi_height) / scale) : grid.height;
+    grid.step = std::max(options_.step / scale, 1);
+    if (grid.x0 >= grid.x1 || grid.y0 >= grid.y1) {
+        return false;
+    }
+
+    uint32_t histograms[4][256] = {};
+    StatisticsSums sums;
+    const FocusMeasure focus = options_.focus;
+    const int level = options_.saturation_level;
+    switch (pixel_type) {
+        case PixelType_Gvsp_Mono8:
+            sample_grid(Mono8Luma{ data, row_stride ? row_stride : (size_t)width }, grid, focus, level, histograms, sums);
+            break;
+        case PixelType_Gvsp_Mono10:
+        case PixelType_Gvsp_Mono12: {
+            const int bits = pixel_type == PixelType_Gvsp_Mono10 ? 10 : 12;
+            Mono16Luma luma{ data, row_stride ? row_stride : 2 * (size_t)width, (1u << bits) - 1, bits - 8 };
+            sample_grid(luma, grid, focus, level, histograms, sums);
+            break;
+        }
+        case PixelType_Gvsp_Mono10_Packed:
+        case PixelType_Gvsp_Mono12_Packed:
+            sample_grid(PackedLuma{ data, (size_t)width }, grid, focus, level, histograms, sums);
+            break;
+        case PixelType_Gvsp_BGR8_Packed:
+        case PixelType_Gvsp_RGB8_Packed: {
+            const bool bgr = pixel_type == PixelType_Gvsp_BGR8_Packed;
+            ColorLuma luma{ data, row_stride ? row_stride : 3 * (size_t)width, bgr ? 2 : 0, bgr ? 0 : 2 };
+            sample_grid(luma, grid, focus, level, histograms, sums);
+            break;
+        }
+        default:
+            sample_grid(BayerLuma{ data, row_stride ? row_stride : (size_t)width }, grid, focus, level, histograms, sums);
+            break;
+    }
+
+    uint64_t samples = 0;
+    for (int i = 0; i < 256; ++i) {
+        stats.histogram[i] = histograms[0][i] + histograms[1][i] + histograms[2][i] + histograms[3][i];
+        samples += stats.histogram[i];
+    }
+    stats.samples = (uint32_t)samples;
+    stats.mean = samples ? (double)sums.sum / samples : 0.0;
+    stats.min = 0;
+    while (stats.min < 255 && stats.histogram[stats.min] == 0) {
+        ++stats.min;
+    }
+    stats.max = 255;
+    while (stats.max > 0 && stats.histogram[stats.max] == 0) {
+        --stats.max;
+    }
+    stats.saturated = (uint32_t)sums.saturated;
+    stats.focus = 0.0;
+    if (samples && focus == FocusMeasure::LaplacianVariance) {
+        double mean = (double)sums.focus_sum / samples;
+        stats.focus = std::max((double)sums.focus_squares / samples - mean * mean, 0.0);
+    } else if (samples && focus == FocusMeasure::Tenengrad) {
+        stats.focus = (double)sums.focus_squares / samples;
+    }
+    stats.compute_us = (double)(FrameTelemetry::steady_now_us() - start_us);
+    stats.valid = samples > 0;
+    return stats.valid;
+}
+
+bool FrameStatisticsCalculator::compute(const unsigned char* data, const MV_FRAME_OUT_INFO_EX& frameInfo,
+                                        FrameStatistics& stats) const {
+    const size_t pixels = (size_t)frameInfo.nWidth * frameInfo.nHeight;
+    size_t required = pixels;
+    switch (frameInfo.enPixelType) {
+        case PixelType_Gvsp_Mono10:
+        case PixelType_Gvsp_Mono12:
+            required = 2 * pixels;
+            break;
+        case PixelType_Gvsp_Mono10_Packed:
+        case PixelType_Gvsp_Mono12_Packed:
+            required = (pixels * 3 + 1) / 2;
+            break;
+        case PixelType_Gvsp_BGR8_Packed:
+        case PixelType_Gvsp_RGB8_Packed:
+            required = 3 * pixels;
+            break;
+        default:
+            break;
+    }
+    if (frameInfo.nFrameLen < required) {
+        stats.valid = false;
+        return false;
+    }
+    stats.frame_num = frameInfo.nFrameNum;
+    return compute(data, frameInfo.nWidth, frameInfo.nHeight, 0, frameInfo.enPixelType, stats);
+}
@@ -0,0 +1,247 @@
+// frame_telemetry.cpp
+
+#include "frame_telemetry.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+static int64_t system_now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// nHostTimeStamp（ms）到现在的微秒数；时间戳缺失或主机时钟回拨时返回-1
+static int64_t since_host_arrival_us(const MV_FRAME_OUT_INFO_EX& frameInfo) {
+    if (frameInfo.nHostTimeStamp <= 0) {
+        return -1;
+    }
+    int64_t elapsed = system_now_us() - frameInfo.nHostTimeStamp * 1000;
+    return elapsed >= 0 ? elapsed : -1;
+}
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+int LatencyHistogram::bucket_index(uint64_t value) {
+    if (value < (uint64_t)kLinearBuckets) {
+        return (int)value;
+    }
+    int exponent = 63 - __builtin_clzll(value);
+    if (exponent >= 40) {
+        return kBuckets - 1;
+    }
+    int sub = (int)((value >> (exponent - 3)) & (kSubBuckets - 1));
+    return kLinearBuckets + (exponent - 4) * kSubBuckets + sub;
+}
+
+double LatencyHistogram::bucket_value(int index) {
+    if (index < kLinearBuckets) {
+        return index;
+    }
+    int exponent = (index - kLinearBuckets) / kSubBuckets + 4;
+    int sub = (index - kLinearBuckets) % kSubBuckets;
+    double width = std::ldexp(1.0, exponent - 3);
+    return (kSubBuckets + sub) * width + width / 2;     // 区间中点
+}
+
+void LatencyHistogram::record(uint64_t value_us) {
+    counts_[bucket_index(value_us)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value_us, std::memory_order_relaxed);
+    uint64_t current = max_.load(std::memory_order_relaxed);
+    while (value_us > current && !max_.compare_exchange_weak(current, value_us, std::memory_order_relaxed)) {
+    }
+}
+
+LatencySummary LatencyHistogram::summary() const {
+    LatencySummary summary;
+    uint64_t counts[kBuckets];
+    uint64_t total = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        counts[i] = counts_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return summary;
+    }
+
+    summary.count = total;
+    summary.mean_us = (double)sum_.load(std::memory_order_relaxed) / std::max<uint64_t>(count_.load(std::memory_order_relaxed), 1);
+    summary.max_us = (double)max_.load(std::memory_order_relaxed);
+
+    const double percentiles[3] = { 0.50, 0.90, 0.99 };
+    double* outputs[3] = { &summary.p50_us, &summary.p90_us, &summary.p99_us };
+    uint64_t cumulative = 0;
+    int p = 0;
+    for (int i = 0; i < kBuckets && p < 3; ++i) {
+        cumulative += counts[i];
+        while (p < 3 && cumulative >= (uint64_t)std::ceil(percentiles[p] * total)) {
+            *outputs[p] = std::min(bucket_value(i), summary.max_us);
+            ++p;
+        }
+    }
+    return summary;
+}
+
+void LatencyHistogram::reset() {
+    for (int i = 0; i < kBuckets; ++i) {
+        counts_[i].store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+FrameTelemetry::FrameTelemetry() {
+    reset();
+}
+
+int64_t FrameTelemetry::steady_now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void FrameTelemetry::record_sequence(const MV_FRAME_OUT_INFO_EX& frameInfo, int64_t now_us) {
+    frames_.fetch_add(1, std::memory_order_relaxed);
+
+    // 帧号连续性：跳号计为丢帧，回退计为复位
+    int64_t frame_num = frameInfo.nFrameNum;
+    int64_t last = last_frame_num_.load(std::memory_order_relaxed);
+    if (last >= 0) {
+        if (frame_num > last + 1) {
+            gaps_.fetch_add((uint64_t)(frame_num - last - 1), std::memory_order_relaxed);
+        } else if (frame_num <= last) {
+            resets_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    last_frame_num_.store(frame_num, std::memory_order_relaxed);
+
+    if (frameInfo.nLostPacket > 0) {
+        lost_packet_frames_.fetch_add(1, std::memory_order_relaxed);
+        lost_packets_.fetch_add(frameInfo.nLostPacket, std::memory_order_relaxed);
+    }
+
+    // 交付间隔及其指数平均（1/16us定点，平滑系数1/8）
+    int64_t last_handoff = last_handoff_us_.load(std::memory_order_relaxed);
+    if (last_handoff > 0 && now_us >= last_handoff) {
+        uint64_t interval = (uint64_t)(now_us - last_handoff);
+        frame_interval_.record(interval);
+        int64_t sample = (int64_t)interval * 16;
+        int64_t ewma = (int64_t)interval_ewma_us_.load(std::memory_order_relaxed);
+        ewma = ewma == 0 ? sample : ewma + (sample - ewma) / 8;
+        interval_ewma_us_.store((uint64_t)ewma, std::memory_order_relaxed);
+    }
+    last_handoff_us_.store(now_us, std::memory_order_relaxed);
+}
+
+void FrameTelemetry::record_pickup(const MV_FRAME_OUT_INFO_EX& frameInfo, int64_t now_us) {
+    picked_up_.fetch_add(1, std::memory_order_relaxed);
+    int64_t since_arrival = since_host_arrival_us(frameInfo);
+    if (since_arrival >= 0) {
+        arrival_to_pickup_.record((uint64_t)since_arrival);
+    }
+    last_pickup_frame_num_.store(frameInfo.nFrameNum, std::memory_order_relaxed);
+    last_pickup_device_ts_.store(((uint64_t)frameInfo.nDevTimeStampHigh << 32) | frameInfo.nDevTimeStampLow,
+                                 std::memory_order_relaxed);
+    last_pickup_arrival_ms_.store(frameInfo.nHostTimeStamp, std::memory_order_relaxed);
+    last_pickup_us_.store(now_us, std::memory_order_relaxed);
+}
+
+void FrameTelemetry::on_handoff(const MV_FRAME_OUT_INFO_EX& frameInfo, uint64_t sequence) {
+    int64_t now_us = steady_now_us();
+    record_sequence(frameInfo, now_us);
+
+    int64_t since_arrival = since_host_arrival_us(frameInfo);
+    if (since_arrival >= 0) {
+        arrival_to_handoff_.record((uint64_t)since_arrival);
+    }
+
+    size_t slot = sequence % kHandoffSlots;
+    handoff_time_us_[slot].store(now_us, std::memory_order_relaxed);
+    handoff_sequence_[slot].store(sequence + 1, std::memory_order_release);
+}
+
+void FrameTelemetry::on_pickup(const MV_FRAME_OUT_INFO_EX& frameInfo, uint64_t sequence) {
+    int64_t now_us = steady_now_us();
+    size_t slot = sequence % kHandoffSlots;
+    if (handoff_sequence_[slot].load(std::memory_order_acquire) == sequence + 1) {
+        int64_t handoff_us = handoff_time_us_[slot].load(std::memory_order_acquire);
+        // 序号未变说明读到的时间属于这一帧
+        if (handoff_sequence_[slot].load(std::memory_order_acquire) == sequence + 1 && now_us >= handoff_us) {
+            handoff_to_pickup_.record((uint64_t)(now_us - handoff_us));
+            last_pickup_handoff_us_.store(handoff_us, std::memory_order_relaxed);
+        }
+    }
+    record_pickup(frameInfo, now_us);
+}
+
+void FrameTelemetry::on_polled(const MV_FRAME_OUT_INFO_EX& frameInfo) {
+    int64_t now_us = steady_now_us();
+    record_sequence(frameInfo, now_us);
+    int64_t since_arrival = since_host_arrival_us(frameInfo);
+    if (since_arrival >= 0) {
+        arrival_to_handoff_.record((uint64_t)since_arrival);
+    }
+    handoff_to_pickup_.record(0);
+    last_pickup_handoff_us_.store(now_us, std::memory_order_relaxed);
+    record_pickup(frameInfo, now_us);
+}
+
+TelemetrySnapshot FrameTelemetry::snapshot() const {
+    TelemetrySnapshot snapshot;
+    snapshot.frames = frames_.load(std::memory_order_relaxed);
+    snapshot.picked_up = picked_up_.load(std::memory_order_relaxed);
+    snapshot.gaps = gaps_.load(std::memory_order_relaxed);
+    snapshot.frame_num_resets = resets_.load(std::memory_order_relaxed);
+    snapshot.lost_packet_frames = lost_packet_frames_.load(std::memory_order_relaxed);
+    snapshot.lost_packets = lost_packets_.load(std::memory_order_relaxed);
+
+    // 停流后不再报告旧的帧率：超过4个平均间隔（至少1秒）没有新帧时为0
+    uint64_t ewma = interval_ewma_us_.load(std::memory_order_relaxed);
+    int64_t last_handoff = last_handoff_us_.load(std::memory_order_relaxed);
+    if (ewma > 0) {
+        double interval_us = ewma / 16.0;
+        double idle_us = (double)(steady_now_us() - last_handoff);
+        if (idle_us <= std::max(1e6, 4 * interval_us)) {
+            snapshot.delivered_fps = 1e6 / interval_us;
+        }
+    }
+
+    snapshot.arrival_to_handoff = arrival_to_handoff_.summary();
+    snapshot.handoff_to_pickup = handoff_to_pickup_.summary();
+    snapshot.arrival_to_pickup = arrival_to_pickup_.summary();
+    snapshot.frame_interval = frame_interval_.summary();
+
+    snapshot.last_frame.frame_num = last_pickup_frame_num_.load(std::memory_order_relaxed);
+    snapshot.last_frame.device_timestamp = last_pickup_device_ts_.load(std::memory_order_relaxed);
+    snapshot.last_frame.host_arrival_ms = last_pickup_arrival_ms_.load(std::memory_order_relaxed);
+    snapshot.last_frame.handoff_us = last_pickup_handoff_us_.load(std::memory_order_relaxed);
+    snapshot.last_frame.pickup_us = last_pickup_us_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void FrameTelemetry::reset() {
+    arrival_to_handoff_.reset();
+    handoff_to_pickup_.reset();
+    arrival_to_pickup_.reset();
+    frame_interval_.reset();
+    frames_.store(0);
+    picked_up_.store(0);
+    gaps_.store(0);
+    resets_.store(0);
+    lost_packet_frames_.store(0);
+    lost_packets_.store(0);
+    last_frame_num_.store(-1);
+    last_handoff_us_.store(0);
+    interval_ewma_us_.store(0);
+    for (size_t i = 0; i < kHandoffSlots; ++i) {
+        handoff_sequence_[i].store(0, std::memory_order_relaxed);
+        handoff_time_us_[i].store(0, std::memory_order_relaxed);
+    }
+    last_pickup_frame_num_.store(0);
+    last_pickup_device_ts_.store(0);
+    last_pickup_arrival_ms_.store(0);
+    last_pickup_handoff_us_.store(0);
+    last_pickup_us_.store(0);
+}
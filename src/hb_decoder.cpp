@@ -0,0 +1,307 @@
+// hb_decoder.cpp
+
+#include "hb_decoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+
+static const MvGvspPixelType kHbPixelTypes[] = {
+    PixelType_Gvsp_HB_Mono8, PixelType_Gvsp_HB_Mono10, PixelType_Gvsp_HB_Mono10_Packed, PixelType_Gvsp_HB_Mono12,
+    PixelType_Gvsp_HB_Mono12_Packed, PixelType_Gvsp_HB_Mono16,
+    PixelType_Gvsp_HB_BayerGR8, PixelType_Gvsp_HB_BayerRG8, PixelType_Gvsp_HB_BayerGB8, PixelType_Gvsp_HB_BayerBG8,
+    PixelType_Gvsp_HB_BayerRBGG8,
+    PixelType_Gvsp_HB_BayerGR10, PixelType_Gvsp_HB_BayerRG10, PixelType_Gvsp_HB_BayerGB10, PixelType_Gvsp_HB_BayerBG10,
+    PixelType_Gvsp_HB_BayerGR12, PixelType_Gvsp_HB_BayerRG12, PixelType_Gvsp_HB_BayerGB12, PixelType_Gvsp_HB_BayerBG12,
+    PixelType_Gvsp_HB_BayerGR10_Packed, PixelType_Gvsp_HB_BayerRG10_Packed, PixelType_Gvsp_HB_BayerGB10_Packed,
+    PixelType_Gvsp_HB_BayerBG10_Packed, PixelType_Gvsp_HB_BayerGR12_Packed, PixelType_Gvsp_HB_BayerRG12_Packed,
+    PixelType_Gvsp_HB_BayerGB12_Packed, PixelType_Gvsp_HB_BayerBG12_Packed,
+    PixelType_Gvsp_HB_YUV422_Packed, PixelType_Gvsp_HB_YUV422_YUYV_Packed,
+    PixelType_Gvsp_HB_RGB8_Packed, PixelType_Gvsp_HB_BGR8_Packed, PixelType_Gvsp_HB_RGBA8_Packed, PixelType_Gvsp_HB_BGRA8_Packed,
+    PixelType_Gvsp_HB_RGB16_Packed, PixelType_Gvsp_HB_BGR16_Packed, PixelType_Gvsp_HB_RGBA16_Packed,
+    PixelType_Gvsp_HB_BGRA16_Packed,
+};
+
+static std::atomic<bool> g_serialized_decode{true};
+
+// 每个句柄一把解码锁；句柄数很少，锁创建后不再释放（句柄地址复用时沿用同一把锁）
+static std::mutex& decode_mutex(void* handle) {
+    static std::mutex registry_mutex;
+    static std::map<void*, std::unique_ptr<std::mutex>> registry;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::unique_ptr<std::mutex>& mutex = registry[handle];
+    if (!mutex) {
+        mutex.reset(new std::mutex());
+    }
+    return *mutex;
+}
+
+void HbDecoder::set_serialized_decode(bool enable) {
+    g_serialized_decode.store(enable);
+}
+
+bool HbDecoder::serialized_decode() {
+    return g_serialized_decode.load();
+}
+
+HbDecoder::HbDecoder(void* handle, int num_threads, size_t pool_size, size_t input_size, size_t output_size,
+                     Deliver deliver)
+    : handle_(handle),
+      num_threads_(std::max(num_threads, 1)),
+      output_size_(output_size),
+      deliver_(std::move(deliver)),
+      pool_size_(std::max<size_t>(pool_size, (size_t)std::max(num_threads, 1) + 1)) {
+    // 输入输出缓冲区一次分配：输入按PayloadSize预留，输出是页对齐、预先缺页的FrameArena槽
+    if (!outputs_.allocate(pool_size_, output_size_)) {
+        std::cerr << "Failed to allocate " << std::dec << pool_size_ << " HB decode buffers of " << output_size_ << " bytes" << std::endl;
+    }
+    free_.reset(new BoundedQueue<Job*>(pool_size_));
+    pending_.reset(new BoundedQueue<Job*>(pool_size_));
+    reorder_.reset(new std::atomic<Job*>[pool_size_]);
+    for (size_t i = 0; i < pool_size_; ++i) {
+        std::unique_ptr<Job> job(new Job());
+        std::memset(&job->info, 0, sizeof(job->info));
+        job->input.resize(input_size);
+        job->output = outputs_.empty() ? nullptr : outputs_.slot(i);
+        free_->push(job.get());
+        jobs_.push_back(std::move(job));
+        reorder_[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+HbDecoder::~HbDecoder() {
+    stop();
+}
+
+bool HbDecoder::is_hb(MvGvspPixelType pixel_type) {
+    return std::find(std::begin(kHbPixelTypes), std::end(kHbPixelTypes), pixel_type) != std::end(kHbPixelTypes);
+}
+
+bool HbDecoder::decode(void* handle, const unsigned char* src, size_t src_len, unsigned char* dst, size_t dst_size,
+                       MV_FRAME_OUT_INFO_EX& frameInfo) {
+    MV_CC_HB_DECODE_PARAM stDecodeParam;
+    std::memset(&stDecodeParam, 0, sizeof(stDecodeParam));
+    stDecodeParam.pSrcBuf = const_cast<unsigned char*>(src);
+    stDecodeParam.nSrcLen = (unsigned int)src_len;
+    stDecodeParam.pDstBuf = dst;
+    stDecodeParam.nDstBufSize = (unsigned int)dst_size;
+    std::unique_lock<std::mutex> lock;
+    if (g_serialized_decode.load(std::memory_order_relaxed)) {
+        lock = std::unique_lock<std::mutex>(decode_mutex(handle));
+    }
+    int nRet = MV_CC_HB_Decode(handle, &stDecodeParam);
+    if (lock.owns_lock()) {
+        lock.unlock();
+    }
+    if (nRet != MV_OK) {
+        std::cerr << "HB decode of frame " << std::dec << frameInfo.nFrameNum << " failed! Error Code: [0x" << std::hex << nRet << "]" << std::dec << std::endl;
+        return false;
+    }
+    frameInfo.enPixelType = stDecodeParam.enDstPixelType;
+    frameInfo.nWidth = (unsigned short)stDecodeParam.nWidth;
+    frameInfo.nHeight = (unsigned short)stDecodeParam.nHeight;
+    frameInfo.nExtendWidth = stDecodeParam.nWidth;
+    frameInfo.nExtendHeight = stDecodeParam.nHeight;
+    frameInfo.nFrameLen = stDecodeParam.nDstBufLen;
+    return true;
+}
+
+bool HbDecoder::start() {
+    if (running_) {
+        return true;
+    }
+    if (outputs_.empty() || !deliver_) {
+        return false;
+    }
+    // 没有解码线程、也没有submit()在进行：残留在队列和重排序槽里的帧全部归还，交付序号与入池序号一起归零，
+    // 否则新的序号与旧的next_delivery_对不上，交付会一直等一个不会到来的帧
+    Job* job = nullptr;
+    while (pending_->pop(job)) {
+        free_->push(job);
+    }
+    for (size_t i = 0; i < pool_size_; ++i) {
+        if (Job* stale = reorder_[i].exchange(nullptr)) {
+            free_->push(stale);
+        }
+    }
+    next_sequence_ = 0;
+    next_delivery_.store(0);
+    stopping_ = false;
+    running_ = true;
+    for (int i = 0; i < num_threads_; ++i) {
+        workers_.emplace_back(&HbDecoder::worker_loop, this);
+    }
+    return true;
+}
+
+void HbDecoder::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    // submit()先登记再检查running_：等已经通过检查的submit()把帧放进队列，工作线程才能把它处理掉
+    while (submitting_.load() > 0) {
+        std::this_thread::yield();
+    }
+    // 工作线程处理完已入池的帧才退出，停止后不再有交付
+    stopping_ = true;
+    {
+        std::lock_guard<std::mutex> lock(work_mutex_);
+    }
+    work_cv_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+}
+
+void HbDecoder::submit(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo) {
+    submitting_.fetch_add(1);
+    struct Leave {
+        std::atomic<int>& count;
+        ~Leave() { count.fetch_sub(1); }
+    } leave{submitting_};
+    if (!running_ || !pData) {
+        return;
+    }
+    Job* job = nullptr;
+    if (frameInfo.nFrameLen > jobs_[0]->input.size() || !free_->pop(job)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    int64_t now_us = FrameTelemetry::steady_now_us();
+    std::memcpy(job->input.data(), pData, frameInfo.nFrameLen);
+    job->input_length = frameInfo.nFrameLen;
+    job->info = frameInfo;
+    job->received_us = now_us;
+    job->sequence = next_sequence_++;
+    job->ok = false;
+
+    int64_t expected = 0;
+    first_received_us_.compare_exchange_strong(expected, now_us, std::memory_order_relaxed);
+    last_received_us_.store(now_us, std::memory_order_relaxed);
+    received_.fetch_add(1, std::memory_order_relaxed);
+    compressed_bytes_.fetch_add(frameInfo.nFrameLen, std::memory_order_relaxed);
+
+    pending_->push(job);    // 与free_容量相同，不会满
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (work_waiters_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(work_mutex_);
+        work_cv_.notify_one();
+    }
+}
+
+void HbDecoder::worker_loop() {
+    while (true) {
+        Job* job = nullptr;
+        if (pending_->pop(job)) {
+            job->compressed = is_hb(job->info.enPixelType);
+            if (job->compressed) {
+                int64_t start_us = FrameTelemetry::steady_now_us();
+                job->ok = decode(handle_, job->input.data(), job->input_length, job->output, output_size_, job->info);
+                decode_latency_.record((uint64_t)(FrameTelemetry::steady_now_us() - start_us));
+            } else {
+                // 未压缩的帧（HB未生效或相机对该帧放弃压缩）直接从输入缓冲区交付
+                job->ok = true;
+            }
+            complete(job);
+            continue;
+        }
+        if (stopping_) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(work_mutex_);
+        work_waiters_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        work_cv_.wait_for(lock, std::chrono::milliseconds(10), [this] { return stopping_ || !pending_->empty(); });
+        work_waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void HbDecoder::complete(Job* job) {
+    reorder_[job->sequence % pool_size_].store(job, std::memory_order_seq_cst);
+    // delivering_是交付权：抢不到时由持有者交付。持有者放手后再检查一次下一帧，
+    // 与这里先写reorder_再抢交付权配对（均为seq_cst），刚完成的帧不会被漏掉
+    while (!delivering_.exchange(true, std::memory_order_seq_cst)) {
+        deliver_ready();
+        delivering_.store(false, std::memory_order_seq_cst);
+        uint64_t next = next_delivery_.load(std::memory_order_relaxed);
+        if (reorder_[next % pool_size_].load(std::memory_order_seq_cst) == nullptr) {
+            return;
+        }
+    }
+}
+
+void HbDecoder::deliver_ready() {
+    uint64_t next = next_delivery_.load(std::memory_order_relaxed);
+    while (true) {
+        std::atomic<Job*>& slot = reorder_[next % pool_size_];
+        Job* job = slot.load(std::memory_order_acquire);
+        if (!job) {
+            break;
+        }
+        slot.store(nullptr, std::memory_order_relaxed);
+        if (job->ok) {
+            deliver_(job->compressed ? job->output : job->input.data(), job->info);
+            int64_t now_us = FrameTelemetry::steady_now_us();
+            int64_t expected = 0;
+            first_delivered_us_.compare_exchange_strong(expected, now_us, std::memory_order_relaxed);
+            last_delivered_us_.store(now_us, std::memory_order_relaxed);
+            delivery_latency_.record((uint64_t)(now_us - job->received_us));
+            decoded_bytes_.fetch_add(job->info.nFrameLen, std::memory_order_relaxed);
+            (job->compressed ? decoded_ : passthrough_).fetch_add(1, std::memory_order_relaxed);
+        } else {
+            failed_.fetch_add(1, std::memory_order_relaxed);
+        }
+        ++next;
+        next_delivery_.store(next, std::memory_order_relaxed);
+        free_->push(job);
+    }
+}
+
+HbDecodeStats HbDecoder::stats() const {
+    HbDecodeStats stats;
+    stats.received = received_.load(std::memory_order_relaxed);
+    stats.decoded = decoded_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.passthrough = passthrough_.load(std::memory_order_relaxed);
+    stats.compressed_bytes = compressed_bytes_.load(std::memory_order_relaxed);
+    stats.decoded_bytes = decoded_bytes_.load(std::memory_order_relaxed);
+    stats.in_flight = pool_size_ - free_->size();
+    stats.serialized_decode = g_serialized_decode.load(std::memory_order_relaxed);
+
+    double received_s = (last_received_us_.load(std::memory_order_relaxed) - first_received_us_.load(std::memory_order_relaxed)) / 1e6;
+    if (received_s > 0 && stats.received > 1) {
+        stats.compressed_fps = (stats.received - 1) / received_s;
+        stats.compressed_mb_per_s = stats.compressed_bytes / received_s / 1e6;
+    }
+    uint64_t delivered = stats.decoded + stats.passthrough;
+    double delivered_s = (last_delivered_us_.load(std::memory_order_relaxed) - first_delivered_us_.load(std::memory_order_relaxed)) / 1e6;
+    if (delivered_s > 0 && delivered > 1) {
+        stats.decoded_fps = (delivered - 1) / delivered_s;
+        stats.decoded_mb_per_s = stats.decoded_bytes / delivered_s / 1e6;
+    }
+    if (stats.compressed_bytes > 0) {
+        stats.compression_ratio = (double)stats.decoded_bytes / stats.compressed_bytes;
+    }
+    stats.decode = decode_latency_.summary();
+    stats.receive_to_delivery = delivery_latency_.summary();
+    return stats;
+}
+
+void HbDecoder::reset_stats() {
+    received_ = 0;
+    decoded_ = 0;
+    failed_ = 0;
+    dropped_ = 0;
+    passthrough_ = 0;
+    compressed_bytes_ = 0;
+    decoded_bytes_ = 0;
+    first_received_us_ = 0;
+    last_received_us_ = 0;
+    first_delivered_us_ = 0;
+    last_delivered_us_ = 0;
+    decode_latency_.reset();
+    delivery_latency_.reset();
+}
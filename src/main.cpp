@@ -2,6 +2,13 @@
 #include <opencv2/opencv.hpp>
 #include "device_camera_sy011.h"
 #include "undistort.h"  // 引入去畸变头文件
+#include "frame_arena.h"
+#include "frame_pipeline.h"
+#include "frame_recorder.h"
+#include "snapshot_encoder.h"
+#include <future>
+#include <memory>
+#include <vector>
 #include <filesystem>
 
 int main() {
@@ -21,7 +28,14 @@ int main() {
     }
 
     // 创建去畸变对象，传入标定文件路径
-    ImageUndistorter undistorter("calibration_parameters.yml");
+    auto undistorter = std::make_shared<ImageUndistorter>("calibration_parameters.yml");
+
+    // 显示流水线：解码 -> 去畸变 -> 十字光标，在两个工作线程上处理，不占用显示循环
+    FramePipeline pipeline(2, 4);
+    pipeline.add_undistort(undistorter);
+    pipeline.add_overlay();
+    pipeline.start();
+    camera.add_frame_sink(&pipeline);
 
     // 设置曝光时间为 1000 微秒
     // if (!camera.set_exposure_time(100)) {
@@ -29,8 +43,14 @@ int main() {
     //     return -1;
     // }
 
-    // 开始抓取图像
-    if (!camera.start_grabbing()) {
+    // USB断开后自动重连并恢复取流，帧环与下面的缓冲区保持不变
+    camera.set_auto_reconnect(true);
+
+    // 相机直接写入本程序分配的页对齐缓存（尽量使用大页），取流中不再有缺页和SDK内部分配
+    camera.use_registered_buffers(6, true);
+
+    // 后台采集：SDK取流线程把帧写入帧环，录像在同一线程上入队，不受显示循环速度影响
+    if (!camera.start_acquisition()) {
         std::cerr << "Failed to start grabbing images!" << std::endl;
         return -1;
     }
@@ -40,10 +60,22 @@ int main() {
     // 创建 OpenCV 窗口
     cv::namedWindow("Camera Image", cv::WINDOW_NORMAL);
 
-    // 图像缓冲区
-    unsigned char* pData = new unsigned char[1440 * 1080 * 3];  // 修改为彩色图像缓冲区
+    // 图像缓冲区，按相机实际负载大小分配一次（页对齐、预先缺页）
+    FrameArena frame_buffer;
+    if (!frame_buffer.allocate(1, camera.frame_buffer_size())) {
+        std::cerr << "Failed to allocate the frame buffer!" << std::endl;
+        return -1;
+    }
+    unsigned char* pData = frame_buffer.slot(0);
     MV_FRAME_OUT_INFO_EX frameInfo = {0};
 
+    // 按 'r' 开始/停止原始录像（写入 pic/record_<时间戳>_NNNNN.hkraw）
+    FrameRecorder recorder;
+
+    // 按 's' 保存快照：编码在后台线程池中进行，不占用采集/显示循环
+    SnapshotEncoder encoder(2, 8);
+    std::vector<std::future<SnapshotResult>> pending_snapshots;
+
     // 捕获图像并显示
     while (true) {
         if (!camera.capture_image(pData, frameInfo)) {
@@ -51,39 +83,65 @@ int main() {
             break;
         }
 
-        // 将捕获的数据转换为 OpenCV Mat 对象，改为支持彩色图像
-        cv::Mat image(frameInfo.nHeight, frameInfo.nWidth, CV_8UC3, pData);  // 使用彩色图像
-
-        // 进行去畸变处理
-        cv::Mat undistorted_image;
-        undistorter.undistort_image(image, undistorted_image);  // Apply undistortion
-
-        // 在图像中间添加十字
-        undistorter.add_calibration(undistorted_image, undistorted_image);  // Add cross at the center
-
-        // 显示图像
-        cv::imshow("Camera Image", image);
+        // 显示流水线最新的去畸变结果（带十字），显示期间该缓冲区不会被复用
+        PipelineOutput processed = pipeline.read_latest(0);
+        if (processed.valid()) {
+            cv::imshow("Camera Image", processed.image());
+        }
+        processed.release();
+
+        int key = cv::waitKey(1);
+
+        if (key == 'r') {
+            if (!recorder.recording()) {
+                std::string base = "pic/record_" + std::to_string(cv::getTickCount());
+                if (recorder.start(base, camera.frame_buffer_size())) {
+                    camera.add_frame_sink(&recorder);
+                    std::cout << "Recording to " << base << "_*.hkraw" << std::endl;
+                }
+            } else {
+                camera.remove_frame_sink(&recorder);
+                recorder.stop();
+                RecorderStats stats = recorder.stats();
+                std::cout << "Recording stopped: " << stats.written << " frames written, "
+                          << stats.dropped << " dropped" << std::endl;
+            }
+        }
 
-        // 按 's' 键保存当前图像
-        if (cv::waitKey(1) == 's') {
-            // 构造保存文件名，包含时间戳
-            std::string filename = "pic/captured_image_" + std::to_string(cv::getTickCount()) + ".png";
-            cv::imwrite(filename, image);  // Save the captured image
-            std::cout << "Image saved as " << filename << std::endl;
+        // 按 's' 键保存当前图像（文件名包含帧号）
+        if (key == 's') {
+            std::future<SnapshotResult> snapshot = encoder.submit(pData, frameInfo, "pic/captured_image");
+            if (snapshot.valid()) {
+                pending_snapshots.push_back(std::move(snapshot));
+            } else {
+                std::cerr << "Snapshot queue is full, frame not saved" << std::endl;
+            }
+        }
+        for (size_t i = 0; i < pending_snapshots.size();) {
+            if (pending_snapshots[i].wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                ++i;
+                continue;
+            }
+            SnapshotResult result = pending_snapshots[i].get();
+            if (result.ok) {
+                std::cout << "Image saved as " << result.path << " (" << result.encode_ms << " ms)" << std::endl;
+            }
+            pending_snapshots.erase(pending_snapshots.begin() + i);
         }
         // 按 'q' 键退出
-        if (cv::waitKey(1) == 'q') {
+        if (key == 'q') {
             break;
         }
     }
 
-    // 停止抓取图像
+    // 停止录像、流水线和抓取图像
+    camera.remove_frame_sink(&recorder);
+    camera.remove_frame_sink(&pipeline);
+    pipeline.stop();
+    recorder.stop();
     camera.stop_grabbing();
     camera.close();
 
-    // 释放内存
-    delete[] pData;
-
     cv::destroyAllWindows();
 
     return 0;
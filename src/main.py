@@ -39,19 +39,32 @@ def main():
     #     camera.close()
     #     return
 
-    print("Starting grabbing...")
-    if not camera.start_grabbing():
+    # Reopen the device and resume streaming automatically after a USB disconnect
+    camera.set_auto_reconnect(True)
+
+    # Brightness/focus/saturation statistics are computed natively on the grab thread (4-pixel grid)
+    camera.set_frame_statistics(True)
+
+    print("Starting acquisition...")
+    # Frames are copied into a ring on the SDK grab thread; recording hooks in there too
+    if not camera.start_acquisition():
         print("Failed to start grabbing!")
         camera.close()
         return
 
-    print("Camera started successfully. Press 's' to save, 'q' to quit.")
+    print("Camera started successfully. Press 's' to save, 'r' to start/stop raw recording, 'q' to quit.")
 
     cv2.namedWindow("Camera Image", cv2.WINDOW_NORMAL)
 
     save_dir = "pic_python"
     os.makedirs(save_dir, exist_ok=True)
 
+    # Raw recorder: queued on the grab thread, written by its own thread, never blocks capture
+    recorder = hikvision_camera.FrameRecorder()
+    # Snapshots are encoded on a small thread pool; the loop only queues them
+    encoder = hikvision_camera.SnapshotEncoder(num_threads=2, max_queue=8)
+    pending_snapshots = []
+
     # --- FPS Calculation/Display Variables ---
     frame_count_calc = 0
     fps_calc = 0.0
@@ -63,16 +76,21 @@ def main():
     sdk_fps_update_interval = 2.0 # Update SDK FPS less frequently
     # --- End FPS Variables ---
 
+    # Frames arrive with a natively downscaled 640x480 preview; the GIL is released while waiting
+    frames = camera.stream(timeout_ms=1000, preview=(640, 480))
+
     while True:
         loop_start_time = time.perf_counter()
         try:
             # Capture image using the Python wrapper method
-            success, image_np = camera.capture_image()
-
-            if not success or image_np is None:
-                # print("Failed to capture image!") # Reduce console spam
-                time.sleep(0.05) # Avoid busy-waiting on error
+            try:
+                image_np, preview_np, frame_info = next(frames)
+            except TimeoutError:
+                # No frame within timeout_ms; the stream can be advanced again
                 continue
+            except StopIteration:
+                print("Stream ended (grabbing stopped).")
+                break
 
             # Ensure it's a valid NumPy array
             if not isinstance(image_np, np.ndarray):
@@ -96,29 +114,51 @@ def main():
             # --- End SDK FPS ---
 
 
-            # Display the image using OpenCV
-            # resize 640 * 480
-            display_image = cv2.resize(image_np, (640, 480))
+            # Display the 640x480 preview produced natively (fall back to cv2.resize for other pixel formats)
+            display_image = preview_np if preview_np is not None else cv2.resize(image_np, (640, 480))
 
             # --- Display FPS on image ---
             calc_fps_text = f"Calc FPS: {fps_calc:.2f}"
             sdk_fps_text = f"SDK FPS: {sdk_fps:.2f}" if sdk_fps >= 0 else "SDK FPS: N/A"
             cv2.putText(display_image, calc_fps_text, (10, 30), cv2.FONT_HERSHEY_SIMPLEX, 0.7, (0, 255, 0), 2)
             cv2.putText(display_image, sdk_fps_text, (10, 60), cv2.FONT_HERSHEY_SIMPLEX, 0.7, (0, 255, 255), 2) # Yellow
+            stats = camera.frame_statistics(frame_info)
+            if stats is not None:
+                stats_text = f"Mean: {stats.mean:.0f}  Focus: {stats.focus:.0f}  Sat: {stats.saturated_fraction * 100:.1f}%"
+                cv2.putText(display_image, stats_text, (10, 90), cv2.FONT_HERSHEY_SIMPLEX, 0.7, (255, 255, 0), 2)
             # --- End Display FPS ---
 
             cv2.imshow("Camera Image", display_image)
 
             key = cv2.waitKey(1) & 0xFF
             if key == ord('s'):
-                filename = os.path.join(save_dir, f"captured_image_{int(time.time())}.png")
                 # Save the original high-res image
-                cv2.imwrite(filename, image_np)
-                print(f"Image saved as {filename}")
+                future = encoder.save(image_np, os.path.join(save_dir, "captured_image"))
+                if future is None:
+                    print("Snapshot queue is full, frame not saved")
+                else:
+                    pending_snapshots.append(future)
+            elif key == ord('r'):
+                if not recorder.recording():
+                    base = os.path.join(save_dir, f"record_{int(time.time())}")
+                    if recorder.start(base, camera.frame_buffer_size()):
+                        camera.add_frame_sink(recorder)
+                        print(f"Recording to {base}_*.hkraw")
+                else:
+                    camera.remove_frame_sink(recorder)
+                    recorder.stop()
+                    stats = recorder.stats()
+                    print(f"Recording stopped: {stats.written} frames written, {stats.dropped} dropped")
             elif key == ord('q'):
                 print("Exiting...")
                 break
 
+            for future in [f for f in pending_snapshots if f.done()]:
+                pending_snapshots.remove(future)
+                result = future.result()
+                if result.ok:
+                    print(f"Image saved as {result.path} ({result.encode_ms:.1f} ms)")
+
         except Exception as e:
             print(f"An error occurred during capture/display: {e}")
             break # Exit loop on error
@@ -128,6 +168,8 @@ def main():
         # print(f"Loop time: {loop_time_ms:.2f} ms")
 
 
+    camera.remove_frame_sink(recorder)
+    recorder.stop()
     print("Stopping grabbing...")
     camera.stop_grabbing()
     print("Closing camera...")
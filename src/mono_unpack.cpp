@@ -0,0 +1,461 @@
+// mono_unpack.cpp
+
+#include "mono_unpack.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MONO_UNPACK_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#define MONO_UNPACK_NEON 1
+#include <arm_neon.h>
+#endif
+
+// 超过该像素数时按块并行（每块像素数为32的倍数，Packed格式的块边界落在3字节组上）
+static const size_t kParallelPixels = (size_t)1 << 20;
+static const size_t kChunkPixels = (size_t)1 << 18;
+
+enum class UnpackKind { Packed, Widen8, Mask16 };
+
+// 每个内核处理尽可能多的完整向量块，返回已处理的像素数，余下的由标量实现完成
+using PackedKernel = size_t (*)(const unsigned char* src, size_t src_len, uint16_t* dst, size_t count, int bits, int shift);
+using WidenKernel = size_t (*)(const unsigned char* src, uint16_t* dst, size_t count, int shift);
+using MaskKernel = size_t (*)(const unsigned char* src, uint16_t* dst, size_t count, int bits, int shift);
+
+struct UnpackKernels {
+    PackedKernel packed = nullptr;
+    WidenKernel widen = nullptr;
+    MaskKernel mask = nullptr;
+    const char* name = "scalar";
+};
+
+// 每组3字节b0 b1 b2两个像素：12位 p0 = b0<<4 | b1&0xF，p1 = b2<<4 | b1>>4；
+// 10位 p0 = b0<<2 | b1&0x3，p1 = b2<<2 | (b1>>4)&0x3
+static void packed_scalar(const unsigned char* src, size_t src_len, uint16_t* dst, size_t count, int bits, int shift) {
+    const int high_shift = bits - 8;
+    const unsigned int low_mask = (1u << high_shift) - 1;
+    size_t i = 0;
+    for (; i + 1 < count; i += 2) {
+        const unsigned char* group = src + i / 2 * 3;
+        dst[i] = (uint16_t)((((unsigned int)group[0] << high_shift) | (group[1] & low_mask)) << shift);
+        dst[i + 1] = (uint16_t)((((unsigned int)group[2] << high_shift) | ((group[1] >> 4) & low_mask)) << shift);
+    }
+    if (i < count && i / 2 * 3 + 1 < src_len) {
+        const unsigned char* group = src + i / 2 * 3;
+        dst[i] = (uint16_t)((((unsigned int)group[0] << high_shift) | (group[1] & low_mask)) << shift);
+    }
+}
+
+static void widen_scalar(const unsigned char* src, uint16_t* dst, size_t count, int shift) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = (uint16_t)(src[i] << shift);
+    }
+}
+
+static void mask_scalar(const unsigned char* src, uint16_t* dst, size_t count, int bits, int shift) {
+    const unsigned int mask = (1u << bits) - 1;
+    for (size_t i = 0; i < count; ++i) {
+        unsigned int value = (unsigned int)src[2 * i] | ((unsigned int)src[2 * i + 1] << 8);
+        dst[i] = (uint16_t)((value & mask) << shift);
+    }
+}
+
+#if defined(MONO_UNPACK_X86)
+
+// pshufb把每组的b0/b2（高位字节）和b1（低位字节）分别放到各16位通道的低字节；
+// 低位字节乘以16（偶数像素）或1（奇数像素）后统一右移4位，即可按通道取低4位或高4位
+__attribute__((target("ssse3")))
+static size_t packed_ssse3(const unsigned char* src, size_t src_len, uint16_t* dst, size_t count, int bits, int shift) {
+    const __m128i shuffle_high = _mm_setr_epi8(0, -128, 2, -128, 3, -128, 5, -128, 6, -128, 8, -128, 9, -128, 11, -128);
+    const __m128i shuffle_low = _mm_setr_epi8(1, -128, 1, -128, 4, -128, 4, -128, 7, -128, 7, -128, 10, -128, 10, -128);
+    const __m128i low_scale = _mm_setr_epi16(16, 1, 16, 1, 16, 1, 16, 1);
+    const __m128i low_mask = _mm_set1_epi16((short)((1 << (bits - 8)) - 1));
+    const __m128i high_shift = _mm_cvtsi32_si128(bits - 8);
+    const __m128i out_shift = _mm_cvtsi32_si128(shift);
+    size_t i = 0;
+    // 每次读16字节、用12字节（8个像素）
+    for (; i + 8 <= count && i / 2 * 3 + 16 <= src_len; i += 8) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i / 2 * 3));
+        __m128i high = _mm_sll_epi16(_mm_shuffle_epi8(bytes, shuffle_high), high_shift);
+        __m128i low = _mm_and_si128(_mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(bytes, shuffle_low), low_scale), 4), low_mask);
+        __m128i value = _mm_sll_epi16(_mm_or_si128(high, low), out_shift);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), value);
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+static size_t widen_ssse3(const unsigned char* src, uint16_t* dst, size_t count, int shift) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i out_shift = _mm_cvtsi32_si128(shift);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_sll_epi16(_mm_unpacklo_epi8(bytes, zero), out_shift));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_sll_epi16(_mm_unpackhi_epi8(bytes, zero), out_shift));
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+static size_t mask_ssse3(const unsigned char* src, uint16_t* dst, size_t count, int bits, int shift) {
+    const __m128i mask = _mm_set1_epi16((short)((1 << bits) - 1));
+    const __m128i out_shift = _mm_cvtsi32_si128(shift);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_sll_epi16(_mm_and_si128(value, mask), out_shift));
+    }
+    return i;
+}
+
+// 与SSSE3版相同的运算；vpshufb按128位通道工作，两个通道分别装入相邻的两个12字节块
+__attribute__((target("avx2")))
+static size_t packed_avx2(const unsigned char* src, size_t src_len, uint16_t* dst, size_t count, int bits, int shift) {
+    const __m128i shuffle_high128 = _mm_setr_epi8(0, -128, 2, -128, 3, -128, 5, -128, 6, -128, 8, -128, 9, -128, 11, -128);
+    const __m128i shuffle_low128 = _mm_setr_epi8(1, -128, 1, -128, 4, -128, 4, -128, 7, -128, 7, -128, 10, -128, 10, -128);
+    const __m256i shuffle_high = _mm256_inserti128_si256(_mm256_castsi128_si256(shuffle_high128), shuffle_high128, 1);
+    const __m256i shuffle_low = _mm256_inserti128_si256(_mm256_castsi128_si256(shuffle_low128), shuffle_low128, 1);
+    const __m256i low_scale = _mm256_setr_epi16(16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1);
+    const __m256i low_mask = _mm256_set1_epi16((short)((1 << (bits - 8)) - 1));
+    const __m128i high_shift = _mm_cvtsi32_si128(bits - 8);
+    const __m128i out_shift = _mm_cvtsi32_si128(shift);
+    size_t i = 0;
+    // 每次处理16个像素（24字节），第二个通道的读取到第28字节为止
+    for (; i + 16 <= count && i / 2 * 3 + 28 <= src_len; i += 16) {
+        const unsigned char* p = src + i / 2 * 3;
+        __m256i bytes = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 12)), 1);
+        __m256i high = _mm256_sll_epi16(_mm256_shuffle_epi8(bytes, shuffle_high), high_shift);
+        __m256i low = _mm256_and_si256(
+            _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_shuffle_epi8(bytes, shuffle_low), low_scale), 4), low_mask);
+        __m256i value = _mm256_sll_epi16(_mm256_or_si256(high, low), out_shift);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), value);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t widen_avx2(const unsigned char* src, uint16_t* dst, size_t count, int shift) {
+    const __m128i out_shift = _mm_cvtsi32_si128(shift);
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_sll_epi16(_mm256_cvtepu8_epi16(low), out_shift));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 16), _mm256_sll_epi16(_mm256_cvtepu8_epi16(high), out_shift));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t mask_avx2(const unsigned char* src, uint16_t* dst, size_t count, int bits, int shift) {
+    const __m256i mask = _mm256_set1_epi16((short)((1 << bits) - 1));
+    const __m128i out_shift = _mm_cvtsi32_si128(shift);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_sll_epi16(_mm256_and_si256(value, mask), out_shift));
+    }
+    return i;
+}
+
+#elif defined(MONO_UNPACK_NEON)
+
+// vld3按3字节组解交错出b0/b1/b2，偶数和奇数像素分别计算后由vst2交错写回
+static size_t packed_neon(const unsigned char* src, size_t src_len, uint16_t* dst, size_t count, int bits, int shift) {
+    const int16x8_t high_shift = vdupq_n_s16((int16_t)(bits - 8));
+    const int16x8_t out_shift = vdupq_n_s16((int16_t)shift);
+    const uint8x8_t low_mask = vdup_n_u8((uint8_t)((1 << (bits - 8)) - 1));
+    size_t i = 0;
+    for (; i + 16 <= count && i / 2 * 3 + 24 <= src_len; i += 16) {
+        uint8x8x3_t groups = vld3_u8(src + i / 2 * 3);
+        uint16x8x2_t value;
+        value.val[0] = vshlq_u16(vorrq_u16(vshlq_u16(vmovl_u8(groups.val[0]), high_shift),
+                                           vmovl_u8(vand_u8(groups.val[1], low_mask))), out_shift);
+        value.val[1] = vshlq_u16(vorrq_u16(vshlq_u16(vmovl_u8(groups.val[2]), high_shift),
+                                           vmovl_u8(vand_u8(vshr_n_u8(groups.val[1], 4), low_mask))), out_shift);
+        vst2q_u16(dst + i, value);
+    }
+    return i;
+}
+
+static size_t widen_neon(const unsigned char* src, uint16_t* dst, size_t count, int shift) {
+    const int16x8_t out_shift = vdupq_n_s16((int16_t)shift);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t bytes = vld1q_u8(src + i);
+        vst1q_u16(dst + i, vshlq_u16(vmovl_u8(vget_low_u8(bytes)), out_shift));
+        vst1q_u16(dst + i + 8, vshlq_u16(vmovl_u8(vget_high_u8(bytes)), out_shift));
+    }
+    return i;
+}
+
+static size_t mask_neon(const unsigned char* src, uint16_t* dst, size_t count, int bits, int shift) {
+    const uint16x8_t mask = vdupq_n_u16((uint16_t)((1 << bits) - 1));
+    const int16x8_t out_shift = vdupq_n_s16((int16_t)shift);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t value = vreinterpretq_u16_u8(vld1q_u8(src + 2 * i));
+        vst1q_u16(dst + i, vshlq_u16(vandq_u16(value, mask), out_shift));
+    }
+    return i;
+}
+
+#endif
+
+static UnpackKernels select_kernels() {
+    UnpackKernels kernels;
+#if defined(MONO_UNPACK_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.packed = packed_avx2;
+        kernels.widen = widen_avx2;
+        kernels.mask = mask_avx2;
+        kernels.name = "avx2";
+    } else if (__builtin_cpu_supports("ssse3")) {
+        kernels.packed = packed_ssse3;
+        kernels.widen = widen_ssse3;
+        kernels.mask = mask_ssse3;
+        kernels.name = "ssse3";
+    }
+#elif defined(MONO_UNPACK_NEON)
+    kernels.packed = packed_neon;
+    kernels.widen = widen_neon;
+    kernels.mask = mask_neon;
+    kernels.name = "neon";
+#endif
+    return kernels;
+}
+
+static const UnpackKernels& unpack_kernels() {
+    static const UnpackKernels kernels = select_kernels();
+    return kernels;
+}
+
+// 解包像素[begin, end)；begin为偶数
+static void unpack_range(const unsigned char* src, size_t src_len, UnpackKind kind, int bits, int shift,
+                         size_t begin, size_t end, uint16_t* dst) {
+    const UnpackKernels& kernels = unpack_kernels();
+    size_t count = end - begin;
+    size_t done = 0;
+    switch (kind) {
+        case UnpackKind::Packed: {
+            size_t offset = begin / 2 * 3;
+            const unsigned char* p = src + offset;
+            size_t available = src_len - offset;
+            if (kernels.packed) {
+                done = kernels.packed(p, available, dst + begin, count, bits, shift);
+            }
+            packed_scalar(p + done / 2 * 3, available - done / 2 * 3, dst + begin + done, count - done, bits, shift);
+            break;
+        }
+        case UnpackKind::Widen8:
+            if (kernels.widen) {
+                done = kernels.widen(src + begin, dst + begin, count, shift);
+            }
+            widen_scalar(src + begin + done, dst + begin + done, count - done, shift);
+            break;
+        case UnpackKind::Mask16:
+            if (kernels.mask) {
+                done = kernels.mask(src + 2 * begin, dst + begin, count, bits, shift);
+            }
+            mask_scalar(src + 2 * (begin + done), dst + begin + done, count - done, bits, shift);
+            break;
+    }
+}
+
+bool MonoUnpacker::is_supported(MvGvspPixelType pixel_type) {
+    return bit_depth(pixel_type) != 0;
+}
+
+bool MonoUnpacker::is_packed(MvGvspPixelType pixel_type) {
+    return pixel_type == PixelType_Gvsp_Mono10_Packed || pixel_type == PixelType_Gvsp_Mono12_Packed;
+}
+
+int MonoUnpacker::bit_depth(MvGvspPixelType pixel_type) {
+    switch (pixel_type) {
+        case PixelType_Gvsp_Mono8:
+            return 8;
+        case PixelType_Gvsp_Mono10:
+        case PixelType_Gvsp_Mono10_Packed:
+            return 10;
+        case PixelType_Gvsp_Mono12:
+        case PixelType_Gvsp_Mono12_Packed:
+            return 12;
+        default:
+            return 0;
+    }
+}
+
+size_t MonoUnpacker::frame_bytes(MvGvspPixelType pixel_type, size_t pixel_count) {
+    int bits = bit_depth(pixel_type);
+    if (bits == 0) {
+        return 0;
+    }
+    if (is_packed(pixel_type)) {
+        return (pixel_count * 3 + 1) / 2;
+    }
+    return bits == 8 ? pixel_count : pixel_count * 2;
+}
+
+bool MonoUnpacker::unpack(const unsigned char* src, size_t src_len, MvGvspPixelType pixel_type, size_t pixel_count,
+                          uint16_t* dst, int shift) {
+    int bits = bit_depth(pixel_type);
+    if (bits == 0) {
+        std::cerr << "MonoUnpacker does not support PixelFormat [0x" << std::hex << (unsigned int)pixel_type << "]" << std::dec << std::endl;
+        return false;
+    }
+    if (!src || !dst || shift < 0 || shift > 16 - bits) {
+        return false;
+    }
+    if (src_len < frame_bytes(pixel_type, pixel_count)) {
+        std::cerr << "Mono frame is too short: " << src_len << " < " << frame_bytes(pixel_type, pixel_count) << " bytes" << std::endl;
+        return false;
+    }
+
+    UnpackKind kind = is_packed(pixel_type) ? UnpackKind::Packed : (bits == 8 ? UnpackKind::Widen8 : UnpackKind::Mask16);
+    if (pixel_count < kParallelPixels) {
+        unpack_range(src, src_len, kind, bits, shift, 0, pixel_count, dst);
+        return true;
+    }
+    int chunks = (int)((pixel_count + kChunkPixels - 1) / kChunkPixels);
+    cv::parallel_for_(cv::Range(0, chunks), [&](const cv::Range& range) {
+        for (int c = range.start; c < range.end; ++c) {
+            size_t begin = (size_t)c * kChunkPixels;
+            size_t end = std::min(begin + kChunkPixels, pixel_count);
+            unpack_range(src, src_len, kind, bits, shift, begin, end, dst);
+        }
+    });
+    return true;
+}
+
+bool MonoUnpacker::pack(const uint16_t* src, size_t pixel_count, MvGvspPixelType pixel_type, unsigned char* dst) {
+    int bits = bit_depth(pixel_type);
+    if (bits == 0 || !src || !dst) {
+        return false;
+    }
+    const unsigned int mask = (1u << bits) - 1;
+    if (is_packed(pixel_type)) {
+        const int high_shift = bits - 8;
+        const unsigned int low_mask = (1u << high_shift) - 1;
+        for (size_t i = 0; i < pixel_count; i += 2) {
+            unsigned int p0 = src[i] & mask;
+            unsigned int p1 = i + 1 < pixel_count ? src[i + 1] & mask : 0;
+            unsigned char* group = dst + i / 2 * 3;
+            group[0] = (unsigned char)(p0 >> high_shift);
+            group[1] = (unsigned char)((p0 & low_mask) | ((p1 & low_mask) << 4));
+            if (i + 1 < pixel_count) {
+                group[2] = (unsigned char)(p1 >> high_shift);
+            }
+        }
+    } else if (bits == 8) {
+        for (size_t i = 0; i < pixel_count; ++i) {
+            dst[i] = (unsigned char)(src[i] & mask);
+        }
+    } else {
+        for (size_t i = 0; i < pixel_count; ++i) {
+            unsigned int value = src[i] & mask;
+            dst[2 * i] = (unsigned char)(value & 0xff);
+            dst[2 * i + 1] = (unsigned char)(value >> 8);
+        }
+    }
+    return true;
+}
+
+const char* MonoUnpacker::kernel_name() {
+    return unpack_kernels().name;
+}
+
+UnpackCompareResult MonoUnpacker::compare_with_sdk(void* handle, int width, int height, MvGvspPixelType pixel_type,
+                                                   int iterations) {
+    using Clock = std::chrono::steady_clock;
+    UnpackCompareResult result;
+    int bits = bit_depth(pixel_type);
+    if (bits == 0 || width <= 0 || height <= 0) {
+        return result;
+    }
+    iterations = std::max(iterations, 1);
+
+    // 合成数据覆盖全部有效位（包括Packed格式共享字节中的低位）
+    size_t count = (size_t)width * height;
+    const unsigned int max_value = (1u << bits) - 1;
+    std::vector<uint16_t> reference(count);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            reference[(size_t)y * width + x] = (uint16_t)(((unsigned int)(x * 4 + y * 3) ^ (unsigned int)(x >> 2)) & max_value);
+        }
+    }
+    std::vector<unsigned char> src(frame_bytes(pixel_type, count));
+    pack(reference.data(), count, pixel_type, src.data());
+
+    std::vector<uint16_t> ours(count);
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        unpack(src.data(), src.size(), pixel_type, count, ours.data());
+    }
+    result.unpack_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+    result.exact = ours == reference;
+
+    // Packed格式先和SDK的解包比较；不支持时退回到转为Mono8
+    std::vector<MvGvspPixelType> targets;
+    if (is_packed(pixel_type)) {
+        targets.push_back(bits == 12 ? PixelType_Gvsp_Mono12 : PixelType_Gvsp_Mono10);
+    }
+    if (bits > 8) {
+        targets.push_back(PixelType_Gvsp_Mono8);
+    }
+    if (targets.empty()) {
+        std::cerr << "No MV_CC_ConvertPixelTypeEx target to compare Mono8 against" << std::endl;
+        return result;
+    }
+
+    for (MvGvspPixelType target : targets) {
+        bool wide = target != PixelType_Gvsp_Mono8;
+        std::vector<unsigned char> sdk_buffer(wide ? count * 2 : count);
+        MV_CC_PIXEL_CONVERT_PARAM_EX stConvertParam;
+        std::memset(&stConvertParam, 0, sizeof(stConvertParam));
+        stConvertParam.nWidth = width;
+        stConvertParam.nHeight = height;
+        stConvertParam.enSrcPixelType = pixel_type;
+        stConvertParam.pSrcData = src.data();
+        stConvertParam.nSrcDataLen = (unsigned int)src.size();
+        stConvertParam.enDstPixelType = target;
+        stConvertParam.pDstBuffer = sdk_buffer.data();
+        stConvertParam.nDstBufferSize = (unsigned int)sdk_buffer.size();
+        int nRet = MV_CC_ConvertPixelTypeEx(handle, &stConvertParam);
+        if (nRet != MV_OK) {
+            std::cerr << "MV_CC_ConvertPixelTypeEx to [0x" << std::hex << (unsigned int)target << "] failed! Error Code: [0x" << nRet << "]" << std::dec << std::endl;
+            continue;
+        }
+        start = Clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            MV_CC_ConvertPixelTypeEx(handle, &stConvertParam);
+        }
+        result.sdk_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+
+        // Mono8目标与本类结果的高8位比较
+        double sum = 0.0;
+        unsigned int max_diff = 0;
+        for (size_t i = 0; i < count; ++i) {
+            unsigned int sdk = wide ? (unsigned int)sdk_buffer[2 * i] | ((unsigned int)sdk_buffer[2 * i + 1] << 8)
+                                    : sdk_buffer[i];
+            unsigned int value = wide ? ours[i] : (unsigned int)ours[i] >> (bits - 8);
+            unsigned int diff = sdk > value ? sdk - value : value - sdk;
+            sum += diff;
+            max_diff = std::max(max_diff, diff);
+        }
+        result.sdk_pixel_type = target;
+        result.mean_abs_diff = sum / (double)count;
+        result.max_abs_diff = max_diff;
+        result.ok = true;
+        break;
+    }
+    return result;
+}
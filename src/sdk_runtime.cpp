@@ -0,0 +1,128 @@
+// sdk_runtime.cpp
+
+#include "sdk_runtime.h"
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+static std::mutex g_sdk_mutex;
+static int g_sdk_refcount = 0;
+
+// 设备信息的副本（SDK返回的列表在下次枚举时失效）
+struct CachedDevice {
+    std::string serial;
+    MV_CC_DEVICE_INFO info;
+};
+static std::vector<CachedDevice> g_devices;
+static unsigned int g_enumerated_layers = 0;
+
+bool SdkRuntime::acquire() {
+    std::lock_guard<std::mutex> lock(g_sdk_mutex);
+    if (g_sdk_refcount == 0) {
+        int nRet = MV_CC_Initialize();
+        if (nRet != MV_OK) {
+            std::cerr << "Failed to initialize SDK! Error Code: [0x" << std::hex << nRet << "]" << std::endl;
+            return false;
+        }
+    }
+    ++g_sdk_refcount;
+    return true;
+}
+
+void SdkRuntime::release() {
+    std::lock_guard<std::mutex> lock(g_sdk_mutex);
+    if (g_sdk_refcount > 0 && --g_sdk_refcount == 0) {
+        MV_CC_Finalize();
+        g_devices.clear();
+        g_enumerated_layers = 0;
+    }
+}
+
+// 调用方持有g_sdk_mutex
+static bool enumerate_layers(unsigned int layer_types) {
+    MV_CC_DEVICE_INFO_LIST device_list;
+    std::memset(&device_list, 0, sizeof(device_list));
+    int nRet = MV_CC_EnumDevices(layer_types, &device_list);
+    if (nRet != MV_OK) {
+        std::cerr << "Enum devices failed! Error Code: [0x" << std::hex << nRet << "]" << std::dec << std::endl;
+        return false;
+    }
+
+    // 只替换本次枚举的传输层，其他传输层的缓存保留
+    std::vector<CachedDevice> devices;
+    for (const CachedDevice& device : g_devices) {
+        if (!(device.info.nTLayerType & layer_types)) {
+            devices.push_back(device);
+        }
+    }
+    for (unsigned int i = 0; i < device_list.nDeviceNum; ++i) {
+        if (device_list.pDeviceInfo[i]) {
+            CachedDevice device;
+            device.info = *device_list.pDeviceInfo[i];
+            device.serial = SdkRuntime::device_serial(device.info);
+            devices.push_back(device);
+        }
+    }
+    g_devices.swap(devices);
+    g_enumerated_layers |= layer_types;
+    return true;
+}
+
+std::vector<std::string> SdkRuntime::enumerate(unsigned int layer_types, bool refresh) {
+    std::lock_guard<std::mutex> lock(g_sdk_mutex);
+    std::vector<std::string> serials;
+    if (refresh || (layer_types & ~g_enumerated_layers)) {
+        if (!enumerate_layers(layer_types)) {
+            return serials;
+        }
+    }
+    for (const CachedDevice& device : g_devices) {
+        if (device.info.nTLayerType & layer_types) {
+            serials.push_back(device.serial);
+        }
+    }
+    return serials;
+}
+
+bool SdkRuntime::find_device(const std::string& serial, unsigned int layer_types, MV_CC_DEVICE_INFO& device_info,
+                             bool refresh) {
+    std::lock_guard<std::mutex> lock(g_sdk_mutex);
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (refresh || attempt > 0 || (layer_types & ~g_enumerated_layers)) {
+            if (!enumerate_layers(layer_types)) {
+                return false;
+            }
+            refresh = true;     // 已经是最新结果，不再重复枚举
+        }
+        for (const CachedDevice& device : g_devices) {
+            if ((device.info.nTLayerType & layer_types) && device.serial == serial) {
+                device_info = device.info;
+                return true;
+            }
+        }
+        if (refresh) {
+            break;
+        }
+    }
+    return false;
+}
+
+std::string SdkRuntime::device_serial(const MV_CC_DEVICE_INFO& device_info) {
+    const unsigned char* serial = nullptr;
+    size_t max_length = 0;
+    if (device_info.nTLayerType == MV_USB_DEVICE) {
+        serial = device_info.SpecialInfo.stUsb3VInfo.chSerialNumber;
+        max_length = sizeof(device_info.SpecialInfo.stUsb3VInfo.chSerialNumber);
+    } else if (device_info.nTLayerType == MV_GIGE_DEVICE) {
+        serial = device_info.SpecialInfo.stGigEInfo.chSerialNumber;
+        max_length = sizeof(device_info.SpecialInfo.stGigEInfo.chSerialNumber);
+    } else {
+        return std::string();
+    }
+    // 序列号字段不保证以'\0'结尾
+    size_t length = 0;
+    while (length < max_length && serial[length] != '\0') {
+        ++length;
+    }
+    return std::string(reinterpret_cast<const char*>(serial), length);
+}
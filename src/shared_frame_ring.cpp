@@ -0,0 +1,481 @@
+// shared_frame_ring.cpp
+
+#include "shared_frame_ring.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char kSharedRingMagic[8] = { 'H', 'K', 'S', 'H', 'R', 'I', 'N', 'G' };
+static const uint32_t kSharedRingVersion = 2;
+
+// 发布者每kHeartbeatInterval更新一次心跳；超过kHeartbeatTimeout未更新视为发布进程已退出
+static const std::chrono::milliseconds kHeartbeatInterval(100);
+static const std::chrono::milliseconds kHeartbeatTimeout(2000);
+
+// 两个进程共用这些原子变量，必须是无锁实现（地址无关）
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared ring needs lock-free 64-bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared ring needs lock-free 32-bit atomics");
+
+struct SharedRingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t slot_count;
+    uint64_t slot_size;
+    uint64_t slot_stride;
+    uint64_t data_offset;
+    uint64_t total_bytes;
+    std::atomic<int64_t> heartbeat_us;              // steady_clock（CLOCK_MONOTONIC，各进程相同），us
+    std::atomic<uint32_t> closed;
+    alignas(64) std::atomic<uint64_t> head;         // 已发布的帧数（下一帧的序号）
+    std::atomic<uint64_t> published;
+    alignas(64) std::atomic<uint32_t> notify;       // futex字，每发布一帧加1
+    std::atomic<uint32_t> waiters;                  // 正在等待新帧的订阅者数
+};
+
+struct alignas(64) SharedSlotHeader {
+    std::atomic<uint64_t> version;                  // 2*seq+1：写入中；2*seq+2：seq帧可读
+    uint64_t length;
+    MV_FRAME_OUT_INFO_EX info;
+};
+
+static int64_t monotonic_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#ifdef __linux__
+static size_t page_size() {
+    return (size_t)sysconf(_SC_PAGESIZE);
+}
+#endif
+
+static size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+static void futex_wake(std::atomic<uint32_t>* word) {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+// 字的值仍为expected时睡眠，最多timeout_ms；其他平台退化为短睡眠轮询
+static void futex_wait(std::atomic<uint32_t>* word, uint32_t expected, unsigned int timeout_ms) {
+#ifdef __linux__
+    struct timespec timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+#else
+    (void)word;
+    (void)expected;
+    std::this_thread::sleep_for(std::chrono::milliseconds(std::min(timeout_ms, 1u)));
+#endif
+}
+
+#ifdef __linux__
+// 标记同名的旧环为已关闭并唤醒其订阅者，让它们重新open()到新环
+static void retire_existing(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(SharedRingHeader)) {
+        void* p = mmap(nullptr, sizeof(SharedRingHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) {
+            SharedRingHeader* header = static_cast<SharedRingHeader*>(p);
+            if (std::memcmp(header->magic, kSharedRingMagic, sizeof(kSharedRingMagic)) == 0) {
+                header->closed.store(1);
+                header->notify.fetch_add(1);
+                futex_wake(&header->notify);
+            }
+            munmap(p, sizeof(SharedRingHeader));
+        }
+    }
+    ::close(fd);
+}
+#endif
+
+SharedFramePublisher::~SharedFramePublisher() {
+    close();
+}
+
+bool SharedFramePublisher::open(const std::string& name, size_t slot_count, size_t slot_size) {
+    close();
+    if (slot_count < 2 || slot_size == 0 || slot_count > UINT32_MAX) {
+        std::cerr << "Invalid shared ring geometry: " << slot_count << " x " << slot_size << std::endl;
+        return false;
+    }
+
+#ifdef __linux__
+    size_t page = page_size();
+    size_t control_bytes = round_up(sizeof(SharedRingHeader) + slot_count * sizeof(SharedSlotHeader), page);
+    size_t slot_stride = round_up(slot_size, page);
+    size_t total_bytes = control_bytes + slot_stride * slot_count;
+
+    // 同名的旧环（上次运行遗留或正在被订阅）先关闭并解除链接，之后的open看到新环
+    retire_existing(name);
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0660);
+    if (fd < 0) {
+        std::cerr << "Failed to create shared ring " << name << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, (off_t)total_bytes) != 0) {
+        std::cerr << "Failed to size shared ring " << name << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* base = mmap(nullptr, total_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        std::cerr << "Failed to map shared ring " << name << ": " << std::strerror(errno) << std::endl;
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    base_ = static_cast<unsigned char*>(base);
+    bytes_ = total_bytes;
+    name_ = name;
+    header_ = new (base_) SharedRingHeader();
+    slots_ = reinterpret_cast<SharedSlotHeader*>(base_ + sizeof(SharedRingHeader));
+    for (size_t i = 0; i < slot_count; ++i) {
+        new (&slots_[i]) SharedSlotHeader();
+        slots_[i].version.store(0, std::memory_order_relaxed);
+    }
+    data_ = base_ + control_bytes;
+
+    header_->version = kSharedRingVersion;
+    header_->slot_count = (uint32_t)slot_count;
+    header_->slot_size = slot_size;
+    header_->slot_stride = slot_stride;
+    header_->data_offset = control_bytes;
+    header_->total_bytes = total_bytes;
+    header_->heartbeat_us.store(monotonic_us(), std::memory_order_relaxed);
+    header_->closed.store(0, std::memory_order_relaxed);
+    header_->head.store(0, std::memory_order_relaxed);
+    header_->published.store(0, std::memory_order_relaxed);
+    header_->notify.store(0, std::memory_order_relaxed);
+    header_->waiters.store(0, std::memory_order_relaxed);
+    // 魔数最后写入，订阅者看到魔数即看到完整的布局
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header_->magic, kSharedRingMagic, sizeof(kSharedRingMagic));
+    rejected_.store(0, std::memory_order_relaxed);
+
+    heartbeat_stop_ = false;
+    heartbeat_thread_ = std::thread(&SharedFramePublisher::heartbeat_loop, this);
+    return true;
+#else
+    (void)name;
+    std::cerr << "Shared frame rings are only supported on Linux" << std::endl;
+    return false;
+#endif
+}
+
+void SharedFramePublisher::heartbeat_loop() {
+    std::unique_lock<std::mutex> lock(heartbeat_mutex_);
+    while (!heartbeat_cv_.wait_for(lock, kHeartbeatInterval, [&] { return heartbeat_stop_; })) {
+        header_->heartbeat_us.store(monotonic_us(), std::memory_order_relaxed);
+    }
+}
+
+void SharedFramePublisher::stop_heartbeat() {
+    if (!heartbeat_thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(heartbeat_mutex_);
+        heartbeat_stop_ = true;
+    }
+    heartbeat_cv_.notify_all();
+    heartbeat_thread_.join();
+}
+
+void SharedFramePublisher::close() {
+    stop_heartbeat();
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    if (!header_) {
+        return;
+    }
+    header_->closed.store(1);
+    header_->notify.fetch_add(1);
+    futex_wake(&header_->notify);
+#ifdef __linux__
+    munmap(base_, bytes_);
+    shm_unlink(name_.c_str());
+#endif
+    base_ = nullptr;
+    bytes_ = 0;
+    header_ = nullptr;
+    slots_ = nullptr;
+    data_ = nullptr;
+}
+
+void SharedFramePublisher::on_frame(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo) {
+    publish(pData, frameInfo);
+}
+
+bool SharedFramePublisher::publish(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo) {
+    // seqlock只允许一个写者：挂在相机上时取流线程也在写
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    if (!header_ || !pData) {
+        return false;
+    }
+    size_t length = frameInfo.nFrameLen;
+    if (length > header_->slot_size) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint64_t sequence = header_->head.load(std::memory_order_relaxed);
+    size_t index = (size_t)(sequence % header_->slot_count);
+    SharedSlotHeader& slot = slots_[index];
+
+    slot.version.store(2 * sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(data_ + index * header_->slot_stride, pData, length);
+    slot.info = frameInfo;
+    slot.length = length;
+    slot.version.store(2 * sequence + 2, std::memory_order_release);
+
+    header_->head.store(sequence + 1);
+    header_->published.fetch_add(1, std::memory_order_relaxed);
+    // 与订阅者的waiters递增/notify读取配对（均为seq_cst）：没有订阅者在等待时不进内核
+    header_->notify.fetch_add(1);
+    if (header_->waiters.load() > 0) {
+        futex_wake(&header_->notify);
+    }
+    return true;
+}
+
+SharedFrameStats SharedFramePublisher::stats() const {
+    SharedFrameStats stats;
+    stats.published = header_ ? header_->published.load(std::memory_order_relaxed) : 0;
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+SharedFrameSubscriber::~SharedFrameSubscriber() {
+    close();
+}
+
+bool SharedFrameSubscriber::open(const std::string& name) {
+    close();
+#ifndef __linux__
+    std::cerr << "Shared frame rings are only supported on Linux" << std::endl;
+    return false;
+#else
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        std::cerr << "Failed to open shared ring " << name << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SharedRingHeader)) {
+        std::cerr << "Shared ring " << name << " is not initialized" << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    // 先只读映射头部取得布局，再分别映射控制区（读写）和数据区（只读）
+    size_t page = page_size();
+    void* probe = mmap(nullptr, page, PROT_READ, MAP_SHARED, fd, 0);
+    if (probe == MAP_FAILED) {
+        std::cerr << "Failed to map shared ring " << name << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    const SharedRingHeader* layout = static_cast<const SharedRingHeader*>(probe);
+    bool valid = std::memcmp(layout->magic, kSharedRingMagic, sizeof(kSharedRingMagic)) == 0;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    valid = valid && layout->version == kSharedRingVersion && layout->total_bytes == (uint64_t)st.st_size &&
+            layout->data_offset % page == 0 &&
+            layout->data_offset + layout->slot_stride * layout->slot_count == layout->total_bytes;
+    size_t control_bytes = (size_t)layout->data_offset;
+    size_t data_bytes = (size_t)(layout->total_bytes - layout->data_offset);
+    size_t slot_count = layout->slot_count;
+    size_t slot_size = (size_t)layout->slot_size;
+    size_t slot_stride = (size_t)layout->slot_stride;
+    munmap(probe, page);
+    if (!valid) {
+        std::cerr << "Shared ring " << name << " has an incompatible layout" << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    void* control = mmap(nullptr, control_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    void* data = control == MAP_FAILED ? MAP_FAILED
+                                       : mmap(nullptr, data_bytes, PROT_READ, MAP_SHARED, fd, (off_t)control_bytes);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        std::cerr << "Failed to map shared ring " << name << ": " << std::strerror(errno) << std::endl;
+        if (control != MAP_FAILED) {
+            munmap(control, control_bytes);
+        }
+        return false;
+    }
+
+    control_ = static_cast<unsigned char*>(control);
+    control_bytes_ = control_bytes;
+    data_ = static_cast<const unsigned char*>(data);
+    data_bytes_ = data_bytes;
+    header_ = reinterpret_cast<SharedRingHeader*>(control_);
+    slots_ = reinterpret_cast<const SharedSlotHeader*>(control_ + sizeof(SharedRingHeader));
+    slot_count_ = slot_count;
+    slot_size_ = slot_size;
+    slot_stride_ = slot_stride;
+    cursor_ = header_->head.load(std::memory_order_acquire);
+    dropped_ = 0;
+    return true;
+#endif
+}
+
+void SharedFrameSubscriber::close() {
+#ifdef __linux__
+    if (control_) {
+        munmap(control_, control_bytes_);
+    }
+    if (data_) {
+        munmap(const_cast<unsigned char*>(data_), data_bytes_);
+    }
+#endif
+    control_ = nullptr;
+    data_ = nullptr;
+    header_ = nullptr;
+    slots_ = nullptr;
+    control_bytes_ = 0;
+    data_bytes_ = 0;
+}
+
+bool SharedFrameSubscriber::publisher_closed() const {
+    if (!header_) {
+        return true;
+    }
+    if (header_->closed.load(std::memory_order_acquire)) {
+        return true;
+    }
+    // 发布进程异常退出时没有机会设置closed，只能从心跳停止更新判断
+    int64_t age_us = monotonic_us() - header_->heartbeat_us.load(std::memory_order_relaxed);
+    return age_us > std::chrono::duration_cast<std::chrono::microseconds>(kHeartbeatTimeout).count();
+}
+
+uint64_t SharedFrameSubscriber::head() const {
+    return header_ ? header_->head.load(std::memory_order_acquire) : 0;
+}
+
+bool SharedFrameSubscriber::view_slot(uint64_t sequence, SharedFrameView& view) const {
+    size_t index = (size_t)(sequence % slot_count_);
+    const SharedSlotHeader& slot = slots_[index];
+    const uint64_t expected = 2 * sequence + 2;
+    if (slot.version.load(std::memory_order_acquire) != expected) {
+        return false;
+    }
+    MV_FRAME_OUT_INFO_EX info = slot.info;
+    size_t length = std::min<size_t>(slot.length, slot_size_);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.version.load(std::memory_order_relaxed) != expected) {
+        return false;
+    }
+    view.data = data_ + index * slot_stride_;
+    view.length = length;
+    view.sequence = sequence;
+    view.info = info;
+    return true;
+}
+
+bool SharedFrameSubscriber::still_valid(uint64_t sequence) const {
+    if (!header_) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slots_[sequence % slot_count_].version.load(std::memory_order_relaxed) == 2 * sequence + 2;
+}
+
+bool SharedFrameSubscriber::copy(const SharedFrameView& view, unsigned char* pData, size_t size) const {
+    if (!view.data || view.length > size) {
+        return false;
+    }
+    std::memcpy(pData, view.data, view.length);
+    return still_valid(view.sequence);
+}
+
+bool SharedFrameSubscriber::wait_for(uint64_t sequence, unsigned int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (header_->head.load() <= sequence) {
+        if (header_->closed.load()) {
+            return false;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            return false;
+        }
+        unsigned int remaining = (unsigned int)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count() + 1;
+        uint32_t observed = header_->notify.load();
+        header_->waiters.fetch_add(1);
+        if (header_->head.load() <= sequence) {
+            futex_wait(&header_->notify, observed, remaining);
+        }
+        header_->waiters.fetch_sub(1);
+    }
+    return true;
+}
+
+bool SharedFrameSubscriber::read_next(SharedFrameView& view, unsigned int timeout_ms) {
+    if (!header_) {
+        return false;
+    }
+    while (true) {
+        uint64_t head = header_->head.load(std::memory_order_acquire);
+        if (cursor_ >= head) {
+            if (!wait_for(cursor_, timeout_ms)) {
+                return false;
+            }
+            continue;
+        }
+        // 落后超过环长度：跳到仍保留在环中的最旧一帧
+        if (head - cursor_ > slot_count_) {
+            dropped_ += head - slot_count_ - cursor_;
+            cursor_ = head - slot_count_;
+        }
+        if (view_slot(cursor_, view)) {
+            ++cursor_;
+            return true;
+        }
+        // 读取时正被覆盖
+        ++dropped_;
+        ++cursor_;
+    }
+}
+
+bool SharedFrameSubscriber::read_latest(SharedFrameView& view) {
+    if (!header_) {
+        return false;
+    }
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        uint64_t head = header_->head.load(std::memory_order_acquire);
+        if (head == 0) {
+            return false;
+        }
+        if (view_slot(head - 1, view)) {
+            cursor_ = head;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,286 @@
+// snapshot_encoder.cpp
+
+#include "snapshot_encoder.h"
+#include "bayer_pipeline.h"
+#include "mono_unpack.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+SnapshotEncoder::SnapshotEncoder(int num_threads, size_t max_queue)
+    : max_queue_(std::max<size_t>(max_queue, 1)) {
+    int threads = std::max(num_threads, 1);
+    for (int i = 0; i < threads; ++i) {
+        workers_.emplace_back(&SnapshotEncoder::worker_loop, this);
+    }
+}
+
+SnapshotEncoder::~SnapshotEncoder() {
+    // 已入队的快照全部写完后才退出
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+const char* SnapshotEncoder::extension(SnapshotFormat format) {
+    switch (format) {
+        case SnapshotFormat::JPEG: return ".jpg";
+        case SnapshotFormat::TIFF: return ".tiff";
+        case SnapshotFormat::RAW: return ".raw";
+        default: return ".png";
+    }
+}
+
+std::unique_ptr<SnapshotEncoder::Job> SnapshotEncoder::acquire_job() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ || queue_.size() >= max_queue_) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    std::unique_ptr<Job> job;
+    if (!free_jobs_.empty()) {
+        job = std::move(free_jobs_.back());
+        free_jobs_.pop_back();
+    } else {
+        job.reset(new Job());
+    }
+    job->promise = std::promise<SnapshotResult>();
+    job->burst.reset();
+    job->burst_index = 0;
+    return job;
+}
+
+std::future<SnapshotResult> SnapshotEncoder::enqueue(std::unique_ptr<Job> job) {
+    std::future<SnapshotResult> future = job->promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(job));
+    }
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    cv_.notify_one();
+    return future;
+}
+
+std::future<SnapshotResult> SnapshotEncoder::submit(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo,
+                                                    const std::string& path_prefix, SnapshotFormat format, int quality) {
+    if (!pData) {
+        return std::future<SnapshotResult>();
+    }
+    std::unique_ptr<Job> job = acquire_job();
+    if (!job) {
+        return std::future<SnapshotResult>();
+    }
+    // 缓冲区跨任务复用，容量只增不减
+    job->data.assign(pData, pData + frameInfo.nFrameLen);
+    job->info = frameInfo;
+    job->path = path_prefix + "_" + std::to_string(frameInfo.nFrameNum) + extension(format);
+    job->format = format;
+    job->quality = quality;
+    return enqueue(std::move(job));
+}
+
+std::future<SnapshotResult> SnapshotEncoder::submit(const cv::Mat& image, const std::string& path_prefix,
+                                                    SnapshotFormat format, int quality) {
+    if (image.empty() || image.depth() != CV_8U || (image.channels() != 1 && image.channels() != 3)) {
+        std::cerr << "Snapshot image must be 8-bit mono or BGR." << std::endl;
+        return std::future<SnapshotResult>();
+    }
+    std::unique_ptr<Job> job = acquire_job();
+    if (!job) {
+        return std::future<SnapshotResult>();
+    }
+    size_t row_bytes = (size_t)image.cols * image.elemSize();
+    job->data.resize(row_bytes * image.rows);
+    for (int y = 0; y < image.rows; ++y) {
+        std::memcpy(job->data.data() + y * row_bytes, image.ptr<unsigned char>(y), row_bytes);
+    }
+    std::memset(&job->info, 0, sizeof(job->info));
+    job->info.nWidth = (unsigned short)image.cols;
+    job->info.nHeight = (unsigned short)image.rows;
+    job->info.enPixelType = image.channels() == 3 ? PixelType_Gvsp_BGR8_Packed : PixelType_Gvsp_Mono8;
+    job->info.nFrameLen = (unsigned int)job->data.size();
+    job->info.nFrameNum = (unsigned int)submitted_.load(std::memory_order_relaxed);
+    job->path = path_prefix + "_" + std::to_string(job->info.nFrameNum) + extension(format);
+    job->format = format;
+    job->quality = quality;
+    return enqueue(std::move(job));
+}
+
+std::future<std::vector<SnapshotResult>> SnapshotEncoder::arm_burst(size_t count, const std::string& path_prefix,
+                                                                    SnapshotFormat format, int quality) {
+    std::lock_guard<std::mutex> lock(burst_mutex_);
+    std::shared_ptr<Burst> burst = std::make_shared<Burst>();
+    std::future<std::vector<SnapshotResult>> future = burst->promise.get_future();
+    if (count == 0) {
+        burst->promise.set_value(std::vector<SnapshotResult>());
+        return future;
+    }
+    burst->results.resize(count);
+    burst->remaining = count;
+    burst_ = burst;
+    burst_next_ = 0;
+    burst_prefix_ = path_prefix;
+    burst_format_ = format;
+    burst_quality_ = quality;
+    burst_armed_.store(true, std::memory_order_release);
+    return future;
+}
+
+void SnapshotEncoder::on_frame(const unsigned char* pData, const MV_FRAME_OUT_INFO_EX& frameInfo) {
+    if (!burst_armed_.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(burst_mutex_);
+    if (!burst_ || burst_next_ >= burst_->results.size()) {
+        return;
+    }
+    std::shared_ptr<Burst> burst = burst_;
+    size_t index = burst_next_++;
+    if (burst_next_ >= burst->results.size()) {
+        burst_armed_.store(false, std::memory_order_relaxed);
+        burst_.reset();
+    }
+
+    std::unique_ptr<Job> job = acquire_job();
+    if (!job) {
+        SnapshotResult rejected;
+        finish_burst(*burst, index, rejected);
+        return;
+    }
+    job->data.assign(pData, pData + frameInfo.nFrameLen);
+    job->info = frameInfo;
+    job->path = burst_prefix_ + "_" + std::to_string(frameInfo.nFrameNum) + extension(burst_format_);
+    job->format = burst_format_;
+    job->quality = burst_quality_;
+    job->burst = burst;
+    job->burst_index = index;
+    enqueue(std::move(job));
+}
+
+void SnapshotEncoder::finish_burst(Burst& burst, size_t index, const SnapshotResult& result) {
+    burst.results[index] = result;
+    if (burst.remaining.fetch_sub(1) == 1) {
+        burst.promise.set_value(std::move(burst.results));
+    }
+}
+
+void SnapshotEncoder::worker_loop() {
+    while (true) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            ++in_flight_;
+        }
+
+        SnapshotResult result = encode(*job);
+        (result.ok ? completed_ : failed_).fetch_add(1, std::memory_order_relaxed);
+        if (job->burst) {
+            finish_burst(*job->burst, job->burst_index, result);
+        }
+        job->promise.set_value(result);
+        job->burst.reset();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        --in_flight_;
+        free_jobs_.push_back(std::move(job));
+    }
+}
+
+SnapshotResult SnapshotEncoder::encode(Job& job) {
+    SnapshotResult result;
+    result.path = job.path;
+    auto start = std::chrono::steady_clock::now();
+
+    if (job.format == SnapshotFormat::RAW) {
+        FILE* file = std::fopen(job.path.c_str(), "wb");
+        if (file) {
+            result.ok = std::fwrite(job.data.data(), 1, job.data.size(), file) == job.data.size();
+            result.ok = std::fclose(file) == 0 && result.ok;
+        }
+    } else {
+        cv::Size size(job.info.nWidth, job.info.nHeight);
+        cv::Mat image;
+        MvGvspPixelType pixel_type = job.info.enPixelType;
+        bool color = pixel_type == PixelType_Gvsp_BGR8_Packed || pixel_type == PixelType_Gvsp_RGB8_Packed;
+        size_t required = MonoUnpacker::is_supported(pixel_type) ? MonoUnpacker::frame_bytes(pixel_type, size.area())
+                                                                 : size.area() * (size_t)(color ? 3 : 1);
+        if (job.data.size() < required) {
+            // 数据不足一整帧，下面的分支都不会执行
+            pixel_type = PixelType_Gvsp_Undefined;
+        }
+        if (pixel_type == PixelType_Gvsp_BGR8_Packed) {
+            image = cv::Mat(size, CV_8UC3, job.data.data());
+        } else if (pixel_type == PixelType_Gvsp_RGB8_Packed) {
+            cv::cvtColor(cv::Mat(size, CV_8UC3, job.data.data()), image, cv::COLOR_RGB2BGR);
+        } else if (pixel_type == PixelType_Gvsp_Mono8) {
+            image = cv::Mat(size, CV_8UC1, job.data.data());
+        } else if (BayerDemosaicer::is_bayer8(pixel_type)) {
+            BayerDemosaicer demosaicer;
+            demosaicer.configure(size, pixel_type, size);
+            demosaicer.process(job.data.data(), size.width, image);
+        } else if (MonoUnpacker::bit_depth(pixel_type) > 8) {
+            // Mono10/12（含Packed）解包为16位：PNG/TIFF保留原始数值，JPEG只支持8位，取高8位
+            cv::Mat unpacked(size, CV_16UC1);
+            if (MonoUnpacker::unpack(job.data.data(), job.data.size(), pixel_type, size.area(),
+                                     unpacked.ptr<uint16_t>())) {
+                if (job.format == SnapshotFormat::JPEG) {
+                    unpacked.convertTo(image, CV_8U, 1.0 / (1 << (MonoUnpacker::bit_depth(pixel_type) - 8)));
+                } else {
+                    image = unpacked;
+                }
+            }
+        }
+
+        if (image.empty()) {
+            std::cerr << "Snapshot: unsupported PixelType [0x" << std::hex << (unsigned int)job.info.enPixelType << "]" << std::dec
+                      << ", use SnapshotFormat::RAW" << std::endl;
+        } else {
+            std::vector<int> params;
+            if (job.format == SnapshotFormat::JPEG) {
+                params = { cv::IMWRITE_JPEG_QUALITY, std::min(std::max(job.quality, 0), 100) };
+            } else if (job.format == SnapshotFormat::TIFF) {
+                params = { cv::IMWRITE_TIFF_COMPRESSION, 1 };
+            } else {
+                params = { cv::IMWRITE_PNG_COMPRESSION, 1 };   // 快速压缩，仍为无损
+            }
+            try {
+                result.ok = cv::imwrite(job.path, image, params);
+            } catch (const cv::Exception& e) {
+                std::cerr << "Snapshot encode failed: " << e.what() << std::endl;
+            }
+        }
+    }
+
+    result.encode_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (!result.ok) {
+        std::cerr << "Failed to save snapshot " << job.path << std::endl;
+    }
+    return result;
+}
+
+SnapshotStats SnapshotEncoder::stats() const {
+    SnapshotStats stats;
+    stats.submitted = submitted_.load(std::memory_order_relaxed);
+    stats.completed = completed_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    stats.queue_depth = queue_depth();
+    return stats;
+}
+
+size_t SnapshotEncoder::queue_depth() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size() + in_flight_;
+}
@@ -1,6 +1,8 @@
 #include "undistort.h"
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 ImageUndistorter::ImageUndistorter(const std::string& calibrationFile) {                             // ImageUndistorter类，内外参文件路径作为参数
@@ -19,27 +21,384 @@ ImageUndistorter::ImageUndistorter(const std::string& calibrationFile) {
 }
 
 void ImageUndistorter::undistort_image(const cv::Mat& src, cv::Mat& dst) {
+    undistort_image(src, dst, -1.0, cv::INTER_LINEAR, false);                                       // 与cv::undistort(newCameraMatrix=camera_matrix_)一致
+}
+
+void ImageUndistorter::undistort_image(const cv::Mat& src, cv::Mat& dst, double alpha,
+                                       int interpolation, bool crop_to_roi) {
     if (camera_matrix_.empty() || dist_coeffs_.empty()) {
         std::cerr << "Calibration parameters are not loaded properly." << std::endl;
         return;
     }
-    cv::undistort(src, dst, camera_matrix_, dist_coeffs_, camera_matrix_);
+    if (src.empty()) {
+        return;
+    }
+    if (!dst.empty() && dst.data == src.data) {
+        std::cerr << "In-place undistortion is not supported." << std::endl;
+        return;
+    }
+
+    // 持有表的引用计数，其他线程clear_cache()不会释放正在使用的表
+    std::shared_ptr<const RemapTable> table_ref = get_remap_table(src.size(), alpha, interpolation);
+    const RemapTable& table = *table_ref;
+    cv::Rect roi(0, 0, src.cols, src.rows);
+    if (crop_to_roi && !table.valid_roi.empty()) {
+        roi = table.valid_roi;
+    }
+
+    dst.create(roi.size(), src.type());                                                             // 尺寸类型一致时不重新分配
+    cv::Mat map1 = table.map1(roi);
+    cv::Mat map2 = table.map2.empty() ? cv::Mat() : table.map2(roi);
+
+    int stripes = num_threads_ > 0 ? num_threads_ : cv::getNumThreads();
+    if (stripes <= 1 || dst.rows < stripes) {
+        cv::remap(src, dst, map1, map2, interpolation, cv::BORDER_CONSTANT);
+        return;
+    }
+
+    // 按行分块并行remap，每块直接写入dst对应的行
+    cv::parallel_for_(cv::Range(0, dst.rows), [&](const cv::Range& rows) {
+        cv::Mat dst_rows = dst.rowRange(rows.start, rows.end);
+        cv::Mat map2_rows = map2.empty() ? cv::Mat() : map2.rowRange(rows.start, rows.end);
+        cv::remap(src, dst_rows, map1.rowRange(rows.start, rows.end), map2_rows, interpolation, cv::BORDER_CONSTANT);
+    }, stripes);
+}
+
+cv::Mat ImageUndistorter::compute_new_camera_matrix(const cv::Size& size, double alpha, cv::Rect& valid_roi) const {
+    if (alpha < 0) {
+        valid_roi = cv::Rect(0, 0, size.width, size.height);
+        return camera_matrix_;
+    }
+    return cv::getOptimalNewCameraMatrix(camera_matrix_, dist_coeffs_, size, alpha, size, &valid_roi);
+}
+
+std::shared_ptr<const ImageUndistorter::RemapTable> ImageUndistorter::get_remap_table(const cv::Size& size, double alpha,
+                                                                                      int interpolation) {
+    RemapKey key = { size.width, size.height, alpha < 0 ? -1.0 : alpha, interpolation };
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        auto it = remap_cache_.find(key);
+        if (it != remap_cache_.end()) {
+            return it->second;
+        }
+    }
+
+    std::shared_ptr<RemapTable> table = std::make_shared<RemapTable>();
+    table->new_camera_matrix = compute_new_camera_matrix(size, key.alpha, table->valid_roi);
+
+    // 定点映射表（CV_16SC2 + 插值表），比浮点表小一半且remap更快；最近邻不需要插值表
+    cv::Mat map_x, map_y;
+    cv::initUndistortRectifyMap(camera_matrix_, dist_coeffs_, cv::Mat(), table->new_camera_matrix,
+                                size, CV_32FC1, map_x, map_y);
+    cv::convertMaps(map_x, map_y, table->map1, table->map2, CV_16SC2, interpolation == cv::INTER_NEAREST);
+
+    // 并发构建同一张表时保留先插入的那张
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    return remap_cache_.emplace(key, table).first->second;
+}
+
+void ImageUndistorter::set_num_threads(int num_threads) {
+    num_threads_ = num_threads < 0 ? 0 : num_threads;
+}
+
+void ImageUndistorter::clear_cache() {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    remap_cache_.clear();
+    point_models_.clear();
+    point_luts_.clear();
+}
+
+cv::Mat ImageUndistorter::get_new_camera_matrix(const cv::Size& size, double alpha) {
+    if (!is_loaded()) {
+        return cv::Mat();
+    }
+    cv::Rect roi;
+    return compute_new_camera_matrix(size, alpha, roi);
+}
+
+cv::Rect ImageUndistorter::get_valid_roi(const cv::Size& size, double alpha) {
+    if (!is_loaded()) {
+        return cv::Rect(0, 0, size.width, size.height);
+    }
+    cv::Rect roi;
+    compute_new_camera_matrix(size, alpha, roi);
+    return roi.empty() ? cv::Rect(0, 0, size.width, size.height) : roi;
+}
+
+void ImageUndistorter::get_float_maps(const cv::Size& size, double alpha, cv::Mat& map_x, cv::Mat& map_y) {
+    if (!is_loaded()) {
+        map_x.release();
+        map_y.release();
+        return;
+    }
+    cv::initUndistortRectifyMap(camera_matrix_, dist_coeffs_, cv::Mat(), get_new_camera_matrix(size, alpha),
+                                size, CV_32FC1, map_x, map_y);
+}
+
+// 每块点数：块内先拆成x/y两个连续数组，逐点运算没有分支，编译器可以整块向量化
+static const int kPointBlock = 256;
+static const size_t kParallelPoints = 16384;
+
+// 畸变图像像素坐标 -> 去畸变图像像素坐标，与cv::undistortPoints相同的定点迭代
+template <typename Model>
+static void undistort_point_block(const Model& m, const float* src, float* dst, int n, int iterations) {
+    float x0[kPointBlock], y0[kPointBlock], x[kPointBlock], y[kPointBlock];
+    const float ifx = 1.0f / m.fx, ify = 1.0f / m.fy;
+    const float k1 = m.k[0], k2 = m.k[1], p1 = m.k[2], p2 = m.k[3];
+    const float k3 = m.k[4], k4 = m.k[5], k5 = m.k[6], k6 = m.k[7];
+
+    for (int i = 0; i < n; ++i) {
+        x0[i] = x[i] = (src[2 * i] - m.cx) * ifx;
+        y0[i] = y[i] = (src[2 * i + 1] - m.cy) * ify;
+    }
+    for (int it = 0; it < iterations; ++it) {
+        for (int i = 0; i < n; ++i) {
+            float xi = x[i], yi = y[i];
+            float r2 = xi * xi + yi * yi;
+            float icdist = (1.0f + ((k6 * r2 + k5) * r2 + k4) * r2) / (1.0f + ((k3 * r2 + k2) * r2 + k1) * r2);
+            float delta_x = 2.0f * p1 * xi * yi + p2 * (r2 + 2.0f * xi * xi);
+            float delta_y = p1 * (r2 + 2.0f * yi * yi) + 2.0f * p2 * xi * yi;
+            x[i] = (x0[i] - delta_x) * icdist;
+            y[i] = (y0[i] - delta_y) * icdist;
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        dst[2 * i] = x[i] * m.nfx + m.ncx;
+        dst[2 * i + 1] = y[i] * m.nfy + m.ncy;
+    }
+}
+
+// 去畸变图像像素坐标 -> 畸变图像像素坐标（正向模型）
+template <typename Model>
+static void distort_point_block(const Model& m, const float* src, float* dst, int n) {
+    float x[kPointBlock], y[kPointBlock];
+    const float infx = 1.0f / m.nfx, infy = 1.0f / m.nfy;
+    const float k1 = m.k[0], k2 = m.k[1], p1 = m.k[2], p2 = m.k[3];
+    const float k3 = m.k[4], k4 = m.k[5], k5 = m.k[6], k6 = m.k[7];
+
+    for (int i = 0; i < n; ++i) {
+        x[i] = (src[2 * i] - m.ncx) * infx;
+        y[i] = (src[2 * i + 1] - m.ncy) * infy;
+    }
+    for (int i = 0; i < n; ++i) {
+        float xi = x[i], yi = y[i];
+        float r2 = xi * xi + yi * yi;
+        float radial = (1.0f + ((k3 * r2 + k2) * r2 + k1) * r2) / (1.0f + ((k6 * r2 + k5) * r2 + k4) * r2);
+        x[i] = xi * radial + 2.0f * p1 * xi * yi + p2 * (r2 + 2.0f * xi * xi);
+        y[i] = yi * radial + p1 * (r2 + 2.0f * yi * yi) + 2.0f * p2 * xi * yi;
+    }
+    for (int i = 0; i < n; ++i) {
+        dst[2 * i] = x[i] * m.fx + m.cx;
+        dst[2 * i + 1] = y[i] * m.fy + m.cy;
+    }
+}
+
+// 按块处理count个点，点数多时按块并行
+template <typename BlockFn>
+static void for_each_point_block(size_t count, int num_threads, BlockFn fn) {
+    size_t blocks = (count + kPointBlock - 1) / kPointBlock;
+    auto run = [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; ++b) {
+            size_t first = b * kPointBlock;
+            fn(first, (int)std::min<size_t>(kPointBlock, count - first));
+        }
+    };
+    int stripes = num_threads > 0 ? num_threads : cv::getNumThreads();
+    if (count < kParallelPoints || stripes <= 1) {
+        run(0, blocks);
+        return;
+    }
+    cv::parallel_for_(cv::Range(0, (int)blocks), [&](const cv::Range& range) {
+        run((size_t)range.start, (size_t)range.end);
+    }, stripes);
+}
+
+bool ImageUndistorter::get_point_model(const cv::Size& size, double alpha, PointModel& model) {
+    if (!is_loaded()) {
+        std::cerr << "Calibration parameters are not loaded properly." << std::endl;
+        return false;
+    }
+    if (alpha >= 0 && size.empty()) {
+        std::cerr << "Image size is required when alpha >= 0." << std::endl;
+        return false;
+    }
+    // alpha < 0时新内参与尺寸无关，共用一个缓存项
+    RemapKey key = alpha < 0 ? RemapKey{ 0, 0, -1.0, 0 } : RemapKey{ size.width, size.height, alpha, 0 };
+
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    auto it = point_models_.find(key);
+    if (it != point_models_.end()) {
+        model = it->second;
+        return true;
+    }
+
+    cv::Mat K, D, P;
+    camera_matrix_.convertTo(K, CV_64F);
+    dist_coeffs_.reshape(1, 1).convertTo(D, CV_64F);
+    P = key.alpha < 0 ? K : cv::getOptimalNewCameraMatrix(camera_matrix_, dist_coeffs_, size, key.alpha, size);
+    P.convertTo(P, CV_64F);
+
+    PointModel m = {};
+    m.fx = (float)K.at<double>(0, 0);
+    m.fy = (float)K.at<double>(1, 1);
+    m.cx = (float)K.at<double>(0, 2);
+    m.cy = (float)K.at<double>(1, 2);
+    m.nfx = (float)P.at<double>(0, 0);
+    m.nfy = (float)P.at<double>(1, 1);
+    m.ncx = (float)P.at<double>(0, 2);
+    m.ncy = (float)P.at<double>(1, 2);
+    int coeffs = (int)D.total();
+    m.native = coeffs <= 8;
+    for (int i = 0; i < std::min(coeffs, 8); ++i) {
+        m.k[i] = (float)D.at<double>(i);
+    }
+    m.new_camera_matrix = P;
+
+    model = point_models_.emplace(key, m).first->second;
+    return true;
+}
+
+bool ImageUndistorter::undistort_points(const float* src, float* dst, size_t count, const cv::Size& size,
+                                        double alpha, int iterations) {
+    PointModel model;
+    if (!get_point_model(size, alpha, model)) {
+        return false;
+    }
+    if (count == 0) {
+        return true;
+    }
+    if (!model.native) {
+        // 12/14参数模型（薄棱镜、倾斜传感器）
+        cv::Mat in((int)count, 1, CV_32FC2, const_cast<float*>(src));
+        cv::Mat out((int)count, 1, CV_32FC2, dst);
+        cv::undistortPoints(in, out, camera_matrix_, dist_coeffs_, cv::noArray(), model.new_camera_matrix);
+        return true;
+    }
+    iterations = std::max(iterations, 1);
+    for_each_point_block(count, num_threads_, [&](size_t first, int n) {
+        undistort_point_block(model, src + 2 * first, dst + 2 * first, n, iterations);
+    });
+    return true;
+}
+
+bool ImageUndistorter::distort_points(const float* src, float* dst, size_t count, const cv::Size& size,
+                                      double alpha) {
+    PointModel model;
+    if (!get_point_model(size, alpha, model)) {
+        return false;
+    }
+    if (count == 0) {
+        return true;
+    }
+    if (!model.native) {
+        // 转为归一化坐标后用projectPoints投影（旋转平移为零）
+        std::vector<cv::Point3f> normalized(count);
+        for (size_t i = 0; i < count; ++i) {
+            normalized[i] = cv::Point3f((src[2 * i] - model.ncx) / model.nfx, (src[2 * i + 1] - model.ncy) / model.nfy, 1.0f);
+        }
+        cv::Mat out((int)count, 1, CV_32FC2, dst);
+        cv::projectPoints(normalized, cv::Mat::zeros(3, 1, CV_64F), cv::Mat::zeros(3, 1, CV_64F),
+                          camera_matrix_, dist_coeffs_, out);
+        return true;
+    }
+    for_each_point_block(count, num_threads_, [&](size_t first, int n) {
+        distort_point_block(model, src + 2 * first, dst + 2 * first, n);
+    });
+    return true;
+}
+
+std::shared_ptr<const ImageUndistorter::PointLut> ImageUndistorter::get_point_lut(const cv::Size& size, double alpha,
+                                                                                  int grid_step) {
+    RemapKey key = { size.width, size.height, alpha < 0 ? -1.0 : alpha, grid_step };
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        auto it = point_luts_.find(key);
+        if (it != point_luts_.end()) {
+            return it->second;
+        }
+    }
+
+    // 网格覆盖整幅图像（最后一列/行落在图像边界之外），每个网格点精确求解一次
+    std::shared_ptr<PointLut> lut = std::make_shared<PointLut>();
+    lut->step = grid_step;
+    lut->cols = (size.width + grid_step - 1) / grid_step + 1;
+    lut->rows = (size.height + grid_step - 1) / grid_step + 1;
+    lut->xy.resize((size_t)lut->cols * lut->rows * 2);
+    for (int r = 0; r < lut->rows; ++r) {
+        for (int c = 0; c < lut->cols; ++c) {
+            size_t i = ((size_t)r * lut->cols + c) * 2;
+            lut->xy[i] = (float)(c * grid_step);
+            lut->xy[i + 1] = (float)(r * grid_step);
+        }
+    }
+    if (!undistort_points(lut->xy.data(), lut->xy.data(), (size_t)lut->cols * lut->rows, size, alpha, 20)) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    return point_luts_.emplace(key, lut).first->second;
+}
+
+bool ImageUndistorter::undistort_points_lut(const float* src, float* dst, size_t count, const cv::Size& size,
+                                            double alpha, int grid_step) {
+    if (size.empty() || grid_step < 1) {
+        std::cerr << "Image size and a positive grid step are required for the point lookup table." << std::endl;
+        return false;
+    }
+    std::shared_ptr<const PointLut> lut = get_point_lut(size, alpha, grid_step);
+    if (!lut) {
+        return false;
+    }
+
+    // 网格外的点按最近的网格单元外推
+    const float inv_step = 1.0f / lut->step;
+    const float max_cell_x = (float)(lut->cols - 2);
+    const float max_cell_y = (float)(lut->rows - 2);
+    const float* table = lut->xy.data();
+    const size_t row_stride = (size_t)lut->cols * 2;
+    for_each_point_block(count, num_threads_, [&](size_t first, int n) {
+        const float* in = src + 2 * first;
+        float* out = dst + 2 * first;
+        for (int i = 0; i < n; ++i) {
+            float gx = in[2 * i] * inv_step;
+            float gy = in[2 * i + 1] * inv_step;
+            float cx = std::min(std::max(std::floor(gx), 0.0f), max_cell_x);
+            float cy = std::min(std::max(std::floor(gy), 0.0f), max_cell_y);
+            float fx = gx - cx;
+            float fy = gy - cy;
+            const float* p00 = table + (size_t)cy * row_stride + (size_t)cx * 2;
+            const float* p10 = p00 + row_stride;
+            float top_x = p00[0] + (p00[2] - p00[0]) * fx;
+            float top_y = p00[1] + (p00[3] - p00[1]) * fx;
+            float bottom_x = p10[0] + (p10[2] - p10[0]) * fx;
+            float bottom_y = p10[1] + (p10[3] - p10[1]) * fx;
+            out[2 * i] = top_x + (bottom_x - top_x) * fy;
+            out[2 * i + 1] = top_y + (bottom_y - top_y) * fy;
+        }
+    });
+    return true;
 }
 
 void ImageUndistorter::add_calibration(const cv::Mat& dst, cv::Mat& calibratedImage) {
 
-    calibratedImage = dst.clone();                                                      // 将dst复制到calibratedImage
+    if (calibratedImage.data != dst.data) {
+        dst.copyTo(calibratedImage);                                                    // 输出是另一幅图像时才拷贝，尺寸类型一致时复用缓冲区
+    }
+
+    draw_crosshair(calibratedImage);
+}
 
+void ImageUndistorter::draw_crosshair(cv::Mat& image, int size, const cv::Scalar& color, int thickness) {
 
-    int centerX = calibratedImage.cols / 2;
-    int centerY = calibratedImage.rows / 2;                                             // 计算图像的中心点
+    int centerX = image.cols / 2;
+    int centerY = image.rows / 2;                                                       // 计算图像的中心点
 
-    cv::line(calibratedImage, cv::Point(centerX - 20, centerY), 
-             cv::Point(centerX + 20, centerY), cv::Scalar(0, 0, 255), 2);               // 画线
+    cv::line(image, cv::Point(centerX - size, centerY),
+             cv::Point(centerX + size, centerY), color, thickness);                     // 画线
 
 
-    cv::line(calibratedImage, cv::Point(centerX, centerY - 20),
-             cv::Point(centerX, centerY + 20), cv::Scalar(0, 0, 255), 2);               // 画线
+    cv::line(image, cv::Point(centerX, centerY - size),
+             cv::Point(centerX, centerY + size), color, thickness);                     // 画线
 }
 
 cv::Mat ImageUndistorter::get_calibrated_image() const {